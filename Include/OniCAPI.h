@@ -120,12 +120,18 @@ ONI_C_API OniStatus oniStreamSetProperty(OniStreamHandle stream, int propertyId,
 ONI_C_API OniStatus oniStreamGetProperty(OniStreamHandle stream, int propertyId, void* data, int* pDataSize);
 /** Check if the property is supported the stream. Use the properties listed in OniTypes.h: ONI_STREAM_PROPERTY_..., or specific ones supplied by the device for its streams. */
 ONI_C_API bool oniStreamIsPropertySupported(OniStreamHandle stream, int propertyId);
+/** Get the pipeline telemetry counters of the stream. Same as getting ONI_STREAM_PROPERTY_TELEMETRY. */
+ONI_C_API OniStatus oniStreamGetTelemetry(OniStreamHandle stream, OniStreamTelemetry* pTelemetry);
 /** Invoke an internal functionality of the stream. */
 ONI_C_API OniStatus oniStreamInvoke(OniStreamHandle stream, int commandId, void* data, int dataSize);
 /** Check if a command is supported, for invoke */
 ONI_C_API bool oniStreamIsCommandSupported(OniStreamHandle stream, int commandId);
 /** Sets the stream buffer allocation functions. Note that this function may only be called while stream is not started. */
 ONI_C_API OniStatus oniStreamSetFrameBuffersAllocator(OniStreamHandle stream, OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
+/** Start copying the stream's frames to a named shared memory block, for OniFrameSubscriber readers in other processes. */
+ONI_C_API OniStatus oniStreamStartPublishing(OniStreamHandle stream, const char* name, int frameCount);
+/** Stop publishing the stream's frames. */
+ONI_C_API void oniStreamStopPublishing(OniStreamHandle stream);
 
 ////
 /** Mark another user of the frame. */
@@ -52,6 +52,8 @@ enum
 
 	ONI_STREAM_PROPERTY_NUMBER_OF_FRAMES		= 8, // int
 
+	ONI_STREAM_PROPERTY_TELEMETRY			= 9, // OniStreamTelemetry (read only)
+
 	// Camera
 	ONI_STREAM_PROPERTY_AUTO_WHITE_BALANCE		= 100, // bool
 	ONI_STREAM_PROPERTY_AUTO_EXPOSURE		= 101, // bool
@@ -198,4 +198,70 @@ typedef struct
 	OniStreamHandle stream;
 } OniSeek;
 
+/** Number of buckets in an OniLatencyHistogram. */
+#define ONI_TELEMETRY_LATENCY_BUCKETS 24
+
+/**
+ Histogram of latencies, in microseconds. Bucket 0 counts samples below 1 microsecond, bucket i (i > 0)
+ counts samples in [2^(i-1), 2^i) microseconds. The last bucket also counts everything above its range.
+*/
+typedef struct
+{
+	/** Number of samples. */
+	uint64_t count;
+	/** Sum of all samples. */
+	uint64_t totalMicroseconds;
+	/** Largest sample. */
+	uint64_t maxMicroseconds;
+	/** Sample count per bucket. */
+	uint64_t buckets[ONI_TELEMETRY_LATENCY_BUCKETS];
+} OniLatencyHistogram;
+
+/**
+ Counters describing the path of a stream's frames, from the USB endpoint to the application.
+ All counters are cumulative since the stream was created. Layers a driver does not instrument report 0.
+ Retrieved using ONI_STREAM_PROPERTY_TELEMETRY or oniStreamGetTelemetry().
+*/
+typedef struct
+{
+	/** USB layer (driver): bytes of frame data received. */
+	uint64_t usbBytesReceived;
+	/** USB layer (driver): packets missing from the sequence. */
+	uint64_t usbPacketsLost;
+
+	/** Processor layer (driver): frames that began arriving. */
+	uint64_t processorFramesStarted;
+	/** Processor layer (driver): frames that were marked as corrupted. */
+	uint64_t processorFramesCorrupted;
+	/** Processor layer (driver): frames handed to OpenNI. */
+	uint64_t processorFramesProduced;
+	/** Processor layer (driver): times no free frame buffer was available. */
+	uint64_t processorBufferFailures;
+	/** Latency from the first USB packet of a frame until the driver hands it to OpenNI. */
+	OniLatencyHistogram usbToDriverOutputLatency;
+
+	/** Frame holder: frames received from the driver. */
+	uint64_t frameHolderFramesReceived;
+	/** Frame holder: frames replaced by a newer one before being read. */
+	uint64_t frameHolderFramesDropped;
+	/** Frame holder: frames read by the application. */
+	uint64_t frameHolderFramesRead;
+
+	/** Callbacks: new frame notifications delivered to listeners. */
+	uint64_t callbackFramesDelivered;
+	/** Latency from the driver handing a frame to OpenNI until new frame listeners are called.
+	    USB-to-callback latency is the sum of this and usbToDriverOutputLatency. */
+	OniLatencyHistogram driverOutputToCallbackLatency;
+
+	/** Recorder: frames written to attached recorders (counted once per recorder). */
+	uint64_t recorderFramesRecorded;
+
+	/** Frame buffer pool: number of buffers allocated. */
+	int bufferPoolSize;
+	/** Frame buffer pool: number of buffers currently in use. */
+	int bufferPoolInUse;
+	/** Frame buffer pool: largest number of buffers in use at once. */
+	int bufferPoolPeakInUse;
+} OniStreamTelemetry;
+
 #endif // ONICTYPES_H
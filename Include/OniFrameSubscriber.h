@@ -0,0 +1,70 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef ONIFRAMESUBSCRIBER_H
+#define ONIFRAMESUBSCRIBER_H
+
+#include "OniCTypes.h"
+
+/**
+ * A lightweight library for reading frames another process publishes with VideoStream::startPublishing().
+ * It doesn't load OpenNI or any driver. Frames are read in place from shared memory: a frame's data stays
+ * valid until it is released, and the publisher won't overwrite it meanwhile.
+ */
+
+#ifdef ONI_FRAME_SUBSCRIBER_EXPORT
+#	define ONI_SUBSCRIBER_C_API ONI_C_API_EXPORT
+#else
+#	define ONI_SUBSCRIBER_C_API ONI_C_API_IMPORT
+#endif
+
+struct _OniFrameSubscriber;
+typedef struct _OniFrameSubscriber* OniFrameSubscriberHandle;
+
+/** Maximum number of frames a subscriber may hold at once. The publisher needs one more free slot to keep publishing. */
+#define ONI_SUBSCRIBER_MAX_HELD_FRAMES 64
+
+/**
+ * Opens frames published under a name.
+ * @returns ONI_STATUS_NO_DEVICE if nothing is published under that name (yet).
+ */
+ONI_SUBSCRIBER_C_API OniStatus oniSubscriberOpen(const char* name, OniFrameSubscriberHandle* pSubscriber);
+
+/** Closes a subscriber. Frames it still holds are released. */
+ONI_SUBSCRIBER_C_API void oniSubscriberClose(OniFrameSubscriberHandle subscriber);
+
+/**
+ * Waits for a frame newer than the last one read, and holds it until oniSubscriberReleaseFrame() is called.
+ * Frames published in between are skipped.
+ * @param	timeout		Time to wait, in milliseconds, or ONI_TIMEOUT_FOREVER.
+ * @returns ONI_STATUS_TIME_OUT if no frame arrived in time, ONI_STATUS_NO_DEVICE once the publisher stopped.
+ */
+ONI_SUBSCRIBER_C_API OniStatus oniSubscriberReadFrame(OniFrameSubscriberHandle subscriber, int timeout, OniFrame** pFrame);
+
+/** Releases a frame read with oniSubscriberReadFrame(), letting the publisher reuse its memory. */
+ONI_SUBSCRIBER_C_API void oniSubscriberReleaseFrame(OniFrameSubscriberHandle subscriber, OniFrame* pFrame);
+
+/** Gets the type of sensor whose frames are published. */
+ONI_SUBSCRIBER_C_API OniSensorType oniSubscriberGetSensorType(OniFrameSubscriberHandle subscriber);
+
+/** Gets the number of frames the publisher dropped, as subscribers held all its slots, or a frame didn't fit. */
+ONI_SUBSCRIBER_C_API uint64_t oniSubscriberGetDroppedFrames(OniFrameSubscriberHandle subscriber);
+
+#endif // ONIFRAMESUBSCRIBER_H
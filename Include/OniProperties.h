@@ -55,6 +55,8 @@ enum
 
 	STREAM_PROPERTY_NUMBER_OF_FRAMES		= 8, // int
 
+	STREAM_PROPERTY_TELEMETRY			= 9, // OniStreamTelemetry (read only)
+
 	// Camera
 	STREAM_PROPERTY_AUTO_WHITE_BALANCE		= 100, // bool
 	STREAM_PROPERTY_AUTO_EXPOSURE			= 101, // bool
@@ -944,6 +944,36 @@ public:
 		}
 	}
 
+	/**
+	Starts copying this stream's frames to a named shared memory block, so other processes can read them using
+	the OniFrameSubscriber library (see OniFrameSubscriber.h). Each frame is copied once, however many subscribers
+	there are. Slots are sized for the current video mode: frames that don't fit are dropped.
+	@param [in] name Name of the shared memory block, which subscribers open.
+	@param [in] frameCount Number of frames the block holds (2 to 64). Subscribers can hold all but one of them.
+	*/
+	Status startPublishing(const char* name, int frameCount = 4)
+	{
+		if (!isValid())
+		{
+			return STATUS_ERROR;
+		}
+
+		return (Status)oniStreamStartPublishing(m_stream, name, frameCount);
+	}
+
+	/**
+	Stops publishing this stream's frames, and removes the shared memory block. Subscribers are notified.
+	*/
+	void stopPublishing()
+	{
+		if (!isValid())
+		{
+			return;
+		}
+
+		oniStreamStopPublishing(m_stream);
+	}
+
 	/**
 	@internal
 	Get an internal handle. This handle can be used via the C API.
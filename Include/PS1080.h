@@ -139,6 +139,8 @@ enum
 	XN_STREAM_PROPERTY_INPUT_FORMAT = 0x10800001, // "InputFormat"
 	/** unsigned long long (XnCroppingMode) */
 	XN_STREAM_PROPERTY_CROPPING_MODE = 0x10800002, // "CroppingMode"
+	/** Boolean. When set, software cropping returns a view of the uncropped frame (data points at the crop origin, stride stays a full line) instead of copying the cropped rows */
+	XN_STREAM_PROPERTY_CROPPING_VIEW = 0x10800003, // "CroppingView"
 
 	/*******************************************************************/
 	/* Depth stream properties                                         */
@@ -184,6 +186,30 @@ enum
 	XN_STREAM_PROPERTY_D2S_TABLE = 0x10801011, // "D2S"
 	/** get only */
 	XN_STREAM_PROPERTY_DEPTH_SENSOR_CALIBRATION_INFO = 0x10801012,
+	/** unsigned long long. Post-filter: fill no-depth runs along rows up to this many pixels wide, with the farther depth
+	    on their sides. 0 (default) disables it. Filters only apply to DEPTH_1_MM and DEPTH_100_UM output */
+	XN_STREAM_PROPERTY_DEPTH_FILTER_HOLE_FILL = 0x10801013, // "DepthFilterHoleFill"
+	/** unsigned long long. Post-filter: average each pixel with its 4 neighbours that are within this depth of it (in
+	    output units), keeping edges. 0 (default) disables it */
+	XN_STREAM_PROPERTY_DEPTH_FILTER_SPATIAL_DELTA = 0x10801014, // "DepthFilterSpatialDelta"
+	/** unsigned long long. Post-filter: weight of the new frame in a temporal exponential filter, in 1/256 units (1-255).
+	    0 (default) disables it */
+	XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_ALPHA = 0x10801015, // "DepthFilterTemporalAlpha"
+	/** unsigned long long. Pixels that moved more than this depth (in output units) restart the temporal filter. 0 (default)
+	    for no limit */
+	XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_DELTA = 0x10801016, // "DepthFilterTemporalDelta"
+	/** unsigned long long. A pixel that lost its depth keeps its last one if it had depth in at least this many of the
+	    last 8 frames (1-8). 0 (default) disables it */
+	XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_PERSISTENCE = 0x10801017, // "DepthFilterTemporalPersistence"
+	/** unsigned long long. Number of threads the post-filters run on, in horizontal bands (up to 16). 0 (default) runs them
+	    on the USB thread only */
+	XN_STREAM_PROPERTY_DEPTH_FILTER_THREADS = 0x10801018, // "DepthFilterThreads"
+	/** unsigned long long. Output frames are reduced by this factor in both axes (1 - default, 2 or 4), after registration
+	    and post-filters. The stream's video mode stays the full resolution one, frames report the reduced one. Can't be
+	    combined with cropping. Only applies to DEPTH_1_MM and DEPTH_100_UM output */
+	XN_STREAM_PROPERTY_DEPTH_DECIMATION = 0x10801019, // "DepthDecimation"
+	/** XnDepthDecimationMethod. How each 2x2 block is reduced to a single pixel */
+	XN_STREAM_PROPERTY_DEPTH_DECIMATION_METHOD = 0x1080101A, // "DepthDecimationMethod"
 	/** Boolean */
 	XN_STREAM_PROPERTY_GMC_MODE	= 0x1080FF44, // "GmcMode"
 	/** Boolean */
@@ -198,6 +224,13 @@ enum
 	/*******************************************************************/
 	/** Integer */
 	XN_STREAM_PROPERTY_FLICKER = 0x10802001, // "Flicker"
+	/** Boolean. When set, JPEG input is decoded with the fast integer DCT (JDCT_IFAST) */
+	XN_STREAM_PROPERTY_JPEG_FAST_DCT = 0x10802002, // "JpegFastDCT"
+	/** Boolean. Cleared to upsample JPEG chroma by replication instead of interpolation. Default is TRUE */
+	XN_STREAM_PROPERTY_JPEG_FANCY_UPSAMPLING = 0x10802003, // "JpegFancyUpsampling"
+	/** Integer. When above 1, JPEG frames with restart markers are decoded in parallel strips on this many threads,
+	    once the whole frame has arrived. Otherwise, frames are decoded on the USB thread as their packets arrive */
+	XN_STREAM_PROPERTY_JPEG_DECODE_THREADS = 0x10802004, // "JpegDecodeThreads"
 };
 
 typedef enum
@@ -318,6 +351,14 @@ typedef enum XnFirmwareCroppingMode
 	XN_FIRMWARE_CROPPING_MODE_INCREASED_FPS = 2,
 } XnFirmwareCroppingMode;
 
+typedef enum XnDepthDecimationMethod
+{
+	/** The closest depth in the block. Keeps thin and near objects. */
+	XN_DEPTH_DECIMATION_MIN_NONZERO = 0,
+	/** The (lower) median of the depths in the block. Drops outliers. */
+	XN_DEPTH_DECIMATION_MEDIAN = 1,
+} XnDepthDecimationMethod;
+
 typedef enum
 {
 	XnLogFilterDebug		= 0x0001,
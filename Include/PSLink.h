@@ -75,6 +75,9 @@ enum
 	LINK_PROP_PIXEL_FORMAT = 0x12001001, // "PixelFormat"
 	/* Int. 0 - None, 1 - 8z, 2 - 16z, 3 - 24z, 4 - 6-bit, 5 - 10-bit, 6 - 11-bit, 7 - 12-bit */
 	LINK_PROP_COMPRESSION = 0x12001002, // "Compression"
+	/* Int, get only. Bytes copied as-is while parsing the last complete frame (the frame size when the wire format is the
+	   output format, and only staging copies for decoding parsers) */
+	LINK_PROP_LAST_FRAME_COPIED_BYTES = 0x12001003, // "LastFrameCopiedBytes"
 
 	/**** Depth Stream properties ****/
 	/* Real, get only */
@@ -135,7 +135,7 @@ void SampleViewer::display()
 
 	if (depthFrame.isValid())
 	{
-		calculateHistogram(m_pDepthHist, MAX_DEPTH, depthFrame);
+		m_depthHist.calculate(depthFrame, MAX_DEPTH);
 	}
 
 	memset(m_pTexMap, 0, m_nTexMapX*m_nTexMapY*sizeof(openni::RGB888Pixel));
@@ -149,6 +149,8 @@ void SampleViewer::display()
 		int rowSize = depthFrame.getStrideInBytes() / sizeof(openni::DepthPixel);
 		int width = depthFrame.getWidth();
 		int height = depthFrame.getHeight();
+		const uint8_t* pIntensities = m_depthHist.getIntensities();
+		int nLastDepth = m_depthHist.getSize() - 1;
 
 		for (int y = 0; y < height; ++y)
 		{
@@ -164,7 +166,7 @@ void SampleViewer::display()
 						factor[0] = factor[1] = 0;
 					}
 
-					int nHistValue = m_pDepthHist[*pDepth];
+					int nHistValue = pIntensities[*pDepth < nLastDepth ? *pDepth : nLastDepth];
 					pTex->r = nHistValue*factor[0];
 					pTex->g = nHistValue*factor[1];
 					pTex->b = nHistValue*factor[2];
@@ -23,6 +23,7 @@
 
 #include "MWClosestPoint/MWClosestPoint.h"
 #include <OpenNI.h>
+#include <DepthHistogram.h>
 
 #define MAX_DEPTH 10000
 
@@ -82,7 +83,7 @@ private:
 	static void glutDisplay();
 	static void glutKeyboard(unsigned char key, int x, int y);
 
-	float				m_pDepthHist[MAX_DEPTH];
+	depth_histogram::DepthHistogram	m_depthHist;
 	char			m_strSampleName[ONI_MAX_STR];
 	openni::RGB888Pixel*m_pTexMap;
 	unsigned int		m_nTexMapX;
@@ -79,41 +79,4 @@ void Sleep(int millisecs)
 }
 #endif // WIN32
 
-void calculateHistogram(float* pHistogram, int histogramSize, const openni::VideoFrameRef& frame)
-{
-	const openni::DepthPixel* pDepth = (const openni::DepthPixel*)frame.getData();
-	// Calculate the accumulative histogram (the yellow display...)
-	memset(pHistogram, 0, histogramSize*sizeof(float));
-	int restOfRow = frame.getStrideInBytes() / sizeof(openni::DepthPixel) - frame.getWidth();
-	int height = frame.getHeight();
-	int width = frame.getWidth();
-
-	unsigned int nNumberOfPoints = 0;
-	for (int y = 0; y < height; ++y)
-	{
-		for (int x = 0; x < width; ++x, ++pDepth)
-		{
-			if (*pDepth != 0)
-			{
-				pHistogram[*pDepth]++;
-				nNumberOfPoints++;
-			}
-		}
-		pDepth += restOfRow;
-	}
-	for (int nIndex=1; nIndex<histogramSize; nIndex++)
-	{
-		pHistogram[nIndex] += pHistogram[nIndex-1];
-	}
-	if (nNumberOfPoints)
-	{
-		for (int nIndex=1; nIndex<histogramSize; nIndex++)
-		{
-			pHistogram[nIndex] = (256 * (1.0f - (pHistogram[nIndex] / nNumberOfPoints)));
-		}
-	}
-}
-
-
-
 #endif // ONISAMPLEUTILITIES_H
@@ -0,0 +1,288 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "DepthHistogram.h"
+#include "DepthHistogramSimd.h"
+#include <string.h>
+
+/* Number of interleaved tables pixels are counted into. */
+#define DEPTH_HISTOGRAM_TABLES 4
+#define DEPTH_HISTOGRAM_MAX_SIZE 65536
+
+namespace depth_histogram
+{
+
+static bool g_bVectorized = hasAVX2();
+
+static inline uint16_t clampDepth(uint16_t nDepth, uint16_t nLast)
+{
+	return nDepth > nLast ? nLast : nDepth;
+}
+
+/* c * i / 255, rounded */
+static inline uint8_t scaleColor(uint8_t c, uint8_t i)
+{
+	uint32_t t = (uint32_t)c * i + 128;
+	return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+static inline uint32_t packColor(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha)
+{
+	uint8_t aColor[4] = { red, green, blue, alpha };
+	uint32_t nColor;
+	memcpy(&nColor, aColor, sizeof(nColor));
+	return nColor;
+}
+
+#if DEPTH_HISTOGRAM_SIMD_X86
+/* Colorizes 16 pixels at a time, returns the number of pixels done. */
+static DEPTH_HISTOGRAM_TARGET_AVX2 int colorizeRowRGBAAVX2(const openni::DepthPixel* pDepth, int width, uint16_t nLast, const uint32_t* pColors, uint32_t* pOutput)
+{
+	const __m256i last = _mm256_set1_epi16((short)nLast);
+	const int* pTable = reinterpret_cast<const int*>(pColors);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		__m256i depth = _mm256_min_epu16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pDepth + x)), last);
+		__m256i low = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(depth));
+		__m256i high = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(depth, 1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput + x), _mm256_i32gather_epi32(pTable, low, 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput + x + 8), _mm256_i32gather_epi32(pTable, high, 4));
+	}
+
+	return x;
+}
+#endif
+
+DepthHistogram::DepthHistogram() :
+	m_nSize(0),
+	m_nNumberOfPoints(0),
+	m_pCounts(NULL),
+	m_pIntensities(NULL)
+{
+}
+
+DepthHistogram::~DepthHistogram()
+{
+	delete[] m_pCounts;
+	delete[] m_pIntensities;
+}
+
+void DepthHistogram::resize(int size)
+{
+	if (size < 1)
+	{
+		size = 1;
+	}
+	else if (size > DEPTH_HISTOGRAM_MAX_SIZE)
+	{
+		size = DEPTH_HISTOGRAM_MAX_SIZE;
+	}
+
+	if (size != m_nSize)
+	{
+		delete[] m_pCounts;
+		delete[] m_pIntensities;
+		m_pCounts = new uint32_t[size * DEPTH_HISTOGRAM_TABLES];
+		m_pIntensities = new uint8_t[size];
+		m_nSize = size;
+	}
+}
+
+void DepthHistogram::calculate(const openni::VideoFrameRef& frame, int maxDepth)
+{
+	calculate((const openni::DepthPixel*)frame.getData(), frame.getWidth(), frame.getHeight(), frame.getStrideInBytes(), maxDepth);
+}
+
+void DepthHistogram::calculate(const openni::DepthPixel* pDepth, int width, int height, int strideInBytes, int maxDepth)
+{
+	resize(maxDepth);
+	memset(m_pCounts, 0, m_nSize * DEPTH_HISTOGRAM_TABLES * sizeof(uint32_t));
+
+	uint32_t* pCounts0 = m_pCounts;
+	uint32_t* pCounts1 = pCounts0 + m_nSize;
+	uint32_t* pCounts2 = pCounts1 + m_nSize;
+	uint32_t* pCounts3 = pCounts2 + m_nSize;
+	const uint16_t nLast = (uint16_t)(m_nSize - 1);
+
+	// count (no depth included, so the loop doesn't branch)
+	const uint8_t* pRow = (const uint8_t*)pDepth;
+	for (int y = 0; y < height; ++y, pRow += strideInBytes)
+	{
+		const openni::DepthPixel* pPixel = (const openni::DepthPixel*)pRow;
+		int x = 0;
+		for (; x + 4 <= width; x += 4, pPixel += 4)
+		{
+			pCounts0[clampDepth(pPixel[0], nLast)]++;
+			pCounts1[clampDepth(pPixel[1], nLast)]++;
+			pCounts2[clampDepth(pPixel[2], nLast)]++;
+			pCounts3[clampDepth(pPixel[3], nLast)]++;
+		}
+		for (; x < width; ++x, ++pPixel)
+		{
+			pCounts0[clampDepth(*pPixel, nLast)]++;
+		}
+	}
+
+	// merge the tables, and accumulate
+	uint32_t nNumberOfPoints = 0;
+	for (int i = 1; i < m_nSize; ++i)
+	{
+		nNumberOfPoints += pCounts0[i] + pCounts1[i] + pCounts2[i] + pCounts3[i];
+		pCounts0[i] = nNumberOfPoints;
+	}
+	m_nNumberOfPoints = (int)nNumberOfPoints;
+
+	// 256 * (1 - cumulative / points), in 8.24 fixed point. (points - cumulative) * scale can't exceed 2^32.
+	m_pIntensities[0] = 0;
+	uint64_t nScale = (nNumberOfPoints == 0) ? 0 : ((uint64_t)256 << 24) / nNumberOfPoints;
+	for (int i = 1; i < m_nSize; ++i)
+	{
+		uint32_t nIntensity = (uint32_t)(((uint64_t)(nNumberOfPoints - pCounts0[i]) * nScale) >> 24);
+		m_pIntensities[i] = (uint8_t)(nIntensity > 255 ? 255 : nIntensity);
+	}
+}
+
+ColorMap::ColorMap() :
+	m_nSize(0),
+	m_pColors(NULL)
+{
+}
+
+ColorMap::~ColorMap()
+{
+	delete[] m_pColors;
+}
+
+void ColorMap::resize(int size)
+{
+	if (size != m_nSize)
+	{
+		delete[] m_pColors;
+		m_pColors = new uint32_t[size];
+		m_nSize = size;
+	}
+}
+
+void ColorMap::build(const DepthHistogram& histogram, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha)
+{
+	resize(histogram.getSize());
+	const uint8_t* pIntensities = histogram.getIntensities();
+
+	m_pColors[0] = 0;
+	for (int i = 1; i < m_nSize; ++i)
+	{
+		uint8_t nIntensity = pIntensities[i];
+		m_pColors[i] = packColor(scaleColor(red, nIntensity), scaleColor(green, nIntensity), scaleColor(blue, nIntensity), alpha);
+	}
+}
+
+void ColorMap::build(const DepthHistogram& histogram, const uint8_t* pRed, const uint8_t* pGreen, const uint8_t* pBlue, uint8_t alpha)
+{
+	resize(histogram.getSize());
+	const uint8_t* pIntensities = histogram.getIntensities();
+
+	m_pColors[0] = 0;
+	for (int i = 1; i < m_nSize; ++i)
+	{
+		uint8_t nIntensity = pIntensities[i];
+		int nColIndex = i % 256;
+		m_pColors[i] = packColor(scaleColor(pRed[nColIndex], nIntensity), scaleColor(pGreen[nColIndex], nIntensity), scaleColor(pBlue[nColIndex], nIntensity), alpha);
+	}
+}
+
+void ColorMap::colorizeRGBA(const openni::VideoFrameRef& frame, uint8_t* pTexture, int textureStrideInBytes) const
+{
+	colorizeRGBA((const openni::DepthPixel*)frame.getData(), frame.getWidth(), frame.getHeight(), frame.getStrideInBytes(), pTexture, textureStrideInBytes);
+}
+
+void ColorMap::colorizeRGBA(const openni::DepthPixel* pDepth, int width, int height, int strideInBytes, uint8_t* pTexture, int textureStrideInBytes) const
+{
+	if (m_nSize == 0)
+	{
+		return;
+	}
+
+	const uint16_t nLast = (uint16_t)(m_nSize - 1);
+	const uint8_t* pRow = (const uint8_t*)pDepth;
+
+	for (int y = 0; y < height; ++y, pRow += strideInBytes, pTexture += textureStrideInBytes)
+	{
+		const openni::DepthPixel* pPixel = (const openni::DepthPixel*)pRow;
+		uint32_t* pOutput = (uint32_t*)pTexture;
+		int x = 0;
+
+#if DEPTH_HISTOGRAM_SIMD_X86
+		if (g_bVectorized)
+		{
+			x = colorizeRowRGBAAVX2(pPixel, width, nLast, m_pColors, pOutput);
+		}
+#endif
+
+		for (; x < width; ++x)
+		{
+			pOutput[x] = m_pColors[clampDepth(pPixel[x], nLast)];
+		}
+	}
+}
+
+void ColorMap::colorizeRGB(const openni::VideoFrameRef& frame, openni::RGB888Pixel* pTexture, int textureStrideInPixels) const
+{
+	colorizeRGB((const openni::DepthPixel*)frame.getData(), frame.getWidth(), frame.getHeight(), frame.getStrideInBytes(), pTexture, textureStrideInPixels);
+}
+
+void ColorMap::colorizeRGB(const openni::DepthPixel* pDepth, int width, int height, int strideInBytes, openni::RGB888Pixel* pTexture, int textureStrideInPixels) const
+{
+	if (m_nSize == 0)
+	{
+		return;
+	}
+
+	const uint16_t nLast = (uint16_t)(m_nSize - 1);
+	const uint8_t* pRow = (const uint8_t*)pDepth;
+
+	for (int y = 0; y < height; ++y, pRow += strideInBytes, pTexture += textureStrideInPixels)
+	{
+		const openni::DepthPixel* pPixel = (const openni::DepthPixel*)pRow;
+		for (int x = 0; x < width; ++x)
+		{
+			if (pPixel[x] != 0)
+			{
+				const uint8_t* pColor = (const uint8_t*)&m_pColors[clampDepth(pPixel[x], nLast)];
+				pTexture[x].r = pColor[0];
+				pTexture[x].g = pColor[1];
+				pTexture[x].b = pColor[2];
+			}
+		}
+	}
+}
+
+void ColorMap::setVectorized(bool bVectorized)
+{
+	g_bVectorized = bVectorized && hasAVX2();
+}
+
+bool ColorMap::isVectorized()
+{
+	return g_bVectorized;
+}
+
+}
@@ -0,0 +1,103 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef DEPTHHISTOGRAM_H
+#define DEPTHHISTOGRAM_H
+
+#include <OpenNI.h>
+
+namespace depth_histogram
+{
+
+/**
+ * Cumulative histogram of a depth frame, turned into an intensity per depth value: 255 for the closest
+ * point in the frame, going down to 0 for the farthest one, by rank. Depth 0 (no depth) always gets 0.
+ *
+ * Pixels are counted into several interleaved tables, so that runs of equal depth values (which are
+ * very common) don't stall on the increment of the previous pixel. Values of maxDepth and above are
+ * counted as maxDepth - 1.
+ */
+class DepthHistogram
+{
+public:
+	DepthHistogram();
+	~DepthHistogram();
+
+	void calculate(const openni::VideoFrameRef& frame, int maxDepth);
+	void calculate(const openni::DepthPixel* pDepth, int width, int height, int strideInBytes, int maxDepth);
+
+	int getSize() const { return m_nSize; }
+	int getNumberOfPoints() const { return m_nNumberOfPoints; }
+	const uint8_t* getIntensities() const { return m_pIntensities; }
+
+private:
+	DepthHistogram(const DepthHistogram&);
+	DepthHistogram& operator=(const DepthHistogram&);
+
+	void resize(int size);
+
+	int m_nSize;
+	int m_nNumberOfPoints;
+	uint32_t* m_pCounts;
+	uint8_t* m_pIntensities;
+};
+
+/**
+ * A color per depth value, built from a DepthHistogram, and used to colorize whole frames with a single
+ * table lookup per pixel (vectorized on CPUs that have AVX2).
+ */
+class ColorMap
+{
+public:
+	ColorMap();
+	~ColorMap();
+
+	/* (red, green, blue) at the closest point, fading to black at the farthest one. */
+	void build(const DepthHistogram& histogram, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha);
+	/* Same, with the color of depth d taken from 256 entry palettes, at d % 256. */
+	void build(const DepthHistogram& histogram, const uint8_t* pRed, const uint8_t* pGreen, const uint8_t* pBlue, uint8_t alpha);
+
+	/* Writes every pixel of the frame. Pixels with no depth are written as 0 (transparent black).
+	   pTexture points at the texture pixel matching the first pixel of the frame. */
+	void colorizeRGBA(const openni::VideoFrameRef& frame, uint8_t* pTexture, int textureStrideInBytes) const;
+	void colorizeRGBA(const openni::DepthPixel* pDepth, int width, int height, int strideInBytes, uint8_t* pTexture, int textureStrideInBytes) const;
+
+	/* Writes only pixels that have depth, so the depth can be drawn over another image. */
+	void colorizeRGB(const openni::VideoFrameRef& frame, openni::RGB888Pixel* pTexture, int textureStrideInPixels) const;
+	void colorizeRGB(const openni::DepthPixel* pDepth, int width, int height, int strideInBytes, openni::RGB888Pixel* pTexture, int textureStrideInPixels) const;
+
+	/* Disables the vectorized path, even if the CPU supports it. Meant for testing and measuring. */
+	static void setVectorized(bool bVectorized);
+	static bool isVectorized();
+
+private:
+	ColorMap(const ColorMap&);
+	ColorMap& operator=(const ColorMap&);
+
+	void resize(int size);
+
+	int m_nSize;
+	/* RGBA, in memory order */
+	uint32_t* m_pColors;
+};
+
+}
+
+#endif // DEPTHHISTOGRAM_H
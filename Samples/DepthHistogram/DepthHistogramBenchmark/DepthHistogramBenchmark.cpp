@@ -0,0 +1,252 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// DepthHistogramBenchmark.cpp : Measures depth histogram colorization, as done by the viewers, against the
+// float histogram it replaced, and checks the vectorized colorization against the scalar one.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include <DepthHistogram.h>
+
+using namespace depth_histogram;
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_FRAMES 300
+#define MAX_DEPTH 10000
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct
+{
+	int nXRes;
+	int nYRes;
+	int nFPS;
+} BenchmarkMode;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const BenchmarkMode g_modes[] =
+{
+	{ 640, 480, 30 },
+	{ 1280, 1024, 30 },
+	{ 320, 240, 120 },
+};
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/* A slanted wall with a box in front of it, noise, holes, and a few values out of range. */
+void GenerateFrame(int nXRes, int nYRes, std::vector<openni::DepthPixel>& frame)
+{
+	frame.resize(nXRes * nYRes);
+	for (int y = 0; y < nYRes; ++y)
+	{
+		for (int x = 0; x < nXRes; ++x)
+		{
+			int nDepth = 2500 + x * 1000 / nXRes;
+			if (x > nXRes / 3 && x < nXRes * 2 / 3 && y > nYRes / 4 && y < nYRes * 3 / 4)
+			{
+				nDepth = 1200;
+			}
+			nDepth += rand() % 9 - 4;
+			if (rand() % 20 == 0)
+			{
+				nDepth = 0;
+			}
+			else if (rand() % 1000 == 0)
+			{
+				nDepth = MAX_DEPTH + rand() % 100;
+			}
+			frame[y * nXRes + x] = (openni::DepthPixel)nDepth;
+		}
+	}
+}
+
+/* The float histogram and per pixel colorization the viewers used to do (with values out of range counted
+   as the largest one, as DepthHistogram does, instead of writing past the histogram). */
+void ReferenceHistogram(const openni::DepthPixel* pDepth, int nPixels, float* pHistogram, int histogramSize)
+{
+	memset(pHistogram, 0, histogramSize * sizeof(float));
+	unsigned int nNumberOfPoints = 0;
+	for (int i = 0; i < nPixels; ++i)
+	{
+		if (pDepth[i] != 0)
+		{
+			pHistogram[XN_MIN(pDepth[i], histogramSize - 1)]++;
+			nNumberOfPoints++;
+		}
+	}
+	for (int nIndex = 1; nIndex < histogramSize; nIndex++)
+	{
+		pHistogram[nIndex] += pHistogram[nIndex-1];
+	}
+	if (nNumberOfPoints)
+	{
+		for (int nIndex = 1; nIndex < histogramSize; nIndex++)
+		{
+			pHistogram[nIndex] = (256 * (1.0f - (pHistogram[nIndex] / nNumberOfPoints)));
+		}
+	}
+}
+
+void ReferenceColorize(const openni::DepthPixel* pDepth, int nPixels, const float* pHistogram, int histogramSize, uint8_t* pTexture)
+{
+	for (int i = 0; i < nPixels; ++i, pTexture += 4)
+	{
+		uint8_t nValue = (uint8_t)pHistogram[XN_MIN(pDepth[i], histogramSize - 1)];
+		pTexture[0] = nValue;
+		pTexture[1] = nValue;
+		pTexture[2] = 0;
+		pTexture[3] = (pDepth[i] == 0) ? 0 : 255;
+	}
+}
+
+/* Checks the intensities against the float histogram, and the selected colorization against the scalar one. */
+bool Verify(xnl::Benchmark& benchmark, uint32_t nPass)
+{
+	const int aWidths[] = { 1, 7, 15, 16, 17, 33, 640 };
+	for (uint32_t w = 0; w < sizeof(aWidths) / sizeof(aWidths[0]); ++w)
+	{
+		int nXRes = aWidths[w];
+		int nYRes = 13;
+		// leave room between rows, to check strides are respected
+		int nStride = nXRes + 3;
+		std::vector<openni::DepthPixel> source;
+		GenerateFrame(nXRes, nYRes, source);
+		std::vector<openni::DepthPixel> frame(nStride * nYRes, 1);
+		for (int y = 0; y < nYRes; ++y)
+		{
+			xnOSMemCopy(&frame[y * nStride], &source[y * nXRes], nXRes * sizeof(openni::DepthPixel));
+		}
+
+		DepthHistogram histogram;
+		histogram.calculate(&frame[0], nXRes, nYRes, nStride * sizeof(openni::DepthPixel), MAX_DEPTH);
+
+		std::vector<float> reference(MAX_DEPTH);
+		ReferenceHistogram(&source[0], nXRes * nYRes, &reference[0], MAX_DEPTH);
+		for (int i = 1; i < MAX_DEPTH; ++i)
+		{
+			int nExpected = XN_MIN((int)reference[i], 255);
+			int nActual = histogram.getIntensities()[i];
+			if ((i == 1 || reference[i] != reference[i-1]) && abs(nExpected - nActual) > 1)
+			{
+				benchmark.Fail("Intensity of %d is %d, expected %d (%dx%d)!", i, nActual, nExpected, nXRes, nYRes);
+				return false;
+			}
+		}
+
+		ColorMap colorMap;
+		colorMap.build(histogram, 255, 255, 0, 255);
+
+		std::vector<uint8_t> expected(nStride * nYRes * 4, 0xAB);
+		std::vector<uint8_t> actual(nStride * nYRes * 4, 0xAB);
+		ColorMap::setVectorized(false);
+		colorMap.colorizeRGBA(&frame[0], nXRes, nYRes, nStride * sizeof(openni::DepthPixel), &expected[0], nStride * 4);
+		benchmark.SelectKernels(nPass);
+		colorMap.colorizeRGBA(&frame[0], nXRes, nYRes, nStride * sizeof(openni::DepthPixel), &actual[0], nStride * 4);
+		if (actual != expected)
+		{
+			benchmark.Fail("%s colorization doesn't match the scalar one (%dx%d)!", benchmark.GetKernelName(), nXRes, nYRes);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BenchmarkColorization(xnl::Benchmark& benchmark, const BenchmarkMode& mode, bool bReference, uint32_t nFrames)
+{
+	std::vector<openni::DepthPixel> frame;
+	GenerateFrame(mode.nXRes, mode.nYRes, frame);
+	std::vector<uint8_t> texture(mode.nXRes * mode.nYRes * 4);
+	std::vector<float> reference(MAX_DEPTH);
+	DepthHistogram histogram;
+	ColorMap colorMap;
+
+	benchmark.ResetTimes();
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		benchmark.StartRun();
+		if (bReference)
+		{
+			ReferenceHistogram(&frame[0], (int)frame.size(), &reference[0], MAX_DEPTH);
+			ReferenceColorize(&frame[0], (int)frame.size(), &reference[0], MAX_DEPTH, &texture[0]);
+		}
+		else
+		{
+			histogram.calculate(&frame[0], mode.nXRes, mode.nYRes, mode.nXRes * sizeof(openni::DepthPixel), MAX_DEPTH);
+			colorMap.build(histogram, 255, 255, 0, 255);
+			colorMap.colorizeRGBA(&frame[0], mode.nXRes, mode.nYRes, mode.nXRes * sizeof(openni::DepthPixel), &texture[0], mode.nXRes * 4);
+		}
+		benchmark.EndRun();
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%dx%d@%d", mode.nXRes, mode.nYRes, mode.nFPS);
+	benchmark.ReportFrameTime(strCase, mode.nFPS, bReference ? "Float" : NULL);
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	const uint32_t nModes = sizeof(g_modes) / sizeof(g_modes[0]);
+
+	uint32_t nFrames = DEFAULT_FRAMES;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("frames", "Number of frames colorized in each run.", &nFrames);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	benchmark.SetKernels(ColorMap::setVectorized, ColorMap::isVectorized, "AVX2");
+
+	srand(0);
+	for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+	{
+		Verify(benchmark, nPass);
+	}
+
+	for (uint32_t i = 0; i < nModes; ++i)
+	{
+		BenchmarkColorization(benchmark, g_modes[i], true, nFrames);
+		for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+		{
+			benchmark.SelectKernels(nPass);
+			BenchmarkColorization(benchmark, g_modes[i], false, nFrames);
+		}
+	}
+
+	return benchmark.GetResult();
+}
@@ -0,0 +1,74 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef DEPTHHISTOGRAMSIMD_H
+#define DEPTHHISTOGRAMSIMD_H
+
+/* The vectorized colorization is built for AVX2 only (no global compiler flags needed), and is only
+   called after hasAVX2() returned true. */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+	#define DEPTH_HISTOGRAM_SIMD_X86 1
+	#define DEPTH_HISTOGRAM_TARGET_AVX2 __attribute__((target("avx2")))
+	#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	#define DEPTH_HISTOGRAM_SIMD_X86 1
+	#define DEPTH_HISTOGRAM_TARGET_AVX2
+	#include <intrin.h>
+	#include <immintrin.h>
+#else
+	#define DEPTH_HISTOGRAM_SIMD_X86 0
+#endif
+
+namespace depth_histogram
+{
+
+static inline bool detectAVX2()
+{
+#if DEPTH_HISTOGRAM_SIMD_X86 && defined(_MSC_VER)
+	int aCPUInfo[4] = {0};
+	__cpuid(aCPUInfo, 1);
+	// OSXSAVE and AVX, and the OS saves the YMM registers
+	if ((aCPUInfo[2] & (1 << 27)) == 0 || (aCPUInfo[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(aCPUInfo, 7, 0);
+	return (aCPUInfo[1] & (1 << 5)) != 0;
+#elif DEPTH_HISTOGRAM_SIMD_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Returns true if the CPU supports the AVX2 colorization. The CPU is only checked once, and it is safe to
+ * call while initializing globals.
+ */
+inline bool hasAVX2()
+{
+	static const bool bSupported = detectAVX2();
+	return bSupported;
+}
+
+}
+
+#endif // DEPTHHISTOGRAMSIMD_H
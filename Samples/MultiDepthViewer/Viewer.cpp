@@ -119,30 +119,9 @@ void SampleViewer::displayFrame(const openni::VideoFrameRef& frame)
 		return;
 	}
 
-	const openni::DepthPixel* pDepthRow = (const openni::DepthPixel*)frame.getData();
-	openni::RGB888Pixel* pTexRow = m_pTexMap + frame.getCropOriginY() * m_nTexMapX;
-	int rowSize = frame.getStrideInBytes() / sizeof(openni::DepthPixel);
-
-	for (int y = 0; y < frame.getHeight(); ++y)
-	{
-		const openni::DepthPixel* pDepth = pDepthRow;
-		openni::RGB888Pixel* pTex = pTexRow + frame.getCropOriginX();
-
-		for (int x = 0; x < frame.getWidth(); ++x, ++pDepth, ++pTex)
-		{
-			if (*pDepth != 0)
-			{
-				int nHistValue = m_pDepthHist[*pDepth];
-				pTex->r = nHistValue;
-				pTex->g = nHistValue;
-				pTex->b = nHistValue;
-			}
-		}
-
-		pDepthRow += rowSize;
-		pTexRow += m_nTexMapX;
-	}
-
+	openni::RGB888Pixel* pTex = m_pTexMap + frame.getCropOriginY() * m_nTexMapX + frame.getCropOriginX();
+	m_depthColorMap.build(m_depthHist, 255, 255, 255, 255);
+	m_depthColorMap.colorizeRGB(frame, pTex, m_nTexMapX);
 }
 
 void SampleViewer::displayBothFrames()
@@ -157,6 +136,8 @@ void SampleViewer::displayBothFrames()
 	maskFrame.pDepthRow = (const openni::DepthPixel*)m_depth2Frame.getData();
 	openni::RGB888Pixel* pTexRow = m_pTexMap + m_depth1Frame.getCropOriginY() * m_nTexMapX;
 	int rowSize = m_depth1Frame.getStrideInBytes() / sizeof(openni::DepthPixel);
+	const uint8_t* pIntensities = m_depthHist.getIntensities();
+	int nLastDepth = m_depthHist.getSize() - 1;
 
 	for (int y = 0; y < m_depth1Frame.getHeight(); ++y)
 	{
@@ -168,7 +149,7 @@ void SampleViewer::displayBothFrames()
 		{
 			if (*mainFrame.pDepth != 0)
 			{
-				int nHistValue = m_pDepthHist[*mainFrame.pDepth];
+				int nHistValue = pIntensities[*mainFrame.pDepth < nLastDepth ? *mainFrame.pDepth : nLastDepth];
 
 				if (*maskFrame.pDepth == 0)
 				{
@@ -179,7 +160,8 @@ void SampleViewer::displayBothFrames()
 				}
 				else
 				{
-					nHistValue = m_pDepthHist[(*mainFrame.pDepth+*maskFrame.pDepth)/2];
+					int nMatchDepth = (*mainFrame.pDepth+*maskFrame.pDepth)/2;
+					nHistValue = pIntensities[nMatchDepth < nLastDepth ? nMatchDepth : nLastDepth];
 					// Match
 					pTex->r = nHistValue;
 					pTex->g = 0;
@@ -224,11 +206,11 @@ void SampleViewer::display()
 
 	if (m_depth1Frame.isValid() && m_eViewState != DISPLAY_MODE_DEPTH2)
 	{
-		calculateHistogram(m_pDepthHist, MAX_DEPTH, m_depth1Frame);
+		m_depthHist.calculate(m_depth1Frame, MAX_DEPTH);
 	}
 	else
 	{
-		calculateHistogram(m_pDepthHist, MAX_DEPTH, m_depth2Frame);
+		m_depthHist.calculate(m_depth2Frame, MAX_DEPTH);
 	}
 
 	memset(m_pTexMap, 0, m_nTexMapX*m_nTexMapY*sizeof(openni::RGB888Pixel));
@@ -22,6 +22,7 @@
 #define VIEWER_H
 
 #include <OpenNI.h>
+#include <DepthHistogram.h>
 
 #define MAX_DEPTH 10000
 
@@ -60,7 +61,8 @@ private:
 	static void glutDisplay();
 	static void glutKeyboard(unsigned char key, int x, int y);
 
-	float			m_pDepthHist[MAX_DEPTH];
+	depth_histogram::DepthHistogram	m_depthHist;
+	depth_histogram::ColorMap	m_depthColorMap;
 	char			m_strSampleName[ONI_MAX_STR];
 	openni::RGB888Pixel*		m_pTexMap;
 	unsigned int		m_nTexMapX;
@@ -0,0 +1,134 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <OpenNI.h>
+#include <OniFrameSubscriber.h>
+
+#include "OniSampleUtilities.h"
+
+#define SAMPLE_SHARED_NAME "OniSharedDepth"
+#define SAMPLE_READ_WAIT_TIMEOUT 2000 //2000ms
+
+// Opens a device and publishes its depth frames, until a key is hit.
+int publish(const char* uri)
+{
+	openni::Status rc = openni::OpenNI::initialize();
+	if (rc != openni::STATUS_OK)
+	{
+		printf("Initialize failed\n%s\n", openni::OpenNI::getExtendedError());
+		return 1;
+	}
+
+	openni::Device device;
+	rc = device.open(uri);
+	if (rc != openni::STATUS_OK)
+	{
+		printf("Couldn't open device\n%s\n", openni::OpenNI::getExtendedError());
+		return 2;
+	}
+
+	openni::VideoStream depth;
+	rc = depth.create(device, openni::SENSOR_DEPTH);
+	if (rc != openni::STATUS_OK)
+	{
+		printf("Couldn't create depth stream\n%s\n", openni::OpenNI::getExtendedError());
+		return 3;
+	}
+
+	rc = depth.startPublishing(SAMPLE_SHARED_NAME);
+	if (rc != openni::STATUS_OK)
+	{
+		printf("Couldn't publish the depth stream\n%s\n", openni::OpenNI::getExtendedError());
+		return 4;
+	}
+
+	rc = depth.start();
+	if (rc != openni::STATUS_OK)
+	{
+		printf("Couldn't start the depth stream\n%s\n", openni::OpenNI::getExtendedError());
+		return 4;
+	}
+
+	printf("Publishing depth as '%s'. Hit any key to stop.\n", SAMPLE_SHARED_NAME);
+	while (!wasKeyboardHit())
+	{
+		Sleep(100);
+	}
+
+	depth.stop();
+	depth.stopPublishing();
+	depth.destroy();
+	device.close();
+	openni::OpenNI::shutdown();
+
+	return 0;
+}
+
+// Reads the depth frames another instance publishes, without loading OpenNI.
+int subscribe()
+{
+	OniFrameSubscriberHandle subscriber;
+	OniStatus rc = oniSubscriberOpen(SAMPLE_SHARED_NAME, &subscriber);
+	if (rc != ONI_STATUS_OK)
+	{
+		printf("Nothing is published as '%s'. Run SharedFrameRead -p first.\n", SAMPLE_SHARED_NAME);
+		return 1;
+	}
+
+	while (!wasKeyboardHit())
+	{
+		OniFrame* pFrame;
+		rc = oniSubscriberReadFrame(subscriber, SAMPLE_READ_WAIT_TIMEOUT, &pFrame);
+		if (rc == ONI_STATUS_NO_DEVICE)
+		{
+			printf("Publisher stopped\n");
+			break;
+		}
+		else if (rc != ONI_STATUS_OK)
+		{
+			printf("Wait failed! (timeout is %d ms)\n", SAMPLE_READ_WAIT_TIMEOUT);
+			continue;
+		}
+
+		OniDepthPixel* pDepth = (OniDepthPixel*)pFrame->data;
+
+		int middleIndex = (pFrame->height+1)*pFrame->width/2;
+
+		printf("[%08llu] %8d (dropped %llu)\n", (long long)pFrame->timestamp, pDepth[middleIndex], (unsigned long long)oniSubscriberGetDroppedFrames(subscriber));
+
+		oniSubscriberReleaseFrame(subscriber, pFrame);
+	}
+
+	oniSubscriberClose(subscriber);
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "-p") == 0)
+	{
+		return publish(argc > 2 ? argv[2] : openni::ANY_DEVICE);
+	}
+
+	return subscribe();
+}
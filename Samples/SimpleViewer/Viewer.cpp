@@ -178,7 +178,8 @@ void SampleViewer::display()
 
 	if (m_depthFrame.isValid())
 	{
-		calculateHistogram(m_pDepthHist, MAX_DEPTH, m_depthFrame);
+		m_depthHist.calculate(m_depthFrame, MAX_DEPTH);
+		m_depthColorMap.build(m_depthHist, 255, 255, 0, 255);
 	}
 
 	memset(m_pTexMap, 0, m_nTexMapX*m_nTexMapY*sizeof(openni::RGB888Pixel));
@@ -210,29 +211,8 @@ void SampleViewer::display()
 	if ((m_eViewState == DISPLAY_MODE_OVERLAY ||
 		m_eViewState == DISPLAY_MODE_DEPTH) && m_depthFrame.isValid())
 	{
-		const openni::DepthPixel* pDepthRow = (const openni::DepthPixel*)m_depthFrame.getData();
-		openni::RGB888Pixel* pTexRow = m_pTexMap + m_depthFrame.getCropOriginY() * m_nTexMapX;
-		int rowSize = m_depthFrame.getStrideInBytes() / sizeof(openni::DepthPixel);
-
-		for (int y = 0; y < m_depthFrame.getHeight(); ++y)
-		{
-			const openni::DepthPixel* pDepth = pDepthRow;
-			openni::RGB888Pixel* pTex = pTexRow + m_depthFrame.getCropOriginX();
-
-			for (int x = 0; x < m_depthFrame.getWidth(); ++x, ++pDepth, ++pTex)
-			{
-				if (*pDepth != 0)
-				{
-					int nHistValue = m_pDepthHist[*pDepth];
-					pTex->r = nHistValue;
-					pTex->g = nHistValue;
-					pTex->b = 0;
-				}
-			}
-
-			pDepthRow += rowSize;
-			pTexRow += m_nTexMapX;
-		}
+		openni::RGB888Pixel* pTex = m_pTexMap + m_depthFrame.getCropOriginY() * m_nTexMapX + m_depthFrame.getCropOriginX();
+		m_depthColorMap.colorizeRGB(m_depthFrame, pTex, m_nTexMapX);
 	}
 
 	glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP_SGIS, GL_TRUE);
@@ -45,7 +45,7 @@ Context::Context() : m_errorLogger(xnl::ErrorLogger::GetInstance()), m_autoRecor
 Context::~Context()
 {
 	s_valid = false;
-	for (xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
+	for (xnl::OpenHash<XN_THREAD_ID, XN_EVENT_HANDLE>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
 	{
 		xnOSCloseEvent(&(it->Value()));
 	}
@@ -149,6 +149,13 @@ XnStatus Context::configure()
 	if (strOniConfigurationFile[0] != '\0')
 	{
 		xnLogVerbose(XN_MASK_ONI_CONTEXT, "Configuration file found at '%s'", strOniConfigurationFile);
+
+		// Placement and scheduling of OpenNI's own threads (new frame, recorder)
+		rc = xnOSLoadThreadPoliciesFromINI(strOniConfigurationFile, "Threads");
+		if (rc != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_ONI_CONTEXT, "Failed to load thread policies: %s", xnGetStatusString(rc));
+		}
 	}
 
 	// Then, process the other device configurations.
@@ -1130,7 +1137,7 @@ void Context::onNewFrame()
 	nNow /= 1000000;
 
 	m_cs.Lock();
-	for (xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
+	for (xnl::OpenHash<XN_THREAD_ID, XN_EVENT_HANDLE>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
 	{
 		xnOSSetEvent(it->Value());
 	}
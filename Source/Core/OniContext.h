@@ -34,7 +34,7 @@
 #include "OniDriverHandler.h"
 #include "OniCommon.h"
 
-#include <XnHash.h>
+#include <XnOpenHash.h>
 #include <XnEvent.h>
 
 struct _OniDevice
@@ -144,7 +144,7 @@ private:
 	bool m_autoRecordingStarted;
 	OniRecorderHandle m_autoRecorder;
 
-	xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE> m_waitingThreads;
+	xnl::OpenHash<XN_THREAD_ID, XN_EVENT_HANDLE> m_waitingThreads;
 
 	xnl::CriticalSection m_cs;
 
@@ -239,6 +239,7 @@ OniStatus FileRecorder::initialize(const char* fileName)
 	{
 		return ONI_STATUS_ERROR;
 	}
+	xnOSApplyThreadPolicy(m_thread, XN_THREAD_CLASS_RECORDER, NULL);
 
 	send(Message::MESSAGE_INITIALIZE);
 	return ONI_STATUS_OK;
@@ -993,15 +994,31 @@ void FileRecorder::onRecord(uint32_t nodeId, XnCodecBase* pCodec, const OniFrame
 		 return;
 	}
 
+	// A cropping view (see XN_STREAM_PROPERTY_CROPPING_VIEW) keeps the stride of the uncropped
+	// frame, while recordings always hold packed lines.
+	const void* pData = pFrame->data;
+	int dataSize = pFrame->dataSize;
+	int rowSize = pFrame->width * oniFormatBytesPerPixel(pFrame->videoMode.pixelFormat);
+	if (pFrame->videoMode.pixelFormat != ONI_PIXEL_FORMAT_JPEG && rowSize > 0 && pFrame->stride > rowSize)
+	{
+		m_frameRows.resize(rowSize * pFrame->height);
+		for (int y = 0; y < pFrame->height; ++y)
+		{
+			xnOSMemCopy(&m_frameRows[y * rowSize], (const uint8_t*)pFrame->data + y * pFrame->stride, rowSize);
+		}
+		pData = &m_frameRows[0];
+		dataSize = (int)m_frameRows.size();
+	}
+
 	Memento undoPoint(this);
 
 	if (NULL != pCodec)
 	{
-		uint32_t bufferSize_bytes32 = pFrame->dataSize * 2 + pCodec->GetOverheadSize();
+		uint32_t bufferSize_bytes32 = dataSize * 2 + pCodec->GetOverheadSize();
 		uint8_t* buffer             = XN_NEW_ARR(uint8_t, bufferSize_bytes32);
 
-		XnStatus status = pCodec->Compress(reinterpret_cast<const unsigned char*>(pFrame->data),
-			pFrame->dataSize, buffer, &bufferSize_bytes32);
+		XnStatus status = pCodec->Compress(reinterpret_cast<const unsigned char*>(pData),
+			dataSize, buffer, &bufferSize_bytes32);
 		size_t  bufferSize_bytes = bufferSize_bytes32;
 		if (XN_STATUS_OK == status)
 		{
@@ -1022,8 +1039,8 @@ void FileRecorder::onRecord(uint32_t nodeId, XnCodecBase* pCodec, const OniFrame
 			pInfo->lastNewDataRecordPosition,
 			pFrame->timestamp,
 			pFrame->frameIndex,
-			pFrame->data,
-			pFrame->dataSize
+			pData,
+			dataSize
 		))
 	}
 	undoPoint.Release();
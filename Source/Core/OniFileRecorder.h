@@ -23,6 +23,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "XnPriorityQueue.h"
 
@@ -180,6 +181,9 @@ private:
 	// serialize them to a file.
 	RecordAssembler m_assembler;
 
+	// Packed lines of the last recorded cropping view (see onRecord()).
+	std::vector<uint8_t> m_frameRows;
+
 	XN_THREAD_HANDLE m_thread;
 	FileHeaderData   m_fileHeader;  //< Will be patched during termination.
 	std::string      m_fileName;
@@ -39,6 +39,7 @@ struct OniFrameInternal : public OniFrame
 	void* backToPoolFuncCookie;
 	FreeBufferFuncPtr freeBufferFunc; // callback function for freeing the frame buffer
 	void* freeBufferFuncCookie;
+	void* buffer; // the allocated frame buffer. Drivers may move data inside it (cropping views).
 };
 
 class FrameManager final
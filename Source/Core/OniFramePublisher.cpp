@@ -0,0 +1,194 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniFramePublisher.h"
+#include <XnLog.h>
+
+#define XN_MASK_ONI_FRAME_PUBLISHER "OniFramePublisher"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+FramePublisher::FramePublisher(xnl::ErrorLogger& errorLogger) :
+	m_errorLogger(errorLogger),
+	m_hSharedMemory(NULL),
+	m_pHeader(NULL),
+	m_nextSequence(1),
+	m_nextSlot(0),
+	m_droppedWarned(false)
+{
+}
+
+FramePublisher::~FramePublisher()
+{
+	if (m_pHeader != NULL)
+	{
+		// Let waiting subscribers know no more frames will come.
+		m_pHeader->closed.store(1);
+		m_pHeader->notifyCount.fetch_add(1);
+		xnOSWakeSharedAddress(sharedFrameRingNotifyAddress(m_pHeader));
+		m_pHeader = NULL;
+	}
+
+	if (m_hSharedMemory != NULL)
+	{
+		xnOSCloseSharedMemory(m_hSharedMemory);
+		m_hSharedMemory = NULL;
+	}
+}
+
+OniStatus FramePublisher::initialize(const char* name, OniSensorType sensorType, int maxDataSize, int slotCount)
+{
+	if (name == NULL || name[0] == '\0')
+	{
+		m_errorLogger.Append("A name is required to publish frames");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	// A subscriber may pin one frame while the publisher writes another.
+	if (slotCount < 2 || slotCount > ONI_SHARED_FRAME_RING_MAX_SLOTS)
+	{
+		m_errorLogger.Append("Frame count must be between 2 and %d", ONI_SHARED_FRAME_RING_MAX_SLOTS);
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	if (maxDataSize <= 0)
+	{
+		m_errorLogger.Append("Stream reports no frame size");
+		return ONI_STATUS_ERROR;
+	}
+
+	uint64_t slotSize = sharedFrameRingAlign(sharedFrameRingSlotDataOffset() + (uint32_t)maxDataSize);
+	uint64_t totalSize = sharedFrameRingHeaderSize() + slotSize * slotCount;
+	if (totalSize > XN_MAX_UINT32)
+	{
+		m_errorLogger.Append("Frames are too big to publish");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	XnStatus rc = xnOSCreateSharedMemory(name, (uint32_t)totalSize, XN_OS_FILE_READ | XN_OS_FILE_WRITE, &m_hSharedMemory);
+	if (rc != XN_STATUS_OK)
+	{
+		m_errorLogger.Append("Couldn't create shared memory '%s': %s", name, xnGetStatusString(rc));
+		return OniStatusFromXnStatus(rc);
+	}
+
+	void* pAddress = NULL;
+	rc = xnOSSharedMemoryGetAddress(m_hSharedMemory, &pAddress);
+	if (rc != XN_STATUS_OK)
+	{
+		xnOSCloseSharedMemory(m_hSharedMemory);
+		m_hSharedMemory = NULL;
+		m_errorLogger.Append("Couldn't map shared memory '%s': %s", name, xnGetStatusString(rc));
+		return OniStatusFromXnStatus(rc);
+	}
+
+	// The block may be left over from a publisher that died. Invalidate it before clearing it, so subscribers
+	// don't mistake it for a valid ring.
+	SharedFrameRingHeader* pHeader = (SharedFrameRingHeader*)pAddress;
+	pHeader->magic.store(0);
+	xnOSMemSet((uint8_t*)pAddress + sizeof(pHeader->magic), 0, (uint32_t)totalSize - sizeof(pHeader->magic));
+
+	pHeader->version = ONI_SHARED_FRAME_RING_VERSION;
+	pHeader->slotCount = slotCount;
+	pHeader->slotSize = (uint32_t)slotSize;
+	pHeader->maxDataSize = maxDataSize;
+	pHeader->sensorType = sensorType;
+	pHeader->magic.store(ONI_SHARED_FRAME_RING_MAGIC, std::memory_order_release);
+
+	m_pHeader = pHeader;
+
+	xnLogInfo(XN_MASK_ONI_FRAME_PUBLISHER, "Publishing frames as '%s' (%d slots of %d bytes)", name, slotCount, maxDataSize);
+
+	return ONI_STATUS_OK;
+}
+
+int FramePublisher::findFreeSlot()
+{
+	uint32_t slotCount = m_pHeader->slotCount;
+	for (uint32_t i = 0; i < slotCount; ++i)
+	{
+		uint32_t slot = (m_nextSlot + i) % slotCount;
+		SharedFrameSlot* pSlot = sharedFrameRingGetSlot(m_pHeader, slot);
+		if (pSlot->readers.load() != 0)
+		{
+			continue;
+		}
+
+		// Claim the slot, then make sure no subscriber pinned it meanwhile (see OniSharedFrameRing.h).
+		uint64_t previous = pSlot->sequence.exchange(0);
+		if (pSlot->readers.load() == 0)
+		{
+			m_nextSlot = (slot + 1) % slotCount;
+			return (int)slot;
+		}
+
+		pSlot->sequence.store(previous);
+	}
+
+	return -1;
+}
+
+void FramePublisher::publish(const OniFrame& frame)
+{
+	if (m_pHeader == NULL)
+	{
+		return;
+	}
+
+	int slot = -1;
+	if (frame.dataSize >= 0 && (uint32_t)frame.dataSize <= m_pHeader->maxDataSize)
+	{
+		slot = findFreeSlot();
+	}
+
+	if (slot < 0)
+	{
+		m_pHeader->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+		if (!m_droppedWarned)
+		{
+			xnLogWarning(XN_MASK_ONI_FRAME_PUBLISHER, "Dropping frames: subscribers hold all slots, or frame is too big (%d bytes)", frame.dataSize);
+			m_droppedWarned = true;
+		}
+		return;
+	}
+
+	SharedFrameSlot* pSlot = sharedFrameRingGetSlot(m_pHeader, slot);
+	pSlot->dataSize = frame.dataSize;
+	pSlot->sensorType = frame.sensorType;
+	pSlot->frameIndex = frame.frameIndex;
+	pSlot->timestamp = frame.timestamp;
+	pSlot->width = frame.width;
+	pSlot->height = frame.height;
+	pSlot->videoMode = frame.videoMode;
+	pSlot->croppingEnabled = frame.croppingEnabled;
+	pSlot->cropOriginX = frame.cropOriginX;
+	pSlot->cropOriginY = frame.cropOriginY;
+	pSlot->stride = frame.stride;
+	xnOSMemCopy(sharedFrameRingGetSlotData(pSlot), frame.data, frame.dataSize);
+
+	uint64_t sequence = m_nextSequence++;
+	pSlot->sequence.store(sequence, std::memory_order_release);
+	m_pHeader->latest.store(sharedFrameRingPackLatest(sequence, slot), std::memory_order_release);
+
+	m_pHeader->notifyCount.fetch_add(1);
+	xnOSWakeSharedAddress(sharedFrameRingNotifyAddress(m_pHeader));
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
@@ -0,0 +1,57 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef ONIFRAMEPUBLISHER_H
+#define ONIFRAMEPUBLISHER_H
+
+#include "OniCommon.h"
+#include "OniSharedFrameRing.h"
+#include "XnErrorLogger.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Copies a stream's frames into a named shared frame ring (see OniSharedFrameRing.h), so other processes can
+// read them using the OniFrameSubscriber library. Each frame is copied once, however many subscribers there are.
+class FramePublisher final
+{
+public:
+	FramePublisher(xnl::ErrorLogger& errorLogger);
+	~FramePublisher();
+
+	OniStatus initialize(const char* name, OniSensorType sensorType, int maxDataSize, int slotCount);
+
+	void publish(const OniFrame& frame);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(FramePublisher)
+
+	int findFreeSlot();
+
+	xnl::ErrorLogger& m_errorLogger;
+	XN_SHARED_MEMORY_HANDLE m_hSharedMemory;
+	SharedFrameRingHeader* m_pHeader;
+	uint64_t m_nextSequence;
+	uint32_t m_nextSlot;
+	bool m_droppedWarned;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // ONIFRAMEPUBLISHER_H
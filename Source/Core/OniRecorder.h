@@ -96,7 +96,7 @@ protected:
 	OniRecorderHandle m_handle;
 
 	// A map of stream -> stream information.
-	typedef xnl::Lockable< xnl::Hash<VideoStream*, uint32_t> > StreamFrameIDList;
+	typedef xnl::Lockable< xnl::OpenHash<VideoStream*, uint32_t> > StreamFrameIDList;
 	StreamFrameIDList m_frameIds;
 
 	bool           m_running;     //< true whenever the threadMain is running.
@@ -33,7 +33,8 @@ Sensor::Sensor(xnl::ErrorLogger& errorLogger, FrameManager& frameManager, const
 	m_frameManager(frameManager),
 	m_driverHandler(driverHandler),
 	m_streamHandle(NULL),
-	m_requiredFrameSize(0)
+	m_requiredFrameSize(0),
+	m_peakFramesInUse(0)
 {
 	resetFrameAllocator();
 
@@ -111,6 +112,7 @@ OniFrame* Sensor::acquireFrame()
 	}
 
 	pResult->data = m_allocFrameBufferCallback(m_requiredFrameSize, m_frameBufferAllocatorCookie);
+	pResult->buffer = pResult->data;
 	if (pResult->data == NULL)
 	{
 		m_frameManager.release(pResult);
@@ -125,10 +127,19 @@ OniFrame* Sensor::acquireFrame()
 
 	xnl::AutoCSLocker lock(m_framesCS);
 	m_currentStreamFrames.push_back(pResult);
+	m_peakFramesInUse = XN_MAX(m_peakFramesInUse, (int)m_currentStreamFrames.size());
 
 	return pResult;
 }
 
+void Sensor::getFramePoolStatistics(int* pPoolSize, int* pInUse, int* pPeakInUse)
+{
+	xnl::AutoCSLocker lock(m_framesCS);
+	*pInUse = (int)m_currentStreamFrames.size();
+	*pPoolSize = *pInUse + (int)m_availableFrameBuffers.size();
+	*pPeakInUse = m_peakFramesInUse;
+}
+
 void* Sensor::allocFrameBufferFromPool(int size)
 {
 	XN_ASSERT(size == m_requiredFrameSize);
@@ -200,10 +211,11 @@ void Sensor::releaseAllFrames()
 void ONI_CALLBACK_TYPE Sensor::frameBackToPoolCallback(OniFrameInternal* pFrame, void* pCookie)
 {
 	// release the data
-	if (pFrame->data != NULL)
+	if (pFrame->buffer != NULL)
 	{
 		// this can happen if allocation of data failed
-		pFrame->freeBufferFunc(pFrame->data, pFrame->freeBufferFuncCookie);
+		pFrame->freeBufferFunc(pFrame->buffer, pFrame->freeBufferFuncCookie);
+		pFrame->buffer = NULL;
 		pFrame->data = NULL;
 	}
 
@@ -44,6 +44,9 @@ public:
 	OniStatus setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 	void setRequiredFrameSize(int requiredFrameSize);
 
+	/** Gets the number of frames allocated by this sensor, currently in use, and the most ever used at once. */
+	void getFramePoolStatistics(int* pPoolSize, int* pInUse, int* pPeakInUse);
+
 	xnl::Event1Arg<OniFrame*>::Interface& newFrameEvent() { return m_newFrameEvent; }
 	void* streamHandle() const { return m_streamHandle; }
 
@@ -90,6 +93,7 @@ private:
 	xnl::CriticalSection m_framesCS;
 	std::list<void*> m_availableFrameBuffers;
 	std::list<OniFrameInternal*> m_currentStreamFrames;
+	int m_peakFramesInUse;
 
 	// following members point to current allocation functions
 	OniFrameAllocBufferCallback m_allocFrameBufferCallback;
@@ -0,0 +1,124 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef ONISHAREDFRAMERING_H
+#define ONISHAREDFRAMERING_H
+
+#include <OniCTypes.h>
+#include "OniCommon.h"
+#include <XnOS.h>
+#include <atomic>
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+// Layout of the shared memory block a stream publishes its frames through (see VideoStream::startPublishing()).
+// It is shared by the publisher (OpenNI2) and the subscriber library, which may be built separately, so any
+// change to it must bump ONI_SHARED_FRAME_RING_VERSION.
+//
+// The block is a header followed by slotCount slots, each holding a frame description and its data. The publisher
+// writes each frame once, into a slot no subscriber is reading, and subscribers get the frame data in place.
+//
+// Protocol:
+// - A slot's sequence is the number of the frame it holds (frames are numbered from 1), or 0 while it's written.
+// - A subscriber pins a slot by incrementing its readers count, and then checks the slot still holds the frame it
+//   wanted. The publisher marks a slot as written (sequence 0) and then checks no one pinned it. As both sides
+//   store and then load (sequentially consistent), at least one of them sees the other and backs off.
+// - latest holds the sequence and slot of the newest complete frame, packed together so they're read atomically.
+// - notifyCount is incremented after each frame, and when the publisher closes. Subscribers wait on it.
+
+#define ONI_SHARED_FRAME_RING_MAGIC		0x494E4F53 // "SONI"
+#define ONI_SHARED_FRAME_RING_VERSION	1
+#define ONI_SHARED_FRAME_RING_MAX_SLOTS	64
+#define ONI_SHARED_FRAME_RING_ALIGNMENT	64
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "shared frame ring atomics must be lock free");
+
+struct SharedFrameRingHeader
+{
+	std::atomic<uint32_t> magic; // stored last, once the header is initialized
+	uint32_t version;
+	uint32_t slotCount;
+	uint32_t slotSize; // size of a slot, including its description
+	uint32_t maxDataSize;
+	int32_t sensorType;
+
+	std::atomic<uint64_t> latest; // (sequence << 8) | slot. 0 if no frame was published yet
+	std::atomic<int32_t> notifyCount;
+	std::atomic<int32_t> closed;
+	std::atomic<uint64_t> droppedFrames; // frames not published, as all slots were pinned or the frame was too big
+};
+
+struct SharedFrameSlot
+{
+	std::atomic<uint64_t> sequence;
+	std::atomic<int32_t> readers;
+
+	// OniFrame, without its data pointer
+	int32_t dataSize;
+	int32_t sensorType;
+	int32_t frameIndex;
+	uint64_t timestamp;
+	int32_t width;
+	int32_t height;
+	OniVideoMode videoMode;
+	int32_t croppingEnabled;
+	int32_t cropOriginX;
+	int32_t cropOriginY;
+	int32_t stride;
+};
+
+inline uint32_t sharedFrameRingAlign(uint32_t size)
+{
+	return (size + ONI_SHARED_FRAME_RING_ALIGNMENT - 1) & ~(ONI_SHARED_FRAME_RING_ALIGNMENT - 1);
+}
+
+inline uint32_t sharedFrameRingHeaderSize()
+{
+	return sharedFrameRingAlign(sizeof(SharedFrameRingHeader));
+}
+
+inline uint32_t sharedFrameRingSlotDataOffset()
+{
+	return sharedFrameRingAlign(sizeof(SharedFrameSlot));
+}
+
+inline SharedFrameSlot* sharedFrameRingGetSlot(SharedFrameRingHeader* pHeader, uint32_t slot)
+{
+	return (SharedFrameSlot*)((uint8_t*)pHeader + sharedFrameRingHeaderSize() + slot * pHeader->slotSize);
+}
+
+inline void* sharedFrameRingGetSlotData(SharedFrameSlot* pSlot)
+{
+	return (uint8_t*)pSlot + sharedFrameRingSlotDataOffset();
+}
+
+inline uint64_t sharedFrameRingPackLatest(uint64_t sequence, uint32_t slot)
+{
+	return (sequence << 8) | slot;
+}
+
+inline volatile int32_t* sharedFrameRingNotifyAddress(SharedFrameRingHeader* pHeader)
+{
+	return reinterpret_cast<volatile int32_t*>(&pHeader->notifyCount);
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // ONISHAREDFRAMERING_H
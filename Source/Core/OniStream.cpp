@@ -23,6 +23,7 @@
 #include "OniProperties.h"
 #include "Driver/OniDriverTypes.h"
 #include "OniRecorder.h"
+#include "OniFramePublisher.h"
 #include "XnLockGuard.h"
 
 #include <math.h>
@@ -40,11 +41,18 @@ VideoStream::VideoStream(Sensor* pSensor, const OniSensorInfo* pSensorInfo, Devi
 	m_frameManager(frameManager),
 	m_pSensor(pSensor),
 	m_hNewFrameEvent(NULL),
-	m_started(false)
+	m_started(false),
+	m_pPublisher(NULL),
+	m_lastFrameArrivalTime(0)
 {
+	xnOSMemSet(&m_telemetry, 0, sizeof(m_telemetry));
+
 	xnOSCreateEvent(&m_newFrameInternalEvent, false);
 	xnOSCreateEvent(&m_newFrameInternalEventForFrameHolder, false);
-	xnOSCreateThread(newFrameThread, this, &m_newFrameThread);
+	if (xnOSCreateThread(newFrameThread, this, &m_newFrameThread) == XN_STATUS_OK)
+	{
+		xnOSApplyThreadPolicy(m_newFrameThread, XN_THREAD_CLASS_NEW_FRAME, NULL);
+	}
 
 	m_pSensorInfo = XN_NEW(OniSensorInfo);
 	m_pSensorInfo->sensorType = pSensorInfo->sensorType;
@@ -68,6 +76,8 @@ VideoStream::~VideoStream()
 	// Make sure stream is stopped.
 	stop();
 
+	stopPublishing();
+
 	xnFPSFree(&m_FPS);
 
 	if (m_hNewFrameEvent != NULL)
@@ -227,6 +237,11 @@ OniStatus VideoStream::setProperty(int propertyId, const void* data, int dataSiz
 
 OniStatus VideoStream::getProperty(int propertyId, void* data, int* pDataSize)
 {
+	if (propertyId == ONI_STREAM_PROPERTY_TELEMETRY)
+	{
+		return getTelemetry(data, pDataSize);
+	}
+
 	OniStatus rc = m_driverHandler.streamGetProperty(m_pSensor->streamHandle(), propertyId, data, pDataSize);
 	if (rc != ONI_STATUS_OK)
 	{
@@ -237,6 +252,11 @@ OniStatus VideoStream::getProperty(int propertyId, void* data, int* pDataSize)
 
 bool VideoStream::isPropertySupported(int propertyId)
 {
+	if (propertyId == ONI_STREAM_PROPERTY_TELEMETRY)
+	{
+		return true;
+	}
+
 	return m_driverHandler.streamIsPropertySupported(m_pSensor->streamHandle(), propertyId);
 }
 
@@ -257,7 +277,67 @@ bool VideoStream::isCommandSupported(int commandId)
 
 OniStatus VideoStream::readFrame(OniFrame** pFrame)
 {
-	return m_pFrameHolder->readFrame(this, pFrame);
+	OniStatus rc = m_pFrameHolder->readFrame(this, pFrame);
+	if (rc == ONI_STATUS_OK && *pFrame != NULL)
+	{
+		xnl::AutoCSLocker lock(m_telemetryCS);
+		++m_telemetry.frameHolderFramesRead;
+	}
+	return rc;
+}
+
+void VideoStream::reportDroppedFrame()
+{
+	xnl::AutoCSLocker lock(m_telemetryCS);
+	++m_telemetry.frameHolderFramesDropped;
+}
+
+OniStatus VideoStream::getTelemetry(void* data, int* pDataSize)
+{
+	if (*pDataSize != sizeof(OniStreamTelemetry))
+	{
+		m_errorLogger.Append("Stream telemetry: bad data size (%d, expected %d)\n", *pDataSize, (int)sizeof(OniStreamTelemetry));
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	OniStreamTelemetry* pTelemetry = (OniStreamTelemetry*)data;
+
+	// start with the counters kept by the driver (USB and processing layers), if it has any
+	if (!m_driverHandler.streamIsPropertySupported(m_pSensor->streamHandle(), ONI_STREAM_PROPERTY_TELEMETRY) ||
+		m_driverHandler.streamGetProperty(m_pSensor->streamHandle(), ONI_STREAM_PROPERTY_TELEMETRY, pTelemetry, pDataSize) != ONI_STATUS_OK)
+	{
+		xnOSMemSet(pTelemetry, 0, sizeof(OniStreamTelemetry));
+		*pDataSize = sizeof(OniStreamTelemetry);
+	}
+
+	// and add our own
+	{
+		xnl::AutoCSLocker lock(m_telemetryCS);
+		pTelemetry->frameHolderFramesReceived = m_telemetry.frameHolderFramesReceived;
+		pTelemetry->frameHolderFramesDropped = m_telemetry.frameHolderFramesDropped;
+		pTelemetry->frameHolderFramesRead = m_telemetry.frameHolderFramesRead;
+		pTelemetry->callbackFramesDelivered = m_telemetry.callbackFramesDelivered;
+		pTelemetry->driverOutputToCallbackLatency = m_telemetry.driverOutputToCallbackLatency;
+		pTelemetry->recorderFramesRecorded = m_telemetry.recorderFramesRecorded;
+	}
+
+	m_pSensor->getFramePoolStatistics(&pTelemetry->bufferPoolSize, &pTelemetry->bufferPoolInUse, &pTelemetry->bufferPoolPeakInUse);
+
+	return ONI_STATUS_OK;
+}
+
+void VideoStream::addLatencySample(OniLatencyHistogram& histogram, uint64_t microseconds)
+{
+	int bucket = 0;
+	for (uint64_t value = microseconds; value != 0 && bucket < ONI_TELEMETRY_LATENCY_BUCKETS - 1; value >>= 1)
+	{
+		++bucket;
+	}
+
+	++histogram.count;
+	histogram.totalMicroseconds += microseconds;
+	histogram.maxMicroseconds = XN_MAX(histogram.maxMicroseconds, microseconds);
+	++histogram.buckets[bucket];
 }
 
 OniStatus VideoStream::registerNewFrameCallback(OniGeneralCallback handler, void* pCookie, XnCallbackHandle* pHandle)
@@ -289,6 +369,18 @@ void VideoStream::newFrameThreadMainloop()
 		rc = xnOSWaitEvent(m_newFrameInternalEvent, XN_WAIT_INFINITE);
 		if ((rc == XN_STATUS_OK) && m_running)
 		{
+			{
+				uint64_t now;
+				xnOSGetHighResTimeStamp(&now);
+
+				xnl::AutoCSLocker lock(m_telemetryCS);
+				++m_telemetry.callbackFramesDelivered;
+				if (m_lastFrameArrivalTime != 0 && now >= m_lastFrameArrivalTime)
+				{
+					addLatencySample(m_telemetry.driverOutputToCallbackLatency, now - m_lastFrameArrivalTime);
+				}
+			}
+
 			m_newFrameEvent.Raise();
 			// HACK: To avoid starvation of other threads.
 			xnOSSleep(1);
@@ -310,6 +402,38 @@ OniStatus VideoStream::removeRecorder(Recorder& aRecorder)
 	return ONI_STATUS_OK;
 }
 
+OniStatus VideoStream::startPublishing(const char* name, int frameCount)
+{
+	xnl::AutoCSLocker lock(m_publisherCS);
+	if (m_pPublisher != NULL)
+	{
+		m_errorLogger.Append("Stream is already published");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	// Slots are sized for the current video mode. Larger frames (after a mode change) are dropped.
+	FramePublisher* pPublisher = XN_NEW(FramePublisher, m_errorLogger);
+	OniStatus rc = pPublisher->initialize(name, m_pSensorInfo->sensorType, getRequiredFrameSize(), frameCount);
+	if (rc != ONI_STATUS_OK)
+	{
+		XN_DELETE(pPublisher);
+		return rc;
+	}
+
+	m_pPublisher = pPublisher;
+	return ONI_STATUS_OK;
+}
+
+void VideoStream::stopPublishing()
+{
+	xnl::AutoCSLocker lock(m_publisherCS);
+	if (m_pPublisher != NULL)
+	{
+		XN_DELETE(m_pPublisher);
+		m_pPublisher = NULL;
+	}
+}
+
 XN_THREAD_PROC VideoStream::newFrameThread(XN_THREAD_PARAM pThreadParam)
 {
 	oni::implementation::VideoStream* pStream = (oni::implementation::VideoStream*)pThreadParam;
@@ -333,6 +457,15 @@ void ONI_CALLBACK_TYPE VideoStream::stream_NewFrame(OniFrame* pFrame, void* pCoo
 		return;
 	}
 
+	{
+		uint64_t now;
+		xnOSGetHighResTimeStamp(&now);
+
+		xnl::AutoCSLocker lock(pStream->m_telemetryCS);
+		++pStream->m_telemetry.frameHolderFramesReceived;
+		pStream->m_lastFrameArrivalTime = now;
+	}
+
 	// Record the frame.
 	// NOTE: record operation must go before ProcessNewFrame, because
 	// m_pFrameHolder might block. We're recording every single frame, no
@@ -342,9 +475,27 @@ void ONI_CALLBACK_TYPE VideoStream::stream_NewFrame(OniFrame* pFrame, void* pCoo
 	{
 		// NOTE: scoped for the guard.
 		xnl::LockGuard<Recorders> guard(pStream->m_recorders);
+		uint64_t recorded = 0;
 		for (Recorders::Iterator i = pStream->m_recorders.Begin(), e = pStream->m_recorders.End(); i != e; ++i)
 		{
-			i->Key()->record(*pStream, *pFrame);
+			if (i->Key()->record(*pStream, *pFrame) == ONI_STATUS_OK)
+			{
+				++recorded;
+			}
+		}
+
+		if (recorded != 0)
+		{
+			xnl::AutoCSLocker lock(pStream->m_telemetryCS);
+			pStream->m_telemetry.recorderFramesRecorded += recorded;
+		}
+	}
+
+	{
+		xnl::AutoCSLocker lock(pStream->m_publisherCS);
+		if (pStream->m_pPublisher != NULL)
+		{
+			pStream->m_pPublisher->publish(*pFrame);
 		}
 	}
 
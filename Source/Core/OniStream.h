@@ -28,7 +28,7 @@
 #include "OniSensor.h"
 #include "XnEvent.h"
 #include "XnErrorLogger.h"
-#include "XnHash.h"
+#include "XnOpenHash.h"
 #include "XnLockable.h"
 #include <XnFPSCalculator.h>
 
@@ -36,6 +36,7 @@ ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 class Device;
 class FrameHolder;
+class FramePublisher;
 class Recorder;
 
 class VideoStream final
@@ -81,9 +82,15 @@ public:
 	void raiseNewFrameEvent();
 	XnStatus waitForNewFrameEvent();
 
+	// Called by the frame holder when a frame is replaced before it was read.
+	void reportDroppedFrame();
+
 	OniStatus addRecorder(Recorder& aRecorder);
 	OniStatus removeRecorder(Recorder& aRecorder);
 
+	OniStatus startPublishing(const char* name, int frameCount);
+	void stopPublishing();
+
 	OniStatus setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 
 	OniStatus convertDepthToWorldCoordinates(float depthX, float depthY, float depthZ, float* pWorldX, float* pWorldY, float* pWorldZ);
@@ -117,6 +124,8 @@ private:
 	static void ONI_CALLBACK_TYPE stream_PropertyChanged(void* streamHandle, int propertyId, const void* data, int dataSize, void* pCookie);
 
 	void refreshWorldConversionCache();
+	OniStatus getTelemetry(void* data, int* pDataSize);
+	static void addLatencySample(OniLatencyHistogram& histogram, uint64_t microseconds);
 	static const char* getSensorName(OniSensorType sensorType);
 
 	NewFrameFuncPtr m_newFrameCallback;
@@ -133,11 +142,21 @@ private:
 
 	// XnLib does not provide a set container. I decided to use this odd
 	// Recorder* -> Recorder* map to mimic a set.
-	typedef xnl::Lockable<xnl::Hash<Recorder*, Recorder*> > Recorders;
+	typedef xnl::Lockable<xnl::OpenHash<Recorder*, Recorder*> > Recorders;
 	Recorders m_recorders;
 	XnFPSData m_FPS;
 	char m_sensorName[80];
 
+	// Copies frames to shared memory for other processes, if startPublishing() was called.
+	xnl::CriticalSection m_publisherCS;
+	FramePublisher* m_pPublisher;
+
+	// Telemetry measured by OpenNI itself (frame holder, callbacks, recorders). Driver counters are
+	// queried from the driver on demand.
+	xnl::CriticalSection m_telemetryCS;
+	OniStreamTelemetry m_telemetry;
+	uint64_t m_lastFrameArrivalTime;
+
 	struct WorldConversionCache
 	{
 		float xzFactor;
@@ -78,7 +78,9 @@ OniStatus StreamFrameHolder::processNewFrame(VideoStream* pStream, OniFrame* pFr
 	lock();
 	if (m_pLastFrame != NULL)
 	{
+		// frame was never read
 		m_frameManager.release(m_pLastFrame);
+		m_pStream->reportDroppedFrame();
 	}
 	m_pLastFrame = pFrame;
 	m_frameManager.addRef(m_pLastFrame);
@@ -126,6 +126,7 @@ OniStatus SyncedStreamsFrameHolder::readFrame(VideoStream* pStream, OniFrame** p
 			if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
 			{
 				m_frameManager.release(m_FrameSyncedStreams[i].pSyncedFrame);
+				m_FrameSyncedStreams[i].pStream->reportDroppedFrame();
 			}
 			m_FrameSyncedStreams[i].pSyncedFrame = NULL;
 		}
@@ -182,6 +183,7 @@ OniStatus SyncedStreamsFrameHolder::processNewFrame(VideoStream* pStream, OniFra
 			{
 				m_frameManager.release(m_FrameSyncedStreams[i].pLastFrame);
 				m_FrameSyncedStreams[i].pLastFrame = NULL;
+				pStream->reportDroppedFrame();
 			}
 
 			// Copy the frame only if stream is enabled.
@@ -220,6 +222,7 @@ OniStatus SyncedStreamsFrameHolder::processNewFrame(VideoStream* pStream, OniFra
 			if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
 			{
 				m_frameManager.release(m_FrameSyncedStreams[i].pSyncedFrame);
+				m_FrameSyncedStreams[i].pStream->reportDroppedFrame();
 			}
 
 			// Replace synced frame with last frame.
@@ -338,6 +338,12 @@ ONI_C_API bool oniStreamIsPropertySupported(OniStreamHandle stream, int property
 	g_Context.clearErrorLogger();
 	return stream->pStream->isPropertySupported(propertyId);
 }
+ONI_C_API OniStatus oniStreamGetTelemetry(OniStreamHandle stream, OniStreamTelemetry* pTelemetry)
+{
+	g_Context.clearErrorLogger();
+	int dataSize = sizeof(OniStreamTelemetry);
+	return stream->pStream->getProperty(ONI_STREAM_PROPERTY_TELEMETRY, pTelemetry, &dataSize);
+}
 
 ONI_C_API OniStatus oniStreamInvoke(OniStreamHandle stream, int commandId, void* data, int dataSize)
 {
@@ -356,6 +362,18 @@ ONI_C_API OniStatus oniStreamSetFrameBuffersAllocator(OniStreamHandle stream, On
 	return stream->pStream->setFrameBufferAllocator(alloc, free, pCookie);
 }
 
+ONI_C_API OniStatus oniStreamStartPublishing(OniStreamHandle stream, const char* name, int frameCount)
+{
+	g_Context.clearErrorLogger();
+	return stream->pStream->startPublishing(name, frameCount);
+}
+
+ONI_C_API void oniStreamStopPublishing(OniStreamHandle stream)
+{
+	g_Context.clearErrorLogger();
+	stream->pStream->stopPublishing();
+}
+
 ////
 ONI_C_API void oniFrameRelease(OniFrame* pFrame)
 {
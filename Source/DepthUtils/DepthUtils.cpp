@@ -66,6 +66,14 @@ XN_C_API XnStatus DepthUtilsTranslateDepthMap(DepthUtilsHandle handle, unsigned
 	}
 	return handle->pDepthUtils->Apply(depth);
 }
+XN_C_API XnStatus DepthUtilsTranslateDepthMapTo(DepthUtilsHandle handle, const unsigned short* depth, unsigned short* registeredDepth)
+{
+	if (handle == NULL || handle->pDepthUtils == NULL)
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+	return handle->pDepthUtils->Apply(depth, registeredDepth);
+}
 
 XN_C_API XnStatus DepthUtilsSetDepthConfiguration(DepthUtilsHandle handle, int xres, int yres, OniPixelFormat format, int isMirrored)
 {
@@ -111,6 +111,7 @@ extern "C"
 
 	int DepthUtilsTranslatePixel(DepthUtilsHandle handle, unsigned int x, unsigned int y, unsigned short z, unsigned int* pX, unsigned int* pY);
 	int DepthUtilsTranslateDepthMap(DepthUtilsHandle handle, unsigned short* depthMap);
+	int DepthUtilsTranslateDepthMapTo(DepthUtilsHandle handle, const unsigned short* depthMap, unsigned short* registeredDepthMap);
 
 	int DepthUtilsSetDepthConfiguration(DepthUtilsHandle handle, int xres, int yres, OniPixelFormat format, int isMirrored);
 	int DepthUtilsSetColorResolution(DepthUtilsHandle handle, int xres, int yres);
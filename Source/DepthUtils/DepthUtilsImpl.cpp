@@ -134,10 +134,19 @@ XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
 {
 	unsigned short* pTempBuffer;
 	pTempBuffer = (unsigned short*)xnOSCallocAligned(m_depthResolution.x*m_depthResolution.y, sizeof(unsigned short), XN_DEFAULT_MEM_ALIGN);
+	XN_VALIDATE_ALLOC_PTR(pTempBuffer);
 
-	unsigned short* pInput = pTempBuffer;
-	memcpy(pInput, pOutput, m_depthResolution.x*m_depthResolution.y*2);
+	memcpy(pTempBuffer, pOutput, m_depthResolution.x*m_depthResolution.y*2);
 
+	XnStatus nRetVal = Apply(pTempBuffer, pOutput);
+
+	xnOSFreeAligned(pTempBuffer);
+
+	return nRetVal;
+}
+
+XnStatus DepthUtilsImpl::Apply(const unsigned short* pInput, unsigned short* pOutput)
+{
 	int16_t* pRegTable;
 	int16_t* pRGBRegDepthToShiftTable = (int16_t*)m_pDepth2ShiftTable;
 	unsigned short nValue = 0;
@@ -199,7 +208,6 @@ XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
 			bMirror ? pRegTable-=2 : pRegTable+=2;
 		}
 	}
-	xnOSFreeAligned(pTempBuffer);
 
 	return XN_STATUS_OK;
 }
@@ -37,6 +37,7 @@ public:
 	XnStatus Free();
 
 	XnStatus Apply(unsigned short* pOutput);
+	XnStatus Apply(const unsigned short* pInput, unsigned short* pOutput);
 
 	XnStatus SetDepthConfiguration(int xres, int yres, OniPixelFormat format, bool isMirrored);
 
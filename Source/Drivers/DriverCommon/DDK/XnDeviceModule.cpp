@@ -34,6 +34,8 @@
 // Code
 //---------------------------------------------------------------------------
 XnDeviceModule::XnDeviceModule(const char* strName) :
+	m_nPropertyPages(0),
+	m_bPropertyPagesFull(false),
 	m_Lock(XN_MODULE_PROPERTY_LOCK, "Lock", false, strName),
 	m_hLockCS(NULL)
 {
@@ -45,6 +47,11 @@ XnDeviceModule::XnDeviceModule(const char* strName) :
 XnDeviceModule::~XnDeviceModule()
 {
 	Free();
+
+	for (uint32_t i = 0; i < m_nPropertyPages; ++i)
+	{
+		xnOSFree(m_apPropertyPages[i]);
+	}
 }
 
 XnStatus XnDeviceModule::Init()
@@ -78,11 +85,61 @@ XnStatus XnDeviceModule::AddProperty(XnProperty* pProperty)
 	nRetVal = m_Properties.Set(pProperty->GetId(), pProperty);
 	XN_IS_STATUS_OK(nRetVal);
 
+	AddPropertyToPage(pProperty);
+
 	pProperty->UpdateName(GetName(), pProperty->GetName());
 
 	return (XN_STATUS_OK);
 }
 
+void XnDeviceModule::AddPropertyToPage(XnProperty* pProperty)
+{
+	uint32_t nPageID = pProperty->GetId() / XN_DEVICE_MODULE_PROPERTY_PAGE_SIZE;
+
+	uint32_t nPage = 0;
+	while (nPage < m_nPropertyPages && m_anPropertyPageIDs[nPage] != nPageID)
+	{
+		++nPage;
+	}
+
+	if (nPage == m_nPropertyPages)
+	{
+		XnProperty** pPage = NULL;
+		if (m_nPropertyPages < XN_DEVICE_MODULE_MAX_PROPERTY_PAGES)
+		{
+			pPage = (XnProperty**)xnOSCalloc(XN_DEVICE_MODULE_PROPERTY_PAGE_SIZE, sizeof(XnProperty*));
+		}
+
+		if (pPage == NULL)
+		{
+			// the property can still be found in the hash
+			if (!m_bPropertyPagesFull)
+			{
+				xnLogVerbose(XN_MASK_DDK, "Module '%s' has properties in too many ID ranges, some are looked up in a hash", GetName());
+			}
+			m_bPropertyPagesFull = true;
+			return;
+		}
+
+		m_anPropertyPageIDs[nPage] = nPageID;
+		m_apPropertyPages[nPage] = pPage;
+		++m_nPropertyPages;
+	}
+
+	m_apPropertyPages[nPage][pProperty->GetId() % XN_DEVICE_MODULE_PROPERTY_PAGE_SIZE] = pProperty;
+}
+
+XnProperty* XnDeviceModule::FindPropertyInHash(uint32_t propertyId) const
+{
+	XnProperty* pProperty = NULL;
+	if (XN_STATUS_NO_MATCH == m_Properties.Get(propertyId, pProperty))
+	{
+		return NULL;
+	}
+
+	return pProperty;
+}
+
 XnStatus XnDeviceModule::AddProperties(XnProperty** apProperties, uint32_t nCount)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -98,18 +155,7 @@ XnStatus XnDeviceModule::AddProperties(XnProperty** apProperties, uint32_t nCoun
 
 XnStatus XnDeviceModule::DoesPropertyExist(uint32_t propertyId, bool* pbDoesExist) const
 {
-	XnStatus nRetVal = XN_STATUS_OK;
-
-	*pbDoesExist = false;
-
-	XnPropertiesHash::ConstIterator it = m_Properties.End();
-	nRetVal = m_Properties.Find(propertyId, it);
-	if (nRetVal != XN_STATUS_NO_MATCH && nRetVal != XN_STATUS_OK)
-	{
-		return (nRetVal);
-	}
-
-	*pbDoesExist = (nRetVal == XN_STATUS_OK);
+	*pbDoesExist = (FindProperty(propertyId) != NULL);
 
 	return (XN_STATUS_OK);
 }
@@ -131,8 +177,8 @@ XnStatus XnDeviceModule::GetPropertyImpl(uint32_t propertyId, XnPropertyType Typ
 {
 	*ppProperty = NULL;
 
-	XnProperty* pProperty;
-	if (XN_STATUS_NO_MATCH == m_Properties.Get(propertyId, pProperty))
+	XnProperty* pProperty = FindProperty(propertyId);
+	if (pProperty == NULL)
 	{
 		return XN_STATUS_DEVICE_PROPERTY_DONT_EXIST;
 	}
@@ -148,8 +194,8 @@ XnStatus XnDeviceModule::GetPropertyImpl(uint32_t propertyId, XnPropertyType Typ
 
 XnStatus XnDeviceModule::GetProperty(uint32_t propertyId, XnProperty **ppProperty) const
 {
-	XnProperty* pProperty;
-	if (XN_STATUS_NO_MATCH == m_Properties.Get(propertyId, pProperty))
+	XnProperty* pProperty = FindProperty(propertyId);
+	if (pProperty == NULL)
 	{
 		return XN_STATUS_DEVICE_PROPERTY_DONT_EXIST;
 	}
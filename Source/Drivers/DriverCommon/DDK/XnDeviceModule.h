@@ -31,6 +31,14 @@
 #include <DDK/XnStringProperty.h>
 #include <DDK/XnGeneralProperty.h>
 
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/** Property IDs are looked up in pages of this many consecutive IDs (OpenNI's own properties take the first
+    page, each group of driver properties takes one or two more). */
+#define XN_DEVICE_MODULE_PROPERTY_PAGE_SIZE		256
+#define XN_DEVICE_MODULE_MAX_PROPERTY_PAGES		8
+
 //---------------------------------------------------------------------------
 // Types
 //---------------------------------------------------------------------------
@@ -95,6 +103,25 @@ public:
 private:
 	XnStatus GetPropertyImpl(uint32_t propertyId, XnPropertyType Type, XnProperty** ppProperty) const;
 
+	/** Returns the property with this ID, or NULL if the module doesn't have it. */
+	inline XnProperty* FindProperty(uint32_t propertyId) const
+	{
+		uint32_t nPageID = propertyId / XN_DEVICE_MODULE_PROPERTY_PAGE_SIZE;
+		for (uint32_t i = 0; i < m_nPropertyPages; ++i)
+		{
+			if (m_anPropertyPageIDs[i] == nPageID)
+			{
+				return m_apPropertyPages[i][propertyId % XN_DEVICE_MODULE_PROPERTY_PAGE_SIZE];
+			}
+		}
+
+		// every property is in a page, unless the module ran out of them
+		return m_bPropertyPagesFull ? FindPropertyInHash(propertyId) : NULL;
+	}
+
+	XnProperty* FindPropertyInHash(uint32_t propertyId) const;
+	void AddPropertyToPage(XnProperty* pProperty);
+
 	XnStatus SetLockState(bool bLocked);
 
 	static XnStatus XN_CALLBACK_TYPE SetLockStateCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
@@ -102,6 +129,14 @@ private:
 	char m_strName[XN_DEVICE_MAX_STRING_LENGTH];
 
 	XnPropertiesHash m_Properties;
+
+	/* Properties by ID, in pages of consecutive IDs, so the ones OpenNI gets and sets on every frame are
+	   found without hashing. */
+	uint32_t m_anPropertyPageIDs[XN_DEVICE_MODULE_MAX_PROPERTY_PAGES];
+	XnProperty** m_apPropertyPages[XN_DEVICE_MODULE_MAX_PROPERTY_PAGES];
+	uint32_t m_nPropertyPages;
+	bool m_bPropertyPagesFull;
+
 	XnActualIntProperty m_Lock;
 	XN_CRITICAL_SECTION_HANDLE m_hLockCS;
 };
@@ -32,6 +32,7 @@ XnFrameBufferManager::XnFrameBufferManager() :
 	m_pServices(NULL),
 	m_pWorkingBuffer(NULL),
 	m_nStableFrameID(0),
+	m_nAcquireFailures(0),
 	m_newFrameCallback(NULL),
 	m_newFrameCallbackCookie(NULL),
 	m_hLock(NULL)
@@ -115,11 +116,14 @@ void XnFrameBufferManager::MarkWriteBufferAsStable(uint32_t* pnFrameID)
 	if (m_pWorkingBuffer == NULL)
 	{
 		xnLogError(XN_MASK_DDK, "Failed to get new working buffer!");
+		++m_nAcquireFailures;
 
 		// we'll return back to our old working one
 		m_pWorkingBuffer = pStableBuffer;
 		m_pWorkingBuffer->dataSize = 0;
 
+		xnOSLeaveCriticalSection(&m_hLock);
+
 		XN_ASSERT(false);
 		return;
 	}
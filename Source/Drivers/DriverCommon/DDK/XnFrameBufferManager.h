@@ -65,12 +65,16 @@ public:
 
 	inline uint32_t GetLastFrameID() const { return m_nStableFrameID; }
 
+	/** Gets the number of times no new working buffer could be acquired (and a frame was lost). */
+	inline uint64_t GetAcquireFailures() const { return m_nAcquireFailures; }
+
 private:
 	XN_DISABLE_COPY_AND_ASSIGN(XnFrameBufferManager);
 
 	oni::driver::StreamServices* m_pServices;
 	OniFrame* m_pWorkingBuffer;
 	uint32_t m_nStableFrameID;
+	uint64_t m_nAcquireFailures;
 	NewFrameCallback m_newFrameCallback;
 	void* m_newFrameCallbackCookie;
 	XN_CRITICAL_SECTION_HANDLE m_hLock;
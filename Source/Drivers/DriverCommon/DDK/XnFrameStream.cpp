@@ -22,17 +22,38 @@
 // Includes
 //---------------------------------------------------------------------------
 #include "XnFrameStream.h"
+#include <XnOSCpp.h>
 
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
+static void AddLatencySample(OniLatencyHistogram& histogram, uint64_t nMicroseconds)
+{
+	int nBucket = 0;
+	for (uint64_t nValue = nMicroseconds; nValue != 0 && nBucket < ONI_TELEMETRY_LATENCY_BUCKETS - 1; nValue >>= 1)
+	{
+		++nBucket;
+	}
+
+	++histogram.count;
+	histogram.totalMicroseconds += nMicroseconds;
+	histogram.maxMicroseconds = XN_MAX(histogram.maxMicroseconds, nMicroseconds);
+	++histogram.buckets[nBucket];
+}
+
 XnFrameStream::XnFrameStream(const char* csType, const char* csName) :
 	XnDeviceStream(csType, csName),
 	m_nLastReadFrame(0),
+	m_pPostProcessedFrame(NULL),
 	m_IsFrameStream(XN_STREAM_PROPERTY_IS_FRAME_BASED, "IsFrameBased", true),
-	m_FPS(XN_STREAM_PROPERTY_FPS, "FPS", 0)
+	m_FPS(XN_STREAM_PROPERTY_FPS, "FPS", 0),
+	m_Telemetry(ONI_STREAM_PROPERTY_TELEMETRY, "Telemetry"),
+	m_hTelemetryLock(NULL),
+	m_nFrameArrivalTime(0)
 {
 	m_FPS.UpdateSetCallback(SetFPSCallback, this);
+	m_Telemetry.UpdateGetCallback(GetTelemetryCallback, this);
+	xnOSMemSet(&m_telemetry, 0, sizeof(m_telemetry));
 }
 
 XnStatus XnFrameStream::Init()
@@ -46,10 +67,13 @@ XnStatus XnFrameStream::Init()
 	nRetVal = m_bufferManager.Init();
 	XN_IS_STATUS_OK(nRetVal);
 
+	nRetVal = xnOSCreateCriticalSection(&m_hTelemetryLock);
+	XN_IS_STATUS_OK(nRetVal);
+
 	// register for new data events
 	m_bufferManager.SetNewFrameCallback(OnTripleBufferNewData, this);
 
-	XN_VALIDATE_ADD_PROPERTIES(this, &m_IsFrameStream, &m_FPS );
+	XN_VALIDATE_ADD_PROPERTIES(this, &m_IsFrameStream, &m_FPS, &m_Telemetry);
 
 	return (XN_STATUS_OK);
 }
@@ -69,6 +93,13 @@ XnStatus XnFrameStream::StartBufferManager(XnFrameBufferManager** pBufferManager
 XnStatus XnFrameStream::Free()
 {
 	m_bufferManager.Free();
+
+	if (m_hTelemetryLock != NULL)
+	{
+		xnOSCloseCriticalSection(&m_hTelemetryLock);
+		m_hTelemetryLock = NULL;
+	}
+
 	XnDeviceStream::Free();
 	return (XN_STATUS_OK);
 }
@@ -93,6 +124,65 @@ void XN_CALLBACK_TYPE XnFrameStream::OnTripleBufferNewData(OniFrame* pFrame, voi
 {
 	XnFrameStream* pThis = (XnFrameStream*)pCookie;
 	pThis->NewDataAvailable(pFrame);
+	pThis->m_pPostProcessedFrame = NULL;
+}
+
+void XnFrameStream::ReportFrameStarted(uint64_t nArrivalTime)
+{
+	xnl::AutoCSLocker locker(m_hTelemetryLock);
+	++m_telemetry.processorFramesStarted;
+	m_nFrameArrivalTime = nArrivalTime;
+}
+
+void XnFrameStream::ReportFrameEnded(uint32_t nBytes, uint32_t nPacketsLost, bool bCorrupted)
+{
+	xnl::AutoCSLocker locker(m_hTelemetryLock);
+	m_telemetry.usbBytesReceived += nBytes;
+	m_telemetry.usbPacketsLost += nPacketsLost;
+	if (bCorrupted)
+	{
+		++m_telemetry.processorFramesCorrupted;
+		m_nFrameArrivalTime = 0;
+	}
+}
+
+void XnFrameStream::NewDataAvailable(OniFrame* pFrame)
+{
+	uint64_t nNow;
+	xnOSGetHighResTimeStamp(&nNow);
+
+	{
+		xnl::AutoCSLocker locker(m_hTelemetryLock);
+		++m_telemetry.processorFramesProduced;
+		if (m_nFrameArrivalTime != 0 && nNow >= m_nFrameArrivalTime)
+		{
+			AddLatencySample(m_telemetry.usbToDriverOutputLatency, nNow - m_nFrameArrivalTime);
+			m_nFrameArrivalTime = 0;
+		}
+	}
+
+	XnDeviceStream::NewDataAvailable(pFrame);
+}
+
+XnStatus XN_CALLBACK_TYPE XnFrameStream::GetTelemetryCallback(const XnGeneralProperty* /*pSender*/, const OniGeneralBuffer& gbValue, void* pCookie)
+{
+	XnFrameStream* pThis = (XnFrameStream*)pCookie;
+
+	if (gbValue.dataSize != sizeof(OniStreamTelemetry))
+	{
+		return XN_STATUS_DEVICE_PROPERTY_SIZE_DONT_MATCH;
+	}
+
+	OniStreamTelemetry* pTelemetry = (OniStreamTelemetry*)gbValue.data;
+
+	{
+		xnl::AutoCSLocker locker(pThis->m_hTelemetryLock);
+		*pTelemetry = pThis->m_telemetry;
+	}
+
+	pTelemetry->processorBufferFailures = pThis->m_bufferManager.GetAcquireFailures();
+
+	return (XN_STATUS_OK);
 }
 
 XnStatus XnFrameStream::Close()
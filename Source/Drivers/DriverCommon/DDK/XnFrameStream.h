@@ -26,6 +26,7 @@
 //---------------------------------------------------------------------------
 #include "XnDeviceStream.h"
 #include "XnFrameBufferManager.h"
+#include "XnGeneralProperty.h"
 #include "Driver/OniDriverTypes.h"
 
 //---------------------------------------------------------------------------
@@ -44,6 +45,23 @@ public:
 	//---------------------------------------------------------------------------
 	inline uint32_t GetFPS() const { return (uint32_t)m_FPS.GetValue(); }
 
+	/**
+	* Marks a frame as already cropped and mirrored by the data processor that wrote it, so the stream
+	* does not do it again. Only valid until the frame was handed to NewDataAvailable().
+	*/
+	inline void SetFramePostProcessed(const OniFrame* pFrame) { m_pPostProcessedFrame = pFrame; }
+
+	/**
+	* Telemetry (see ONI_STREAM_PROPERTY_TELEMETRY), reported by the stream processor.
+	*
+	* @param	nArrivalTime	[in]	Host time (xnOSGetHighResTimeStamp()) the first packet of the frame arrived at.
+	* @param	nBytes			[in]	Bytes received for this frame.
+	* @param	nPacketsLost	[in]	Packets lost since the previous frame ended.
+	* @param	bCorrupted		[in]	TRUE if the frame was corrupted and will not be handed to OpenNI.
+	*/
+	void ReportFrameStarted(uint64_t nArrivalTime);
+	void ReportFrameEnded(uint32_t nBytes, uint32_t nPacketsLost, bool bCorrupted);
+
 	//---------------------------------------------------------------------------
 	// Overridden Methods
 	//---------------------------------------------------------------------------
@@ -52,6 +70,8 @@ public:
 
 	virtual XnStatus Close() override;
 
+	virtual void NewDataAvailable(OniFrame* pFrame) override;
+
 protected:
 	//---------------------------------------------------------------------------
 	// Properties Getters
@@ -68,6 +88,8 @@ protected:
 	//---------------------------------------------------------------------------
 	virtual XnStatus SetFPS(uint32_t nFPS);
 
+	inline bool IsFramePostProcessed(const OniFrame* pFrame) const { return (pFrame == m_pPostProcessedFrame); }
+
 	//---------------------------------------------------------------------------
 	// Virtual Methods
 	//---------------------------------------------------------------------------
@@ -78,6 +100,7 @@ private:
 
 	static XnStatus XN_CALLBACK_TYPE SetFPSCallback(XnActualIntProperty* pSenser, uint64_t nValue, void* pCookie);
 	static void XN_CALLBACK_TYPE OnTripleBufferNewData(OniFrame* pFrame, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE GetTelemetryCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 
 	//---------------------------------------------------------------------------
 	// Members
@@ -85,9 +108,15 @@ private:
 	XnFrameBufferManager m_bufferManager;
 
 	uint32_t m_nLastReadFrame; // the ID that was given
+	const OniFrame* m_pPostProcessedFrame;
 
 	XnActualIntProperty m_IsFrameStream;
 	XnActualIntProperty m_FPS;
+	XnGeneralProperty m_Telemetry;
+
+	XN_CRITICAL_SECTION_HANDLE m_hTelemetryLock;
+	OniStreamTelemetry m_telemetry;
+	uint64_t m_nFrameArrivalTime;
 };
 
 #endif // XNFRAMESTREAM_H
@@ -38,6 +38,7 @@ XnPixelStream::XnPixelStream(const char* csType, const char* csName, bool bAllow
 	m_YRes(XN_STREAM_PROPERTY_Y_RES, "YRes", XN_VGA_Y_RES),
 	m_BytesPerPixel(XN_STREAM_PROPERTY_BYTES_PER_PIXEL, "BytesPerPixel"),
 	m_Cropping(XN_STREAM_PROPERTY_CROPPING, "Cropping", &m_CroppingData, sizeof(OniCropping), ReadCroppingFromFileCallback),
+	m_CroppingView(XN_STREAM_PROPERTY_CROPPING_VIEW, "CroppingView", false),
 	m_SupportedModesCount(XN_STREAM_PROPERTY_SUPPORT_MODES_COUNT, "SupportedModesCount", 0),
 	m_SupportedModes(XN_STREAM_PROPERTY_SUPPORT_MODES, "SupportedModes"),
 	m_supportedModesData(30, XnCmosPreset()),
@@ -60,10 +61,11 @@ XnStatus XnPixelStream::Init()
 	m_XRes.UpdateSetCallback(SetXResCallback, this);
 	m_YRes.UpdateSetCallback(SetYResCallback, this);
 	m_Cropping.UpdateSetCallback(SetCroppingCallback, this);
+	m_CroppingView.UpdateSetCallbackToDefault();
 
 	// add properties
 	XN_VALIDATE_ADD_PROPERTIES(this, &m_IsPixelStream, &m_Resolution, &m_XRes, &m_YRes,
-		&m_BytesPerPixel, &m_Cropping, &m_SupportedModesCount, &m_SupportedModes);
+		&m_BytesPerPixel, &m_Cropping, &m_CroppingView, &m_SupportedModesCount, &m_SupportedModes);
 
 	// register required size properties
 	nRetVal = RegisterRequiredSizeProperty(&m_XRes);
@@ -322,7 +324,8 @@ void XnPixelStream::NewDataAvailable(OniFrame* pFrame)
 	OniCropping cropping = *GetCropping();
 	xnOSLeaveCriticalSection(GetLock());
 
-	if (cropping.enabled)
+	// when the data processor already placed the rows in their cropped position, there's nothing left to do
+	if (cropping.enabled && !IsFramePostProcessed(pFrame))
 	{
 		XnStatus nRetVal = CropImpl(pFrame, &cropping);
 		if (nRetVal != XN_STATUS_OK)
@@ -337,11 +340,61 @@ void XnPixelStream::NewDataAvailable(OniFrame* pFrame)
 
 XnStatus XnPixelStream::Mirror(OniFrame* pFrame) const
 {
-	return XnFormatsMirrorPixelData(GetOutputFormat(), (unsigned char*)pFrame->data, pFrame->dataSize, pFrame->width);
+	if (IsFramePostProcessed(pFrame))
+	{
+		return (XN_STATUS_OK);
+	}
+
+	uint32_t nLineSize = pFrame->width * GetBytesPerPixel();
+	if ((uint32_t)pFrame->stride == nLineSize)
+	{
+		return XnFormatsMirrorPixelData(GetOutputFormat(), (unsigned char*)pFrame->data, pFrame->dataSize, pFrame->width);
+	}
+
+	// a cropping view. Mirror only the visible part of each line.
+	unsigned char* pLine = (unsigned char*)pFrame->data;
+	for (int y = 0; y < pFrame->height; ++y)
+	{
+		XnStatus nRetVal = XnFormatsMirrorPixelData(GetOutputFormat(), pLine, nLineSize, pFrame->width);
+		XN_IS_STATUS_OK(nRetVal);
+
+		pLine += pFrame->stride;
+	}
+
+	return (XN_STATUS_OK);
+}
+
+void XnPixelStream::GetCroppingAndMirror(OniCropping* pCropping, bool* pbMirror)
+{
+	xnOSEnterCriticalSection(GetLock());
+	*pCropping = *GetCropping();
+	*pbMirror = IsMirrored();
+	xnOSLeaveCriticalSection(GetLock());
+}
+
+void XnPixelStream::SetCroppingView(OniFrame* pFrame, const OniCropping* pCropping, uint32_t nBytesPerPixel)
+{
+	uint32_t nStride = pFrame->width * nBytesPerPixel;
+
+	pFrame->data = (unsigned char*)pFrame->data + pCropping->originY * nStride + pCropping->originX * nBytesPerPixel;
+	// the last line ends where the cropped area does, not a full stride after it
+	pFrame->dataSize = (pCropping->height - 1) * nStride + pCropping->width * nBytesPerPixel;
+	pFrame->width = pCropping->width;
+	pFrame->height = pCropping->height;
+	pFrame->cropOriginX = pCropping->originX;
+	pFrame->cropOriginY = pCropping->originY;
+	pFrame->croppingEnabled = true;
+	pFrame->stride = nStride;
 }
 
 XnStatus XnPixelStream::CropImpl(OniFrame* pFrame, const OniCropping* pCropping)
 {
+	if (IsCroppingView())
+	{
+		SetCroppingView(pFrame, pCropping, GetBytesPerPixel());
+		return XN_STATUS_OK;
+	}
+
 	unsigned char* pPixelData = (unsigned char*)pFrame->data;
 	uint32_t nCurDataSize = 0;
 
@@ -356,6 +409,12 @@ XnStatus XnPixelStream::CropImpl(OniFrame* pFrame, const OniCropping* pCropping)
 
 	// update size
 	pFrame->dataSize = nCurDataSize;
+	pFrame->width = pCropping->width;
+	pFrame->height = pCropping->height;
+	pFrame->cropOriginX = pCropping->originX;
+	pFrame->cropOriginY = pCropping->originY;
+	pFrame->croppingEnabled = true;
+	pFrame->stride = pCropping->width * GetBytesPerPixel();
 
 	return XN_STATUS_OK;
 }
@@ -53,8 +53,12 @@ public:
 	inline uint32_t GetYRes() const { return (uint32_t)m_YRes.GetValue(); }
 	inline uint32_t GetBytesPerPixel() const { return (uint32_t)m_BytesPerPixel.GetValue(); }
 	inline const OniCropping* GetCropping() const { return (OniCropping*)m_Cropping.GetValue().data; }
+	inline bool IsCroppingView() const { return (bool)m_CroppingView.GetValue(); }
 	inline const std::vector<XnCmosPreset>& GetSupportedModes() const { return m_supportedModesData; }
 
+	/** Reads the cropping and the mirror setting together, under the stream lock. */
+	void GetCroppingAndMirror(OniCropping* pCropping, bool* pbMirror);
+
 protected:
 	XnStatus AddSupportedModes(XnCmosPreset* aPresets, uint32_t nCount);
 	XnStatus ValidateSupportedMode(const XnCmosPreset& preset);
@@ -71,6 +75,7 @@ protected:
 	inline XnActualIntProperty& YResProperty() { return m_YRes; }
 	inline XnActualIntProperty& BytesPerPixelProperty() { return m_BytesPerPixel; }
 	inline XnActualGeneralProperty& CroppingProperty() { return m_Cropping; }
+	inline XnActualIntProperty& CroppingViewProperty() { return m_CroppingView; }
 
 	//---------------------------------------------------------------------------
 	// Setters
@@ -95,6 +100,17 @@ protected:
 
 	XnStatus ValidateCropping(const OniCropping* pCropping);
 
+public:
+	/**
+	* Turns a full frame into a view of its cropped area: data is moved to the crop origin, while the stride
+	* remains a full line of the original frame. No pixel is copied.
+	*
+	* @param	pFrame			[in]	The frame. Must not be cropped already.
+	* @param	pCropping		[in]	The area to show.
+	* @param	nBytesPerPixel	[in]	Size of a pixel, in bytes.
+	*/
+	static void SetCroppingView(OniFrame* pFrame, const OniCropping* pCropping, uint32_t nBytesPerPixel);
+
 private:
 	class XnResolutionProperty : public XnActualIntProperty
 	{
@@ -126,6 +142,7 @@ private:
 	XnActualIntProperty m_YRes;
 	XnActualIntProperty m_BytesPerPixel;
 	XnActualGeneralProperty m_Cropping;
+	XnActualIntProperty m_CroppingView;
 
 	OniCropping m_CroppingData;
 
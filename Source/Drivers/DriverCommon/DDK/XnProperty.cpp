@@ -152,19 +152,21 @@ bool XnProperty::ConvertValueToString(char* /*csValue*/, const void* /*pValue*/)
 XnStatus XnProperty::ChangeEvent::Raise(const XnProperty* pSender)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
-	xnl::AutoCSLocker locker(m_hLock);
-	ApplyListChanges();
+	const CallbackList* pCallbacks = BeginRaise();
 
-	for (std::list<Callback*>::const_iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
+	if (pCallbacks != NULL)
 	{
-		Callback* pCallback = *it;
-		nRetVal = pCallback->pFunc(pSender, pCallback->pCookie);
-		if (nRetVal != XN_STATUS_OK)
+		for (CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
 		{
-			break;
+			Callback* pCallback = *it;
+			nRetVal = pCallback->pFunc(pSender, pCallback->pCookie);
+			if (nRetVal != XN_STATUS_OK)
+			{
+				break;
+			}
 		}
 	}
 
-	ApplyListChanges();
+	EndRaise();
 	return (nRetVal);
 }
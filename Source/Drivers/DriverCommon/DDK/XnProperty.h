@@ -117,6 +117,6 @@ private:
 };
 
 /** A hash table, mapping property name to the property */
-typedef xnl::Hash<uint32_t, XnProperty*> XnPropertiesHash;
+typedef xnl::OpenHash<uint32_t, XnProperty*> XnPropertiesHash;
 
 #endif // XNPROPERTY_H
@@ -0,0 +1,247 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// DepthFilterBenchmark.cpp : Measures the depth filter chain at the rates depth streams run at, and checks the
+// vectorized and multithreaded paths against the scalar single threaded one.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include <XnDepthFilterChain.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_FRAMES 300
+/* Number of distinct synthetic frames played in a loop. */
+#define SYNTHETIC_FRAMES 8
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct
+{
+	uint32_t nXRes;
+	uint32_t nYRes;
+	uint32_t nFPS;
+} BenchmarkMode;
+
+typedef struct
+{
+	const char* strName;
+	XnDepthFilterSettings settings;
+} BenchmarkChain;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const BenchmarkMode g_modes[] =
+{
+	{ 640, 480, 30 },
+	{ 320, 240, 120 },
+};
+
+/* hole fill width, spatial delta, temporal alpha, temporal delta, temporal persistence, threads (set per run) */
+static const BenchmarkChain g_chains[] =
+{
+	{ "HoleFill", { 8, 0, 0, 0, 0, 0 } },
+	{ "Spatial", { 0, 20, 0, 0, 0, 0 } },
+	{ "Temporal", { 0, 0, 102, 40, 3, 0 } },
+	{ "All", { 8, 20, 102, 40, 3, 0 } },
+};
+
+static const uint32_t g_threads[] = { 1, 2, 4 };
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/* A slanted wall with a box in front of it, sensor noise, and holes: thin ones (as around edges and on dark
+   surfaces), and large ones that stay lost for a few frames. */
+void GenerateFrames(uint32_t nXRes, uint32_t nYRes, std::vector<std::vector<OniDepthPixel> >& frames)
+{
+	frames.resize(SYNTHETIC_FRAMES);
+	for (uint32_t f = 0; f < SYNTHETIC_FRAMES; ++f)
+	{
+		std::vector<OniDepthPixel>& frame = frames[f];
+		frame.resize(nXRes * nYRes);
+		for (uint32_t y = 0; y < nYRes; ++y)
+		{
+			for (uint32_t x = 0; x < nXRes; ++x)
+			{
+				int nDepth = 2500 + (int)(x * 1000 / nXRes);
+				if (x > nXRes / 3 + f && x < nXRes * 2 / 3 + f && y > nYRes / 4 && y < nYRes * 3 / 4)
+				{
+					nDepth = 1200;
+				}
+				nDepth += rand() % 9 - 4;
+				frame[y * nXRes + x] = (OniDepthPixel)nDepth;
+			}
+		}
+
+		for (uint32_t i = 0; i < nXRes * nYRes / 40; ++i)
+		{
+			uint32_t nStart = rand() % (nXRes * nYRes);
+			uint32_t nWidth = 1 + rand() % 12;
+			for (uint32_t j = nStart; j < nStart + nWidth && j < nXRes * nYRes; ++j)
+			{
+				frame[j] = 0;
+			}
+		}
+
+		if (f % 4 != 3)
+		{
+			for (uint32_t y = nYRes / 8; y < nYRes / 5; ++y)
+			{
+				xnOSMemSet(&frame[y * nXRes + nXRes / 8], 0, nXRes / 10 * sizeof(OniDepthPixel));
+			}
+		}
+	}
+}
+
+/* Filters a sequence of frames, returning the outputs. */
+bool FilterSequence(const XnDepthFilterSettings& settings, const std::vector<std::vector<OniDepthPixel> >& frames, uint32_t nXRes, uint32_t nYRes, std::vector<std::vector<OniDepthPixel> >& outputs)
+{
+	XnDepthFilterChain chain;
+	if (chain.SetSettings(settings) != XN_STATUS_OK)
+	{
+		return false;
+	}
+
+	outputs = frames;
+	for (uint32_t i = 0; i < outputs.size(); ++i)
+	{
+		chain.Apply(&outputs[i][0], nXRes, nYRes);
+	}
+
+	return true;
+}
+
+/* Checks the selected kernels and the bands give the same output as the scalar kernels on a single thread. */
+bool VerifyChain(xnl::Benchmark& benchmark, const BenchmarkChain& chain, uint32_t nPass)
+{
+	const uint32_t aWidths[] = { 1, 7, 9, 17, 33, 640 };
+	for (uint32_t w = 0; w < sizeof(aWidths) / sizeof(aWidths[0]); ++w)
+	{
+		uint32_t nXRes = aWidths[w];
+		uint32_t nYRes = 13;
+		std::vector<std::vector<OniDepthPixel> > frames;
+		GenerateFrames(nXRes, nYRes, frames);
+
+		XnDepthFilterSettings settings = chain.settings;
+		std::vector<std::vector<OniDepthPixel> > expected;
+		XnDepthFilterChain::SetVectorized(false);
+		settings.nThreads = 1;
+		FilterSequence(settings, frames, nXRes, nYRes, expected);
+
+		benchmark.SelectKernels(nPass);
+		for (uint32_t t = 0; t < sizeof(g_threads) / sizeof(g_threads[0]); ++t)
+		{
+			std::vector<std::vector<OniDepthPixel> > outputs;
+			settings.nThreads = g_threads[t];
+			if (!FilterSequence(settings, frames, nXRes, nYRes, outputs) || outputs != expected)
+			{
+				benchmark.Fail("%s: %s output on %u threads doesn't match the scalar one (%ux%u)!", chain.strName, benchmark.GetKernelName(), g_threads[t], nXRes, nYRes);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void BenchmarkChainMode(xnl::Benchmark& benchmark, const BenchmarkChain& chain, const BenchmarkMode& mode, uint32_t nThreads, uint32_t nFrames)
+{
+	std::vector<std::vector<OniDepthPixel> > frames;
+	GenerateFrames(mode.nXRes, mode.nYRes, frames);
+	std::vector<OniDepthPixel> frame(mode.nXRes * mode.nYRes);
+
+	XnDepthFilterSettings settings = chain.settings;
+	settings.nThreads = nThreads;
+	XnDepthFilterChain filter;
+	filter.SetSettings(settings);
+
+	benchmark.ResetTimes();
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		// frames are filtered in place, so each run starts from a fresh copy (not timed)
+		xnOSMemCopy(&frame[0], &frames[i % SYNTHETIC_FRAMES][0], frame.size() * sizeof(OniDepthPixel));
+
+		benchmark.StartRun();
+		filter.Apply(&frame[0], mode.nXRes, mode.nYRes);
+		benchmark.EndRun();
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %ux%u@%u %u threads", chain.strName, mode.nXRes, mode.nYRes, mode.nFPS, nThreads);
+	benchmark.ReportFrameTime(strCase, mode.nFPS);
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	const uint32_t nChains = sizeof(g_chains) / sizeof(g_chains[0]);
+	const uint32_t nModes = sizeof(g_modes) / sizeof(g_modes[0]);
+	const uint32_t nThreadCounts = sizeof(g_threads) / sizeof(g_threads[0]);
+
+	uint32_t nFrames = DEFAULT_FRAMES;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("frames", "Number of frames filtered in each run.", &nFrames);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	benchmark.SetKernels(XnDepthFilterChain::SetVectorized, XnDepthFilterChain::IsVectorized, "SSSE3");
+
+	srand(0);
+	for (uint32_t i = 0; i < nChains; ++i)
+	{
+		for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+		{
+			VerifyChain(benchmark, g_chains[i], nPass);
+		}
+	}
+
+	for (uint32_t i = 0; i < nChains; ++i)
+	{
+		for (uint32_t j = 0; j < nModes; ++j)
+		{
+			for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+			{
+				benchmark.SelectKernels(nPass);
+				for (uint32_t t = 0; t < nThreadCounts; ++t)
+				{
+					BenchmarkChainMode(benchmark, g_chains[i], g_modes[j], g_threads[t], nFrames);
+				}
+			}
+		}
+	}
+
+	return benchmark.GetResult();
+}
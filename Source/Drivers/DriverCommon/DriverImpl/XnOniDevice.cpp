@@ -165,15 +165,17 @@ XnStatus XnOniDevice::FillSupportedVideoModes()
 	nSupportedModes = m_sensor.GetDevicePrivateData()->FWInfo.irModes.size();
 	pSupportedModes = m_sensor.GetDevicePrivateData()->FWInfo.irModes.data();
 
+	OniPixelFormat irFormats[] = {ONI_PIXEL_FORMAT_GRAY16, ONI_PIXEL_FORMAT_GRAY8, ONI_PIXEL_FORMAT_RGB888};
+	const int nIRFormats = sizeof(irFormats) / sizeof(irFormats[0]);
+
 	m_sensors[s].sensorType 	    = ONI_SENSOR_IR;
-	m_sensors[s].pSupportedVideoModes   = XN_NEW_ARR(OniVideoMode, nSupportedModes*2);
+	m_sensors[s].pSupportedVideoModes   = XN_NEW_ARR(OniVideoMode, nSupportedModes*nIRFormats);
 	XN_VALIDATE_ALLOC_PTR(m_sensors[s].pSupportedVideoModes);
 
-	OniPixelFormat irFormats[] = {ONI_PIXEL_FORMAT_GRAY16, ONI_PIXEL_FORMAT_RGB888};
 	writeIndex = 0;
 	for(uint32_t i=0; i < nSupportedModes; ++i)
 	{
-		for (int fmt = 0; fmt <= 1; ++fmt)
+		for (int fmt = 0; fmt < nIRFormats; ++fmt)
 		{
 			m_sensors[s].pSupportedVideoModes[writeIndex].pixelFormat = irFormats[fmt];
 			m_sensors[s].pSupportedVideoModes[writeIndex].fps = pSupportedModes[i].nFPS;
@@ -29,6 +29,7 @@
 #include "../Sensor/XnDeviceEnumeration.h"
 #include <XnLogWriterBase.h>
 #include <XnStringsHash.h>
+#include <XnProfiling.h>
 
 //---------------------------------------------------------------------------
 // XnOniDriver class
@@ -56,6 +57,8 @@ OniStatus XnOniDriver::initialize(oni::driver::DeviceConnectedCallback deviceCon
 	}
 
 	xnLogSetMaskMinSeverity(XN_LOG_MASK_ALL, XN_LOG_VERBOSE);
+	// Entries are forwarded to the OpenNI log, which queues them itself
+	xnLogSetAsynchronous(false);
 	m_writer.Register();
 
 	XnStatus rc = XnDeviceEnumeration::ConnectedEvent().Register(OnDeviceConnected, this, m_connectedEventHandle);
@@ -70,6 +73,16 @@ OniStatus XnOniDriver::initialize(oni::driver::DeviceConnectedCallback deviceCon
 		return ONI_STATUS_ERROR;
 	}
 
+	// Thread policies must be loaded before enumeration starts the USB threads.
+	char strConfigFile[XN_FILE_MAX_PATH];
+	bool bConfigExists = false;
+	if (XnSensor::ResolveGlobalConfigFileName(strConfigFile, sizeof(strConfigFile), NULL) == XN_STATUS_OK &&
+		xnOSDoesFileExist(strConfigFile, &bConfigExists) == XN_STATUS_OK && bConfigExists)
+	{
+		xnOSLoadThreadPoliciesFromINI(strConfigFile, "Threads");
+		xnProfilingInitFromINI(strConfigFile, "Profiling");
+	}
+
 	rc = XnDeviceEnumeration::Initialize();
 	if (rc != XN_STATUS_OK)
 	{
@@ -102,6 +115,8 @@ void XnOniDriver::shutdown()
 	m_devices.Clear();
 
 	XnDeviceEnumeration::Shutdown();
+
+	xnProfilingShutdown();
 }
 
 oni::driver::DeviceBase* XnOniDriver::deviceOpen(const char* uri, const char* mode)
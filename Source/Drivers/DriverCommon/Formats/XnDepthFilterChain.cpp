@@ -0,0 +1,665 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "XnDepthFilterChain.h"
+#include "XnFormats.h"
+#include "XnFormatsSimd.h"
+#include <XnLog.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_DEPTH_FILTER_THREAD_TERMINATE_TIMEOUT	3000
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static bool g_bDepthFilterVectorized = XnFormatsHasSSSE3();
+
+//---------------------------------------------------------------------------
+// Kernels
+//---------------------------------------------------------------------------
+/* Parameters of the temporal filter, as the kernels use them. */
+typedef struct
+{
+	/* Weight of the previous output, in 1/65536 units (0 when the filter only tracks validity). */
+	uint16_t nHistoryWeight;
+	uint16_t nDelta;
+	/* Minimum number of valid frames (out of the last 8) for a lost pixel to keep its depth. 9 never keeps it. */
+	uint16_t nPersistence;
+} XnDepthTemporalParams;
+
+static inline OniDepthPixel XnDepthAbsDiff(OniDepthPixel a, OniDepthPixel b)
+{
+	return (OniDepthPixel)(a > b ? a - b : b - a);
+}
+
+static inline OniDepthPixel XnDepthAverage(OniDepthPixel a, OniDepthPixel b)
+{
+	return (OniDepthPixel)((a + b + 1) >> 1);
+}
+
+static inline uint32_t XnDepthCountBits(uint8_t nBits)
+{
+	uint32_t nCount = 0;
+	for (; nBits != 0; nBits &= (uint8_t)(nBits - 1))
+	{
+		++nCount;
+	}
+	return nCount;
+}
+
+/* Neighbours too far from the center (or without depth) are replaced by the center. */
+static inline OniDepthPixel XnDepthSpatialSelect(OniDepthPixel nCenter, OniDepthPixel nNeighbour, OniDepthPixel nDelta)
+{
+	return (nNeighbour != 0 && XnDepthAbsDiff(nNeighbour, nCenter) <= nDelta) ? nNeighbour : nCenter;
+}
+
+static inline OniDepthPixel XnDepthSpatialPixel(OniDepthPixel c, OniDepthPixel l, OniDepthPixel r, OniDepthPixel u, OniDepthPixel d, OniDepthPixel nDelta)
+{
+	if (c == 0)
+	{
+		return 0;
+	}
+
+	OniDepthPixel nHorizontal = XnDepthAverage(XnDepthSpatialSelect(c, l, nDelta), XnDepthSpatialSelect(c, r, nDelta));
+	OniDepthPixel nVertical = XnDepthAverage(XnDepthSpatialSelect(c, u, nDelta), XnDepthSpatialSelect(c, d, nDelta));
+	return XnDepthAverage(c, XnDepthAverage(nHorizontal, nVertical));
+}
+
+static inline OniDepthPixel XnDepthTemporalPixel(OniDepthPixel c, OniDepthPixel* pHistory, uint8_t* pValidity, const XnDepthTemporalParams& params)
+{
+	OniDepthPixel p = *pHistory;
+	uint8_t nValidity = (uint8_t)((*pValidity << 1) | (c != 0 ? 1 : 0));
+	*pValidity = nValidity;
+
+	OniDepthPixel nOutput;
+	if (c != 0)
+	{
+		nOutput = c;
+		if (p != 0 && XnDepthAbsDiff(c, p) <= params.nDelta)
+		{
+			uint32_t nBlend = c - ((c * params.nHistoryWeight) >> 16) + ((p * params.nHistoryWeight) >> 16);
+			nOutput = (OniDepthPixel)XN_MIN(nBlend, 0xFFFFu);
+		}
+	}
+	else
+	{
+		nOutput = (p != 0 && XnDepthCountBits(nValidity) >= params.nPersistence) ? p : 0;
+	}
+
+	*pHistory = nOutput;
+	return nOutput;
+}
+
+static uint32_t XnDepthFindZero(const OniDepthPixel* pRow, uint32_t x, uint32_t nXRes)
+{
+	while (x < nXRes && pRow[x] != 0)
+	{
+		++x;
+	}
+	return x;
+}
+
+static uint32_t XnDepthFindNonZero(const OniDepthPixel* pRow, uint32_t x, uint32_t nXRes)
+{
+	while (x < nXRes && pRow[x] == 0)
+	{
+		++x;
+	}
+	return x;
+}
+
+static void XnDepthFillHolesRow(OniDepthPixel* pRow, uint32_t nXRes, uint32_t nMaxWidth, uint32_t (*pFindZero)(const OniDepthPixel*, uint32_t, uint32_t), uint32_t (*pFindNonZero)(const OniDepthPixel*, uint32_t, uint32_t))
+{
+	uint32_t x = 0;
+	for (;;)
+	{
+		uint32_t nStart = pFindZero(pRow, x, nXRes);
+		if (nStart == nXRes)
+		{
+			break;
+		}
+
+		uint32_t nEnd = pFindNonZero(pRow, nStart, nXRes);
+
+		// only holes with depth on both sides are filled
+		if (nStart > 0 && nEnd < nXRes && nEnd - nStart <= nMaxWidth)
+		{
+			OniDepthPixel nFill = XN_MAX(pRow[nStart - 1], pRow[nEnd]);
+			for (uint32_t i = nStart; i < nEnd; ++i)
+			{
+				pRow[i] = nFill;
+			}
+		}
+
+		x = nEnd;
+	}
+}
+
+static void XnDepthSpatialRow(const OniDepthPixel* pUp, const OniDepthPixel* pRow, const OniDepthPixel* pDown, OniDepthPixel* pOutput, uint32_t nXRes, uint32_t nFirst, OniDepthPixel nDelta)
+{
+	// pixels outside the frame are taken to be the center pixel
+	for (uint32_t x = nFirst; x < nXRes; ++x)
+	{
+		OniDepthPixel c = pRow[x];
+		OniDepthPixel l = (x > 0) ? pRow[x - 1] : c;
+		OniDepthPixel r = (x + 1 < nXRes) ? pRow[x + 1] : c;
+		pOutput[x] = XnDepthSpatialPixel(c, l, r, pUp[x], pDown[x], nDelta);
+	}
+}
+
+static void XnDepthTemporalRow(const OniDepthPixel* pInput, OniDepthPixel* pOutput, OniDepthPixel* pHistory, uint8_t* pValidity, uint32_t nFirst, uint32_t nXRes, const XnDepthTemporalParams& params)
+{
+	for (uint32_t x = nFirst; x < nXRes; ++x)
+	{
+		pOutput[x] = XnDepthTemporalPixel(pInput[x], &pHistory[x], &pValidity[x], params);
+	}
+}
+
+#if XN_FORMATS_SIMD_X86
+
+static inline uint32_t XnDepthFirstSetBit(uint32_t nMask)
+{
+#if defined(_MSC_VER)
+	unsigned long nIndex;
+	_BitScanForward(&nIndex, nMask);
+	return (uint32_t)nIndex;
+#else
+	return (uint32_t)__builtin_ctz(nMask);
+#endif
+}
+
+/* Holes are sparse, so whole blocks of 8 pixels are skipped at a time. */
+XN_FORMATS_TARGET_SSSE3 static uint32_t XnDepthFindZeroSSSE3(const OniDepthPixel* pRow, uint32_t x, uint32_t nXRes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	for (; x + 8 <= nXRes; x += 8)
+	{
+		uint32_t nMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(pRow + x)), zero));
+		if (nMask != 0)
+		{
+			return x + XnDepthFirstSetBit(nMask) / 2;
+		}
+	}
+	return XnDepthFindZero(pRow, x, nXRes);
+}
+
+XN_FORMATS_TARGET_SSSE3 static uint32_t XnDepthFindNonZeroSSSE3(const OniDepthPixel* pRow, uint32_t x, uint32_t nXRes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	for (; x + 8 <= nXRes; x += 8)
+	{
+		uint32_t nMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(pRow + x)), zero)) ^ 0xFFFF;
+		if (nMask != 0)
+		{
+			return x + XnDepthFirstSetBit(nMask) / 2;
+		}
+	}
+	return XnDepthFindNonZero(pRow, x, nXRes);
+}
+
+XN_FORMATS_TARGET_SSSE3 static inline __m128i XnDepthAbsDiffSSSE3(__m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+/* All ones in lanes where a <= b (unsigned). */
+XN_FORMATS_TARGET_SSSE3 static inline __m128i XnDepthLessEqualSSSE3(__m128i a, __m128i b)
+{
+	return _mm_cmpeq_epi16(_mm_subs_epu16(a, b), _mm_setzero_si128());
+}
+
+XN_FORMATS_TARGET_SSSE3 static inline __m128i XnDepthSelectSSSE3(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+XN_FORMATS_TARGET_SSSE3 static inline __m128i XnDepthSpatialSelectSSSE3(__m128i c, __m128i n, __m128i delta)
+{
+	__m128i noDepth = _mm_cmpeq_epi16(n, _mm_setzero_si128());
+	__m128i near = _mm_andnot_si128(noDepth, XnDepthLessEqualSSSE3(XnDepthAbsDiffSSSE3(n, c), delta));
+	return XnDepthSelectSSSE3(near, n, c);
+}
+
+XN_FORMATS_TARGET_SSSE3 static void XnDepthSpatialRowSSSE3(const OniDepthPixel* pUp, const OniDepthPixel* pRow, const OniDepthPixel* pDown, OniDepthPixel* pOutput, uint32_t nXRes, uint32_t /*nFirst*/, OniDepthPixel nDelta)
+{
+	if (nXRes < 10)
+	{
+		XnDepthSpatialRow(pUp, pRow, pDown, pOutput, nXRes, 0, nDelta);
+		return;
+	}
+
+	// the first pixel has no left neighbour
+	pOutput[0] = XnDepthSpatialPixel(pRow[0], pRow[0], pRow[1], pUp[0], pDown[0], nDelta);
+
+	const __m128i delta = _mm_set1_epi16((short)nDelta);
+	const __m128i zero = _mm_setzero_si128();
+	uint32_t x = 1;
+	for (; x + 9 <= nXRes; x += 8)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)(pRow + x));
+		__m128i l = XnDepthSpatialSelectSSSE3(c, _mm_loadu_si128((const __m128i*)(pRow + x - 1)), delta);
+		__m128i r = XnDepthSpatialSelectSSSE3(c, _mm_loadu_si128((const __m128i*)(pRow + x + 1)), delta);
+		__m128i u = XnDepthSpatialSelectSSSE3(c, _mm_loadu_si128((const __m128i*)(pUp + x)), delta);
+		__m128i d = XnDepthSpatialSelectSSSE3(c, _mm_loadu_si128((const __m128i*)(pDown + x)), delta);
+
+		__m128i out = _mm_avg_epu16(c, _mm_avg_epu16(_mm_avg_epu16(l, r), _mm_avg_epu16(u, d)));
+		out = _mm_andnot_si128(_mm_cmpeq_epi16(c, zero), out);
+		_mm_storeu_si128((__m128i*)(pOutput + x), out);
+	}
+
+	XnDepthSpatialRow(pUp, pRow, pDown, pOutput, nXRes, x, nDelta);
+}
+
+XN_FORMATS_TARGET_SSSE3 static void XnDepthTemporalRowSSSE3(const OniDepthPixel* pInput, OniDepthPixel* pOutput, OniDepthPixel* pHistory, uint8_t* pValidity, uint32_t /*nFirst*/, uint32_t nXRes, const XnDepthTemporalParams& params)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i lowNibble = _mm_set1_epi8(0x0F);
+	const __m128i nibbleBits = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m128i weight = _mm_set1_epi16((short)params.nHistoryWeight);
+	const __m128i delta = _mm_set1_epi16((short)params.nDelta);
+	const __m128i minCount = _mm_set1_epi16((short)(params.nPersistence - 1));
+
+	uint32_t x = 0;
+	for (; x + 8 <= nXRes; x += 8)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)(pInput + x));
+		__m128i p = _mm_loadu_si128((const __m128i*)(pHistory + x));
+
+		__m128i cNoDepth = _mm_cmpeq_epi16(c, zero);
+		__m128i pNoDepth = _mm_cmpeq_epi16(p, zero);
+
+		// shift this frame into the validity history, and count the frames with depth
+		__m128i validBytes = _mm_andnot_si128(_mm_packs_epi16(cNoDepth, cNoDepth), one);
+		__m128i validity = _mm_loadl_epi64((const __m128i*)(pValidity + x));
+		validity = _mm_or_si128(_mm_add_epi8(validity, validity), validBytes);
+		_mm_storel_epi64((__m128i*)(pValidity + x), validity);
+
+		__m128i count = _mm_add_epi8(_mm_shuffle_epi8(nibbleBits, _mm_and_si128(validity, lowNibble)),
+			_mm_shuffle_epi8(nibbleBits, _mm_and_si128(_mm_srli_epi16(validity, 4), lowNibble)));
+		count = _mm_unpacklo_epi8(count, zero);
+		__m128i keep = _mm_andnot_si128(pNoDepth, _mm_cmpgt_epi16(count, minCount));
+
+		__m128i blend = _mm_adds_epu16(_mm_sub_epi16(c, _mm_mulhi_epu16(c, weight)), _mm_mulhi_epu16(p, weight));
+		__m128i near = _mm_andnot_si128(pNoDepth, XnDepthLessEqualSSSE3(XnDepthAbsDiffSSSE3(c, p), delta));
+
+		__m128i withDepth = XnDepthSelectSSSE3(near, blend, c);
+		__m128i withoutDepth = _mm_and_si128(keep, p);
+		__m128i out = XnDepthSelectSSSE3(cNoDepth, withoutDepth, withDepth);
+
+		_mm_storeu_si128((__m128i*)(pOutput + x), out);
+		_mm_storeu_si128((__m128i*)(pHistory + x), out);
+	}
+
+	XnDepthTemporalRow(pInput, pOutput, pHistory, pValidity, x, nXRes, params);
+}
+
+#endif // XN_FORMATS_SIMD_X86
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+XnDepthFilterChain::XnDepthFilterChain() :
+	m_pBands(NULL),
+	m_nBands(0),
+	m_pFrame(NULL),
+	m_nXRes(0),
+	m_nYRes(0),
+	m_stage(STAGE_HOLE_FILL),
+	m_pSpatial(NULL),
+	m_pHistory(NULL),
+	m_pValidity(NULL),
+	m_nHistoryPixels(0),
+	m_bHistoryValid(false)
+{
+	xnOSMemSet(&m_settings, 0, sizeof(m_settings));
+}
+
+XnDepthFilterChain::~XnDepthFilterChain()
+{
+	FreeBands();
+	xnOSFree(m_pSpatial);
+	xnOSFree(m_pHistory);
+	xnOSFree(m_pValidity);
+}
+
+void XnDepthFilterChain::SetVectorized(bool bVectorized)
+{
+	g_bDepthFilterVectorized = bVectorized && XnFormatsHasSSSE3();
+}
+
+bool XnDepthFilterChain::IsVectorized()
+{
+	return g_bDepthFilterVectorized;
+}
+
+bool XnDepthFilterChain::IsEnabled() const
+{
+	return (m_settings.nHoleFillWidth != 0 || m_settings.nSpatialDelta != 0 || m_settings.nTemporalAlpha != 0 || m_settings.nTemporalPersistence != 0);
+}
+
+XnStatus XnDepthFilterChain::SetSettings(const XnDepthFilterSettings& settings)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (settings.nTemporalAlpha > XN_DEPTH_FILTER_MAX_TEMPORAL_ALPHA || settings.nTemporalPersistence > XN_DEPTH_FILTER_HISTORY_FRAMES || settings.nThreads > XN_DEPTH_FILTER_MAX_THREADS)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	bool bTemporalWasEnabled = (m_settings.nTemporalAlpha != 0 || m_settings.nTemporalPersistence != 0);
+
+	m_settings = settings;
+
+	uint32_t nBands = XN_MAX(settings.nThreads, 1);
+	if (nBands != m_nBands)
+	{
+		FreeBands();
+		nRetVal = CreateBands(nBands);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_FORMATS, "Failed to start %u depth filter threads: %s", nBands, xnGetStatusString(nRetVal));
+			m_settings.nThreads = 0;
+			CreateBands(1);
+		}
+	}
+
+	// history from before the filter was enabled is stale
+	if (!bTemporalWasEnabled)
+	{
+		m_bHistoryValid = false;
+	}
+
+	return (nRetVal);
+}
+
+void XnDepthFilterChain::Reset()
+{
+	m_bHistoryValid = false;
+}
+
+XN_THREAD_PROC XnDepthFilterChain::BandThread(XN_THREAD_PARAM pThreadParam)
+{
+	Band* pBand = (Band*)pThreadParam;
+
+	for (;;)
+	{
+		xnOSWaitEvent(pBand->hStartEvent, XN_WAIT_INFINITE);
+		if (pBand->bStop)
+		{
+			break;
+		}
+
+		pBand->pChain->ProcessBand(*pBand);
+		xnOSSetEvent(pBand->hDoneEvent);
+	}
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void XnDepthFilterChain::FreeBands()
+{
+	for (uint32_t i = 0; i < m_nBands; ++i)
+	{
+		Band* pBand = &m_pBands[i];
+		if (pBand->hThread != NULL)
+		{
+			pBand->bStop = true;
+			xnOSSetEvent(pBand->hStartEvent);
+			xnOSWaitAndTerminateThread(&pBand->hThread, XN_DEPTH_FILTER_THREAD_TERMINATE_TIMEOUT);
+		}
+		if (pBand->hStartEvent != NULL)
+		{
+			xnOSCloseEvent(&pBand->hStartEvent);
+		}
+		if (pBand->hDoneEvent != NULL)
+		{
+			xnOSCloseEvent(&pBand->hDoneEvent);
+		}
+	}
+
+	XN_DELETE_ARR(m_pBands);
+	m_pBands = NULL;
+	m_nBands = 0;
+}
+
+XnStatus XnDepthFilterChain::CreateBands(uint32_t nCount)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	m_pBands = XN_NEW_ARR(Band, nCount);
+	XN_VALIDATE_ALLOC_PTR(m_pBands);
+	m_nBands = nCount;
+
+	for (uint32_t i = 0; i < nCount; ++i)
+	{
+		Band* pBand = &m_pBands[i];
+		pBand->pChain = this;
+		pBand->nFirstRow = 0;
+		pBand->nLastRow = 0;
+		pBand->hThread = NULL;
+		pBand->hStartEvent = NULL;
+		pBand->hDoneEvent = NULL;
+		pBand->bStop = false;
+
+		// the first band is filtered by the calling thread
+		if (i == 0)
+		{
+			continue;
+		}
+
+		nRetVal = xnOSCreateEvent(&pBand->hStartEvent, false);
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = xnOSCreateEvent(&pBand->hDoneEvent, false);
+		}
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = xnOSCreateThread(BandThread, pBand, &pBand->hThread);
+		}
+		if (nRetVal != XN_STATUS_OK)
+		{
+			m_nBands = i + 1;
+			FreeBands();
+			return (nRetVal);
+		}
+
+		char strThreadName[16];
+		uint32_t nChars;
+		xnOSStrFormat(strThreadName, sizeof(strThreadName), &nChars, "DepthFilter-%u", i);
+		xnOSApplyThreadPolicy(pBand->hThread, XN_THREAD_CLASS_DECODE, strThreadName);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+void XnDepthFilterChain::RunStage(Stage stage)
+{
+	m_stage = stage;
+
+	for (uint32_t i = 1; i < m_nBands; ++i)
+	{
+		xnOSSetEvent(m_pBands[i].hStartEvent);
+	}
+
+	ProcessBand(m_pBands[0]);
+
+	for (uint32_t i = 1; i < m_nBands; ++i)
+	{
+		xnOSWaitEvent(m_pBands[i].hDoneEvent, XN_WAIT_INFINITE);
+	}
+}
+
+void XnDepthFilterChain::ProcessBand(const Band& band)
+{
+	uint32_t nXRes = m_nXRes;
+	bool bVectorized = g_bDepthFilterVectorized;
+
+	if (m_stage == STAGE_HOLE_FILL)
+	{
+		uint32_t (*pFindZero)(const OniDepthPixel*, uint32_t, uint32_t) = XnDepthFindZero;
+		uint32_t (*pFindNonZero)(const OniDepthPixel*, uint32_t, uint32_t) = XnDepthFindNonZero;
+#if XN_FORMATS_SIMD_X86
+		if (bVectorized)
+		{
+			pFindZero = XnDepthFindZeroSSSE3;
+			pFindNonZero = XnDepthFindNonZeroSSSE3;
+		}
+#endif
+		for (uint32_t y = band.nFirstRow; y < band.nLastRow; ++y)
+		{
+			XnDepthFillHolesRow(m_pFrame + y * nXRes, nXRes, m_settings.nHoleFillWidth, pFindZero, pFindNonZero);
+		}
+		return;
+	}
+
+	if (m_stage == STAGE_SPATIAL)
+	{
+		void (*pSpatialRow)(const OniDepthPixel*, const OniDepthPixel*, const OniDepthPixel*, OniDepthPixel*, uint32_t, uint32_t, OniDepthPixel) = XnDepthSpatialRow;
+#if XN_FORMATS_SIMD_X86
+		if (bVectorized)
+		{
+			pSpatialRow = XnDepthSpatialRowSSSE3;
+		}
+#endif
+		OniDepthPixel nDelta = (OniDepthPixel)XN_MIN(m_settings.nSpatialDelta, 0xFFFFu);
+		for (uint32_t y = band.nFirstRow; y < band.nLastRow; ++y)
+		{
+			// rows outside the frame are taken to be the center row
+			const OniDepthPixel* pRow = m_pFrame + y * nXRes;
+			const OniDepthPixel* pUp = (y > 0) ? pRow - nXRes : pRow;
+			const OniDepthPixel* pDown = (y + 1 < m_nYRes) ? pRow + nXRes : pRow;
+			pSpatialRow(pUp, pRow, pDown, m_pSpatial + y * nXRes, nXRes, 0, nDelta);
+		}
+		return;
+	}
+
+	// the spatial filter output goes back to the frame through the temporal filter, if it's enabled
+	const OniDepthPixel* pInput = (m_settings.nSpatialDelta != 0) ? m_pSpatial : m_pFrame;
+	if (m_settings.nTemporalAlpha == 0 && m_settings.nTemporalPersistence == 0)
+	{
+		uint32_t nOffset = band.nFirstRow * nXRes;
+		xnOSMemCopy(m_pFrame + nOffset, pInput + nOffset, (band.nLastRow - band.nFirstRow) * nXRes * sizeof(OniDepthPixel));
+		return;
+	}
+
+	void (*pTemporalRow)(const OniDepthPixel*, OniDepthPixel*, OniDepthPixel*, uint8_t*, uint32_t, uint32_t, const XnDepthTemporalParams&) = XnDepthTemporalRow;
+#if XN_FORMATS_SIMD_X86
+	if (bVectorized)
+	{
+		pTemporalRow = XnDepthTemporalRowSSSE3;
+	}
+#endif
+
+	XnDepthTemporalParams params;
+	// without an alpha, the temporal filter only keeps lost pixels
+	params.nHistoryWeight = (uint16_t)(m_settings.nTemporalAlpha == 0 ? 0 : (256 - m_settings.nTemporalAlpha) << 8);
+	params.nDelta = (uint16_t)((m_settings.nTemporalDelta == 0) ? 0xFFFF : XN_MIN(m_settings.nTemporalDelta, 0xFFFFu));
+	params.nPersistence = (uint16_t)(m_settings.nTemporalPersistence == 0 ? XN_DEPTH_FILTER_HISTORY_FRAMES + 1 : m_settings.nTemporalPersistence);
+
+	for (uint32_t y = band.nFirstRow; y < band.nLastRow; ++y)
+	{
+		uint32_t nOffset = y * nXRes;
+		pTemporalRow(pInput + nOffset, m_pFrame + nOffset, m_pHistory + nOffset, m_pValidity + nOffset, 0, nXRes, params);
+	}
+}
+
+XnStatus XnDepthFilterChain::Apply(OniDepthPixel* pDepth, uint32_t nXRes, uint32_t nYRes)
+{
+	XN_VALIDATE_INPUT_PTR(pDepth);
+
+	if (!IsEnabled() || nXRes == 0 || nYRes == 0)
+	{
+		return (XN_STATUS_OK);
+	}
+
+	uint32_t nPixels = nXRes * nYRes;
+	if (nPixels > m_nHistoryPixels)
+	{
+		xnOSFree(m_pSpatial);
+		xnOSFree(m_pHistory);
+		xnOSFree(m_pValidity);
+		m_pSpatial = (OniDepthPixel*)xnOSMalloc(nPixels * sizeof(OniDepthPixel));
+		m_pHistory = (OniDepthPixel*)xnOSMalloc(nPixels * sizeof(OniDepthPixel));
+		m_pValidity = (uint8_t*)xnOSMalloc(nPixels);
+		m_nHistoryPixels = nPixels;
+		m_bHistoryValid = false;
+
+		if (m_pSpatial == NULL || m_pHistory == NULL || m_pValidity == NULL)
+		{
+			xnOSFree(m_pSpatial);
+			xnOSFree(m_pHistory);
+			xnOSFree(m_pValidity);
+			m_pSpatial = NULL;
+			m_pHistory = NULL;
+			m_pValidity = NULL;
+			m_nHistoryPixels = 0;
+			return (XN_STATUS_ALLOC_FAILED);
+		}
+	}
+
+	if (nXRes != m_nXRes || nYRes != m_nYRes)
+	{
+		m_nXRes = nXRes;
+		m_nYRes = nYRes;
+		m_bHistoryValid = false;
+	}
+
+	if (!m_bHistoryValid)
+	{
+		// no depth and no valid frames: the first frame passes as is
+		xnOSMemSet(m_pHistory, 0, nPixels * sizeof(OniDepthPixel));
+		xnOSMemSet(m_pValidity, 0, nPixels);
+		m_bHistoryValid = true;
+	}
+
+	for (uint32_t i = 0; i < m_nBands; ++i)
+	{
+		m_pBands[i].nFirstRow = i * nYRes / m_nBands;
+		m_pBands[i].nLastRow = (i + 1) * nYRes / m_nBands;
+	}
+
+	m_pFrame = pDepth;
+
+	if (m_settings.nHoleFillWidth != 0)
+	{
+		RunStage(STAGE_HOLE_FILL);
+	}
+
+	// each stage reads neighbour rows of other bands, so the stages are run one after the other
+	if (m_settings.nSpatialDelta != 0)
+	{
+		RunStage(STAGE_SPATIAL);
+	}
+
+	if (m_settings.nSpatialDelta != 0 || m_settings.nTemporalAlpha != 0 || m_settings.nTemporalPersistence != 0)
+	{
+		RunStage(STAGE_TEMPORAL);
+	}
+
+	m_pFrame = NULL;
+
+	return (XN_STATUS_OK);
+}
@@ -0,0 +1,145 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNDEPTHFILTERCHAIN_H
+#define XNDEPTHFILTERCHAIN_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnPlatform.h>
+#include <XnStatus.h>
+#include <XnOS.h>
+#include <OniCTypes.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_DEPTH_FILTER_MAX_THREADS				16
+/* Number of frames the validity history covers (bits of a byte). */
+#define XN_DEPTH_FILTER_HISTORY_FRAMES			8
+#define XN_DEPTH_FILTER_MAX_TEMPORAL_ALPHA		255
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+
+/* Settings of a depth filter chain. Each filter is disabled while its main setting is 0. */
+typedef struct XnDepthFilterSettings
+{
+	/* Fill no-depth runs along a row up to this many pixels wide, with the farther of the depths on their two sides. */
+	uint32_t nHoleFillWidth;
+	/* Average each pixel with its 4 neighbours that are within this depth of it, so edges are kept. */
+	uint32_t nSpatialDelta;
+	/* Weight of the new frame in the temporal exponential filter, in 1/256 units (1 to 255). */
+	uint32_t nTemporalAlpha;
+	/* Pixels that moved more than this depth restart the temporal filter. 0 for no limit. */
+	uint32_t nTemporalDelta;
+	/* A pixel that lost its depth keeps its last one, if it had depth in at least this many of the last 8 frames. */
+	uint32_t nTemporalPersistence;
+	/* Frames are filtered in this many horizontal bands, in parallel. 0 or 1 filters on the calling thread only. */
+	uint32_t nThreads;
+} XnDepthFilterSettings;
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+
+/*
+* Post-processes depth frames (0 meaning no depth) in place: hole filling, then an edge preserving spatial
+* filter, then a temporal filter. The temporal filter keeps the previous output, so a chain should only see
+* frames of a single stream.
+*/
+class XnDepthFilterChain
+{
+public:
+	XnDepthFilterChain();
+	~XnDepthFilterChain();
+
+	/* Changes the settings. Worker threads are started or stopped as needed: if they fail to start, frames are
+	   filtered on the calling thread and the error is returned. */
+	XnStatus SetSettings(const XnDepthFilterSettings& settings);
+	inline const XnDepthFilterSettings& GetSettings() const { return m_settings; }
+
+	/* Returns true if any filter is enabled. */
+	bool IsEnabled() const;
+
+	/* Filters a frame in place. The temporal history restarts when the resolution changes. */
+	XnStatus Apply(OniDepthPixel* pDepth, uint32_t nXRes, uint32_t nYRes);
+
+	/* Forgets the temporal history. */
+	void Reset();
+
+	/*
+	* Selects between the vectorized kernels (the default, when the CPU supports them) and the scalar ones.
+	* Both give the same output.
+	*/
+	static void SetVectorized(bool bVectorized);
+	static bool IsVectorized();
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(XnDepthFilterChain)
+
+	enum Stage
+	{
+		STAGE_HOLE_FILL,
+		STAGE_SPATIAL,
+		STAGE_TEMPORAL, // also copies the spatial filter output back to the frame
+	};
+
+	struct Band
+	{
+		XnDepthFilterChain* pChain;
+		uint32_t nFirstRow;
+		uint32_t nLastRow;
+		XN_THREAD_HANDLE hThread;
+		XN_EVENT_HANDLE hStartEvent;
+		XN_EVENT_HANDLE hDoneEvent;
+		volatile bool bStop;
+	};
+
+	XnStatus CreateBands(uint32_t nCount);
+	void FreeBands();
+	void RunStage(Stage stage);
+	void ProcessBand(const Band& band);
+	static XN_THREAD_PROC BandThread(XN_THREAD_PARAM pThreadParam);
+
+	XnDepthFilterSettings m_settings;
+
+	Band* m_pBands;
+	uint32_t m_nBands;
+
+	/* Current frame and stage, for the band threads. */
+	OniDepthPixel* m_pFrame;
+	uint32_t m_nXRes;
+	uint32_t m_nYRes;
+	Stage m_stage;
+
+	/* Spatial filter output, read by the temporal filter. */
+	OniDepthPixel* m_pSpatial;
+	/* Temporal filter output of the previous frame, and which of the last 8 frames had depth in each pixel
+	   (bit 0 is the latest). */
+	OniDepthPixel* m_pHistory;
+	uint8_t* m_pValidity;
+	uint32_t m_nHistoryPixels;
+	bool m_bHistoryValid;
+};
+
+#endif // XNDEPTHFILTERCHAIN_H
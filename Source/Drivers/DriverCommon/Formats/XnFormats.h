@@ -48,4 +48,78 @@
 */
 XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nXRes);
 
+/**
+* This function copies a single line of pixel data of a known format, reversing the order of its pixels.
+* Source and destination must not overlap.
+*
+* @param	nOutputFormat	[in]	The format of the pixel data.
+* @param	pSrc			[in]	A pointer to the source line.
+* @param	pDst			[in]	A pointer to the destination line.
+* @param	nPixels			[in]	Line size in pixels.
+*/
+XnStatus XnFormatsMirrorLine(OniPixelFormat nOutputFormat, const unsigned char* pSrc, unsigned char* pDst, uint32_t nPixels);
+
+/**
+* Selects between the vectorized mirror kernels (the default, when the CPU supports them) and the
+* scalar ones. Mostly useful for benchmarking and for checking the vectorized code.
+*
+* @param	bVectorized		[in]	true to use the vectorized kernels when supported.
+*/
+void XnFormatsSetMirrorVectorized(bool bVectorized);
+
+/**
+* Returns true if mirroring currently uses the vectorized kernels.
+*/
+bool XnFormatsIsMirrorVectorized();
+
+/**
+* Unpacks packed 10-bit pixels (groups of 5 bytes holding 4 big endian 10-bit values) straight into an
+* output format. Gray16 keeps the 10-bit values, Gray8 and RGB888 get their 8 most significant bits.
+*
+* @param	nOutputFormat	[in]	ONI_PIXEL_FORMAT_GRAY16, ONI_PIXEL_FORMAT_GRAY8 or ONI_PIXEL_FORMAT_RGB888.
+* @param	pInput			[in]	A pointer to the packed pixels.
+* @param	nGroups			[in]	Number of 5 byte groups to unpack.
+* @param	pOutput			[in]	A pointer to the output buffer. Must have room for nGroups * 4 pixels.
+*/
+XnStatus XnFormatsUnpack10Bit(OniPixelFormat nOutputFormat, const uint8_t* pInput, uint32_t nGroups, unsigned char* pOutput);
+
+/**
+* Selects between the vectorized unpacking kernels (the default, when the CPU supports them) and the
+* scalar ones.
+*
+* @param	bVectorized		[in]	true to use the vectorized kernels when supported.
+*/
+void XnFormatsSetUnpackVectorized(bool bVectorized);
+
+/**
+* Returns true if unpacking currently uses the vectorized kernels.
+*/
+bool XnFormatsIsUnpackVectorized();
+
+/**
+* Reduces a depth map in place, by a factor of 2 or 4 in both axes. Each 2x2 block of pixels becomes a single
+* pixel (twice, for a factor of 4), ignoring pixels with no depth (0). A block with no depth at all gives 0.
+* A last odd row or column is dropped.
+*
+* @param	nMethod			[in]	How a block is reduced.
+* @param	nFactor			[in]	1 (nothing to do), 2 or 4.
+* @param	pBuffer			[in]	A pointer to nXRes x nYRes pixels. On return, holds (nXRes / nFactor) x (nYRes / nFactor) pixels.
+* @param	nXRes			[in]	X-resolution of the buffer.
+* @param	nYRes			[in]	Y-resolution of the buffer.
+*/
+XnStatus XnFormatsDecimateDepth(XnDepthDecimationMethod nMethod, uint32_t nFactor, OniDepthPixel* pBuffer, uint32_t nXRes, uint32_t nYRes);
+
+/**
+* Selects between the vectorized decimation kernels (the default, when the CPU supports them) and the
+* scalar ones.
+*
+* @param	bVectorized		[in]	true to use the vectorized kernels when supported.
+*/
+void XnFormatsSetDecimateVectorized(bool bVectorized);
+
+/**
+* Returns true if decimation currently uses the vectorized kernels.
+*/
+bool XnFormatsIsDecimateVectorized();
+
 #endif // XNFORMATS_H
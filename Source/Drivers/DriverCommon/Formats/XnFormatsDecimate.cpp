@@ -0,0 +1,217 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnPlatform.h>
+#include <XnCore.h>
+#include "XnFormats.h"
+#include "XnFormatsSimd.h"
+#include <XnOS.h>
+#include <XnLog.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/* Output pixels produced by a single vector step. */
+#define XN_DECIMATE_VECTOR_PIXELS	8
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static bool g_bDecimateVectorized = XnFormatsHasSSSE3();
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/*
+* All kernels work on depth - 1 (wrapping), so no depth (0) becomes the largest value and sorts after
+* every real depth. Adding 1 back to the result turns it into 0 again when the whole block had no depth.
+*/
+static inline void XnDecimateSort2(uint16_t& a, uint16_t& b)
+{
+	uint16_t nMin = XN_MIN(a, b);
+	b = XN_MAX(a, b);
+	a = nMin;
+}
+
+static inline OniDepthPixel XnDecimateBlockMinNonZero(OniDepthPixel p0, OniDepthPixel p1, OniDepthPixel p2, OniDepthPixel p3)
+{
+	uint16_t a = (uint16_t)(p0 - 1);
+	uint16_t b = (uint16_t)(p1 - 1);
+	uint16_t c = (uint16_t)(p2 - 1);
+	uint16_t d = (uint16_t)(p3 - 1);
+	return (OniDepthPixel)(XN_MIN(XN_MIN(a, b), XN_MIN(c, d)) + 1);
+}
+
+static inline OniDepthPixel XnDecimateBlockMedian(OniDepthPixel p0, OniDepthPixel p1, OniDepthPixel p2, OniDepthPixel p3)
+{
+	uint16_t a = (uint16_t)(p0 - 1);
+	uint16_t b = (uint16_t)(p1 - 1);
+	uint16_t c = (uint16_t)(p2 - 1);
+	uint16_t d = (uint16_t)(p3 - 1);
+
+	// sorting network: a <= b <= c <= d
+	XnDecimateSort2(a, b);
+	XnDecimateSort2(c, d);
+	XnDecimateSort2(a, c);
+	XnDecimateSort2(b, d);
+	XnDecimateSort2(b, c);
+
+	// the lower median of the valid depths is the second one when there are 3 or more, the first one otherwise
+	return (OniDepthPixel)(((c != XN_MAX_UINT16) ? b : a) + 1);
+}
+
+static void XnDecimateRow(XnDepthDecimationMethod nMethod, const OniDepthPixel* pTop, const OniDepthPixel* pBottom, OniDepthPixel* pOutput, uint32_t nStart, uint32_t nPixels)
+{
+	if (nMethod == XN_DEPTH_DECIMATION_MEDIAN)
+	{
+		for (uint32_t x = nStart; x < nPixels; ++x)
+		{
+			pOutput[x] = XnDecimateBlockMedian(pTop[2*x], pTop[2*x + 1], pBottom[2*x], pBottom[2*x + 1]);
+		}
+	}
+	else
+	{
+		for (uint32_t x = nStart; x < nPixels; ++x)
+		{
+			pOutput[x] = XnDecimateBlockMinNonZero(pTop[2*x], pTop[2*x + 1], pBottom[2*x], pBottom[2*x + 1]);
+		}
+	}
+}
+
+#if XN_FORMATS_SIMD_X86
+/* Splits 16 pixels into the 8 even and the 8 odd ones, moved to signed order (see above). */
+static XN_FORMATS_TARGET_SSSE3 inline void XnDecimateSplitSSSE3(const OniDepthPixel* pInput, __m128i& even, __m128i& odd)
+{
+	const __m128i split = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i sign = _mm_set1_epi16((short)0x8000);
+
+	__m128i low = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput)), split);
+	__m128i high = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput + 8)), split);
+	even = _mm_xor_si128(_mm_sub_epi16(_mm_unpacklo_epi64(low, high), one), sign);
+	odd = _mm_xor_si128(_mm_sub_epi16(_mm_unpackhi_epi64(low, high), one), sign);
+}
+
+/* Decimates 8 output pixels at a time, returns the number of pixels done. Each step reads its input before
+   writing, so the output may start where the top row does. */
+static XN_FORMATS_TARGET_SSSE3 uint32_t XnDecimateRowSSSE3(XnDepthDecimationMethod nMethod, const OniDepthPixel* pTop, const OniDepthPixel* pBottom, OniDepthPixel* pOutput, uint32_t nPixels)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i sign = _mm_set1_epi16((short)0x8000);
+	// no depth, in signed order
+	const __m128i none = _mm_set1_epi16(0x7FFF);
+
+	uint32_t x = 0;
+	for (; x + XN_DECIMATE_VECTOR_PIXELS <= nPixels; x += XN_DECIMATE_VECTOR_PIXELS)
+	{
+		__m128i a, b, c, d;
+		XnDecimateSplitSSSE3(pTop + 2*x, a, b);
+		XnDecimateSplitSSSE3(pBottom + 2*x, c, d);
+
+		__m128i result;
+		if (nMethod == XN_DEPTH_DECIMATION_MEDIAN)
+		{
+			// same sorting network as the scalar kernel
+			__m128i t = _mm_min_epi16(a, b); b = _mm_max_epi16(a, b); a = t;
+			t = _mm_min_epi16(c, d); d = _mm_max_epi16(c, d); c = t;
+			t = _mm_min_epi16(a, c); c = _mm_max_epi16(a, c); a = t;
+			t = _mm_min_epi16(b, d); d = _mm_max_epi16(b, d); b = t;
+			t = _mm_min_epi16(b, c); c = _mm_max_epi16(b, c); b = t;
+
+			__m128i fewer = _mm_cmpeq_epi16(c, none);
+			result = _mm_or_si128(_mm_and_si128(fewer, a), _mm_andnot_si128(fewer, b));
+		}
+		else
+		{
+			result = _mm_min_epi16(_mm_min_epi16(a, b), _mm_min_epi16(c, d));
+		}
+
+		result = _mm_add_epi16(_mm_xor_si128(result, sign), one);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput + x), result);
+	}
+
+	return x;
+}
+#endif
+
+static void XnDecimateDepth2x2(XnDepthDecimationMethod nMethod, OniDepthPixel* pBuffer, uint32_t nXRes, uint32_t nYRes)
+{
+	uint32_t nOutXRes = nXRes / 2;
+	uint32_t nOutYRes = nYRes / 2;
+
+	// output row y ends before input row 2y starts (for y > 0), and row 0 is done front to back
+	for (uint32_t y = 0; y < nOutYRes; ++y)
+	{
+		const OniDepthPixel* pTop = pBuffer + 2 * y * nXRes;
+		const OniDepthPixel* pBottom = pTop + nXRes;
+		OniDepthPixel* pOutput = pBuffer + y * nOutXRes;
+
+		uint32_t nDone = 0;
+#if XN_FORMATS_SIMD_X86
+		if (g_bDecimateVectorized)
+		{
+			nDone = XnDecimateRowSSSE3(nMethod, pTop, pBottom, pOutput, nOutXRes);
+		}
+#endif
+		XnDecimateRow(nMethod, pTop, pBottom, pOutput, nDone, nOutXRes);
+	}
+}
+
+void XnFormatsSetDecimateVectorized(bool bVectorized)
+{
+	g_bDecimateVectorized = bVectorized && XnFormatsHasSSSE3();
+}
+
+bool XnFormatsIsDecimateVectorized()
+{
+	return g_bDecimateVectorized;
+}
+
+XnStatus XnFormatsDecimateDepth(XnDepthDecimationMethod nMethod, uint32_t nFactor, OniDepthPixel* pBuffer, uint32_t nXRes, uint32_t nYRes)
+{
+	XN_VALIDATE_OUTPUT_PTR(pBuffer);
+
+	if (nMethod != XN_DEPTH_DECIMATION_MIN_NONZERO && nMethod != XN_DEPTH_DECIMATION_MEDIAN)
+	{
+		xnLogError(XN_MASK_FORMATS, "Unknown depth decimation method: %d", nMethod);
+		XN_ASSERT(false);
+		return XN_STATUS_BAD_PARAM;
+	}
+
+	if (nFactor != 1 && nFactor != 2 && nFactor != 4)
+	{
+		xnLogError(XN_MASK_FORMATS, "Depth can't be decimated by %u", nFactor);
+		XN_ASSERT(false);
+		return XN_STATUS_BAD_PARAM;
+	}
+
+	// a factor of 4 is two levels of the pyramid
+	for (; nFactor > 1; nFactor /= 2)
+	{
+		XnDecimateDepth2x2(nMethod, pBuffer, nXRes, nYRes);
+		nXRes /= 2;
+		nYRes /= 2;
+	}
+
+	return (XN_STATUS_OK);
+}
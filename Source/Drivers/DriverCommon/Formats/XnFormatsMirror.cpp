@@ -24,195 +24,240 @@
 #include <XnPlatform.h>
 #include <XnCore.h>
 #include "XnFormats.h"
+#include "XnFormatsSimd.h"
 #include <XnOS.h>
 #include <XnLog.h>
 
 //---------------------------------------------------------------------------
 // Defines
 //---------------------------------------------------------------------------
-#define XN_MIRROR_MAX_LINE_SIZE	1920*3
+#define XN_MIRROR_VECTOR_SIZE	16
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/* pshufb masks reversing the units of a vector. A vector holds as many whole units as fit in it
+   (5 for RGB888, where the last byte is not part of the block). */
+typedef struct XnMirrorMasks
+{
+	uint32_t nBlockSize;
+	uint8_t aToLow[XN_MIRROR_VECTOR_SIZE];		// block at the top of the source -> bottom of the result
+	uint8_t aToHigh[XN_MIRROR_VECTOR_SIZE];		// block at the bottom of the source -> top of the result
+	uint8_t aKeepTop[XN_MIRROR_VECTOR_SIZE];	// bytes above a block at the bottom
+	uint8_t aKeepBottom[XN_MIRROR_VECTOR_SIZE];	// bytes below a block at the top
+} XnMirrorMasks;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+/* Source byte of each byte of a mirrored unit. A unit is a pixel, or a pair of pixels for YUV
+   formats, where the two Y values are swapped. */
+static const uint8_t XN_MIRROR_ORDER_PIXEL[] = { 0, 1, 2, 3 };
+static const uint8_t XN_MIRROR_ORDER_YUV422[] = { 0, 3, 2, 1 }; // u, y2, v, y1
+static const uint8_t XN_MIRROR_ORDER_YUYV[] = { 2, 3, 0, 1 }; // y2, u, y1, v
+
+static bool g_bMirrorVectorized = XnFormatsHasSSSE3();
 
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
-XnStatus XnMirrorOneBytePixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+static void XnMirrorBuildMasks(uint32_t nUnitSize, const uint8_t* aOrder, XnMirrorMasks& masks)
 {
-	// Local function variables
-	uint8_t* pSrc = pBuffer;
-	uint8_t pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	uint8_t* pSrcEnd = pSrc + nBufferSize;
-	uint8_t* pDest = NULL;
-	uint8_t* pDestVal = &pLineBuffer[nLineSize - 1];
-	uint8_t* pDestEnd = &pLineBuffer[0];
+	uint32_t nBlockSize = XN_MIRROR_VECTOR_SIZE / nUnitSize * nUnitSize;
+	uint32_t nUnits = nBlockSize / nUnitSize;
+	uint32_t nGap = XN_MIRROR_VECTOR_SIZE - nBlockSize;
+
+	masks.nBlockSize = nBlockSize;
+	xnOSMemSet(masks.aToLow, 0x80, sizeof(masks.aToLow));
+	xnOSMemSet(masks.aToHigh, 0x80, sizeof(masks.aToHigh));
+	xnOSMemSet(masks.aKeepTop, 0x80, sizeof(masks.aKeepTop));
+	xnOSMemSet(masks.aKeepBottom, 0x80, sizeof(masks.aKeepBottom));
 
-	if (nLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	for (uint32_t i = 0; i < nBlockSize; ++i)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		uint32_t nSrcByte = (nUnits - 1 - i / nUnitSize) * nUnitSize + aOrder[i % nUnitSize];
+		masks.aToLow[i] = (uint8_t)(nGap + nSrcByte);
+		masks.aToHigh[nGap + i] = (uint8_t)nSrcByte;
 	}
+	for (uint32_t i = 0; i < nGap; ++i)
+	{
+		masks.aKeepTop[nBlockSize + i] = (uint8_t)(nBlockSize + i);
+		masks.aKeepBottom[i] = (uint8_t)i;
+	}
+}
 
-	while (pSrc < pSrcEnd)
+#if XN_FORMATS_SIMD_X86
+/* Swaps and reverses blocks from both ends of [pLeft, pRight) until less than two vectors are left. */
+static XN_FORMATS_TARGET_SSSE3 void XnMirrorBlocksSSSE3(uint8_t*& pLeft, uint8_t*& pRight, const XnMirrorMasks& masks)
+{
+	const __m128i toLow = _mm_loadu_si128((const __m128i*)masks.aToLow);
+	const __m128i toHigh = _mm_loadu_si128((const __m128i*)masks.aToHigh);
+	const __m128i keepTop = _mm_loadu_si128((const __m128i*)masks.aKeepTop);
+	const __m128i keepBottom = _mm_loadu_si128((const __m128i*)masks.aKeepBottom);
+
+	while (pRight - pLeft >= 2 * XN_MIRROR_VECTOR_SIZE)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nLineSize);
+		__m128i left = _mm_loadu_si128((const __m128i*)pLeft);
+		__m128i right = _mm_loadu_si128((const __m128i*)(pRight - XN_MIRROR_VECTOR_SIZE));
 
-		pDest = pDestVal;
-		while (pDest >= pDestEnd)
-		{
-			*pSrc = *pDest;
+		_mm_storeu_si128((__m128i*)pLeft, _mm_or_si128(_mm_shuffle_epi8(right, toLow), _mm_shuffle_epi8(left, keepTop)));
+		_mm_storeu_si128((__m128i*)(pRight - XN_MIRROR_VECTOR_SIZE), _mm_or_si128(_mm_shuffle_epi8(left, toHigh), _mm_shuffle_epi8(right, keepBottom)));
 
-			pSrc++;
-			pDest--;
-		}
+		pLeft += masks.nBlockSize;
+		pRight -= masks.nBlockSize;
 	}
-
-	// All is good...
-	return (XN_STATUS_OK);
 }
 
-XnStatus XnMirrorTwoBytePixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+/* Writes reversed blocks from the end of the source to the start of the destination until less than a vector is left. */
+static XN_FORMATS_TARGET_SSSE3 void XnMirrorBlocksCopySSSE3(const uint8_t*& pSrcEnd, uint8_t*& pDst, const uint8_t* pDstEnd, const XnMirrorMasks& masks)
 {
-	// Local function variables
-	uint8_t* pSrc = pBuffer;
-	uint8_t pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	uint8_t* pSrcEnd = pSrc + nBufferSize;
-	uint8_t* pDest = NULL;
-	uint8_t* pDestVal = &pLineBuffer[nLineSize * 2 - 1];
-	uint8_t* pDestEnd = &pLineBuffer[0];
-	uint16_t nMemCpyLineSize = (uint16_t)(nLineSize * 2);
+	const __m128i toLow = _mm_loadu_si128((const __m128i*)masks.aToLow);
 
-	if (nLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	// the bytes above the block are overwritten by the next block (or by the scalar tail)
+	while (pDstEnd - pDst >= XN_MIRROR_VECTOR_SIZE)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		__m128i src = _mm_loadu_si128((const __m128i*)(pSrcEnd - XN_MIRROR_VECTOR_SIZE));
+		_mm_storeu_si128((__m128i*)pDst, _mm_shuffle_epi8(src, toLow));
+
+		pSrcEnd -= masks.nBlockSize;
+		pDst += masks.nBlockSize;
 	}
+}
+#endif
 
-	while (pSrc < pSrcEnd)
+/* Reverses the units of [pLeft, pRight) in place, working from both ends. */
+template<uint32_t nUnitSize>
+static void XnMirrorUnits(uint8_t* pLeft, uint8_t* pRight, const uint8_t* aOrder)
+{
+	uint8_t aLeft[nUnitSize];
+	uint8_t aRight[nUnitSize];
+
+	while (pLeft < pRight)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
+		pRight -= nUnitSize;
 
-		pDest = pDestVal;
-		while (pDest >= pDestEnd)
+		for (uint32_t i = 0; i < nUnitSize; ++i)
 		{
-			*pSrc = *(pDest-1);
-			*(pSrc+1) = *pDest;
-
-                        pSrc += 2;
-                        pDest -= 2;
+			aLeft[i] = pLeft[i];
+			aRight[i] = pRight[i];
+		}
+		// when both point to the middle unit, both writes are the same
+		for (uint32_t i = 0; i < nUnitSize; ++i)
+		{
+			pLeft[i] = aRight[aOrder[i]];
+			pRight[i] = aLeft[aOrder[i]];
 		}
-	}
 
-	// All is good...
-	return (XN_STATUS_OK);
+		pLeft += nUnitSize;
+	}
 }
 
-XnStatus XnMirrorThreeBytePixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+template<uint32_t nUnitSize>
+static void XnMirrorUnitsCopy(const uint8_t* pSrcEnd, uint8_t* pDst, const uint8_t* pDstEnd, const uint8_t* aOrder)
 {
-	// Local function variables
-	uint8_t* pSrc = pBuffer;
-	uint8_t pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	uint8_t* pSrcEnd = pSrc + nBufferSize;
-	uint8_t* pDest = NULL;
-	uint8_t* pDestVal = &pLineBuffer[nLineSize * 3 - 1];
-	uint8_t* pDestEnd = &pLineBuffer[0];
-	uint16_t nMemCpyLineSize = (uint16_t)(nLineSize * 3);
-
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	while (pDst < pDstEnd)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
-	}
-
-	while (pSrc < pSrcEnd)
-	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
+		pSrcEnd -= nUnitSize;
 
-		pDest = pDestVal;
-		while (pDest >= pDestEnd)
+		for (uint32_t i = 0; i < nUnitSize; ++i)
 		{
-			*pSrc = *(pDest-2);
-			*(pSrc+1) = *(pDest-1);
-			*(pSrc+2) = *pDest;
-
-			pSrc += 3;
-			pDest -= 3;
+			pDst[i] = pSrcEnd[aOrder[i]];
 		}
-	}
 
-	// All is good...
-	return (XN_STATUS_OK);
+		pDst += nUnitSize;
+	}
 }
 
-XnStatus XnMirrorYUV422Pixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+template<uint32_t nUnitSize>
+static void XnMirrorLines(uint8_t* pBuffer, uint32_t nBufferSize, uint32_t nLineSize, const uint8_t* aOrder)
 {
-	// Local function variables
-	uint8_t* pSrc = pBuffer;
-	uint8_t pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	uint8_t* pSrcEnd = (uint8_t*)pSrc + nBufferSize;
-	uint8_t* pDest = NULL;
-	uint8_t* pDestVal = &pLineBuffer[(nLineSize/2-1)*sizeof(uint32_t)]; // last element
-	uint8_t* pDestEnd = &pLineBuffer[0]; // first element
-	uint32_t nMemCpyLineSize = nLineSize/2*sizeof(uint32_t);
+	if (nLineSize == 0)
+	{
+		return;
+	}
 
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	XnMirrorMasks masks;
+	bool bVectorize = g_bMirrorVectorized;
+	if (bVectorize)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		XnMirrorBuildMasks(nUnitSize, aOrder, masks);
 	}
 
-	while (pSrc < pSrcEnd)
+	uint8_t* pLine = pBuffer;
+	uint8_t* pBufferEnd = pBuffer + nBufferSize / nLineSize * nLineSize;
+
+	for (; pLine < pBufferEnd; pLine += nLineSize)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
-		pDest = pDestVal;
+		uint8_t* pLeft = pLine;
+		uint8_t* pRight = pLine + nLineSize;
 
-		while (pDest >= pDestEnd)
+#if XN_FORMATS_SIMD_X86
+		if (bVectorize)
 		{
-			pSrc[0] = pDest[0]; // u
-			pSrc[1] = pDest[3]; // y1 <-> y2
-			pSrc[2] = pDest[2]; // v
-			pSrc[3] = pDest[1]; // y2 <-> y1
-
-			pSrc += 4;
-			pDest -= 4;
+			XnMirrorBlocksSSSE3(pLeft, pRight, masks);
 		}
+#endif
+		XnMirrorUnits<nUnitSize>(pLeft, pRight, aOrder);
 	}
-
-	// All is good...
-	return (XN_STATUS_OK);
 }
 
-XnStatus XnMirrorYUYVPixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+template<uint32_t nUnitSize>
+static void XnMirrorLineCopy(const uint8_t* pSrc, uint8_t* pDst, uint32_t nLineSize, const uint8_t* aOrder)
 {
-	// Local function variables
-	uint8_t* pSrc = pBuffer;
-	uint8_t pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	uint8_t* pSrcEnd = (uint8_t*)pSrc + nBufferSize;
-	uint8_t* pDest = NULL;
-	uint8_t* pDestVal = &pLineBuffer[(nLineSize/2-1)*sizeof(uint32_t)]; // last element
-	uint8_t* pDestEnd = &pLineBuffer[0]; // first element
-	uint32_t nMemCpyLineSize = nLineSize/2*sizeof(uint32_t);
+	const uint8_t* pSrcEnd = pSrc + nLineSize;
+	const uint8_t* pDstEnd = pDst + nLineSize;
 
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
+#if XN_FORMATS_SIMD_X86
+	if (g_bMirrorVectorized)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		XnMirrorMasks masks;
+		XnMirrorBuildMasks(nUnitSize, aOrder, masks);
+		XnMirrorBlocksCopySSSE3(pSrcEnd, pDst, pDstEnd, masks);
 	}
+#endif
+	XnMirrorUnitsCopy<nUnitSize>(pSrcEnd, pDst, pDstEnd, aOrder);
+}
 
-	while (pSrc < pSrcEnd)
-	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
-		pDest = pDestVal;
+XnStatus XnMirrorOneBytePixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+{
+	XnMirrorLines<1>(pBuffer, nBufferSize, nLineSize, XN_MIRROR_ORDER_PIXEL);
+	return (XN_STATUS_OK);
+}
 
-		while (pDest >= pDestEnd)
-		{
-			pSrc[0] = pDest[2]; // y1 <-> y2
-			pSrc[1] = pDest[3]; // u
-			pSrc[2] = pDest[0]; // y2 <-> y1
-			pSrc[3] = pDest[1]; // v
+XnStatus XnMirrorTwoBytePixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+{
+	XnMirrorLines<2>(pBuffer, nBufferSize, nLineSize * 2, XN_MIRROR_ORDER_PIXEL);
+	return (XN_STATUS_OK);
+}
 
-			pSrc += 4;
-			pDest -= 4;
-		}
-	}
+XnStatus XnMirrorThreeBytePixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+{
+	XnMirrorLines<3>(pBuffer, nBufferSize, nLineSize * 3, XN_MIRROR_ORDER_PIXEL);
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnMirrorYUV422Pixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+{
+	XnMirrorLines<4>(pBuffer, nBufferSize, nLineSize / 2 * sizeof(uint32_t), XN_MIRROR_ORDER_YUV422);
+	return (XN_STATUS_OK);
+}
 
-	// All is good...
+XnStatus XnMirrorYUYVPixels(unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nLineSize)
+{
+	XnMirrorLines<4>(pBuffer, nBufferSize, nLineSize / 2 * sizeof(uint32_t), XN_MIRROR_ORDER_YUYV);
 	return (XN_STATUS_OK);
 }
 
+void XnFormatsSetMirrorVectorized(bool bVectorized)
+{
+	g_bMirrorVectorized = bVectorized && XnFormatsHasSSSE3();
+}
+
+bool XnFormatsIsMirrorVectorized()
+{
+	return g_bMirrorVectorized;
+}
+
 XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, unsigned char* pBuffer, uint32_t nBufferSize, uint32_t nXRes)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
@@ -239,3 +284,38 @@ XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, unsigned char* p
 		return XN_STATUS_ERROR;
 	}
 }
+
+XnStatus XnFormatsMirrorLine(OniPixelFormat nOutputFormat, const unsigned char* pSrc, unsigned char* pDst, uint32_t nPixels)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(pSrc);
+	XN_VALIDATE_OUTPUT_PTR(pDst);
+
+	switch (nOutputFormat)
+	{
+	case ONI_PIXEL_FORMAT_SHIFT_9_2:
+	case ONI_PIXEL_FORMAT_DEPTH_1_MM:
+	case ONI_PIXEL_FORMAT_DEPTH_100_UM:
+	case ONI_PIXEL_FORMAT_GRAY16:
+		XnMirrorLineCopy<2>(pSrc, pDst, nPixels * 2, XN_MIRROR_ORDER_PIXEL);
+		break;
+	case ONI_PIXEL_FORMAT_GRAY8:
+		XnMirrorLineCopy<1>(pSrc, pDst, nPixels, XN_MIRROR_ORDER_PIXEL);
+		break;
+	case ONI_PIXEL_FORMAT_RGB888:
+		XnMirrorLineCopy<3>(pSrc, pDst, nPixels * 3, XN_MIRROR_ORDER_PIXEL);
+		break;
+	case ONI_PIXEL_FORMAT_YUV422:
+		XnMirrorLineCopy<4>(pSrc, pDst, nPixels / 2 * sizeof(uint32_t), XN_MIRROR_ORDER_YUV422);
+		break;
+	case ONI_PIXEL_FORMAT_YUYV:
+		XnMirrorLineCopy<4>(pSrc, pDst, nPixels / 2 * sizeof(uint32_t), XN_MIRROR_ORDER_YUYV);
+		break;
+	default:
+		xnLogError(XN_MASK_FORMATS, "Mirror was not implemented for output format %d", nOutputFormat);
+		XN_ASSERT(false);
+		return XN_STATUS_ERROR;
+	}
+
+	return (XN_STATUS_OK);
+}
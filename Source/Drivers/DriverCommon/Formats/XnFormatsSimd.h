@@ -0,0 +1,74 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNFORMATSSIMD_H
+#define XNFORMATSSIMD_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnPlatform.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/* The vectorized kernels are built for SSSE3 only (no global compiler flags needed), and are only
+   called after XnFormatsHasSSSE3() returned true. */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+	#define XN_FORMATS_SIMD_X86 1
+	#define XN_FORMATS_TARGET_SSSE3 __attribute__((target("ssse3")))
+	#include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	#define XN_FORMATS_SIMD_X86 1
+	#define XN_FORMATS_TARGET_SSSE3
+	#include <intrin.h>
+	#include <tmmintrin.h>
+#else
+	#define XN_FORMATS_SIMD_X86 0
+#endif
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+static inline bool XnFormatsDetectSSSE3()
+{
+#if XN_FORMATS_SIMD_X86 && defined(_MSC_VER)
+	int aCPUInfo[4] = {0};
+	__cpuid(aCPUInfo, 1);
+	return (aCPUInfo[2] & (1 << 9)) != 0;
+#elif XN_FORMATS_SIMD_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3") != 0;
+#else
+	return false;
+#endif
+}
+
+/**
+* Returns true if the CPU supports the SSSE3 kernels. The CPU is only checked once, and it is safe to call
+* while initializing globals.
+*/
+inline bool XnFormatsHasSSSE3()
+{
+	static const bool bSupported = XnFormatsDetectSSSE3();
+	return bSupported;
+}
+
+#endif // XNFORMATSSIMD_H
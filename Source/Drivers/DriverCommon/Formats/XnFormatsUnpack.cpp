@@ -0,0 +1,224 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnPlatform.h>
+#include <XnCore.h>
+#include "XnFormats.h"
+#include "XnFormatsSimd.h"
+#include <XnOS.h>
+#include <XnLog.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/* A group of 4 packed 10-bit pixels */
+#define XN_UNPACK_GROUP_SIZE		5
+#define XN_UNPACK_GROUP_PIXELS		4
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static bool g_bUnpackVectorized = XnFormatsHasSSSE3();
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/* Each group holds 4 big endian 10-bit values: aaaaaaaa aabbbbbb bbbbcccc ccccccdd dddddddd */
+static inline void XnUnpack10BitGroup(const uint8_t* pInput, uint16_t* pValues)
+{
+	pValues[0] = (uint16_t)((pInput[0] << 2) | (pInput[1] >> 6));
+	pValues[1] = (uint16_t)(((pInput[1] & 0x3F) << 4) | (pInput[2] >> 4));
+	pValues[2] = (uint16_t)(((pInput[2] & 0x0F) << 6) | (pInput[3] >> 2));
+	pValues[3] = (uint16_t)(((pInput[3] & 0x03) << 8) | pInput[4]);
+}
+
+static void XnUnpack10BitToGray16(const uint8_t* pInput, uint32_t nGroups, uint16_t* pOutput)
+{
+	for (uint32_t i = 0; i < nGroups; ++i)
+	{
+		XnUnpack10BitGroup(pInput, pOutput);
+		pInput += XN_UNPACK_GROUP_SIZE;
+		pOutput += XN_UNPACK_GROUP_PIXELS;
+	}
+}
+
+static void XnUnpack10BitToGray8(const uint8_t* pInput, uint32_t nGroups, uint8_t* pOutput)
+{
+	uint16_t aValues[XN_UNPACK_GROUP_PIXELS];
+	for (uint32_t i = 0; i < nGroups; ++i)
+	{
+		XnUnpack10BitGroup(pInput, aValues);
+		for (uint32_t j = 0; j < XN_UNPACK_GROUP_PIXELS; ++j)
+		{
+			pOutput[j] = (uint8_t)(aValues[j] >> 2);
+		}
+		pInput += XN_UNPACK_GROUP_SIZE;
+		pOutput += XN_UNPACK_GROUP_PIXELS;
+	}
+}
+
+static void XnUnpack10BitToRGB888(const uint8_t* pInput, uint32_t nGroups, uint8_t* pOutput)
+{
+	uint16_t aValues[XN_UNPACK_GROUP_PIXELS];
+	for (uint32_t i = 0; i < nGroups; ++i)
+	{
+		XnUnpack10BitGroup(pInput, aValues);
+		for (uint32_t j = 0; j < XN_UNPACK_GROUP_PIXELS; ++j)
+		{
+			uint8_t nGray = (uint8_t)(aValues[j] >> 2);
+			pOutput[0] = nGray;
+			pOutput[1] = nGray;
+			pOutput[2] = nGray;
+			pOutput += 3;
+		}
+		pInput += XN_UNPACK_GROUP_SIZE;
+	}
+}
+
+#if XN_FORMATS_SIMD_X86
+/* Unpacks the 2 groups at pInput to 8 words. Loads 16 bytes, so at least 4 groups must be readable. */
+static XN_FORMATS_TARGET_SSSE3 inline __m128i XnUnpack10BitPairSSSE3(const uint8_t* pInput)
+{
+	// each 16 bit lane gets the two bytes its value spans, big endian (first byte is the high one)
+	const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 3, 2, 4, 3, 6, 5, 7, 6, 8, 7, 9, 8);
+	// value k of a group starts 2k bits into its first byte - shift it to the top of the lane, then down to bit 0
+	const __m128i multiplier = _mm_setr_epi16(1, 4, 16, 64, 1, 4, 16, 64);
+
+	__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput));
+	__m128i pairs = _mm_shuffle_epi8(bytes, shuffle);
+	return _mm_srli_epi16(_mm_mullo_epi16(pairs, multiplier), 6);
+}
+
+/* Unpacks 4 groups to 16 gray levels (the 8 most significant bits). At least 6 groups must be readable. */
+static XN_FORMATS_TARGET_SSSE3 inline __m128i XnUnpack10BitQuadToGray8SSSE3(const uint8_t* pInput)
+{
+	__m128i low = _mm_srli_epi16(XnUnpack10BitPairSSSE3(pInput), 2);
+	__m128i high = _mm_srli_epi16(XnUnpack10BitPairSSSE3(pInput + 2 * XN_UNPACK_GROUP_SIZE), 2);
+	return _mm_packus_epi16(low, high);
+}
+
+/* Each function unpacks the bulk of the groups, and returns the number of groups left for the scalar code. */
+static XN_FORMATS_TARGET_SSSE3 uint32_t XnUnpack10BitToGray16SSSE3(const uint8_t*& pInput, uint32_t nGroups, uint16_t*& pOutput)
+{
+	while (nGroups >= 4)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput), XnUnpack10BitPairSSSE3(pInput));
+		pInput += 2 * XN_UNPACK_GROUP_SIZE;
+		pOutput += 2 * XN_UNPACK_GROUP_PIXELS;
+		nGroups -= 2;
+	}
+
+	return nGroups;
+}
+
+static XN_FORMATS_TARGET_SSSE3 uint32_t XnUnpack10BitToGray8SSSE3(const uint8_t*& pInput, uint32_t nGroups, uint8_t*& pOutput)
+{
+	while (nGroups >= 6)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput), XnUnpack10BitQuadToGray8SSSE3(pInput));
+		pInput += 4 * XN_UNPACK_GROUP_SIZE;
+		pOutput += 4 * XN_UNPACK_GROUP_PIXELS;
+		nGroups -= 4;
+	}
+
+	return nGroups;
+}
+
+static XN_FORMATS_TARGET_SSSE3 uint32_t XnUnpack10BitToRGB888SSSE3(const uint8_t*& pInput, uint32_t nGroups, uint8_t*& pOutput)
+{
+	// spread 16 gray levels over 48 bytes, 3 copies each
+	const __m128i spread0 = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+	const __m128i spread1 = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+	const __m128i spread2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+
+	while (nGroups >= 6)
+	{
+		__m128i gray = XnUnpack10BitQuadToGray8SSSE3(pInput);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput), _mm_shuffle_epi8(gray, spread0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput + 16), _mm_shuffle_epi8(gray, spread1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput + 32), _mm_shuffle_epi8(gray, spread2));
+		pInput += 4 * XN_UNPACK_GROUP_SIZE;
+		pOutput += 4 * XN_UNPACK_GROUP_PIXELS * 3;
+		nGroups -= 4;
+	}
+
+	return nGroups;
+}
+#endif
+
+void XnFormatsSetUnpackVectorized(bool bVectorized)
+{
+	g_bUnpackVectorized = bVectorized && XnFormatsHasSSSE3();
+}
+
+bool XnFormatsIsUnpackVectorized()
+{
+	return g_bUnpackVectorized;
+}
+
+XnStatus XnFormatsUnpack10Bit(OniPixelFormat nOutputFormat, const uint8_t* pInput, uint32_t nGroups, unsigned char* pOutput)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(pInput);
+	XN_VALIDATE_OUTPUT_PTR(pOutput);
+
+	switch (nOutputFormat)
+	{
+	case ONI_PIXEL_FORMAT_GRAY16:
+		{
+			uint16_t* pOutputPixels = (uint16_t*)pOutput;
+#if XN_FORMATS_SIMD_X86
+			if (g_bUnpackVectorized)
+			{
+				nGroups = XnUnpack10BitToGray16SSSE3(pInput, nGroups, pOutputPixels);
+			}
+#endif
+			XnUnpack10BitToGray16(pInput, nGroups, pOutputPixels);
+		}
+		break;
+	case ONI_PIXEL_FORMAT_GRAY8:
+#if XN_FORMATS_SIMD_X86
+		if (g_bUnpackVectorized)
+		{
+			nGroups = XnUnpack10BitToGray8SSSE3(pInput, nGroups, pOutput);
+		}
+#endif
+		XnUnpack10BitToGray8(pInput, nGroups, pOutput);
+		break;
+	case ONI_PIXEL_FORMAT_RGB888:
+#if XN_FORMATS_SIMD_X86
+		if (g_bUnpackVectorized)
+		{
+			nGroups = XnUnpack10BitToRGB888SSSE3(pInput, nGroups, pOutput);
+		}
+#endif
+		XnUnpack10BitToRGB888(pInput, nGroups, pOutput);
+		break;
+	default:
+		xnLogError(XN_MASK_FORMATS, "10-bit unpacking was not implemented for output format %d", nOutputFormat);
+		XN_ASSERT(false);
+		return XN_STATUS_ERROR;
+	}
+
+	return (XN_STATUS_OK);
+}
@@ -0,0 +1,235 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// FormatsDecimateBenchmark.cpp : Measures the throughput of the depth decimation kernels, scalar against vectorized.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include <XnFormats.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_ITERATIONS 200
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct
+{
+	XnDepthDecimationMethod method;
+	const char* strName;
+} BenchmarkMethod;
+
+typedef struct
+{
+	uint32_t nXRes;
+	uint32_t nYRes;
+} BenchmarkResolution;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const BenchmarkMethod g_methods[] =
+{
+	{ XN_DEPTH_DECIMATION_MIN_NONZERO, "MinNonZero" },
+	{ XN_DEPTH_DECIMATION_MEDIAN, "Median" },
+};
+
+static const uint32_t g_factors[] = { 2, 4 };
+
+static const BenchmarkResolution g_resolutions[] =
+{
+	{ 320, 240 },
+	{ 640, 480 },
+	{ 1280, 1024 },
+};
+
+/* Odd sizes, for checking the scalar tails of the vectorized kernels. */
+static const uint32_t g_verifyWidths[] = { 1, 2, 3, 5, 15, 16, 17, 31, 33, 63, 66, 98, 642 };
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/* Straightforward decimation of a single block, as the output is defined: the smallest valid depth, or the
+   lower median of the valid depths. */
+OniDepthPixel ReferenceBlock(XnDepthDecimationMethod method, const std::vector<OniDepthPixel>& frame, uint32_t nXRes, uint32_t x, uint32_t y)
+{
+	OniDepthPixel aValid[4];
+	uint32_t nValid = 0;
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		OniDepthPixel nDepth = frame[(2*y + i/2) * nXRes + 2*x + i%2];
+		if (nDepth == 0)
+		{
+			continue;
+		}
+
+		// insertion sort
+		uint32_t j = nValid++;
+		for (; j > 0 && aValid[j - 1] > nDepth; --j)
+		{
+			aValid[j] = aValid[j - 1];
+		}
+		aValid[j] = nDepth;
+	}
+
+	if (nValid == 0)
+	{
+		return 0;
+	}
+
+	return (method == XN_DEPTH_DECIMATION_MEDIAN) ? aValid[(nValid - 1) / 2] : aValid[0];
+}
+
+void ReferenceDecimate(XnDepthDecimationMethod method, uint32_t nFactor, std::vector<OniDepthPixel>& frame, uint32_t nXRes, uint32_t nYRes)
+{
+	for (; nFactor > 1; nFactor /= 2)
+	{
+		std::vector<OniDepthPixel> output((nXRes / 2) * (nYRes / 2));
+		for (uint32_t y = 0; y < nYRes / 2; ++y)
+		{
+			for (uint32_t x = 0; x < nXRes / 2; ++x)
+			{
+				output[y * (nXRes / 2) + x] = ReferenceBlock(method, frame, nXRes, x, y);
+			}
+		}
+
+		frame = output;
+		nXRes /= 2;
+		nYRes /= 2;
+	}
+}
+
+/* Depth with plenty of holes and some far away values, so all the orderings of a block show up. */
+void FillRandom(std::vector<OniDepthPixel>& frame)
+{
+	for (uint32_t i = 0; i < frame.size(); ++i)
+	{
+		uint32_t nRandom = (uint32_t)rand();
+		frame[i] = (nRandom % 3 == 0) ? 0 : (nRandom % 7 == 0) ? (OniDepthPixel)(0xFFFF - nRandom % 4) : (OniDepthPixel)(nRandom % 10000);
+	}
+}
+
+/* Checks the current kernels against the reference, for many frame sizes. */
+bool VerifyMethod(xnl::Benchmark& benchmark, const BenchmarkMethod& method, uint32_t nFactor)
+{
+	for (uint32_t w = 0; w < sizeof(g_verifyWidths) / sizeof(g_verifyWidths[0]); ++w)
+	{
+		uint32_t nXRes = g_verifyWidths[w] * nFactor + (w % nFactor);
+		uint32_t nYRes = 3 * nFactor + 1;
+
+		std::vector<OniDepthPixel> input(nXRes * nYRes);
+		FillRandom(input);
+
+		std::vector<OniDepthPixel> expected = input;
+		ReferenceDecimate(method.method, nFactor, expected, nXRes, nYRes);
+
+		std::vector<OniDepthPixel> output = input;
+		if (XnFormatsDecimateDepth(method.method, nFactor, &output[0], nXRes, nYRes) != XN_STATUS_OK ||
+			xnOSMemCmp(&output[0], &expected[0], expected.size() * sizeof(OniDepthPixel)) != 0)
+		{
+			benchmark.Fail("%s: decimating a %ux%u frame by %u doesn't match the reference!", method.strName, nXRes, nYRes, nFactor);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BenchmarkDecimation(xnl::Benchmark& benchmark, const BenchmarkMethod& method, uint32_t nFactor, const BenchmarkResolution& resolution, uint32_t nIterations)
+{
+	std::vector<OniDepthPixel> input(resolution.nXRes * resolution.nYRes);
+	FillRandom(input);
+	std::vector<OniDepthPixel> frame = input;
+
+	benchmark.ResetTimes();
+	for (uint32_t i = 0; i < nIterations; ++i)
+	{
+		// decimation is in place, so every iteration starts from a fresh copy (not timed)
+		xnOSMemCopy(&frame[0], &input[0], input.size() * sizeof(OniDepthPixel));
+
+		benchmark.StartRun();
+		XnFormatsDecimateDepth(method.method, nFactor, &frame[0], resolution.nXRes, resolution.nYRes);
+		benchmark.EndRun();
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s /%u %ux%u", method.strName, nFactor, resolution.nXRes, resolution.nYRes);
+	benchmark.ReportThroughput(strCase, input.size() * sizeof(OniDepthPixel));
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	const uint32_t nMethods = sizeof(g_methods) / sizeof(g_methods[0]);
+	const uint32_t nFactors = sizeof(g_factors) / sizeof(g_factors[0]);
+	const uint32_t nResolutions = sizeof(g_resolutions) / sizeof(g_resolutions[0]);
+
+	uint32_t nIterations = DEFAULT_ITERATIONS;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("iterations", "Number of times each frame is decimated.", &nIterations);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	benchmark.SetKernels(XnFormatsSetDecimateVectorized, XnFormatsIsDecimateVectorized, "SSSE3");
+
+	srand(0);
+	for (uint32_t i = 0; i < nMethods; ++i)
+	{
+		for (uint32_t f = 0; f < nFactors; ++f)
+		{
+			for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+			{
+				benchmark.SelectKernels(nPass);
+				VerifyMethod(benchmark, g_methods[i], g_factors[f]);
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < nMethods; ++i)
+	{
+		for (uint32_t f = 0; f < nFactors; ++f)
+		{
+			for (uint32_t j = 0; j < nResolutions; ++j)
+			{
+				for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+				{
+					benchmark.SelectKernels(nPass);
+					BenchmarkDecimation(benchmark, g_methods[i], g_factors[f], g_resolutions[j], nIterations);
+				}
+			}
+		}
+	}
+
+	return benchmark.GetResult();
+}
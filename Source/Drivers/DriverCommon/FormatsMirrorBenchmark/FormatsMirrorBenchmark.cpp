@@ -0,0 +1,231 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// FormatsMirrorBenchmark.cpp : Measures the throughput of the frame mirroring kernels, scalar against vectorized.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include <XnFormats.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_ITERATIONS 200
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct
+{
+	OniPixelFormat format;
+	const char* strName;
+	uint32_t nBytesPerPixel;
+} BenchmarkFormat;
+
+typedef struct
+{
+	uint32_t nXRes;
+	uint32_t nYRes;
+} BenchmarkResolution;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const BenchmarkFormat g_formats[] =
+{
+	{ ONI_PIXEL_FORMAT_GRAY8, "Gray8", 1 },
+	{ ONI_PIXEL_FORMAT_DEPTH_1_MM, "Depth", 2 },
+	{ ONI_PIXEL_FORMAT_RGB888, "RGB888", 3 },
+	{ ONI_PIXEL_FORMAT_YUV422, "YUV422", 2 },
+	{ ONI_PIXEL_FORMAT_YUYV, "YUYV", 2 },
+};
+
+static const BenchmarkResolution g_resolutions[] =
+{
+	{ 320, 240 },
+	{ 640, 480 },
+	{ 1280, 1024 },
+	{ 1920, 1080 },
+	{ 2592, 1944 }, // wider than the old per-line stack buffer
+};
+
+/* Odd sizes, for checking the scalar tails of the vectorized kernels. */
+static const uint32_t g_verifyWidths[] = { 2, 4, 6, 10, 14, 22, 30, 34, 62, 66, 98, 642, 4098 };
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/* Straightforward mirror of a single line, as the output is defined. */
+void ReferenceMirrorLine(OniPixelFormat format, const uint8_t* pSrc, uint8_t* pDst, uint32_t nXRes)
+{
+	if (format == ONI_PIXEL_FORMAT_YUV422 || format == ONI_PIXEL_FORMAT_YUYV)
+	{
+		// every 4 bytes hold 2 pixels. In YUV422 the two Y values swap places, in YUYV the two
+		// halves of the pair do (this has always been the driver's YUYV output).
+		uint32_t nPairs = nXRes / 2;
+		for (uint32_t i = 0; i < nPairs; ++i)
+		{
+			const uint8_t* pPair = pSrc + (nPairs - 1 - i) * 4;
+			uint8_t* pDstPair = pDst + i * 4;
+			if (format == ONI_PIXEL_FORMAT_YUV422)
+			{
+				pDstPair[0] = pPair[0];
+				pDstPair[1] = pPair[3];
+				pDstPair[2] = pPair[2];
+				pDstPair[3] = pPair[1];
+			}
+			else
+			{
+				pDstPair[0] = pPair[2];
+				pDstPair[1] = pPair[3];
+				pDstPair[2] = pPair[0];
+				pDstPair[3] = pPair[1];
+			}
+		}
+		return;
+	}
+
+	uint32_t nBytesPerPixel = (format == ONI_PIXEL_FORMAT_GRAY8) ? 1 : (format == ONI_PIXEL_FORMAT_RGB888) ? 3 : 2;
+	for (uint32_t i = 0; i < nXRes; ++i)
+	{
+		xnOSMemCopy(pDst + i * nBytesPerPixel, pSrc + (nXRes - 1 - i) * nBytesPerPixel, nBytesPerPixel);
+	}
+}
+
+void FillRandom(std::vector<uint8_t>& buffer)
+{
+	for (uint32_t i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = (uint8_t)rand();
+	}
+}
+
+/* Checks in-place and line mirroring of the current kernels against the reference, for many line sizes. */
+bool VerifyFormat(xnl::Benchmark& benchmark, const BenchmarkFormat& format)
+{
+	for (uint32_t w = 0; w < sizeof(g_verifyWidths) / sizeof(g_verifyWidths[0]); ++w)
+	{
+		uint32_t nXRes = g_verifyWidths[w];
+		uint32_t nYRes = 3;
+		uint32_t nLineSize = nXRes * format.nBytesPerPixel;
+
+		std::vector<uint8_t> input(nLineSize * nYRes);
+		std::vector<uint8_t> expected(input.size());
+		std::vector<uint8_t> output(input.size());
+		FillRandom(input);
+
+		for (uint32_t y = 0; y < nYRes; ++y)
+		{
+			ReferenceMirrorLine(format.format, &input[y * nLineSize], &expected[y * nLineSize], nXRes);
+		}
+
+		output = input;
+		if (XnFormatsMirrorPixelData(format.format, &output[0], (uint32_t)output.size(), nXRes) != XN_STATUS_OK ||
+			xnOSMemCmp(&output[0], &expected[0], output.size()) != 0)
+		{
+			benchmark.Fail("%s: in-place mirror of %u pixels wide lines doesn't match the reference!", format.strName, nXRes);
+			return false;
+		}
+
+		xnOSMemSet(&output[0], 0, output.size());
+		for (uint32_t y = 0; y < nYRes; ++y)
+		{
+			XnFormatsMirrorLine(format.format, &input[y * nLineSize], &output[y * nLineSize], nXRes);
+		}
+		if (xnOSMemCmp(&output[0], &expected[0], output.size()) != 0)
+		{
+			benchmark.Fail("%s: mirroring a %u pixels line doesn't match the reference!", format.strName, nXRes);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BenchmarkMirror(xnl::Benchmark& benchmark, const BenchmarkFormat& format, const BenchmarkResolution& resolution, uint32_t nIterations)
+{
+	std::vector<uint8_t> frame(resolution.nXRes * resolution.nYRes * format.nBytesPerPixel);
+	FillRandom(frame);
+
+	//Warm up caches and page in the frame
+	XnFormatsMirrorPixelData(format.format, &frame[0], (uint32_t)frame.size(), resolution.nXRes);
+
+	benchmark.ResetTimes();
+	for (uint32_t i = 0; i < nIterations; ++i)
+	{
+		benchmark.StartRun();
+		XnFormatsMirrorPixelData(format.format, &frame[0], (uint32_t)frame.size(), resolution.nXRes);
+		benchmark.EndRun();
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %ux%u", format.strName, resolution.nXRes, resolution.nYRes);
+	benchmark.ReportThroughput(strCase, frame.size());
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	const uint32_t nFormats = sizeof(g_formats) / sizeof(g_formats[0]);
+	const uint32_t nResolutions = sizeof(g_resolutions) / sizeof(g_resolutions[0]);
+	uint32_t nIterations = DEFAULT_ITERATIONS;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("iterations", "Number of times each frame is mirrored.", &nIterations);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	benchmark.SetKernels(XnFormatsSetMirrorVectorized, XnFormatsIsMirrorVectorized, "SSSE3");
+
+	srand(0);
+	for (uint32_t i = 0; i < nFormats; ++i)
+	{
+		for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+		{
+			benchmark.SelectKernels(nPass);
+			VerifyFormat(benchmark, g_formats[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < nFormats; ++i)
+	{
+		for (uint32_t j = 0; j < nResolutions; ++j)
+		{
+			for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+			{
+				benchmark.SelectKernels(nPass);
+				BenchmarkMirror(benchmark, g_formats[i], g_resolutions[j], nIterations);
+			}
+		}
+	}
+
+	return benchmark.GetResult();
+}
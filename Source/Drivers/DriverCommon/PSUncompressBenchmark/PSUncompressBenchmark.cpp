@@ -0,0 +1,476 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// PSUncompressBenchmark.cpp : Checks the PS depth and image decoders against their element by element versions, and
+// measures both.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include "../Sensor/Uncomp.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_STREAMS 2000
+#define DEFAULT_ITERATIONS 200
+#define BENCHMARK_FPS 30
+#define BENCHMARK_X_RES 640
+#define BENCHMARK_Y_RES 480
+
+/* Largest packet the streams are cut to, as from the device. */
+#define MAX_CHUNK_SIZE 1200
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef enum
+{
+	STREAM_ENCODED,
+	STREAM_CORRUPTED,
+	STREAM_RANDOM,
+	STREAM_KINDS_COUNT,
+} StreamKind;
+
+/* Result of a single decoder call. */
+typedef struct
+{
+	XnStatus nRetVal;
+	uint32_t nOutputSize;
+	uint32_t nActualRead;
+} DecodeCall;
+
+/* Calls made decoding a stream, and what they wrote. */
+typedef struct
+{
+	std::vector<DecodeCall> calls;
+	std::vector<uint8_t> output;
+} DecodeTrace;
+
+class NibbleWriter
+{
+public:
+	NibbleWriter(std::vector<uint8_t>& stream) : m_stream(stream), m_bHalf(false) {}
+
+	void Write(uint32_t nNibble)
+	{
+		if (m_bHalf)
+		{
+			m_stream.back() |= (uint8_t)nNibble;
+		}
+		else
+		{
+			m_stream.push_back((uint8_t)(nNibble << 4));
+		}
+		m_bHalf = !m_bHalf;
+	}
+
+	/* Pads with a dummy to a whole byte. */
+	void Align()
+	{
+		if (m_bHalf)
+		{
+			Write(0xd);
+		}
+	}
+
+private:
+	std::vector<uint8_t>& m_stream;
+	bool m_bHalf;
+};
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static OniDepthPixel g_shiftToDepth[XN_DEVICE_SENSOR_MAX_SHIFT_VALUE];
+
+static const char* g_astrKinds[STREAM_KINDS_COUNT] = { "encoded", "corrupted", "random" };
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+uint32_t Random(uint32_t nRange)
+{
+	return (uint32_t)rand() % nRange;
+}
+
+/* Smooth surfaces with noise, holes, and jumps between them. */
+void FillShifts(std::vector<uint16_t>& shifts)
+{
+	uint32_t nValue = 800;
+	for (uint32_t i = 0; i < shifts.size(); ++i)
+	{
+		uint32_t nRandom = Random(100);
+		if (nRandom < 5)
+		{
+			nValue = Random(XN_DEVICE_SENSOR_MAX_SHIFT_VALUE);
+		}
+		else if (nRandom < 15)
+		{
+			nValue += Random(100);
+			nValue = XN_MIN(nValue, (uint32_t)XN_DEVICE_SENSOR_MAX_SHIFT_VALUE - 1);
+		}
+		else if (nRandom < 60)
+		{
+			nValue += Random(9);
+			nValue = (nValue < 4) ? 0 : nValue - 4;
+		}
+
+		shifts[i] = (nRandom >= 90 && nRandom < 95) ? 0 : (uint16_t)nValue;
+	}
+}
+
+/* Encodes the shifts with every kind of element: diffs, large diffs, full values, runs and dummies. */
+void EncodeDepth(const std::vector<uint16_t>& shifts, std::vector<uint8_t>& stream)
+{
+	NibbleWriter writer(stream);
+	int32_t nLast = 0;
+
+	for (uint32_t i = 0; i < shifts.size();)
+	{
+		if (Random(50) == 0)
+		{
+			writer.Write(0xd);
+		}
+
+		int32_t nValue = shifts[i];
+		int32_t nDiff = nValue - nLast;
+
+		uint32_t nRun = 0;
+		while (nRun < 16 && i + nRun < shifts.size() && shifts[i + nRun] == nLast)
+		{
+			++nRun;
+		}
+
+		if (nRun > 1 && Random(4) != 0)
+		{
+			writer.Write(0xe);
+			writer.Write(nRun - 1);
+			i += nRun;
+			continue;
+		}
+
+		// full values every now and then, as they are where decoding can stop
+		if (Random(40) == 0 || nDiff < -64 || nDiff > 63)
+		{
+			writer.Write(0xf);
+			writer.Write(nValue >> 12);
+			writer.Write((nValue >> 8) & 0xf);
+			writer.Write((nValue >> 4) & 0xf);
+			writer.Write(nValue & 0xf);
+		}
+		else if (nDiff < -6 || nDiff > 6)
+		{
+			writer.Write(0xf);
+			writer.Write(0x8 | ((nDiff + 64) >> 4));
+			writer.Write((nDiff + 64) & 0xf);
+		}
+		else
+		{
+			writer.Write(nDiff + 6);
+		}
+
+		nLast = nValue;
+		++i;
+	}
+
+	writer.Align();
+}
+
+/* Lines of U, Y1, V, Y2, each line ending on a whole byte (where decoding can stop). */
+void EncodeImage(uint32_t nXRes, uint32_t nYRes, std::vector<uint8_t>& stream)
+{
+	static const uint32_t anChannelValue[4] = { 0, 1, 2, 1 };
+	NibbleWriter writer(stream);
+
+	for (uint32_t y = 0; y < nYRes; ++y)
+	{
+		uint8_t anLast[3] = { 0, 0, 0 };
+		uint8_t anValue[3] = { (uint8_t)Random(256), (uint8_t)Random(256), (uint8_t)Random(256) };
+
+		for (uint32_t i = 0; i < nXRes * 2; ++i)
+		{
+			if (Random(50) == 0)
+			{
+				writer.Write(0xd);
+			}
+
+			uint32_t nValue = anChannelValue[i & 3];
+			uint32_t nRandom = Random(100);
+			if (nRandom < 10)
+			{
+				anValue[nValue] = (uint8_t)Random(256);
+			}
+			else if (nRandom < 70)
+			{
+				anValue[nValue] = (uint8_t)(anValue[nValue] + Random(13) - 6);
+			}
+
+			int32_t nDiff = (int8_t)(anValue[nValue] - anLast[nValue]);
+			if (nDiff < -6 || nDiff > 6)
+			{
+				writer.Write(0xf);
+				writer.Write(anValue[nValue] >> 4);
+				writer.Write(anValue[nValue] & 0xf);
+			}
+			else
+			{
+				writer.Write(nDiff + 6);
+			}
+
+			anLast[nValue] = anValue[nValue];
+		}
+
+		writer.Align();
+	}
+}
+
+void MakeStream(StreamKind kind, bool bDepth, uint32_t nXRes, uint32_t nYRes, std::vector<uint8_t>& stream)
+{
+	stream.clear();
+
+	if (kind == STREAM_RANDOM)
+	{
+		stream.resize(Random(nXRes * nYRes * 2));
+		for (uint32_t i = 0; i < stream.size(); ++i)
+		{
+			// mostly diffs, so the decoders don't escape on every other pair
+			stream[i] = (Random(4) == 0) ? (uint8_t)Random(256) : (uint8_t)(Random(13) << 4 | Random(13));
+		}
+		return;
+	}
+
+	if (bDepth)
+	{
+		std::vector<uint16_t> shifts(nXRes * nYRes);
+		FillShifts(shifts);
+		EncodeDepth(shifts, stream);
+	}
+	else
+	{
+		EncodeImage(nXRes, nYRes, stream);
+	}
+
+	if (kind == STREAM_CORRUPTED && !stream.empty())
+	{
+		for (uint32_t i = Random(4) + 1; i > 0; --i)
+		{
+			stream[Random((uint32_t)stream.size())] = (uint8_t)Random(256);
+		}
+		if (Random(2) == 0)
+		{
+			stream.resize(Random((uint32_t)stream.size()));
+		}
+	}
+}
+
+XnStatus Decode(bool bDepth, uint16_t nLineSize, const uint8_t* pInput, uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnOutputSize, uint32_t* pnActualRead, bool bLastPart)
+{
+	if (bDepth)
+	{
+		return XnStreamUncompressDepthPS(pInput, nInputSize, g_shiftToDepth, (OniDepthPixel*)pOutput, pnOutputSize, pnActualRead, bLastPart);
+	}
+	else
+	{
+		return XnStreamUncompressYUVImagePS(pInput, nInputSize, pOutput, pnOutputSize, nLineSize, pnActualRead, bLastPart);
+	}
+}
+
+/* Feeds the stream in the given chunks, as XnPSCompressedDepthProcessor and XnPSCompressedImageProcessor do, and
+   stops at the first failure (the processors drop the frame). */
+void DecodeChunked(bool bDepth, uint16_t nLineSize, const std::vector<uint8_t>& stream, const std::vector<uint32_t>& chunks, uint32_t nOutputSpace, DecodeTrace& trace)
+{
+	std::vector<uint8_t> raw;
+	std::vector<uint8_t> output(nOutputSpace + 1);
+	uint32_t nWritten = 0;
+	uint32_t nOffset = 0;
+
+	trace.calls.clear();
+
+	for (uint32_t i = 0; i < chunks.size(); ++i)
+	{
+		raw.insert(raw.end(), stream.begin() + nOffset, stream.begin() + nOffset + chunks[i]);
+		nOffset += chunks[i];
+
+		DecodeCall call;
+		call.nOutputSize = nOutputSpace - nWritten;
+		call.nActualRead = 0;
+		const uint8_t* pRaw = raw.empty() ? NULL : &raw[0];
+		call.nRetVal = Decode(bDepth, nLineSize, pRaw, (uint32_t)raw.size(), &output[nWritten], &call.nOutputSize, &call.nActualRead, i + 1 == chunks.size());
+		trace.calls.push_back(call);
+
+		if (call.nRetVal != XN_STATUS_OK)
+		{
+			break;
+		}
+
+		nWritten += call.nOutputSize;
+		raw.erase(raw.begin(), raw.begin() + call.nActualRead);
+	}
+
+	trace.output.assign(output.begin(), output.begin() + nWritten);
+}
+
+/* Runs every stream through both decoders, cut to the same random chunks, and checks they agree on the status,
+   the bytes written and read by each call (which are where decoding stopped), and the output. */
+bool VerifyDecoder(xnl::Benchmark& benchmark, bool bDepth, uint32_t nStreams)
+{
+	const char* strDecoder = bDepth ? "Depth" : "Image";
+
+	std::vector<uint8_t> stream;
+	std::vector<uint32_t> chunks;
+	DecodeTrace traces[2];
+
+	for (uint32_t s = 0; s < nStreams; ++s)
+	{
+		StreamKind kind = (StreamKind)(s % STREAM_KINDS_COUNT);
+		uint32_t nXRes = Random(64) + 1;
+		uint32_t nYRes = Random(8) + 1;
+		MakeStream(kind, bDepth, nXRes, nYRes, stream);
+		if (stream.empty())
+		{
+			continue;
+		}
+
+		chunks.clear();
+		uint32_t nMaxChunk = (Random(2) == 0) ? 16 : MAX_CHUNK_SIZE;
+		for (uint32_t nLeft = (uint32_t)stream.size(); nLeft > 0;)
+		{
+			uint32_t nChunk = Random(nMaxChunk) + 1;
+			nChunk = XN_MIN(nChunk, nLeft);
+			chunks.push_back(nChunk);
+			nLeft -= nChunk;
+		}
+
+		// the output is sometimes too short, to check overflows are detected at the same point
+		uint32_t nOutputSpace = nXRes * nYRes * 2;
+		if (Random(4) == 0)
+		{
+			nOutputSpace = Random(nOutputSpace);
+		}
+
+		uint16_t nLineSize = (uint16_t)(nXRes * 2);
+		for (uint32_t nPass = 0; nPass < 2; ++nPass)
+		{
+			benchmark.SelectKernels(nPass);
+			DecodeChunked(bDepth, nLineSize, stream, chunks, nOutputSpace, traces[nPass]);
+		}
+
+		const DecodeTrace& scalar = traces[0];
+		const DecodeTrace& pairs = traces[1];
+		for (uint32_t i = 0; i < XN_MAX(scalar.calls.size(), pairs.calls.size()); ++i)
+		{
+			if (i >= scalar.calls.size() || i >= pairs.calls.size() ||
+				scalar.calls[i].nRetVal != pairs.calls[i].nRetVal ||
+				(scalar.calls[i].nRetVal == XN_STATUS_OK &&
+				 (scalar.calls[i].nOutputSize != pairs.calls[i].nOutputSize || scalar.calls[i].nActualRead != pairs.calls[i].nActualRead)))
+			{
+				benchmark.Fail("%s: %s stream %u (%ux%u) differs on call %u of %u!", strDecoder, g_astrKinds[kind], s, nXRes, nYRes, i, (uint32_t)chunks.size());
+				return false;
+			}
+		}
+
+		if (scalar.output != pairs.output)
+		{
+			benchmark.Fail("%s: %s stream %u (%ux%u) decodes to a different output!", strDecoder, g_astrKinds[kind], s, nXRes, nYRes);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BenchmarkDecoder(xnl::Benchmark& benchmark, bool bDepth, uint32_t nIterations)
+{
+	std::vector<uint8_t> stream;
+	MakeStream(STREAM_ENCODED, bDepth, BENCHMARK_X_RES, BENCHMARK_Y_RES, stream);
+
+	std::vector<uint8_t> output(BENCHMARK_X_RES * BENCHMARK_Y_RES * 2);
+
+	benchmark.ResetTimes();
+	for (uint32_t i = 0; i < nIterations; ++i)
+	{
+		uint32_t nOutputSize = (uint32_t)output.size();
+		uint32_t nActualRead = 0;
+
+		benchmark.StartRun();
+		XnStatus nRetVal = Decode(bDepth, BENCHMARK_X_RES * 2, &stream[0], (uint32_t)stream.size(), &output[0], &nOutputSize, &nActualRead, true);
+		benchmark.EndRun();
+
+		if (nRetVal != XN_STATUS_OK || nOutputSize != output.size())
+		{
+			benchmark.Fail("%s: failed decoding a whole frame!", bDepth ? "Depth" : "Image");
+			return;
+		}
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %ux%u", bDepth ? "Depth" : "YUV image", BENCHMARK_X_RES, BENCHMARK_Y_RES);
+	benchmark.ReportFrameTime(strCase, BENCHMARK_FPS);
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t nStreams = DEFAULT_STREAMS;
+	uint32_t nIterations = DEFAULT_ITERATIONS;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("streams", "Number of random streams each decoder is checked with.", &nStreams);
+	benchmark.AddOption("iterations", "Number of times each frame is decoded.", &nIterations);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	// the table decoders aren't vectorized, but are selected the same way
+	benchmark.SetKernels(XnStreamSetPSNibblePairsEnabled, XnStreamIsPSNibblePairsEnabled, "Pairs");
+
+	for (uint32_t i = 0; i < XN_DEVICE_SENSOR_MAX_SHIFT_VALUE; ++i)
+	{
+		g_shiftToDepth[i] = (OniDepthPixel)((i * 7919) % 10000);
+	}
+
+	srand(0);
+	VerifyDecoder(benchmark, true, nStreams);
+	VerifyDecoder(benchmark, false, nStreams);
+
+	for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+	{
+		benchmark.SelectKernels(nPass);
+		BenchmarkDecoder(benchmark, true, nIterations);
+	}
+
+	for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+	{
+		benchmark.SelectKernels(nPass);
+		BenchmarkDecoder(benchmark, false, nIterations);
+	}
+
+	return benchmark.GetResult();
+}
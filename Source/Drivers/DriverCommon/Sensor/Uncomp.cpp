@@ -39,10 +39,117 @@
 	*pOutput = nValue;									\
 	++pOutput;
 
+#define XN_CHECK_UNC_DEPTH_OUTPUT(x, y, z)			\
+	if (x >= y)										\
+	{												\
+		return (XN_STATUS_OUTPUT_BUFFER_OVERFLOW);	\
+	}												\
+	if (z >= XN_DEVICE_SENSOR_MAX_SHIFT_VALUE)		\
+	{												\
+		z = XN_DEVICE_SENSOR_NO_DEPTH_VALUE;		\
+	}
+
+#define XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nValue)					                \
+	XN_CHECK_UNC_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nValue)				                \
+	*pDepthOutput = pShiftToDepthTable[nValue];							                \
+	++pDepthOutput;
+
+#define GET_NEXT_INPUT(nInput)								\
+	if (__bShouldReadByte)									\
+	{														\
+		if (__pCurrInput == __pInputEnd)					\
+			break;											\
+															\
+		/* read from input */								\
+		__nLastByte = *__pCurrInput;						\
+		__bShouldReadByte = false;							\
+															\
+		/* take high 4-bits */								\
+		nInput = __nLastByte >> 4;							\
+															\
+		__pCurrInput++;										\
+	}														\
+	else													\
+	{														\
+		/* byte already read. take its low 4-bits */		\
+		nInput = __nLastByte & 0x0F;						\
+		__bShouldReadByte = true;							\
+	}
+
+
+#define GET_INPUT_READ_BYTES (__pCurrInput - __pInputOrig);
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+class XnPSNibblePairTable
+{
+public:
+	XnPSNibblePairTable(bool bRunLengths)
+	{
+		for (uint32_t nPair = 0; nPair < 256; ++nPair)
+		{
+			XnPSNibblePair& pair = m_pairs[nPair];
+			uint32_t nHigh = nPair >> 4;
+			uint32_t nLow = nPair & 0x0F;
+
+			pair.nOutputs = 0;
+			pair.anDiffs[0] = pair.anDiffs[1] = 0;
+
+			if (nHigh == 0xe && bRunLengths)
+			{
+				// repeat last value (count + 1) times
+				pair.nOutputs = (uint8_t)(nLow + 1);
+			}
+			else if (nHigh > 0xd || nLow > 0xd)
+			{
+				// full values and large diffs span more than a pair
+				pair.nOutputs = XN_PS_NIBBLE_PAIR_ESCAPE;
+			}
+			else
+			{
+				// 0x0 to 0xc are diffs, between -6 and 6. 0xd is dummy.
+				if (nHigh < 0xd)
+				{
+					pair.anDiffs[pair.nOutputs++] = (int8_t)(nHigh - 6);
+				}
+				if (nLow < 0xd)
+				{
+					pair.anDiffs[pair.nOutputs++] = (int8_t)(nLow - 6);
+				}
+			}
+		}
+	}
+
+	XnPSNibblePair m_pairs[256];
+};
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static bool g_bPSNibblePairs = true;
+
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
-XnStatus XnStreamUncompressYUVImagePS(const uint8_t* pInput, const uint32_t nInputSize,
+const XnPSNibblePair* XnStreamGetPSNibblePairs(bool bRunLengths)
+{
+	static const XnPSNibblePairTable runLengthPairs(true);
+	static const XnPSNibblePairTable pairs(false);
+	return bRunLengths ? runLengthPairs.m_pairs : pairs.m_pairs;
+}
+
+void XnStreamSetPSNibblePairsEnabled(bool bEnabled)
+{
+	g_bPSNibblePairs = bEnabled;
+}
+
+bool XnStreamIsPSNibblePairsEnabled()
+{
+	return g_bPSNibblePairs;
+}
+
+static XnStatus XnStreamUncompressYUVImagePSScalar(const uint8_t* pInput, const uint32_t nInputSize,
 										  uint8_t* pOutput, uint32_t* pnOutputSize, uint16_t nLineSize,
 										  uint32_t* pnActualRead, bool bLastPart)
 {
@@ -179,6 +286,480 @@ XnStatus XnStreamUncompressYUVImagePS(const uint8_t* pInput, const uint32_t nInp
 	return (XN_STATUS_OK);
 }
 
+static XnStatus XnStreamUncompressYUVImagePSPairs(const uint8_t* pInput, const uint32_t nInputSize,
+										  uint8_t* pOutput, uint32_t* pnOutputSize, uint16_t nLineSize,
+										  uint32_t* pnActualRead, bool bLastPart)
+{
+	// Input is made of 4-bit elements.
+	const uint8_t* pInputOrig = pInput;
+	const uint8_t* pInputEnd = pInput + nInputSize;
+	uint8_t* pOrigOutput = pOutput;
+	uint8_t* pOutputEnd = pOutput + (*pnOutputSize);
+
+	// Output is U, Y1, V, Y2. Each of U, Y and V is a diff from the previous value of the same kind.
+	static const uint32_t anChannelValue[4] = { 0, 1, 2, 1 };
+	uint8_t nLastFullValue[3] = {0};
+
+	// NOTE: we use variables of type uint32 instead of uint8 as an optimization (better CPU usage)
+	uint32_t nTempValue = 0;
+	uint32_t cInput = 0;
+	bool bReadByte = true;
+
+	if (nInputSize < sizeof(uint8_t))
+	{
+		printf("Buffer too small!\n");
+		return (XN_STATUS_IO_COMPRESSED_BUFFER_TOO_SMALL);
+	}
+
+	const uint8_t* pInputLastPossibleStop = pInputOrig;
+	uint8_t* pOutputLastPossibleStop = pOrigOutput;
+
+	*pnActualRead = 0;
+	*pnOutputSize = 0;
+
+	uint32_t nChannel = 0;
+	uint32_t nCurLineSize = 0;
+
+	const XnPSNibblePair* pPairs = XnStreamGetPSNibblePairs(false);
+
+	while (pInput < pInputEnd)
+	{
+		// Diffs and dummies are decoded a pair of elements at a time, away from line ends (where decoding may stop).
+		// When not byte aligned, the pair is the low element of the current byte and the high element of the next
+		// one. Both outputs are always written, and the output advances by the number of diffs the pair holds.
+		while (pInput < pInputEnd && nCurLineSize + 2 < nLineSize && pOutputEnd - pOutput >= 2)
+		{
+			uint32_t nPair;
+			if (bReadByte)
+			{
+				nPair = *pInput;
+			}
+			else if (pInput + 1 < pInputEnd)
+			{
+				nPair = ((pInput[0] << 4) | (pInput[1] >> 4)) & 0xFF;
+			}
+			else
+			{
+				break;
+			}
+
+			const XnPSNibblePair& pair = pPairs[nPair];
+			if (pair.nOutputs == XN_PS_NIBBLE_PAIR_ESCAPE)
+				break;
+
+			uint8_t& nFirst = nLastFullValue[anChannelValue[nChannel]];
+			nFirst += pair.anDiffs[0];
+			pOutput[0] = nFirst;
+
+			uint8_t& nSecond = nLastFullValue[anChannelValue[(nChannel + 1) & 3]];
+			nSecond += pair.anDiffs[1];
+			pOutput[1] = nSecond;
+
+			pOutput += pair.nOutputs;
+			nChannel = (nChannel + pair.nOutputs) & 3;
+			nCurLineSize += pair.nOutputs;
+
+			pInput++;
+		}
+
+		if (pInput == pInputEnd)
+			break;
+
+		cInput = *pInput;
+
+		if (bReadByte)
+		{
+			bReadByte = false;
+
+			if (cInput < 0xd0) // 0x0 to 0xc are diffs
+			{
+				// take high_element only
+				// diffs are between -6 and 6 (0x0 to 0xc)
+				nLastFullValue[anChannelValue[nChannel]] += int8_t((cInput >> 4) - 6);
+			}
+			else if (cInput < 0xe0) // 0xd is dummy
+			{
+				// Do nothing
+				continue;
+			}
+			else // 0xe is not used, so this must be 0xf - full
+			{
+				// take two more elements
+				nTempValue = (cInput & 0x0f) << 4;
+
+				if (++pInput == pInputEnd)
+					break;
+
+				nTempValue += (*pInput >> 4);
+				nLastFullValue[anChannelValue[nChannel]] = (uint8_t)nTempValue;
+			}
+		}
+		else
+		{
+			// take low-element
+			cInput &= 0x0f;
+			bReadByte = true;
+			pInput++;
+
+			if (cInput < 0xd) // 0x0 to 0xc are diffs
+			{
+				// diffs are between -6 and 6 (0x0 to 0xc)
+				nLastFullValue[anChannelValue[nChannel]] += (int8_t)(cInput - 6);
+			}
+			else if (cInput < 0xe) // 0xd is dummy
+			{
+				// Do nothing
+				continue;
+			}
+			else // 0xe is not in use, so this must be 0xf - full
+			{
+				if (pInput == pInputEnd)
+					break;
+
+				// take two more elements
+				nLastFullValue[anChannelValue[nChannel]] = *pInput;
+				pInput++;
+			}
+		}
+
+		// write output
+		if (pOutput >= pOutputEnd)
+		{
+			return (XN_STATUS_OUTPUT_BUFFER_OVERFLOW);
+		}
+
+		*pOutput = nLastFullValue[anChannelValue[nChannel]];
+		pOutput++;
+
+		nChannel = (nChannel + 1) & 3;
+
+		nCurLineSize++;
+		if (nCurLineSize == nLineSize)
+		{
+			pInputLastPossibleStop = pInput;
+			pOutputLastPossibleStop = pOutput;
+
+			nLastFullValue[0] = nLastFullValue[1] = nLastFullValue[2] = 0;
+			nCurLineSize = 0;
+		}
+	}
+
+	if (bLastPart == true)
+	{
+		*pnOutputSize = (uint32_t)(pOutput - pOrigOutput) * sizeof(uint8_t);
+		*pnActualRead += (uint32_t)(pInput - pInputOrig) * sizeof(uint8_t);
+	}
+	else if ((pOutputLastPossibleStop != pOrigOutput) && (pInputLastPossibleStop != pInputOrig))
+	{
+		*pnOutputSize = (uint32_t)(pOutputLastPossibleStop - pOrigOutput) * sizeof(uint8_t);
+		*pnActualRead += (uint32_t)(pInputLastPossibleStop - pInputOrig) * sizeof(uint8_t);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnStreamUncompressYUVImagePS(const uint8_t* pInput, const uint32_t nInputSize,
+										  uint8_t* pOutput, uint32_t* pnOutputSize, uint16_t nLineSize,
+										  uint32_t* pnActualRead, bool bLastPart)
+{
+	if (g_bPSNibblePairs)
+	{
+		return XnStreamUncompressYUVImagePSPairs(pInput, nInputSize, pOutput, pnOutputSize, nLineSize, pnActualRead, bLastPart);
+	}
+	else
+	{
+		return XnStreamUncompressYUVImagePSScalar(pInput, nInputSize, pOutput, pnOutputSize, nLineSize, pnActualRead, bLastPart);
+	}
+}
+
+static XnStatus XnStreamUncompressDepthPSScalar(const uint8_t* pInput, const uint32_t nInputSize,
+									const OniDepthPixel* pShiftToDepthTable, OniDepthPixel* pDepthOutput,
+									uint32_t* pnOutputSize, uint32_t* pnActualRead, bool bLastPart)
+{
+	// Input is made of 4-bit elements.
+	const uint8_t* __pInputOrig = pInput;
+	const uint8_t* __pCurrInput = pInput;
+	const uint8_t* __pInputEnd = pInput + nInputSize;
+	/** True if input is in a steady state (not in the middle of a byte) */
+	bool __bShouldReadByte = true;
+	uint32_t __nLastByte = 0;
+
+	uint16_t* pOutputEnd = pDepthOutput + (*pnOutputSize / sizeof(OniDepthPixel));
+	uint16_t nLastValue = 0;
+
+	const uint8_t* pInputOrig = pInput;
+	uint16_t* pOutputOrig = pDepthOutput;
+
+	const uint8_t* pInputLastPossibleStop = pInputOrig;
+	uint16_t* pOutputLastPossibleStop = pOutputOrig;
+
+	// NOTE: we use variables of type uint32 instead of uint8 as an optimization (better CPU usage)
+	uint32_t nInput;
+	uint32_t nLargeValue;
+	bool bCanStop;
+
+	for (;;)
+	{
+		bCanStop = __bShouldReadByte;
+		GET_NEXT_INPUT(nInput);
+
+		switch (nInput)
+		{
+		case 0xd: // Dummy.
+			// Do nothing
+			break;
+		case 0xe: // RLE
+			// read count
+			GET_NEXT_INPUT(nInput);
+
+			// should repeat last value (nInput + 1) times
+			nInput++;
+			while (nInput != 0)
+			{
+				XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nLastValue);
+				--nInput;
+			}
+			break;
+
+		case 0xf: // Full (or large)
+			// read next element
+			GET_NEXT_INPUT(nInput);
+
+			// First bit tells us if it's a large diff (turned on) or a full value (turned off)
+			if (nInput & 0x8) // large diff (7-bit)
+			{
+				// turn off high bit, and shift left
+				nLargeValue = (nInput - 0x8) << 4;
+
+				// read low 4-bits
+				GET_NEXT_INPUT(nInput);
+
+				nLargeValue |= nInput;
+				// diff values are from -64 to 63 (0x00 to 0x7f)
+				nLastValue += ((int16_t)nLargeValue - 64);
+			}
+			else // Full value (15-bit)
+			{
+				if (bCanStop)
+				{
+					// We can stop here. First input is a full value
+					/** Gets a pointer to 1 element before current input */
+					pInputLastPossibleStop = __pCurrInput - 1;
+					pOutputLastPossibleStop = pDepthOutput;
+				}
+
+				nLargeValue = (nInput << 12);
+
+				// read 3 more elements
+				GET_NEXT_INPUT(nInput);
+				nLargeValue |= nInput << 8;
+
+				GET_NEXT_INPUT(nInput);
+				nLargeValue |= nInput << 4;
+
+				GET_NEXT_INPUT(nInput);
+				nLastValue = (uint16_t)(nLargeValue | nInput);
+			}
+
+			XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nLastValue);
+
+			break;
+		default: // all rest (smaller than 0xd) are diffs
+			// diff values are from -6 to 6 (0x0 to 0xc)
+			nLastValue += ((int16_t)nInput - 6);
+			XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nLastValue);
+		}
+	}
+
+	if (bLastPart == true)
+	{
+		*pnOutputSize = (uint32_t)(pDepthOutput - pOutputOrig) * sizeof(uint16_t);
+		*pnActualRead = (uint32_t)GET_INPUT_READ_BYTES;
+	}
+	else
+	{
+		*pnOutputSize = (uint32_t)(pOutputLastPossibleStop - pOutputOrig) * sizeof(uint16_t);
+		*pnActualRead = (uint32_t)(pInputLastPossibleStop - pInputOrig) * sizeof(uint8_t);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+static XnStatus XnStreamUncompressDepthPSPairs(const uint8_t* pInput, const uint32_t nInputSize,
+									const OniDepthPixel* pShiftToDepthTable, OniDepthPixel* pDepthOutput,
+									uint32_t* pnOutputSize, uint32_t* pnActualRead, bool bLastPart)
+{
+	// Input is made of 4-bit elements.
+	const uint8_t* __pInputOrig = pInput;
+	const uint8_t* __pCurrInput = pInput;
+	const uint8_t* __pInputEnd = pInput + nInputSize;
+	/** True if input is in a steady state (not in the middle of a byte) */
+	bool __bShouldReadByte = true;
+	uint32_t __nLastByte = 0;
+
+	uint16_t* pOutputEnd = pDepthOutput + (*pnOutputSize / sizeof(OniDepthPixel));
+	uint16_t nLastValue = 0;
+
+	const uint8_t* pInputOrig = pInput;
+	uint16_t* pOutputOrig = pDepthOutput;
+
+	const uint8_t* pInputLastPossibleStop = pInputOrig;
+	uint16_t* pOutputLastPossibleStop = pOutputOrig;
+
+	// NOTE: we use variables of type uint32 instead of uint8 as an optimization (better CPU usage)
+	uint32_t nInput;
+	uint32_t nLargeValue;
+	bool bCanStop;
+
+	const XnPSNibblePair* pPairs = XnStreamGetPSNibblePairs(true);
+
+	for (;;)
+	{
+		// Diffs, dummies and runs are decoded a pair of elements at a time. When not byte aligned, the pair is the
+		// low element of the last byte read and the high element of the next one. To avoid branching on the kind
+		// of pair, the first output gets the first diff, the next ones all get the value after the second diff
+		// (for a run, both diffs are 0), and the output advances by the number of values the pair holds. Values
+		// written past that are overwritten by the following pairs.
+		// Full values and large diffs are left to the element by element decoding below.
+		while (__pCurrInput != __pInputEnd && pOutputEnd - pDepthOutput >= XN_PS_NIBBLE_PAIR_MAX_OUTPUTS)
+		{
+			uint32_t nPair = __bShouldReadByte ? *__pCurrInput : (((__nLastByte << 4) | (*__pCurrInput >> 4)) & 0xFF);
+			const XnPSNibblePair& pair = pPairs[nPair];
+			if (pair.nOutputs == XN_PS_NIBBLE_PAIR_ESCAPE)
+				break;
+
+			nLastValue += pair.anDiffs[0];
+			if (nLastValue >= XN_DEVICE_SENSOR_MAX_SHIFT_VALUE)
+			{
+				nLastValue = XN_DEVICE_SENSOR_NO_DEPTH_VALUE;
+			}
+			OniDepthPixel nFirstDepth = pShiftToDepthTable[nLastValue];
+
+			nLastValue += pair.anDiffs[1];
+			if (nLastValue >= XN_DEVICE_SENSOR_MAX_SHIFT_VALUE)
+			{
+				nLastValue = XN_DEVICE_SENSOR_NO_DEPTH_VALUE;
+			}
+			OniDepthPixel nDepth = pShiftToDepthTable[nLastValue];
+
+			// a fixed size fill (compiled to a couple of vector stores), then the first value over it
+			for (uint32_t i = 0; i < XN_PS_NIBBLE_PAIR_MAX_OUTPUTS; ++i)
+			{
+				pDepthOutput[i] = nDepth;
+			}
+			pDepthOutput[0] = nFirstDepth;
+
+			pDepthOutput += pair.nOutputs;
+
+			if (!__bShouldReadByte)
+			{
+				__nLastByte = *__pCurrInput;
+			}
+			++__pCurrInput;
+		}
+
+		bCanStop = __bShouldReadByte;
+		GET_NEXT_INPUT(nInput);
+
+		switch (nInput)
+		{
+		case 0xd: // Dummy.
+			// Do nothing
+			break;
+		case 0xe: // RLE
+			// read count
+			GET_NEXT_INPUT(nInput);
+
+			// should repeat last value (nInput + 1) times
+			nInput++;
+			while (nInput != 0)
+			{
+				XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nLastValue);
+				--nInput;
+			}
+			break;
+
+		case 0xf: // Full (or large)
+			// read next element
+			GET_NEXT_INPUT(nInput);
+
+			// First bit tells us if it's a large diff (turned on) or a full value (turned off)
+			if (nInput & 0x8) // large diff (7-bit)
+			{
+				// turn off high bit, and shift left
+				nLargeValue = (nInput - 0x8) << 4;
+
+				// read low 4-bits
+				GET_NEXT_INPUT(nInput);
+
+				nLargeValue |= nInput;
+				// diff values are from -64 to 63 (0x00 to 0x7f)
+				nLastValue += ((int16_t)nLargeValue - 64);
+			}
+			else // Full value (15-bit)
+			{
+				if (bCanStop)
+				{
+					// We can stop here. First input is a full value
+					/** Gets a pointer to 1 element before current input */
+					pInputLastPossibleStop = __pCurrInput - 1;
+					pOutputLastPossibleStop = pDepthOutput;
+				}
+
+				nLargeValue = (nInput << 12);
+
+				// read 3 more elements
+				GET_NEXT_INPUT(nInput);
+				nLargeValue |= nInput << 8;
+
+				GET_NEXT_INPUT(nInput);
+				nLargeValue |= nInput << 4;
+
+				GET_NEXT_INPUT(nInput);
+				nLastValue = (uint16_t)(nLargeValue | nInput);
+			}
+
+			XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nLastValue);
+
+			break;
+		default: // all rest (smaller than 0xd) are diffs
+			// diff values are from -6 to 6 (0x0 to 0xc)
+			nLastValue += ((int16_t)nInput - 6);
+			XN_DEPTH_OUTPUT(pDepthOutput, pOutputEnd, nLastValue);
+		}
+	}
+
+	if (bLastPart == true)
+	{
+		*pnOutputSize = (uint32_t)(pDepthOutput - pOutputOrig) * sizeof(uint16_t);
+		*pnActualRead = (uint32_t)GET_INPUT_READ_BYTES;
+	}
+	else
+	{
+		*pnOutputSize = (uint32_t)(pOutputLastPossibleStop - pOutputOrig) * sizeof(uint16_t);
+		*pnActualRead = (uint32_t)(pInputLastPossibleStop - pInputOrig) * sizeof(uint8_t);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnStreamUncompressDepthPS(const uint8_t* pInput, const uint32_t nInputSize,
+									const OniDepthPixel* pShiftToDepthTable, OniDepthPixel* pDepthOutput,
+									uint32_t* pnOutputSize, uint32_t* pnActualRead, bool bLastPart)
+{
+	if (g_bPSNibblePairs)
+	{
+		return XnStreamUncompressDepthPSPairs(pInput, nInputSize, pShiftToDepthTable, pDepthOutput, pnOutputSize, pnActualRead, bLastPart);
+	}
+	else
+	{
+		return XnStreamUncompressDepthPSScalar(pInput, nInputSize, pShiftToDepthTable, pDepthOutput, pnOutputSize, pnActualRead, bLastPart);
+	}
+}
+
 XnStatus XnStreamUncompressImageNew(const uint8_t* pInput, const uint32_t nInputSize,
 									uint8_t* pOutput, uint32_t* pnOutputSize, uint16_t nLineSize,
 									uint32_t* pnActualRead, bool bLastPart)
@@ -29,15 +29,44 @@
 //---------------------------------------------------------------------------
 // Defines
 //---------------------------------------------------------------------------
+/* XnPSNibblePair::nOutputs of pairs that must be decoded element by element. */
+#define XN_PS_NIBBLE_PAIR_ESCAPE 0xFF
+/* Largest number of outputs a single pair can hold (a run of 16). */
+#define XN_PS_NIBBLE_PAIR_MAX_OUTPUTS 16
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/* Decoding of two consecutive 4-bit elements of the PS compression (diffs, dummies, or a run). */
+typedef struct XnPSNibblePair
+{
+	/* Number of output values the pair holds, or XN_PS_NIBBLE_PAIR_ESCAPE. */
+	uint8_t nOutputs;
+	/* Diff to apply before the first output, and before the second one. Unused diffs are 0. */
+	int8_t anDiffs[2];
+} XnPSNibblePair;
 
 //---------------------------------------------------------------------------
 // Functions Declaration
 //---------------------------------------------------------------------------
+/* Returns a 256-entry table, indexed by a pair of elements (first element in the high 4 bits). When
+   bRunLengths is false, 0xe is not a run (as in image streams) and pairs containing it are escaped. */
+const XnPSNibblePair* XnStreamGetPSNibblePairs(bool bRunLengths);
+
+/* Selects between decoding diffs, dummies and runs a pair of elements at a time (the default), and decoding every
+   element on its own. Both give the same output, so this is only for comparing the two. */
+void XnStreamSetPSNibblePairsEnabled(bool bEnabled);
+bool XnStreamIsPSNibblePairsEnabled();
+
 XnStatus XnStreamUncompressImageNew(const uint8_t* pInput, const uint32_t nInputSize,
 									uint8_t* pOutput, uint32_t* pnOutputSize, uint16_t nLineSize,
 									uint32_t* pnActualRead, bool bLastPart);
 XnStatus XnStreamUncompressYUVImagePS(const uint8_t* pInput, const uint32_t nInputSize,
 									   uint8_t* pOutput, uint32_t* pnOutputSize, uint16_t nLineSize,
 									   uint32_t* pnActualRead, bool bLastPart);
+/* Decodes PS compressed shifts, converting them to depth with pShiftToDepthTable. */
+XnStatus XnStreamUncompressDepthPS(const uint8_t* pInput, const uint32_t nInputSize,
+									const OniDepthPixel* pShiftToDepthTable, OniDepthPixel* pDepthOutput,
+									uint32_t* pnOutputSize, uint32_t* pnActualRead, bool bLastPart);
 
 #endif // UNCOMP_H
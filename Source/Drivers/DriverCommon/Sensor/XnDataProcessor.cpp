@@ -31,6 +31,7 @@
 XnDataProcessor::XnDataProcessor(XnDevicePrivateData* pDevicePrivateData, const char* csName) :
 	m_pDevicePrivateData(pDevicePrivateData),
 	m_nBytesReceived(0),
+	m_nPacketsLost(0),
 	m_nLastPacketID(0),
 	m_csName(csName),
 	m_bUseHostTimestamps(false)
@@ -62,6 +63,7 @@ void XnDataProcessor::ProcessData(const XnSensorProtocolResponseHeader* pHeader,
 		if (pHeader->nPacketID != m_nLastPacketID+1 && pHeader->nPacketID != 0)
 		{
 			xnLogWarning(XN_MASK_SENSOR_PROTOCOL, "%s: Expected %x, got %x", m_csName, m_nLastPacketID+1, pHeader->nPacketID);
+			m_nPacketsLost += (uint16_t)(pHeader->nPacketID - m_nLastPacketID - 1);
 			OnPacketLost();
 		}
 
@@ -85,6 +85,8 @@ protected:
 	XnDevicePrivateData* m_pDevicePrivateData;
 	/* The number of bytes received so far (since last time this member was reset). */
 	uint32_t m_nBytesReceived;
+	/* The number of packets missing from the sequence so far (since last time this member was reset). */
+	uint32_t m_nPacketsLost;
 	/* Stores last packet ID */
 	uint16_t m_nLastPacketID;
 	/* The name of the stream. */
@@ -23,6 +23,7 @@
 //---------------------------------------------------------------------------
 #include "XnDepthProcessor.h"
 #include "XnSensor.h"
+#include <Formats/XnFormats.h>
 #include <XnProfiling.h>
 #include <XnLog.h>
 
@@ -39,8 +40,15 @@ XnDepthProcessor::XnDepthProcessor(XnSensorDepthStream* pStream, XnSensorStreamH
 	m_applyRegistrationOnEnd(false),
 	m_nExpectedFrameSize(0),
 	m_bShiftToDepthAllocated(false),
-	m_pShiftToDepthTable(pStream->GetShiftToDepthTable())
+	m_pShiftToDepthTable(pStream->GetShiftToDepthTable()),
+	m_bFilterOnEnd(false),
+	m_nFilterXRes(0),
+	m_nFilterYRes(0),
+	m_bDecimateOnEnd(false),
+	m_nDecimation(1),
+	m_decimationMethod(XN_DEPTH_DECIMATION_MIN_NONZERO)
 {
+	xnOSMemSet(&m_filterSettings, 0, sizeof(m_filterSettings));
 }
 
 XnDepthProcessor::~XnDepthProcessor()
@@ -98,6 +106,56 @@ void XnDepthProcessor::OnStartOfFrame(const XnSensorProtocolResponseHeader* pHea
 		GetStream()->m_DepthRegistration.GetValue() == true &&
 		GetStream()->m_FirmwareRegistration.GetValue() == false);
 
+	// registration always works on full resolution maps
+	uint32_t nRegistrationSize = GetStream()->GetXRes() * GetStream()->GetYRes() * sizeof(OniDepthPixel);
+	if (m_applyRegistrationOnEnd && m_RegistrationBuffer.GetMaxSize() < nRegistrationSize)
+	{
+		XnStatus nRetVal = m_RegistrationBuffer.Allocate(nRegistrationSize);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_SENSOR_PROTOCOL_DEPTH, "Failed to allocate registration buffer: %s", xnGetStatusString(nRetVal));
+			m_applyRegistrationOnEnd = false;
+			FrameIsCorrupted();
+		}
+	}
+
+	// post-filters work on depth values, and need the whole frame (neighbouring rows, and the previous frame)
+	UpdateFilterSettings();
+	m_bFilterOnEnd = (
+		(GetStream()->GetOutputFormat() == ONI_PIXEL_FORMAT_DEPTH_1_MM || GetStream()->GetOutputFormat() == ONI_PIXEL_FORMAT_DEPTH_100_UM) &&
+		m_FilterChain.IsEnabled());
+
+	// decimation shrinks the whole frame, once it was registered and filtered. It can't be combined with cropping
+	// (the stream makes sure of that), but firmware cropping may still be left over from an older setting.
+	OniCropping cropping;
+	bool bMirror;
+	GetStream()->GetSoftwareCroppingAndMirror(&cropping, &bMirror);
+	GetStream()->GetDepthDecimation(&m_nDecimation, &m_decimationMethod);
+	m_bDecimateOnEnd = (
+		(GetStream()->GetOutputFormat() == ONI_PIXEL_FORMAT_DEPTH_1_MM || GetStream()->GetOutputFormat() == ONI_PIXEL_FORMAT_DEPTH_100_UM) &&
+		m_nDecimation > 1 &&
+		GetStream()->m_FirmwareCropMode.GetValue() == XN_FIRMWARE_CROPPING_MODE_DISABLED &&
+		!cropping.enabled);
+
+	// crop and mirror each row as soon as it is written. When registering, filtering or decimating, rows are
+	// placed once the whole frame is ready.
+	uint32_t nXRes = GetStream()->GetXRes();
+	uint32_t nYRes = GetStream()->GetYRes();
+	if (GetStream()->m_FirmwareCropMode.GetValue() != XN_FIRMWARE_CROPPING_MODE_DISABLED)
+	{
+		nXRes = (uint32_t)GetStream()->m_FirmwareCropSizeX.GetValue();
+		nYRes = (uint32_t)GetStream()->m_FirmwareCropSizeY.GetValue();
+	}
+
+	SetRowPlacement(GetStream()->GetOutputFormat(), sizeof(OniDepthPixel), nXRes, nYRes, &cropping, bMirror, GetStream()->IsCroppingView());
+	if (m_applyRegistrationOnEnd || m_bFilterOnEnd || m_bDecimateOnEnd)
+	{
+		DeferRowPlacement();
+	}
+
+	m_nFilterXRes = nXRes;
+	m_nFilterYRes = nYRes;
+
 	if (m_pDevicePrivateData->FWInfo.nFWVer >= XN_SENSOR_FW_VER_5_1 && pHeader->nTimeStamp != 0)
 	{
 		// PATCH: starting with v5.1, the timestamp field of the SOF packet, is the number of pixels
@@ -133,6 +191,9 @@ void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeade
 		m_nPaddingPixelsOnEnd = 0 ;
 	}
 
+	// a corrupt frame keeps its full size, only a decimated one is reported at the lower resolution
+	bool bDecimated = false;
+
 	if (GetWriteBuffer()->GetSize() != GetExpectedSize())
 	{
 		xnLogWarning(XN_MASK_SENSOR_READ, "Read: Depth buffer is corrupt. Size is %u (!= %u)", GetWriteBuffer()->GetSize(), GetExpectedSize());
@@ -142,7 +203,24 @@ void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeade
 	{
 		if (m_applyRegistrationOnEnd)
 		{
-			GetStream()->ApplyRegistration((OniDepthPixel*)GetWriteBuffer()->GetData());
+			ApplyRegistration();
+		}
+		else if (m_bFilterOnEnd || m_bDecimateOnEnd)
+		{
+			OniDepthPixel* pDepth = (OniDepthPixel*)GetWriteBuffer()->GetData();
+			if (m_bFilterOnEnd)
+			{
+				ApplyFilters(pDepth, m_nFilterXRes, m_nFilterYRes);
+			}
+			if (IsRowPlacementEnabled())
+			{
+				PlaceFrameRows((const unsigned char*)pDepth);
+			}
+		}
+
+		if (m_bDecimateOnEnd)
+		{
+			bDecimated = (ApplyDecimation() == XN_STATUS_OK);
 		}
 	}
 
@@ -171,12 +249,107 @@ void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeade
 		pFrame->croppingEnabled = false;
 	}
 
+	if (bDecimated)
+	{
+		pFrame->videoMode.resolutionX /= m_nDecimation;
+		pFrame->videoMode.resolutionY /= m_nDecimation;
+		pFrame->width = pFrame->videoMode.resolutionX;
+		pFrame->height = pFrame->videoMode.resolutionY;
+	}
+
 	pFrame->stride = pFrame->width * GetStream()->GetBytesPerPixel();
 
 	// call base
 	XnFrameStreamProcessor::OnEndOfFrame(pHeader);
 }
 
+void XnDepthProcessor::ApplyRegistration()
+{
+	XN_PROFILING_START_SECTION("XnDepthProcessor::ApplyRegistration")
+
+	OniDepthPixel* pDepth = (OniDepthPixel*)GetWriteBuffer()->GetData();
+	OniDepthPixel* pRegistered = (OniDepthPixel*)m_RegistrationBuffer.GetData();
+
+	if (IsRowPlacementEnabled())
+	{
+		// registration writes to the side buffer, and each row goes from there straight to its final position
+		GetStream()->ApplyRegistration(pDepth, pRegistered);
+		if (m_bFilterOnEnd)
+		{
+			ApplyFilters(pRegistered, GetStream()->GetXRes(), GetStream()->GetYRes());
+		}
+		PlaceFrameRows((const unsigned char*)pRegistered);
+	}
+	else
+	{
+		xnOSMemCopy(pRegistered, pDepth, GetWriteBuffer()->GetSize());
+		GetStream()->ApplyRegistration(pRegistered, pDepth);
+		if (m_bFilterOnEnd)
+		{
+			ApplyFilters(pDepth, GetStream()->GetXRes(), GetStream()->GetYRes());
+		}
+	}
+
+	XN_PROFILING_END_SECTION
+}
+
+void XnDepthProcessor::UpdateFilterSettings()
+{
+	XnDepthFilterSettings settings;
+	GetStream()->GetDepthFilterSettings(&settings);
+	if (memcmp(&settings, &m_filterSettings, sizeof(settings)) == 0)
+	{
+		return;
+	}
+
+	m_filterSettings = settings;
+
+	// on failure, the chain still filters (on this thread only)
+	XnStatus nRetVal = m_FilterChain.SetSettings(settings);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_SENSOR_PROTOCOL_DEPTH, "Failed to apply depth filter settings: %s", xnGetStatusString(nRetVal));
+	}
+}
+
+void XnDepthProcessor::ApplyFilters(OniDepthPixel* pDepth, uint32_t nXRes, uint32_t nYRes)
+{
+	XN_PROFILING_START_SECTION("XnDepthProcessor::ApplyFilters")
+
+	XnStatus nRetVal = m_FilterChain.Apply(pDepth, nXRes, nYRes);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_SENSOR_PROTOCOL_DEPTH, "Failed to filter depth frame: %s", xnGetStatusString(nRetVal));
+	}
+
+	XN_PROFILING_END_SECTION
+}
+
+XnStatus XnDepthProcessor::ApplyDecimation()
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_PROFILING_START_SECTION("XnDepthProcessor::ApplyDecimation")
+
+	// frame rows are already in their final place, so the frame is shrunk in place
+	uint32_t nXRes = GetStream()->GetXRes();
+	uint32_t nYRes = GetStream()->GetYRes();
+	nRetVal = XnFormatsDecimateDepth(m_decimationMethod, m_nDecimation, (OniDepthPixel*)GetWriteBuffer()->GetData(), nXRes, nYRes);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_SENSOR_PROTOCOL_DEPTH, "Failed to decimate depth frame: %s", xnGetStatusString(nRetVal));
+	}
+	else
+	{
+		// the buffer manager takes the frame size from the write buffer
+		GetWriteBuffer()->UnsafeSetSize((nXRes / m_nDecimation) * (nYRes / m_nDecimation) * sizeof(OniDepthPixel));
+	}
+
+	XN_PROFILING_END_SECTION
+
+	return (nRetVal);
+}
+
 void XnDepthProcessor::PadPixels(uint32_t nPixels)
 {
 	XnBuffer* pWriteBuffer = GetWriteBuffer();
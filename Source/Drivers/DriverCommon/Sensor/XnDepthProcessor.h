@@ -72,6 +72,11 @@ protected:
 		return m_pShiftToDepthTable[nShift];
 	}
 
+	inline const OniDepthPixel* GetShiftToDepthTable()
+	{
+		return m_pShiftToDepthTable;
+	}
+
 	inline uint32_t GetExpectedSize()
 	{
 		return m_nExpectedFrameSize;
@@ -80,6 +85,10 @@ protected:
 private:
 	void PadPixels(uint32_t nPixels);
 	uint32_t CalculateExpectedSize();
+	void ApplyRegistration();
+	void UpdateFilterSettings();
+	void ApplyFilters(OniDepthPixel* pDepth, uint32_t nXRes, uint32_t nYRes);
+	XnStatus ApplyDecimation();
 
 	uint32_t m_nPaddingPixelsOnEnd;
 	bool m_applyRegistrationOnEnd;
@@ -87,6 +96,18 @@ private:
 	bool m_bShiftToDepthAllocated;
 	OniDepthPixel* m_pShiftToDepthTable;
 	OniDepthPixel m_noDepthValue;
+	XnBuffer m_RegistrationBuffer;
+
+	XnDepthFilterChain m_FilterChain;
+	/* Settings last requested from the filter chain, so a failure is only reported once. */
+	XnDepthFilterSettings m_filterSettings;
+	bool m_bFilterOnEnd;
+	uint32_t m_nFilterXRes;
+	uint32_t m_nFilterYRes;
+
+	bool m_bDecimateOnEnd;
+	uint32_t m_nDecimation;
+	XnDepthDecimationMethod m_decimationMethod;
 };
 
 #endif // XNDEPTHPROCESSOR_H
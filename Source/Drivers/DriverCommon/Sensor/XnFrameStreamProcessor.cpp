@@ -24,6 +24,8 @@
 #include "XnFrameStreamProcessor.h"
 #include "XnSensor.h"
 #include <XnProfiling.h>
+#include <Formats/XnFormats.h>
+#include <DDK/XnPixelStream.h>
 
 //---------------------------------------------------------------------------
 // Code
@@ -38,8 +40,19 @@ XnFrameStreamProcessor::XnFrameStreamProcessor(XnFrameStream* pStream, XnSensorS
 	m_bFrameCorrupted(false),
 	m_bAllowDoubleSOF(false),
 	m_nLastSOFPacketID(0),
-	m_nFirstPacketTimestamp(0)
+	m_nFirstPacketTimestamp(0),
+	m_nFrameArrivalTime(0),
+	m_bPlaceRows(false),
+	m_bDeferRowPlacement(false),
+	m_placementFormat(ONI_PIXEL_FORMAT_DEPTH_1_MM),
+	m_nPlacementBytesPerPixel(0),
+	m_nPlacementXRes(0),
+	m_nPlacementYRes(0),
+	m_bPlacementMirror(false),
+	m_bPlacementView(false),
+	m_nPlacedRows(0)
 {
+	xnOSMemSet(&m_placementCropping, 0, sizeof(m_placementCropping));
 	sprintf(m_csInDumpMask, "%sIn", pStream->GetType());
 	sprintf(m_csInternalDumpMask, "Internal%s", pStream->GetType());
 	m_InDump = xnDumpFileOpen(m_csInDumpMask, "%s_0.raw", m_csInDumpMask);
@@ -70,6 +83,11 @@ void XnFrameStreamProcessor::ProcessPacketChunk(const XnSensorProtocolResponseHe
 	{
 		xnDumpFileWriteBuffer(m_InDump, pData, nDataSize);
 		ProcessFramePacketChunk(pHeader, pData, nDataOffset, nDataSize);
+
+		if (m_bPlaceRows && !m_bDeferRowPlacement)
+		{
+			PlaceCompletedRows();
+		}
 	}
 
 	// if last data from EOF packet
@@ -89,21 +107,34 @@ void XnFrameStreamProcessor::OnPacketLost()
 void XnFrameStreamProcessor::OnStartOfFrame(const XnSensorProtocolResponseHeader* /*pHeader*/)
 {
 	m_bFrameCorrupted = false;
+	m_bPlaceRows = false;
+	m_bDeferRowPlacement = false;
+	GetStream()->SetFramePostProcessed(NULL);
 	m_pTripleBuffer->GetWriteBuffer()->Reset();
 	if (m_pDevicePrivateData->pSensor->ShouldUseHostTimestamps())
 	{
 		m_nFirstPacketTimestamp = GetHostTimestamp();
 	}
+
+	xnOSGetHighResTimeStamp(&m_nFrameArrivalTime);
+	GetStream()->ReportFrameStarted(m_nFrameArrivalTime);
 }
 
 void XnFrameStreamProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader)
 {
+	if (m_bPlaceRows && !m_bFrameCorrupted)
+	{
+		FinishRowPlacement();
+	}
+
 	// write dump
 	XnBuffer* pCurWriteBuffer = m_pTripleBuffer->GetWriteBuffer();
 	xnDumpFileWriteBuffer(m_InternalDump, pCurWriteBuffer->GetData(), pCurWriteBuffer->GetSize());
 	xnDumpFileClose(m_InternalDump);
 	xnDumpFileClose(m_InDump);
 
+	GetStream()->ReportFrameEnded(m_nBytesReceived, m_nPacketsLost, m_bFrameCorrupted);
+
 	if (!m_bFrameCorrupted)
 	{
 		// mark the buffer as stable
@@ -144,6 +175,7 @@ void XnFrameStreamProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader*
 	m_InDump = xnDumpFileOpen(m_csInDumpMask, "%s_%d.raw", m_csInDumpMask, GetCurrentFrameID());
 	m_InternalDump = xnDumpFileOpen(m_csInternalDumpMask, "%s_%d.raw", m_csInternalDumpMask, GetCurrentFrameID());
 	m_nBytesReceived = 0;
+	m_nPacketsLost = 0;
 }
 
 void XnFrameStreamProcessor::FrameIsCorrupted()
@@ -161,3 +193,168 @@ void XnFrameStreamProcessor::WriteBufferOverflowed()
 	xnLogWarning(XN_MASK_SENSOR_PROTOCOL, "%s Frame Buffer overflow! current size: %d", m_csName, pBuffer->GetSize());
 	FrameIsCorrupted();
 }
+
+void XnFrameStreamProcessor::SetRowPlacement(OniPixelFormat format, uint32_t nBytesPerPixel, uint32_t nXRes, uint32_t nYRes, const OniCropping* pCropping, bool bMirror, bool bCroppingView)
+{
+	m_bPlaceRows = false;
+
+	bool bCrop = (pCropping != NULL && pCropping->enabled);
+	if (!bCrop && !bMirror)
+	{
+		// nothing to do
+		return;
+	}
+
+	if (bCrop && bCroppingView && !bMirror)
+	{
+		// rows stay where they are. The stream only has to publish the view.
+		return;
+	}
+
+	if (bCrop && ((uint32_t)(pCropping->originX + pCropping->width) > nXRes || (uint32_t)(pCropping->originY + pCropping->height) > nYRes))
+	{
+		// leave it to the stream (which will fail and drop the frame)
+		return;
+	}
+
+	uint32_t nLineSize = nXRes * nBytesPerPixel;
+	if (bMirror && m_PlacementLine.GetMaxSize() < nLineSize)
+	{
+		XnStatus nRetVal = m_PlacementLine.Allocate(nLineSize);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_SENSOR_PROTOCOL, "%s: failed to allocate line buffer (%s). Cropping and mirroring will be done by the stream.", m_csName, xnGetStatusString(nRetVal));
+			return;
+		}
+	}
+
+	m_placementFormat = format;
+	m_nPlacementBytesPerPixel = nBytesPerPixel;
+	m_nPlacementXRes = nXRes;
+	m_nPlacementYRes = nYRes;
+	m_bPlacementMirror = bMirror;
+	m_bPlacementView = (bCrop && bCroppingView);
+	m_nPlacedRows = 0;
+
+	if (bCrop)
+	{
+		m_placementCropping = *pCropping;
+	}
+	else
+	{
+		m_placementCropping.enabled = false;
+		m_placementCropping.originX = 0;
+		m_placementCropping.originY = 0;
+		m_placementCropping.width = nXRes;
+		m_placementCropping.height = nYRes;
+	}
+
+	m_bPlaceRows = true;
+}
+
+void XnFrameStreamProcessor::PlaceRow(const unsigned char* pSrc, unsigned char* pDst)
+{
+	uint32_t nRowBytes = m_placementCropping.width * m_nPlacementBytesPerPixel;
+
+	if (!m_bPlacementMirror)
+	{
+		if (pDst != pSrc)
+		{
+			xnOSMemMove(pDst, pSrc, nRowBytes);
+		}
+	}
+	else if (pDst + nRowBytes <= pSrc || pSrc + nRowBytes <= pDst)
+	{
+		XnFormatsMirrorLine(m_placementFormat, pSrc, pDst, m_placementCropping.width);
+	}
+	else
+	{
+		// source and destination overlap. Go through the line buffer (the row is hot in cache anyway).
+		XnFormatsMirrorLine(m_placementFormat, pSrc, m_PlacementLine.GetData(), m_placementCropping.width);
+		xnOSMemCopy(pDst, m_PlacementLine.GetData(), nRowBytes);
+	}
+}
+
+uint32_t XnFrameStreamProcessor::GetPlacementOffset(uint32_t nRow)
+{
+	if (m_bPlacementView)
+	{
+		// rows keep their place in the full frame
+		return (nRow * m_nPlacementXRes + m_placementCropping.originX) * m_nPlacementBytesPerPixel;
+	}
+	else
+	{
+		return (nRow - m_placementCropping.originY) * m_placementCropping.width * m_nPlacementBytesPerPixel;
+	}
+}
+
+void XnFrameStreamProcessor::PlaceCompletedRows()
+{
+	// NOTE: rows are compacted in place. The destination of a row never goes beyond the end of its source,
+	// so rows that were not written yet are never touched.
+	uint32_t nLineSize = m_nPlacementXRes * m_nPlacementBytesPerPixel;
+	uint32_t nCompletedRows = XN_MIN(GetWriteBuffer()->GetSize() / nLineSize, m_nPlacementYRes);
+	uint32_t nFirstRow = (uint32_t)m_placementCropping.originY;
+	uint32_t nLastRow = nFirstRow + (uint32_t)m_placementCropping.height;
+	unsigned char* pData = GetWriteBuffer()->GetData();
+
+	for (; m_nPlacedRows < nCompletedRows; ++m_nPlacedRows)
+	{
+		uint32_t y = m_nPlacedRows;
+		if (y < nFirstRow || y >= nLastRow)
+		{
+			continue;
+		}
+
+		PlaceRow(pData + y * nLineSize + m_placementCropping.originX * m_nPlacementBytesPerPixel, pData + GetPlacementOffset(y));
+	}
+}
+
+void XnFrameStreamProcessor::PlaceFrameRows(const unsigned char* pSource)
+{
+	XN_ASSERT(m_bPlaceRows);
+
+	uint32_t nLineSize = m_nPlacementXRes * m_nPlacementBytesPerPixel;
+	unsigned char* pData = GetWriteBuffer()->GetData();
+
+	const unsigned char* pSrc = pSource + m_placementCropping.originY * nLineSize + m_placementCropping.originX * m_nPlacementBytesPerPixel;
+	for (uint32_t y = m_placementCropping.originY; y < (uint32_t)(m_placementCropping.originY + m_placementCropping.height); ++y)
+	{
+		PlaceRow(pSrc, pData + GetPlacementOffset(y));
+		pSrc += nLineSize;
+	}
+
+	m_nPlacedRows = m_nPlacementYRes;
+}
+
+void XnFrameStreamProcessor::FinishRowPlacement()
+{
+	// place whatever was written since the last chunk (some processors only write at end-of-frame)
+	if (m_nPlacedRows < m_nPlacementYRes)
+	{
+		PlaceCompletedRows();
+	}
+
+	OniFrame* pFrame = GetWriteFrame();
+	if (m_bPlacementView)
+	{
+		// the buffer manager takes the frame size from the write buffer
+		XnPixelStream::SetCroppingView(pFrame, &m_placementCropping, m_nPlacementBytesPerPixel);
+		GetWriteBuffer()->UnsafeSetSize(pFrame->dataSize);
+	}
+	else if (m_placementCropping.enabled)
+	{
+		uint32_t nRowBytes = m_placementCropping.width * m_nPlacementBytesPerPixel;
+		GetWriteBuffer()->UnsafeSetSize(nRowBytes * m_placementCropping.height);
+
+		pFrame->width = m_placementCropping.width;
+		pFrame->height = m_placementCropping.height;
+		pFrame->cropOriginX = m_placementCropping.originX;
+		pFrame->cropOriginY = m_placementCropping.originY;
+		pFrame->croppingEnabled = true;
+		pFrame->stride = nRowBytes;
+	}
+
+	// let the stream know it doesn't have to crop or mirror this frame
+	GetStream()->SetFramePostProcessed(pFrame);
+}
@@ -159,7 +159,43 @@ protected:
 
 	void SetAllowDoubleSOFPackets(bool bAllow) { m_bAllowDoubleSOF = bAllow; }
 
+	/*
+	* Fuses software cropping and mirroring into the writing of the current frame: every row is moved to its
+	* final position as soon as the processor completes it in the write buffer (while it is still in cache),
+	* instead of the stream cropping and mirroring the whole frame afterwards. Should be called from
+	* OnStartOfFrame(), and only by processors that write the frame in raster order.
+	*
+	* @param	format			[in]	The pixel format written to the write buffer.
+	* @param	nBytesPerPixel	[in]	Size of a pixel, in bytes.
+	* @param	nXRes			[in]	Number of pixels in each written row.
+	* @param	nYRes			[in]	Number of rows in a frame.
+	* @param	pCropping		[in]	Cropping to apply. Ignored if not enabled.
+	* @param	bMirror			[in]	TRUE to mirror the rows.
+	* @param	bCroppingView	[in]	TRUE to leave rows where they are and publish a view of the cropped area.
+	*/
+	void SetRowPlacement(OniPixelFormat format, uint32_t nBytesPerPixel, uint32_t nXRes, uint32_t nYRes, const OniCropping* pCropping, bool bMirror, bool bCroppingView);
+
+	/*
+	* Suspends placing rows while the frame is being written. The rows are then expected to be placed
+	* at once using PlaceFrameRows().
+	*/
+	inline void DeferRowPlacement() { m_bDeferRowPlacement = true; }
+
+	inline bool IsRowPlacementEnabled() const { return m_bPlaceRows; }
+
+	/*
+	* Places the rows of a complete frame, read from another buffer, in the write buffer.
+	*
+	* @param	pSource		[in]	A full (uncropped) frame, in the format set by SetRowPlacement().
+	*/
+	void PlaceFrameRows(const unsigned char* pSource);
+
 private:
+	void PlaceCompletedRows();
+	void PlaceRow(const unsigned char* pSrc, unsigned char* pDst);
+	uint32_t GetPlacementOffset(uint32_t nRow);
+	void FinishRowPlacement();
+
 	//---------------------------------------------------------------------------
 	// Class Members
 	//---------------------------------------------------------------------------
@@ -178,6 +214,21 @@ private:
 	bool m_bAllowDoubleSOF;
 	uint16_t m_nLastSOFPacketID;
 	uint64_t m_nFirstPacketTimestamp;
+	/* Host time the first packet of current frame arrived at (for telemetry). */
+	uint64_t m_nFrameArrivalTime;
+
+	/* Fused cropping and mirroring of the current frame (see SetRowPlacement()). */
+	bool m_bPlaceRows;
+	bool m_bDeferRowPlacement;
+	OniPixelFormat m_placementFormat;
+	uint32_t m_nPlacementBytesPerPixel;
+	uint32_t m_nPlacementXRes;
+	uint32_t m_nPlacementYRes;
+	OniCropping m_placementCropping;
+	bool m_bPlacementMirror;
+	bool m_bPlacementView;
+	uint32_t m_nPlacedRows;
+	XnBuffer m_PlacementLine;
 };
 
 #endif // XNFRAMESTREAMPROCESSOR_H
@@ -24,6 +24,7 @@
 #include "XnIRProcessor.h"
 #include <XnProfiling.h>
 #include "XnSensor.h"
+#include <Formats/XnFormats.h>
 
 //---------------------------------------------------------------------------
 // Defines
@@ -31,8 +32,8 @@
 
 /* The size of an input element for unpacking. */
 #define XN_INPUT_ELEMENT_SIZE 5
-/* The size of an output element for unpacking. */
-#define XN_OUTPUT_ELEMENT_SIZE 8
+/* The number of pixels in an input element. */
+#define XN_OUTPUT_ELEMENT_PIXELS 4
 
 //---------------------------------------------------------------------------
 // Code
@@ -61,9 +62,8 @@ XnStatus XnIRProcessor::Init()
 	switch (GetStream()->GetOutputFormat())
 	{
 	case ONI_PIXEL_FORMAT_GRAY16:
-		break;
+	case ONI_PIXEL_FORMAT_GRAY8:
 	case ONI_PIXEL_FORMAT_RGB888:
-		XN_VALIDATE_BUFFER_ALLOCATE(m_UnpackedBuffer, GetExpectedOutputSize());
 		break;
 	default:
 		assert(0);
@@ -73,13 +73,10 @@ XnStatus XnIRProcessor::Init()
 	return (XN_STATUS_OK);
 }
 
-XnStatus XnIRProcessor::Unpack10to16(const uint8_t* pcInput, const uint32_t nInputSize, uint16_t* pnOutput, uint32_t* pnActualRead, uint32_t* pnOutputSize)
+XnStatus XnIRProcessor::Unpack10(const uint8_t* pcInput, const uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnActualRead, uint32_t* pnOutputSize)
 {
-	int32_t cInput = 0;
-	const uint8_t* pOrigInput = pcInput;
-
 	uint32_t nElements = nInputSize / XN_INPUT_ELEMENT_SIZE; // floored
-	uint32_t nNeededOutput = nElements * XN_OUTPUT_ELEMENT_SIZE;
+	uint32_t nNeededOutput = nElements * XN_OUTPUT_ELEMENT_PIXELS * GetStream()->GetBytesPerPixel();
 
 	*pnActualRead = 0;
 
@@ -89,51 +86,11 @@ XnStatus XnIRProcessor::Unpack10to16(const uint8_t* pcInput, const uint32_t nInp
 		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
 	}
 
-	// Convert the 10bit packed data into 16bit shorts
-
-	for (uint32_t nElem = 0; nElem < nElements; ++nElem)
-	{
-		//1a
-		cInput = *pcInput;
-		*pnOutput = (cInput & 0xFF) << 2;
-
-		//1b
-		pcInput++;
-		cInput = *pcInput;
-		*pnOutput = *pnOutput | ((cInput & 0xC0) >> 6);
-		pnOutput++;
-
-		//2a
-		*pnOutput = (cInput & 0x3F) << 4;
-
-		//2b
-		pcInput++;
-		cInput = *pcInput;
-		*pnOutput = *pnOutput | ((cInput & 0xF0) >> 4);
-		pnOutput++;
-
-		//3a
-		*pnOutput = (cInput & 0x0F) << 6;
-
-		//3b
-		pcInput++;
-		cInput = *pcInput;
-		*pnOutput = *pnOutput | ((cInput & 0xFC) >> 2);
-		pnOutput++;
-
-		//4a
-		*pnOutput = (cInput & 0x3) << 8;
-
-		//4b
-		pcInput++;
-		cInput = *pcInput;
-		*pnOutput = *pnOutput | (cInput & 0xFF);
-		pnOutput++;
-
-		pcInput++;
-	}
+	// Convert the 10bit packed data straight into the output format
+	XnStatus nRetVal = XnFormatsUnpack10Bit(GetStream()->GetOutputFormat(), pcInput, nElements, pOutput);
+	XN_IS_STATUS_OK(nRetVal);
 
-	*pnActualRead = (uint32_t)(pcInput - pOrigInput);
+	*pnActualRead = nElements * XN_INPUT_ELEMENT_SIZE;
 	*pnOutputSize = nNeededOutput;
 	return XN_STATUS_OK;
 }
@@ -142,9 +99,8 @@ void XnIRProcessor::ProcessFramePacketChunk(const XnSensorProtocolResponseHeader
 {
 	XN_PROFILING_START_SECTION("XnIRProcessor::ProcessFramePacketChunk")
 
-	// if output format is Gray16, we can write directly to output buffer. otherwise, we need
-	// to write to a temp buffer.
-	XnBuffer* pWriteBuffer = (GetStream()->GetOutputFormat() == ONI_PIXEL_FORMAT_GRAY16) ? GetWriteBuffer() : &m_UnpackedBuffer;
+	// pixels are unpacked straight into the output format
+	XnBuffer* pWriteBuffer = GetWriteBuffer();
 
 	if (m_ContinuousBuffer.GetSize() != 0)
 	{
@@ -159,7 +115,7 @@ void XnIRProcessor::ProcessFramePacketChunk(const XnSensorProtocolResponseHeader
 			// process it
 			uint32_t nActualRead = 0;
 			uint32_t nOutputSize = pWriteBuffer->GetFreeSpaceInBuffer();
-			if (XN_STATUS_OK != Unpack10to16(m_ContinuousBuffer.GetData(), XN_INPUT_ELEMENT_SIZE, (uint16_t*)pWriteBuffer->GetUnsafeWritePointer(), &nActualRead, &nOutputSize))
+			if (XN_STATUS_OK != Unpack10(m_ContinuousBuffer.GetData(), XN_INPUT_ELEMENT_SIZE, pWriteBuffer->GetUnsafeWritePointer(), &nActualRead, &nOutputSize))
 				WriteBufferOverflowed();
 			else
 				pWriteBuffer->UnsafeUpdateSize(nOutputSize);
@@ -170,7 +126,7 @@ void XnIRProcessor::ProcessFramePacketChunk(const XnSensorProtocolResponseHeader
 
 	uint32_t nActualRead = 0;
 	uint32_t nOutputSize = pWriteBuffer->GetFreeSpaceInBuffer();
-	if (XN_STATUS_OK != Unpack10to16(pData, nDataSize, (uint16_t*)pWriteBuffer->GetUnsafeWritePointer(), &nActualRead, &nOutputSize))
+	if (XN_STATUS_OK != Unpack10(pData, nDataSize, pWriteBuffer->GetUnsafeWritePointer(), &nActualRead, &nOutputSize))
 	{
 		WriteBufferOverflowed();
 	}
@@ -193,25 +149,6 @@ void XnIRProcessor::ProcessFramePacketChunk(const XnSensorProtocolResponseHeader
 	XN_PROFILING_END_SECTION
 }
 
-void IRto888(uint16_t* pInput, uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnOutputSize)
-{
-	uint16_t* pInputEnd = pInput + nInputSize;
-	uint8_t* pOutputOrig = pOutput;
-	uint8_t* pOutputEnd = pOutput + *pnOutputSize;
-
-	while (pInput != pInputEnd && pOutput < pOutputEnd)
-	{
-		*pOutput = (uint8_t)((*pInput)>>2);
-		*(pOutput+1) = *pOutput;
-		*(pOutput+2) = *pOutput;
-
-		pOutput+=3;
-		pInput++;
-	}
-
-	*pnOutputSize = (uint32_t)(pOutput - pOutputOrig);
-}
-
 void XnIRProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader)
 {
 	XN_PROFILING_START_SECTION("XnIRProcessor::OnEndOfFrame")
@@ -223,24 +160,6 @@ void XnIRProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader)
 		FrameIsCorrupted();
 	}
 
-	// if data was written to temp buffer, convert it now
-	switch (GetStream()->GetOutputFormat())
-	{
-	case ONI_PIXEL_FORMAT_GRAY16:
-		break;
-	case ONI_PIXEL_FORMAT_RGB888:
-		{
-			uint32_t nOutputSize = GetWriteBuffer()->GetFreeSpaceInBuffer();
-			IRto888((uint16_t*)m_UnpackedBuffer.GetData(), m_UnpackedBuffer.GetSize() / sizeof(uint16_t), GetWriteBuffer()->GetUnsafeWritePointer(), &nOutputSize);
-			GetWriteBuffer()->UnsafeUpdateSize(nOutputSize);
-			m_UnpackedBuffer.Reset();
-		}
-		break;
-	default:
-		assert(0);
-		return;
-	}
-
 	// calculate expected size
 	uint32_t width = GetStream()->GetXRes();
 	uint32_t height = GetStream()->GetYRes();
@@ -51,7 +51,7 @@ private:
 	//---------------------------------------------------------------------------
 	// Internal Functions
 	//---------------------------------------------------------------------------
-	XnStatus Unpack10to16(const uint8_t* pcInput, const uint32_t nInputSize, uint16_t* pnOutput, uint32_t* pnActualRead, uint32_t* pnOutputSize);
+	XnStatus Unpack10(const uint8_t* pcInput, const uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnActualRead, uint32_t* pnOutputSize);
 	inline XnSensorIRStream* GetStream()
 	{
 		return (XnSensorIRStream*)XnFrameStreamProcessor::GetStream();
@@ -62,7 +62,6 @@ private:
 	//---------------------------------------------------------------------------
 	/* A buffer to store bytes till we have enough to unpack. */
 	XnBuffer m_ContinuousBuffer;
-	XnBuffer m_UnpackedBuffer;
 	uint64_t m_nRefTimestamp; // needed for firmware bug workaround
 	XnDepthCMOSType m_DepthCMOSType;
 };
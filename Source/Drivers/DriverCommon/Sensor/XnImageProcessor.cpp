@@ -87,6 +87,21 @@ uint32_t XnImageProcessor::CalculateExpectedSize()
 	return nExpectedDepthBufferSize;
 }
 
+void XnImageProcessor::OnStartOfFrame(const XnSensorProtocolResponseHeader* pHeader)
+{
+	// call base
+	XnFrameStreamProcessor::OnStartOfFrame(pHeader);
+
+	// crop and mirror each row as soon as it is written (compressed output can't be handled in software anyway)
+	if (!m_bCompressedOutput && GetStream()->GetOutputFormat() != ONI_PIXEL_FORMAT_JPEG)
+	{
+		OniCropping cropping;
+		bool bMirror;
+		GetStream()->GetSoftwareCroppingAndMirror(&cropping, &bMirror);
+		SetRowPlacement(GetStream()->GetOutputFormat(), GetStream()->GetBytesPerPixel(), GetActualXRes(), GetActualYRes(), &cropping, bMirror, GetStream()->IsCroppingView());
+	}
+}
+
 void XnImageProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader)
 {
 	if (!m_bCompressedOutput)
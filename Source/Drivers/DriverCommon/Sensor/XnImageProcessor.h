@@ -42,6 +42,7 @@ protected:
 	//---------------------------------------------------------------------------
 	// Overridden Functions
 	//---------------------------------------------------------------------------
+	virtual void OnStartOfFrame(const XnSensorProtocolResponseHeader* pHeader);
 	virtual void OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader);
 	virtual void OnFrameReady(uint32_t nFrameID, uint64_t nFrameTS);
 
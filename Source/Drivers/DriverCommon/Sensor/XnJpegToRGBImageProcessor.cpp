@@ -31,6 +31,10 @@
 XnJpegToRGBImageProcessor::XnJpegToRGBImageProcessor(XnSensorImageStream* pStream, XnSensorStreamHelper* pHelper, XnFrameBufferManager* pBufferManager)
 : XnImageProcessor(pStream, pHelper, pBufferManager)
 , mp_JPEGContext(NULL)
+, m_bDecodeFailed(false)
+, m_bFastDCT(false)
+, m_bFancyUpsampling(true)
+, m_nDecodeThreads(0)
 {
 	SetAllowDoubleSOFPackets(true);
 }
@@ -65,12 +69,24 @@ void XnJpegToRGBImageProcessor::ProcessFramePacketChunk(const XnSensorProtocolRe
 		xnLogWarning(XN_MASK_SENSOR_PROTOCOL_IMAGE, "Bad overflow image! %d", m_RawData.GetSize());
 		FrameIsCorrupted();
 		m_RawData.Reset();
+		m_bDecodeFailed = true;
 	}
 	else
 	{
 		m_RawData.UnsafeWrite(pData, nDataSize);
 	}
 
+	// decode whatever can be decoded so far, so that only the last scanlines are left for the end of the frame
+	// (parallel decoding needs the whole frame)
+	if (!m_bDecodeFailed && m_nDecodeThreads <= 1)
+	{
+		XnStatus nRetVal = XnStreamContinueUncompressImageJ(&mp_JPEGContext, m_RawData.GetData(), m_RawData.GetSize());
+		if (nRetVal != XN_STATUS_OK)
+		{
+			m_bDecodeFailed = true;
+		}
+	}
+
 	XN_PROFILING_END_SECTION
 }
 
@@ -78,6 +94,30 @@ void XnJpegToRGBImageProcessor::OnStartOfFrame(const XnSensorProtocolResponseHea
 {
 	XnImageProcessor::OnStartOfFrame(pHeader);
 	m_RawData.Reset();
+	m_bDecodeFailed = false;
+
+	// pick up decoder options
+	XnSensorImageStream* pStream = GetStream();
+	if (pStream->IsJpegFastDCT() != m_bFastDCT || pStream->IsJpegFancyUpsampling() != m_bFancyUpsampling || pStream->GetJpegDecodeThreads() != m_nDecodeThreads)
+	{
+		m_bFastDCT = pStream->IsJpegFastDCT();
+		m_bFancyUpsampling = pStream->IsJpegFancyUpsampling();
+		m_nDecodeThreads = pStream->GetJpegDecodeThreads();
+
+		XnStatus nRetVal = XnStreamSetUncompressImageJOptions(&mp_JPEGContext, m_bFastDCT, m_bFancyUpsampling, m_nDecodeThreads);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_SENSOR_PROTOCOL_IMAGE, "Failed to set JPEG decoder options: %s", xnGetStatusString(nRetVal));
+			m_nDecodeThreads = 0;
+		}
+	}
+
+	if (m_nDecodeThreads <= 1)
+	{
+		XnBuffer* pWriteBuffer = GetWriteBuffer();
+		XnStatus nRetVal = XnStreamStartUncompressImageJ(&mp_JPEGContext, pWriteBuffer->GetUnsafeWritePointer(), pWriteBuffer->GetMaxSize());
+		m_bDecodeFailed = (nRetVal != XN_STATUS_OK);
+	}
 }
 
 void XnJpegToRGBImageProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader)
@@ -86,8 +126,19 @@ void XnJpegToRGBImageProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeade
 
 	XnBuffer* pWriteBuffer = GetWriteBuffer();
 
-	uint32_t nOutputSize = pWriteBuffer->GetMaxSize();
-	XnStatus nRetVal = XnStreamUncompressImageJ(&mp_JPEGContext, m_RawData.GetData(), m_RawData.GetSize(), pWriteBuffer->GetUnsafeWritePointer(), &nOutputSize);
+	uint32_t nOutputSize = 0;
+	XnStatus nRetVal = XN_STATUS_ERROR;
+	if (!m_bDecodeFailed && m_nDecodeThreads > 1)
+	{
+		nOutputSize = pWriteBuffer->GetMaxSize();
+		nRetVal = XnStreamUncompressImageJ(&mp_JPEGContext, m_RawData.GetData(), m_RawData.GetSize(), pWriteBuffer->GetUnsafeWritePointer(), &nOutputSize);
+	}
+	else if (!m_bDecodeFailed)
+	{
+		// most of the frame was already decoded as its packets arrived
+		nRetVal = XnStreamFinishUncompressImageJ(&mp_JPEGContext, m_RawData.GetData(), m_RawData.GetSize(), &nOutputSize);
+	}
+
 	if (nRetVal != XN_STATUS_OK)
 	{
 		xnLogWarning(XN_MASK_SENSOR_PROTOCOL_IMAGE, "Failed to uncompress JPEG for frame %d: %s (%d)\n", GetCurrentFrameID(), xnGetStatusString(nRetVal), pWriteBuffer->GetSize());
@@ -53,6 +53,13 @@ protected:
 private:
 	XnBuffer m_RawData;
 	XnStreamUncompJPEGContext* mp_JPEGContext;
+	// decoding of the current frame failed (packets are still collected, for dumping the bad image)
+	bool m_bDecodeFailed;
+
+	// decoder options currently set (from the stream properties)
+	bool m_bFastDCT;
+	bool m_bFancyUpsampling;
+	uint32_t m_nDecodeThreads;
 };
 
 #endif // XNJPEGTORGBIMAGEPROCESSOR_H
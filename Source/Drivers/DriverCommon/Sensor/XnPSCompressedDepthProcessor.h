@@ -46,13 +46,6 @@ protected:
 	virtual void OnStartOfFrame(const XnSensorProtocolResponseHeader* pHeader);
 	virtual void OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader);
 
-	//---------------------------------------------------------------------------
-	// Internal Functions
-	//---------------------------------------------------------------------------
-	XnStatus UncompressDepthPS(const uint8_t* pInput, const uint32_t nInputSize,
-		uint16_t* pDepthOutput, uint32_t* pnOutputSize,
-		uint32_t* pnActualRead, bool bLastPart);
-
 private:
 	//---------------------------------------------------------------------------
 	// Class Members
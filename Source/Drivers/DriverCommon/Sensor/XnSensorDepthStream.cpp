@@ -76,6 +76,14 @@ XnSensorDepthStream::XnSensorDepthStream(const char* strName, XnSensorObjects* p
 	m_GMCDebug(XN_STREAM_PROPERTY_GMC_DEBUG, "GMCDebug", XN_DEPTH_STREAM_DEFAULT_GMC_DEBUG),
 	m_WavelengthCorrection(XN_STREAM_PROPERTY_WAVELENGTH_CORRECTION, "WavelengthCorrection", XN_DEPTH_STREAM_DEFAULT_WAVELENGTH_CORRECTION),
 	m_WavelengthCorrectionDebug(XN_STREAM_PROPERTY_WAVELENGTH_CORRECTION_DEBUG, "WavelengthCorrectionDebug", XN_DEPTH_STREAM_DEFAULT_WAVELENGTH_CORRECTION_DEBUG),
+	m_DepthFilterHoleFill(XN_STREAM_PROPERTY_DEPTH_FILTER_HOLE_FILL, "DepthFilterHoleFill", 0),
+	m_DepthFilterSpatialDelta(XN_STREAM_PROPERTY_DEPTH_FILTER_SPATIAL_DELTA, "DepthFilterSpatialDelta", 0),
+	m_DepthFilterTemporalAlpha(XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_ALPHA, "DepthFilterTemporalAlpha", 0),
+	m_DepthFilterTemporalDelta(XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_DELTA, "DepthFilterTemporalDelta", 0),
+	m_DepthFilterTemporalPersistence(XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_PERSISTENCE, "DepthFilterTemporalPersistence", 0),
+	m_DepthFilterThreads(XN_STREAM_PROPERTY_DEPTH_FILTER_THREADS, "DepthFilterThreads", 0),
+	m_DepthDecimation(XN_STREAM_PROPERTY_DEPTH_DECIMATION, "DepthDecimation", 1),
+	m_DepthDecimationMethod(XN_STREAM_PROPERTY_DEPTH_DECIMATION_METHOD, "DepthDecimationMethod", XN_DEPTH_DECIMATION_MIN_NONZERO),
 	m_depthUtilsHandle(NULL),
 	m_hReferenceSizeChangedCallback(NULL)
 {
@@ -109,11 +117,22 @@ XnStatus XnSensorDepthStream::Init()
 	m_GMCDebug.UpdateSetCallback(SetGMCDebugCallback, this);
 	m_WavelengthCorrection.UpdateSetCallback(SetWavelengthCorrectionCallback, this);
 	m_WavelengthCorrectionDebug.UpdateSetCallback(SetWavelengthCorrectionDebugCallback, this);
+	m_DepthFilterHoleFill.UpdateSetCallback(SetDepthFilterCallback, this);
+	m_DepthFilterSpatialDelta.UpdateSetCallback(SetDepthFilterCallback, this);
+	m_DepthFilterTemporalAlpha.UpdateSetCallback(SetDepthFilterCallback, this);
+	m_DepthFilterTemporalDelta.UpdateSetCallback(SetDepthFilterCallback, this);
+	m_DepthFilterTemporalPersistence.UpdateSetCallback(SetDepthFilterCallback, this);
+	m_DepthFilterThreads.UpdateSetCallback(SetDepthFilterCallback, this);
+	m_DepthDecimation.UpdateSetCallback(SetDepthDecimationCallback, this);
+	m_DepthDecimationMethod.UpdateSetCallback(SetDepthDecimationMethodCallback, this);
 
 	XN_VALIDATE_ADD_PROPERTIES(this, &m_InputFormat, &m_DepthRegistration, &m_HoleFilter,
 		&m_WhiteBalance, &m_Gain, &m_AGCBin, &m_ActualRead, &m_GMCMode,
 		&m_CloseRange, &m_CroppingMode, &m_RegistrationType, &m_PixelRegistration,
-		&m_HorizontalFOV, &m_VerticalFOV, &m_GMCDebug, &m_WavelengthCorrection, &m_WavelengthCorrectionDebug);
+		&m_HorizontalFOV, &m_VerticalFOV, &m_GMCDebug, &m_WavelengthCorrection, &m_WavelengthCorrectionDebug,
+		&m_DepthFilterHoleFill, &m_DepthFilterSpatialDelta, &m_DepthFilterTemporalAlpha,
+		&m_DepthFilterTemporalDelta, &m_DepthFilterTemporalPersistence, &m_DepthFilterThreads,
+		&m_DepthDecimation, &m_DepthDecimationMethod);
 
 	// register supported modes
 	XnCmosPreset* pSupportedModes = m_Helper.GetPrivateData()->FWInfo.depthModes.data();
@@ -774,6 +793,11 @@ XnStatus XnSensorDepthStream::SetCroppingImpl(const OniCropping* pCropping, XnCr
 	nRetVal = ValidateCropping(pCropping);
 	XN_IS_STATUS_OK(nRetVal);
 
+	if (pCropping->enabled && m_DepthDecimation.GetValue() > 1)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_DEVICE_UNSUPPORTED_MODE, XN_MASK_DEVICE_SENSOR, "Cropping can't be used while depth is decimated");
+	}
+
 	xnOSEnterCriticalSection(GetLock());
 
 	if (m_Helper.GetFirmwareVersion() > XN_SENSOR_FW_VER_3_0)
@@ -1052,6 +1076,28 @@ XnStatus XnSensorDepthStream::ApplyRegistration(OniDepthPixel* pDetphmap)
 	return XN_STATUS_OK;
 }
 
+XnStatus XnSensorDepthStream::ApplyRegistration(const OniDepthPixel* pInput, OniDepthPixel* pOutput)
+{
+	DepthUtilsTranslateDepthMapTo(m_depthUtilsHandle, pInput, pOutput);
+	return XN_STATUS_OK;
+}
+
+void XnSensorDepthStream::GetDepthFilterSettings(XnDepthFilterSettings* pSettings)
+{
+	pSettings->nHoleFillWidth = (uint32_t)m_DepthFilterHoleFill.GetValue();
+	pSettings->nSpatialDelta = (uint32_t)m_DepthFilterSpatialDelta.GetValue();
+	pSettings->nTemporalAlpha = (uint32_t)m_DepthFilterTemporalAlpha.GetValue();
+	pSettings->nTemporalDelta = (uint32_t)m_DepthFilterTemporalDelta.GetValue();
+	pSettings->nTemporalPersistence = (uint32_t)m_DepthFilterTemporalPersistence.GetValue();
+	pSettings->nThreads = (uint32_t)m_DepthFilterThreads.GetValue();
+}
+
+void XnSensorDepthStream::GetDepthDecimation(uint32_t* pnFactor, XnDepthDecimationMethod* pMethod)
+{
+	*pnFactor = (uint32_t)m_DepthDecimation.GetValue();
+	*pMethod = (XnDepthDecimationMethod)m_DepthDecimationMethod.GetValue();
+}
+
 #define RGB_REG_X_RES 640
 #define RGB_REG_Y_RES 512
 #define XN_CMOS_VGAOUTPUT_XRES 1280
@@ -1189,6 +1235,59 @@ XnStatus XN_CALLBACK_TYPE XnSensorDepthStream::SetWavelengthCorrectionDebugCallb
 	return pStream->SetWavelengthCorrectionDebug((bool)nValue);
 }
 
+XnStatus XN_CALLBACK_TYPE XnSensorDepthStream::SetDepthFilterCallback(XnActualIntProperty* pSender, uint64_t nValue, void* /*pCookie*/)
+{
+	// filters are software only, and the depth processor picks up new values on the next frame
+	uint64_t nMax = XN_MAX_UINT16;
+	switch (pSender->GetId())
+	{
+	case XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_ALPHA:
+		nMax = XN_DEPTH_FILTER_MAX_TEMPORAL_ALPHA;
+		break;
+	case XN_STREAM_PROPERTY_DEPTH_FILTER_TEMPORAL_PERSISTENCE:
+		nMax = XN_DEPTH_FILTER_HISTORY_FRAMES;
+		break;
+	case XN_STREAM_PROPERTY_DEPTH_FILTER_THREADS:
+		nMax = XN_DEPTH_FILTER_MAX_THREADS;
+		break;
+	}
+
+	if (nValue > nMax)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_DEVICE_BAD_PARAM, XN_MASK_DEVICE_SENSOR, "%s must be at most %llu (got %llu)", pSender->GetName(), nMax, nValue);
+	}
+
+	return pSender->UnsafeUpdateValue(nValue);
+}
+
+XnStatus XN_CALLBACK_TYPE XnSensorDepthStream::SetDepthDecimationCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie)
+{
+	XnSensorDepthStream* pStream = (XnSensorDepthStream*)pCookie;
+
+	// decimation is software only, and the depth processor picks up new values on the next frame
+	if (nValue != 1 && nValue != 2 && nValue != 4)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_DEVICE_BAD_PARAM, XN_MASK_DEVICE_SENSOR, "%s must be 1, 2 or 4 (got %llu)", pSender->GetName(), nValue);
+	}
+
+	if (nValue > 1 && pStream->GetCropping()->enabled)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_DEVICE_UNSUPPORTED_MODE, XN_MASK_DEVICE_SENSOR, "Depth can't be decimated while cropping is enabled");
+	}
+
+	return pSender->UnsafeUpdateValue(nValue);
+}
+
+XnStatus XN_CALLBACK_TYPE XnSensorDepthStream::SetDepthDecimationMethodCallback(XnActualIntProperty* pSender, uint64_t nValue, void* /*pCookie*/)
+{
+	if (nValue != XN_DEPTH_DECIMATION_MIN_NONZERO && nValue != XN_DEPTH_DECIMATION_MEDIAN)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_DEVICE_BAD_PARAM, XN_MASK_DEVICE_SENSOR, "Unknown depth decimation method: %llu", nValue);
+	}
+
+	return pSender->UnsafeUpdateValue(nValue);
+}
+
 XnStatus XN_CALLBACK_TYPE XnSensorDepthStream::SetAGCBinCallback(XnGeneralProperty* /*pSender*/, const OniGeneralBuffer& gbValue, void* pCookie)
 {
 	if (gbValue.dataSize != sizeof(XnDepthAGCBin))
@@ -28,6 +28,7 @@
 #include "XnDeviceSensorProtocol.h"
 #include "XnSensorStreamHelper.h"
 #include <DepthUtils.h>
+#include <Formats/XnDepthFilterChain.h>
 
 //---------------------------------------------------------------------------
 // Defines
@@ -94,8 +95,12 @@ protected:
 	void GetFirmwareStreamConfig(XnResolutions* pnRes, uint32_t* pnFPS) { *pnRes = GetResolution(); *pnFPS = GetFPS(); }
 
 	XnStatus ApplyRegistration(OniDepthPixel* pDetphmap);
+	XnStatus ApplyRegistration(const OniDepthPixel* pInput, OniDepthPixel* pOutput);
+	void GetSoftwareCroppingAndMirror(OniCropping* pCropping, bool* pbMirror) { m_Helper.GetSoftwareCroppingAndMirror(this, m_FirmwareCropMode, m_FirmwareMirror, pCropping, pbMirror); }
 	OniStatus GetSensorCalibrationInfo(void* data, int* dataSize);
 	XnStatus PopulateSensorCalibrationInfo();
+	void GetDepthFilterSettings(XnDepthFilterSettings* pSettings);
+	void GetDepthDecimation(uint32_t* pnFactor, XnDepthDecimationMethod* pMethod);
 
 protected:
 	//---------------------------------------------------------------------------
@@ -149,6 +154,9 @@ private:
 	static XnStatus XN_CALLBACK_TYPE SetGMCDebugCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetWavelengthCorrectionCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetWavelengthCorrectionDebugCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetDepthFilterCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetDepthDecimationCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetDepthDecimationMethodCallback(XnActualIntProperty* pSender, uint64_t nValue, void* pCookie);
 
 	//---------------------------------------------------------------------------
 	// Members
@@ -184,6 +192,16 @@ private:
 	XnActualIntProperty m_WavelengthCorrection;
 	XnActualIntProperty m_WavelengthCorrectionDebug;
 
+	XnActualIntProperty m_DepthFilterHoleFill;
+	XnActualIntProperty m_DepthFilterSpatialDelta;
+	XnActualIntProperty m_DepthFilterTemporalAlpha;
+	XnActualIntProperty m_DepthFilterTemporalDelta;
+	XnActualIntProperty m_DepthFilterTemporalPersistence;
+	XnActualIntProperty m_DepthFilterThreads;
+
+	XnActualIntProperty m_DepthDecimation;
+	XnActualIntProperty m_DepthDecimationMethod;
+
 	DepthUtilsHandle m_depthUtilsHandle;
 	DepthUtilsSensorCalibrationInfo m_calibrationInfo;
 	XnCallbackHandle m_hReferenceSizeChangedCallback;
@@ -248,6 +248,7 @@ XnStatus XnSensorIRStream::SetOutputFormat(OniPixelFormat nOutputFormat)
 	switch (nOutputFormat)
 	{
 	case ONI_PIXEL_FORMAT_RGB888:
+	case ONI_PIXEL_FORMAT_GRAY8:
 	case ONI_PIXEL_FORMAT_GRAY16:
 		nRetVal = DeviceMaxIRProperty().UnsafeUpdateValue(XN_DEVICE_SENSOR_MAX_IR);
 		break;
@@ -61,6 +61,9 @@ XnSensorImageStream::XnSensorImageStream(const char* StreamName, XnSensorObjects
 	m_Exposure(ONI_STREAM_PROPERTY_EXPOSURE, "Exposure", XN_IMAGE_STREAM_DEFAULT_EXPOSURE_BAR),
 	m_Gain(ONI_STREAM_PROPERTY_GAIN, "Gain", XN_IMAGE_STREAM_DEFAULT_GAIN),
 	m_FastZoomCrop(XN_STREAM_PROPERTY_FAST_ZOOM_CROP, "FastZoomCrop", false),
+	m_JpegFastDCT(XN_STREAM_PROPERTY_JPEG_FAST_DCT, "JpegFastDCT", false),
+	m_JpegFancyUpsampling(XN_STREAM_PROPERTY_JPEG_FANCY_UPSAMPLING, "JpegFancyUpsampling", true),
+	m_JpegDecodeThreads(XN_STREAM_PROPERTY_JPEG_DECODE_THREADS, "JpegDecodeThreads", 0),
 
 	m_ActualRead(XN_STREAM_PROPERTY_ACTUAL_READ_DATA, "ActualReadData", false),
 	m_HorizontalFOV(ONI_STREAM_PROPERTY_HORIZONTAL_FOV, "HorizontalFov"),
@@ -86,10 +89,14 @@ XnStatus XnSensorImageStream::Init()
 	m_FastZoomCrop.UpdateSetCallback(SetFastZoomCropCallback, this);
 	m_AutoWhiteBalance.UpdateSetCallback(SetAutoWhiteBalanceCallback, this);
 	m_ActualRead.UpdateSetCallback(SetActualReadCallback, this);
+	m_JpegFastDCT.UpdateSetCallbackToDefault();
+	m_JpegFancyUpsampling.UpdateSetCallbackToDefault();
+	m_JpegDecodeThreads.UpdateSetCallbackToDefault();
 
 	// add properties
 	XN_VALIDATE_ADD_PROPERTIES(this, &m_InputFormat, &m_AntiFlicker, &m_ImageQuality,
-		&m_CroppingMode, &m_ActualRead, &m_HorizontalFOV, &m_VerticalFOV, &m_AutoExposure, &m_AutoWhiteBalance, &m_Exposure, &m_Gain, &m_FastZoomCrop);
+		&m_CroppingMode, &m_ActualRead, &m_HorizontalFOV, &m_VerticalFOV, &m_AutoExposure, &m_AutoWhiteBalance, &m_Exposure, &m_Gain, &m_FastZoomCrop,
+		&m_JpegFastDCT, &m_JpegFancyUpsampling, &m_JpegDecodeThreads);
 
 	// set base properties default values
 	nRetVal = ResolutionProperty().UnsafeUpdateValue(XN_IMAGE_STREAM_DEFAULT_RESOLUTION);
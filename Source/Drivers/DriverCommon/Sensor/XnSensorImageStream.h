@@ -74,6 +74,12 @@ public:
 
 	uint32_t CalculateExpectedSize();
 
+	void GetSoftwareCroppingAndMirror(OniCropping* pCropping, bool* pbMirror) { m_Helper.GetSoftwareCroppingAndMirror(this, m_FirmwareCropMode, m_FirmwareMirror, pCropping, pbMirror); }
+
+	inline bool IsJpegFastDCT() const { return (bool)m_JpegFastDCT.GetValue(); }
+	inline bool IsJpegFancyUpsampling() const { return (bool)m_JpegFancyUpsampling.GetValue(); }
+	inline uint32_t GetJpegDecodeThreads() const { return (uint32_t)m_JpegDecodeThreads.GetValue(); }
+
 	inline XnSensorStreamHelper* GetHelper() { return &m_Helper; }
 
 	friend class XnImageProcessor;
@@ -153,6 +159,10 @@ private:
 	XnActualIntProperty m_Gain;
 	XnActualIntProperty m_FastZoomCrop;
 
+	XnActualIntProperty m_JpegFastDCT;
+	XnActualIntProperty m_JpegFancyUpsampling;
+	XnActualIntProperty m_JpegDecodeThreads;
+
 	XnActualIntProperty m_ActualRead;
 
 	XnActualRealProperty m_HorizontalFOV;
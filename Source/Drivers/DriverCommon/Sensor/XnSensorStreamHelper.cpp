@@ -421,3 +421,19 @@ XnFirmwareCroppingMode XnSensorStreamHelper::GetFirmwareCroppingMode(XnCroppingM
 		return XN_FIRMWARE_CROPPING_MODE_NORMAL;
 	}
 }
+
+void XnSensorStreamHelper::GetSoftwareCroppingAndMirror(XnPixelStream* pStream, const XnActualIntProperty& FirmwareCropMode, const XnActualIntProperty& FirmwareMirror, OniCropping* pCropping, bool* pbMirror)
+{
+	pStream->GetCroppingAndMirror(pCropping, pbMirror);
+
+	// cropping and mirroring done by the firmware are already applied to the data (see the streams' CropImpl() and Mirror())
+	if (FirmwareCropMode.GetValue() != XN_FIRMWARE_CROPPING_MODE_DISABLED)
+	{
+		pCropping->enabled = false;
+	}
+
+	if (FirmwareMirror.GetValue() == true)
+	{
+		*pbMirror = false;
+	}
+}
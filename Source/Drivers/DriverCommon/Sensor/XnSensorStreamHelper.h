@@ -28,6 +28,7 @@
 #include "XnSensorFirmware.h"
 #include "XnSensorFixedParams.h"
 #include <DDK/XnDeviceStream.h>
+#include <DDK/XnPixelStream.h>
 #include <DDK/XnDeviceModuleHolder.h>
 
 //---------------------------------------------------------------------------
@@ -94,6 +95,12 @@ public:
 
 	XnFirmwareCroppingMode GetFirmwareCroppingMode(XnCroppingMode nValue, bool bEnabled);
 
+	/**
+	* Gets the cropping and mirroring left for the data processor to apply to pStream's frames. What the
+	* firmware already does (according to FirmwareCropMode and FirmwareMirror) is left out.
+	*/
+	void GetSoftwareCroppingAndMirror(XnPixelStream* pStream, const XnActualIntProperty& FirmwareCropMode, const XnActualIntProperty& FirmwareMirror, OniCropping* pCropping, bool* pbMirror);
+
 private:
 	IXnSensorStream* m_pSensorStream;
 	XnDeviceStream* m_pStream;
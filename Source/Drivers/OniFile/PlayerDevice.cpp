@@ -238,14 +238,7 @@ OniStatus PlayerDevice::Initialize()
 		return ONI_STATUS_ERROR;
 	}
 
-	// Create thread for running the player.
-	XnStatus status = xnOSCreateThread(ThreadProc, this, &m_threadHandle);
-	if (status != XN_STATUS_OK)
-	{
-		return ONI_STATUS_ERROR;
-	}
-
-	status = ResolveGlobalConfigFileName(m_iniFilePath, sizeof(m_iniFilePath), NULL);
+	XnStatus status = ResolveGlobalConfigFileName(m_iniFilePath, sizeof(m_iniFilePath), NULL);
 	if (XN_STATUS_OK != status)
 	{
 		return ONI_STATUS_ERROR;
@@ -254,6 +247,20 @@ OniStatus PlayerDevice::Initialize()
 	bool bIsExist = false;
 	xnOSDoesFileExist(m_iniFilePath, &bIsExist);
 
+	if (bIsExist)
+	{
+		// Thread policies must be known before the player thread is created.
+		xnOSLoadThreadPoliciesFromINI(m_iniFilePath, "Threads");
+	}
+
+	// Create thread for running the player.
+	status = xnOSCreateThread(ThreadProc, this, &m_threadHandle);
+	if (status != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+	xnOSApplyThreadPolicy(m_threadHandle, XN_THREAD_CLASS_PLAYER, NULL);
+
 	if (bIsExist)
 	{
 		LoadConfigurationFromIniFile();
@@ -458,6 +465,12 @@ OniStatus PlayerDevice::setProperty(int propertyId, const void* data, int dataSi
 
 		// Reset the timing reference.
 		m_bHasTimeReference = false;
+
+		// If the player thread is waiting for a manual trigger, wake it up so the new speed takes effect.
+		if (m_dPlaybackSpeed != XN_PLAYBACK_SPEED_MANUAL)
+		{
+			m_manualTriggerInternalEvent.Set();
+		}
 	}
 	else if (propertyId == ONI_DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED)
 	{
@@ -645,6 +645,7 @@ XnStatus XnSensor::InitReading()
 	// open 'commands.txt' thread
 	nRetVal = xnOSCreateThread(XnDeviceSensorProtocolScriptThread, (XN_THREAD_PARAM)&m_DevicePrivateData, &m_DevicePrivateData.LogThread.hThread);
 	XN_IS_STATUS_OK(nRetVal);
+	xnOSApplyThreadPolicy(m_DevicePrivateData.LogThread.hThread, XN_THREAD_CLASS_SERVICE, "SensorLog");
 
 	return XN_STATUS_OK;
 }
@@ -189,7 +189,13 @@ XnStatus LinkOniDevice::Init(const char* mode)
 	xn::PS1200Device *pPrimeClient = new xn::PS1200Device();
 	XN_VALIDATE_ALLOC_PTR(pPrimeClient);
 
-	XnStatus retVal = pPrimeClient->Init(m_info.uri, XN_TRANSPORT_TYPE_USB);
+	XnTransportType transportType = XN_TRANSPORT_TYPE_USB;
+	if (strncmp(m_info.uri, XN_LINK_LOOPBACK_URI_PREFIX, xnOSStrLen(XN_LINK_LOOPBACK_URI_PREFIX)) == 0)
+	{
+		transportType = XN_TRANSPORT_TYPE_LOOPBACK;
+	}
+
+	XnStatus retVal = pPrimeClient->Init(m_info.uri, transportType);
 	if (retVal != XN_STATUS_OK)
 	{
 		xnLogError(XN_MASK_LINK_DEVICE, "Failed to initialize prime client: %s", xnGetStatusString(retVal));
@@ -240,6 +246,11 @@ XnStatus LinkOniDevice::Init(const char* mode)
 		return retVal;
 	}
 
+	if (XN_STATUS_OK == xnOSReadIntFromINI(m_configFile, CONFIG_DEVICE_SECTION, "StreamDecodeThreads", &value32))
+	{
+		m_pSensor->SetStreamDecodeThreads(value32 == 1);
+	}
+
 	if (XN_STATUS_OK == xnOSReadIntFromINI(m_configFile, CONFIG_DEVICE_SECTION, "FirmwareLog", &value32))
 	{
 		if (value32 == true)
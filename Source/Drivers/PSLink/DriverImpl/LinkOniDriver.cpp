@@ -24,8 +24,10 @@
 #include "LinkOniDriver.h"
 #include "LinkOniDevice.h"
 #include "LinkDeviceEnumeration.h"
+#include "XnLinkProtoLibDefs.h"
 #include <XnOS.h>
 #include <XnLogWriterBase.h>
+#include <XnProfiling.h>
 
 #define LINK_CONFIGURATION_FILE "PSLink.ini"
 
@@ -55,6 +57,8 @@ OniStatus LinkOniDriver::initialize(oni::driver::DeviceConnectedCallback deviceC
 	}
 
 	xnLogSetMaskMinSeverity(XN_LOG_MASK_ALL, XN_LOG_VERBOSE);
+	// Entries are forwarded to the OpenNI log, which queues them itself
+	xnLogSetAsynchronous(false);
 	m_writer.Register();
 
 	XnStatus rc = LinkDeviceEnumeration::ConnectedEvent().Register(OnDeviceConnected, this, m_connectedEventHandle);
@@ -69,14 +73,22 @@ OniStatus LinkOniDriver::initialize(oni::driver::DeviceConnectedCallback deviceC
 		return ONI_STATUS_ERROR;
 	}
 
+	// Thread policies must be loaded before enumeration starts the USB threads.
+	resolveConfigFilePath();
+
+	bool bConfigExists = false;
+	if (xnOSDoesFileExist(m_configFilePath, &bConfigExists) == XN_STATUS_OK && bConfigExists)
+	{
+		xnOSLoadThreadPoliciesFromINI(m_configFilePath, "Threads");
+		xnProfilingInitFromINI(m_configFilePath, "Profiling");
+	}
+
 	rc = LinkDeviceEnumeration::Initialize();
 	if (rc != XN_STATUS_OK)
 	{
 		return ONI_STATUS_ERROR;
 	}
 
-	resolveConfigFilePath();
-
 	return ONI_STATUS_OK;
 }
 
@@ -103,6 +115,8 @@ void LinkOniDriver::shutdown()
 	m_devices.Clear();
 
 	LinkDeviceEnumeration::Shutdown();
+
+	xnProfilingShutdown();
 }
 
 oni::driver::DeviceBase* LinkOniDriver::deviceOpen(const char* uri, const char* mode)
@@ -145,6 +159,24 @@ void LinkOniDriver::deviceClose(oni::driver::DeviceBase* pDevice)
 	XN_ASSERT(false);
 }
 
+OniStatus LinkOniDriver::tryDevice(const char* uri)
+{
+	// Devices on the loopback transport are never enumerated - they exist once someone asks for them
+	if (strncmp(uri, XN_LINK_LOOPBACK_URI_PREFIX, xnOSStrLen(XN_LINK_LOOPBACK_URI_PREFIX)) != 0)
+	{
+		return DriverBase::tryDevice(uri);
+	}
+
+	XnStatus nRetVal = LinkDeviceEnumeration::ConnectLoopbackDevice(uri);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		getServices().errorLoggerAppend("Could not add loopback device \"%s\": %s", uri, xnGetStatusString(nRetVal));
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
 void XN_CALLBACK_TYPE LinkOniDriver::OnDevicePropertyChanged(const char* /*ModuleName*/, uint32_t /*nPropertyId*/, void* /*pCookie*/)
 {
 }
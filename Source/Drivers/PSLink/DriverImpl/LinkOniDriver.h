@@ -47,6 +47,7 @@ public:
 
 	virtual oni::driver::DeviceBase* deviceOpen(const char* uri, const char* mode);
 	virtual void deviceClose(oni::driver::DeviceBase* pDevice);
+	virtual OniStatus tryDevice(const char* uri);
 
 	void ClearDevice(const char* uri);
 
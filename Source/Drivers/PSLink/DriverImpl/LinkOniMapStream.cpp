@@ -140,6 +140,11 @@ OniStatus LinkOniMapStream::getProperty(int propertyId, void* data, int* pDataSi
 			ASSIGN_PROP_VALUE_INT(data, *pDataSize, m_pInputStream->GetVideoMode().m_nCompression);
 			break;
 
+		case LINK_PROP_LAST_FRAME_COPIED_BYTES:
+			ENSURE_PROP_SIZE(*pDataSize, uint32_t);
+			ASSIGN_PROP_VALUE_INT(data, *pDataSize, m_pInputStream->GetLastFrameCopiedBytes());
+			break;
+
 		case PS_PROPERTY_GAIN:
 			{
 				ENSURE_PROP_SIZE(*pDataSize, uint16_t);
@@ -227,6 +232,7 @@ bool LinkOniMapStream::isPropertySupported(int propertyId)
 	case ONI_STREAM_PROPERTY_CROPPING:
 	case LINK_PROP_PIXEL_FORMAT:
 	case LINK_PROP_COMPRESSION:
+	case LINK_PROP_LAST_FRAME_COPIED_BYTES:
 		return true;
 	default:
 		return LinkOniStream::isPropertySupported(propertyId);
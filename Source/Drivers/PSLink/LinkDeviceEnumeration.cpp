@@ -158,6 +158,25 @@ void XN_CALLBACK_TYPE LinkDeviceEnumeration::OnConnectivityEventCallback(XnUSBEv
 	OnConnectivityEvent(pArgs->strDevicePath, pArgs->eventType, usbId);
 }
 
+XnStatus LinkDeviceEnumeration::ConnectLoopbackDevice(const char* uri)
+{
+	if (!ms_initialized)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	if (xnOSStrLen(uri) >= sizeof(((OniDeviceInfo*)NULL)->uri))
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+
+	// loopback devices have no USB IDs
+	XnUsbId usbId = { 0, 0 };
+	OnConnectivityEvent(uri, XN_USB_EVENT_DEVICE_CONNECT, usbId);
+
+	return XN_STATUS_OK;
+}
+
 OniDeviceInfo* LinkDeviceEnumeration::GetDeviceInfo(const char* uri)
 {
 	OniDeviceInfo* pInfo = NULL;
@@ -43,6 +43,9 @@ public:
 
 	static XnStatus EnumerateSensors(OniDeviceInfo* aDevices, uint32_t* pnCount);
 
+	/** Adds a simulated device for a loopback:// uri, as if it was just connected. **/
+	static XnStatus ConnectLoopbackDevice(const char* uri);
+
 private:
 	typedef struct XnUsbId
 	{
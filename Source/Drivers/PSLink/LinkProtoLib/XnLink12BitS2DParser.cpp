@@ -96,6 +96,7 @@ uint32_t Link12BitS2DParser::ProcessFramePacketChunk(const uint8_t* pData,uint8_
 
 		xnOSMemCopy(m_ContinuousBuffer + m_ContinuousBufferSize, pData, nReadBytes);
 		m_ContinuousBufferSize += nReadBytes;
+		AddCopiedBytes(nReadBytes);
 
 		pData += nReadBytes;
 		nDataSize -= nReadBytes;
@@ -130,6 +131,7 @@ uint32_t Link12BitS2DParser::ProcessFramePacketChunk(const uint8_t* pData,uint8_
 
 			xnOSMemCopy(m_ContinuousBuffer + m_ContinuousBufferSize, pData, nDataSize);
 			m_ContinuousBufferSize += nDataSize;
+			AddCopiedBytes(nDataSize);
 		}
 	}
 	return totalWrite; //return total written bytes
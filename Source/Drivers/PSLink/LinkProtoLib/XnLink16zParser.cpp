@@ -57,6 +57,55 @@ inline OniDepthPixel Link16zParser<false>::TranslatePixel(uint32_t nShift)
 }
 
 
+/* Small diffs and RLE make up most of a frame. This decodes them with the parser state kept in locals, and returns at
+   the first opcode it doesn't handle (or one that would go out of range), leaving it to the state machine. */
+template<bool TS2D>
+void Link16zParser<TS2D>::DecodeSmallDiffsAndRuns(const uint8_t*& pSrc, const uint8_t* pSrcEnd, bool& bReadHigh, OniDepthPixel*& pDstPixel, const OniDepthPixel* pDstPixelEnd)
+{
+	const uint8_t* pCurr = pSrc;
+	bool bHigh = bReadHigh;
+	OniDepthPixel* pOut = pDstPixel;
+	uint32_t nShift = m_nShift;
+
+	while ((pCurr < pSrcEnd) && (pOut < pDstPixelEnd))
+	{
+		uint32_t nNibble = bHigh ? (*pCurr >> 4) : (*pCurr & 0x0F);
+		if (nNibble <= MAX_SMALL_DIFF_NIBBLE)
+		{
+			uint32_t nNewShift = nShift + nNibble - SMALL_DIFF_OFFSET;
+			if (nNewShift > m_nMaxShift)
+			{
+				break;
+			}
+			nShift = nNewShift;
+			*pOut++ = TranslatePixel(nShift);
+			pCurr += bHigh ? 0 : 1;
+			bHigh = !bHigh;
+		}
+		else if (nNibble == STATE_RLE && (bHigh || (pCurr + 1 < pSrcEnd)) && (nShift <= m_nMaxShift))
+		{
+			uint32_t nRepeats = (bHigh ? (*pCurr & 0x0F) : (pCurr[1] >> 4)) + 1;
+			nRepeats = XN_MIN(nRepeats, uint32_t(pDstPixelEnd - pOut));
+			OniDepthPixel nPixel = TranslatePixel(nShift);
+			while (nRepeats > 0)
+			{
+				*pOut++ = nPixel;
+				nRepeats--;
+			}
+			pCurr++;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	pSrc = pCurr;
+	bReadHigh = bHigh;
+	pDstPixel = pOut;
+	m_nShift = nShift;
+}
+
 template<bool TS2D>
 XnStatus Link16zParser<TS2D>::ParsePacketImpl(XnLinkFragmentation fragmentation,
 						const uint8_t* pSrc,
@@ -82,6 +131,15 @@ XnStatus Link16zParser<TS2D>::ParsePacketImpl(XnLinkFragmentation fragmentation,
 	////////////////////////////////////////////
 	while ((pSrc < pSrcEnd) && (pDstPixel < pDstPixelEnd))
 	{
+		if (m_nState == STATE_OPCODE)
+		{
+			DecodeSmallDiffsAndRuns(pSrc, pSrcEnd, bReadHigh, pDstPixel, pDstPixelEnd);
+			if ((pSrc == pSrcEnd) || (pDstPixel == pDstPixelEnd))
+			{
+				break;
+			}
+		}
+
 		//Read next nibble
 		if (bReadHigh)
 		{
@@ -43,6 +43,7 @@ protected:
 						const uint8_t* pDstEnd);
 private:
 	inline OniDepthPixel TranslatePixel(uint32_t nShift);
+	inline void DecodeSmallDiffsAndRuns(const uint8_t*& pSrc, const uint8_t* pSrcEnd, bool& bReadHigh, OniDepthPixel*& pDstPixel, const OniDepthPixel* pDstPixelEnd);
 
 	const OniDepthPixel* m_pShiftToDepth;
 	uint32_t m_nShift;
@@ -82,6 +82,7 @@ XnStatus Link24zYuv422Parser::ParsePacketImpl(XnLinkFragmentation fragmentation,
 		}
 
 		xnOSMemCopy(m_dataFromPrevPacket, pSrc, inputSize);
+		AddCopiedBytes((uint32_t)inputSize);
 		pInput = m_dataFromPrevPacket;
 		inputSize = m_dataFromPrevPacketBytes + inputSize;
 	}
@@ -106,6 +107,7 @@ XnStatus Link24zYuv422Parser::ParsePacketImpl(XnLinkFragmentation fragmentation,
 	{
 		m_dataFromPrevPacketBytes = inputSize - actualRead;
 		xnOSMemMove(m_dataFromPrevPacket, pInput + actualRead, m_dataFromPrevPacketBytes);
+		AddCopiedBytes((uint32_t)m_dataFromPrevPacketBytes);
 	}
 
 	if ((fragmentation & XN_LINK_FRAG_END) != 0)
@@ -20,14 +20,48 @@
 *****************************************************************************/
 #include "XnLink6BitParser.h"
 #include "XnLinkProtoUtils.h"
+#include "XnLinkSimd.h"
 #include <XnLog.h>
 
+#if XN_LINK_SIMD_X86
+	#include <tmmintrin.h>
+#endif
+
 namespace xn
 {
 
+#if XN_LINK_SIMD_X86
+/* Same output as the scalar state machine below, 3 bytes (4 pixels) per group, for whole groups while at least
+   16 bytes can be loaded. Returns the first byte that was not unpacked - always the beginning of a group. */
+static XN_LINK_TARGET_SSSE3 const uint8_t* Unpack6BitSSSE3(const uint8_t* pSrc, const uint8_t* pSrcEnd, OniDepthPixel*& pDstPixel)
+{
+	//Each 16 bit lane gets the two bytes its pixel is taken from, little endian
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 0, 1, 1, 2, 2, 3, 3, 4, 3, 4, 4, 5, 5, 6);
+	//Pixel 0 is the low bits of the lane, the others are assembled from the lane shifted by 6 and by 4
+	const __m128i mask0 = _mm_setr_epi16(0x3F, 0, 0, 0, 0x3F, 0, 0, 0);
+	const __m128i mask6 = _mm_setr_epi16(0, 0x3F, 0xFC, 0x03, 0, 0x3F, 0xFC, 0x03);
+	const __m128i mask4 = _mm_setr_epi16(0, 0, 0x0F, 0, 0, 0, 0x0F, 0);
+
+	while (pSrcEnd - pSrc >= 16)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+		__m128i pairs = _mm_shuffle_epi8(bytes, shuffle);
+		__m128i pixels = _mm_or_si128(
+			_mm_and_si128(pairs, mask0),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi16(pairs, 6), mask6), _mm_and_si128(_mm_srli_epi16(pairs, 4), mask4)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel), pixels);
+		pSrc += 6;
+		pDstPixel += 8;
+	}
+
+	return pSrc;
+}
+#endif
+
 Link6BitParser::Link6BitParser() :
 	m_nState(0),
-	m_nShift(0)
+	m_nShift(0),
+	m_bUseSSSE3(xnLinkGetSimdLevel() >= XN_LINK_SIMD_SSSE3)
 {
 }
 
@@ -67,8 +101,19 @@ XnStatus Link6BitParser::ParsePacketImpl(XnLinkFragmentation fragmentation,
 		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
 	}
 
+	bool bVectorize = m_bUseSSSE3;
+
 	while (pSrc < pSrcEnd)
 	{
+#if XN_LINK_SIMD_X86
+		if (bVectorize && m_nState == 0)
+		{
+			//Bulk of the packet - the rest (less than 16 bytes) is unpacked below
+			pSrc = Unpack6BitSSSE3(pSrc, pSrcEnd, pDstPixel);
+			bVectorize = false;
+			continue;
+		}
+#endif
 		XN_ASSERT(pDstPixel < pDstPixelEnd);
 		if (pSrc + 1 == pSrcEnd && (m_nState != 0 || m_nState != 3))
 			break;
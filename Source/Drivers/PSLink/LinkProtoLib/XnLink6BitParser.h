@@ -42,6 +42,7 @@ protected:
 private:
 	uint32_t m_nState;
 	uint16_t m_nShift;
+	bool m_bUseSSSE3;
 };
 
 }
@@ -55,6 +55,8 @@ LinkFrameInputStream::LinkFrameInputStream()
 	m_frameIndex = 0;
 
 	m_nBufferSize = 0;
+	m_pLinkMsgParser = NULL;
+	m_nLastFrameCopiedBytes = 0;
 	m_hCriticalSection = NULL;
 	m_pDumpFile = NULL;
 	m_currentFrameCorrupt = false;
@@ -175,7 +177,7 @@ void LinkFrameInputStream::Shutdown()
 	xnOSLeaveCriticalSection(&m_hCriticalSection);
 }
 
-XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& origHeader, const uint8_t* pData, bool& bPacketLoss)
+XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& header, const uint8_t* pData, bool& bPacketLoss)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 	xnl::AutoCSLocker csLock(m_hCriticalSection);
@@ -184,7 +186,14 @@ XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& origHeader,
 		return XN_STATUS_NOT_INIT;
 	}
 
-	LinkPacketHeader header = origHeader;
+	if (m_pLinkMsgParser == NULL)
+	{
+		//Not streaming anymore
+		return XN_STATUS_OK;
+	}
+
+	//Packet data is parsed straight from the transfer buffer into the frame, so only its bounds are tracked here
+	uint32_t nDataSize = header.GetDataSize();
 
     if (header.GetFragmentationFlags() & XN_LINK_FRAG_BEGIN)
     {
@@ -206,7 +215,7 @@ XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& origHeader,
 		}
 
 		// take timestamp
-		if (header.GetDataSize() < sizeof(uint64_t))
+		if (nDataSize < sizeof(uint64_t))
 		{
 			m_currentFrameCorrupt = true;
 			xnLogWarning(XN_MASK_LINK, "Got a BEGIN packet with no timestamp!");
@@ -215,7 +224,7 @@ XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& origHeader,
 		}
 		m_pCurrFrame->timestamp = *(uint64_t*)pData;
 		pData += sizeof(uint64_t);
-		header.SetSize(header.GetSize() - sizeof(uint64_t));
+		nDataSize -= sizeof(uint64_t);
 
 		// TEMP: inject the host's timestamp. Firmware can't produce timestamps yet
 		uint64_t nTimestamp;
@@ -239,7 +248,7 @@ XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& origHeader,
 	if (!m_currentFrameCorrupt)
 	{
 		uint32_t nPrevSize = m_pLinkMsgParser->GetParsedSize();
-		nRetVal = m_pLinkMsgParser->ParsePacket(header, pData);
+		nRetVal = m_pLinkMsgParser->ParsePacket(header.GetFragmentationFlags(), pData, nDataSize);
 		if (nRetVal != XN_STATUS_OK)
 		{
 			m_currentFrameCorrupt = true;
@@ -270,6 +279,7 @@ XnStatus LinkFrameInputStream::HandlePacket(const LinkPacketHeader& origHeader,
 		{
 			//Save actual size of data in working buffer info
 			m_pCurrFrame->dataSize = m_pLinkMsgParser->GetParsedSize();
+			m_nLastFrameCopiedBytes = m_pLinkMsgParser->GetCopiedSize();
 			m_pCurrFrame->frameIndex            = ++m_frameIndex;
 			m_pCurrFrame->croppingEnabled       = m_cropping.enabled;
 			if (m_cropping.enabled)
@@ -376,6 +386,9 @@ XnStatus LinkFrameInputStream::StopImpl()
 	XN_IS_STATUS_OK_LOG_ERROR("Stop streaming", nRetVal);
 	m_pConnection->Disconnect();
 
+	//Packets may still be parsed on a decode thread after the connection is gone
+	xnl::AutoCSLocker csLock(m_hCriticalSection);
+
 	if (m_pLinkMsgParser != NULL)
 	{
 		m_pLinkMsgParser->Shutdown();
@@ -58,6 +58,11 @@ public:
 
 	uint32_t GetRequiredFrameSize() const { return CalcBufferSize(); }
 
+	/* Bytes copied as-is while parsing the last complete frame. Equals the frame size when the wire format is
+	   the output format (a single copy from the transfer buffers into the frame), and counts only staging
+	   copies for decoding parsers. */
+	uint32_t GetLastFrameCopiedBytes() const { return m_nLastFrameCopiedBytes; }
+
 	virtual void Reset();
 
 	virtual bool IsInitialized() const;
@@ -131,6 +136,7 @@ private:
 
 	uint32_t m_nBufferSize;
 	LinkMsgParser* m_pLinkMsgParser;
+	uint32_t m_nLastFrameCopiedBytes;
 
 	XnDumpFile* m_pDumpFile;
 	char m_strDumpName[XN_FILE_MAX_PATH];
@@ -41,10 +41,30 @@ const uint32_t LinkInputStreamsMgr::FRAG_FLAGS_ALLOWED_CHANGES[4][4] = {
 	/* Allowed state changes from SINGLE: */ {0, 1, 0, 1},
 };
 const uint16_t LinkInputStreamsMgr::INITIAL_PACKET_ID = 1;
+const uint32_t LinkInputStreamsMgr::DECODE_QUEUE_SIZE = 4 * 1024 * 1024;
+const uint32_t LinkInputStreamsMgr::DECODE_THREAD_WAIT_TIMEOUT = 100;
+const uint32_t LinkInputStreamsMgr::DECODE_THREAD_TERMINATE_TIMEOUT = 3000;
 
 LinkInputStreamsMgr::LinkInputStreamsMgr()
 {
-	xnOSMemSet(&m_streamInfos, 0, sizeof(m_streamInfos));
+	for (uint16_t nStreamID = 0; nStreamID < XN_LINK_MAX_STREAMS; nStreamID++)
+	{
+		StreamInfo& streamInfo = m_streamInfos[nStreamID];
+		streamInfo.nNextPacketID = 0;
+		streamInfo.nMsgType = 0;
+		streamInfo.prevFragmentation = XN_LINK_FRAG_MIDDLE;
+		streamInfo.streamFragLevel = XN_LINK_STREAM_FRAG_LEVEL_NONE;
+		streamInfo.pInputStream = NULL;
+		streamInfo.pDecodeWorker = NULL;
+		streamInfo.nDecodeWorkerUsers = 0;
+		streamInfo.bDecodeWorkerStopping = false;
+		streamInfo.packetLoss = false;
+		streamInfo.streamType = (XnStreamType)0;
+		streamInfo.strCreationInfo = NULL;
+		streamInfo.refCount = 0;
+	}
+	m_bDecodeThreadsEnabled = false;
+	m_hDecodeWorkerReleasedEvent = NULL;
 }
 
 LinkInputStreamsMgr::~LinkInputStreamsMgr()
@@ -54,6 +74,12 @@ LinkInputStreamsMgr::~LinkInputStreamsMgr()
 
 XnStatus LinkInputStreamsMgr::Init()
 {
+	if (m_hDecodeWorkerReleasedEvent == NULL)
+	{
+		XnStatus nRetVal = xnOSCreateEvent(&m_hDecodeWorkerReleasedEvent, false);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
 	return XN_STATUS_OK;
 }
 
@@ -63,6 +89,12 @@ void LinkInputStreamsMgr::Shutdown()
 	{
 		ShutdownInputStream(nStreamID);
 	}
+
+	if (m_hDecodeWorkerReleasedEvent != NULL)
+	{
+		xnOSCloseEvent(&m_hDecodeWorkerReleasedEvent);
+		m_hDecodeWorkerReleasedEvent = NULL;
+	}
 }
 
 void LinkInputStreamsMgr::RegisterStreamOfType(XnStreamType streamType, const char* strCreationInfo, uint16_t nStreamID)
@@ -200,11 +232,25 @@ XnStatus LinkInputStreamsMgr::InitInputStream(LinkControlEndpoint* pLinkControlE
 	streamInfo.streamFragLevel = streamFragLevel;
 	streamInfo.prevFragmentation = XN_LINK_FRAG_END; // this means we now expect BEGIN
 	streamInfo.packetLoss = false;
+
+	if (m_bDecodeThreadsEnabled && streamFragLevel == XN_LINK_STREAM_FRAG_LEVEL_FRAMES && streamInfo.pDecodeWorker == NULL)
+	{
+		nRetVal = StartDecodeWorker(nStreamID);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			//Not fatal - packets of this stream will be parsed on the receiving thread
+			xnLogWarning(XN_MASK_LINK, "Failed to start decode thread for stream %u: %s", nStreamID, xnGetStatusString(nRetVal));
+		}
+	}
+
 	return XN_STATUS_OK;
 }
 
 void LinkInputStreamsMgr::ShutdownInputStream(uint16_t nStreamID)
 {
+	//The decode thread must not touch the stream once it starts shutting down
+	StopDecodeWorker(nStreamID);
+
 	LinkInputStream* pLinkInputStream = GetInputStream(nStreamID);
 	if (pLinkInputStream != NULL)
 	{
@@ -278,6 +324,17 @@ void LinkInputStreamsMgr::HandlePacket(const LinkPacketHeader* pLinkPacketHeader
 		return;
 	}
 
+	//Announce we're using the worker before reading it, so StopDecodeWorker() either sees us or we see NULL
+	++pStreamInfo->nDecodeWorkerUsers;
+	DecodeWorker* pWorker = pStreamInfo->pDecodeWorker;
+	if (pWorker != NULL)
+	{
+		EnqueuePacket(pWorker, pLinkPacketHeader);
+		ReleaseDecodeWorker(nStreamID);
+		return;
+	}
+	ReleaseDecodeWorker(nStreamID);
+
 	// the data is immediately after the header
 	const uint8_t* pPacketData = reinterpret_cast<const uint8_t*>(pLinkPacketHeader + 1);
 	XnStatus nRetVal = pStreamInfo->pInputStream->HandlePacket(*pLinkPacketHeader, pPacketData, pStreamInfo->packetLoss);
@@ -289,6 +346,165 @@ void LinkInputStreamsMgr::HandlePacket(const LinkPacketHeader* pLinkPacketHeader
 	}
 }
 
+void LinkInputStreamsMgr::EnqueuePacket(DecodeWorker* pWorker, const LinkPacketHeader* pLinkPacketHeader)
+{
+	StreamInfo* pStreamInfo = &m_streamInfos[pWorker->nStreamID];
+	bool bWasEmpty = false;
+
+	if (!pWorker->queue.Push(pLinkPacketHeader, pStreamInfo->packetLoss, bWasEmpty))
+	{
+		//The decoder fell behind. Drop the packet and let the stream discard the frame it belongs to.
+		xnLogWarning(XN_MASK_LINK, "Decode queue of stream %u is full - dropping packet %u",
+			pWorker->nStreamID, pLinkPacketHeader->GetPacketID());
+		pStreamInfo->packetLoss = true;
+		return;
+	}
+
+	//A frame input stream clears the packet loss flag once it gets a BEGIN packet
+	if (pLinkPacketHeader->GetFragmentationFlags() & XN_LINK_FRAG_BEGIN)
+	{
+		pStreamInfo->packetLoss = false;
+	}
+
+	if (bWasEmpty)
+	{
+		xnOSSetEvent(pWorker->hDataEvent);
+	}
+}
+
+XnStatus LinkInputStreamsMgr::StartDecodeWorker(uint16_t nStreamID)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	DecodeWorker* pWorker = XN_NEW(DecodeWorker);
+	XN_VALIDATE_ALLOC_PTR(pWorker);
+	pWorker->pMgr = this;
+	pWorker->nStreamID = nStreamID;
+	pWorker->hThread = NULL;
+	pWorker->hDataEvent = NULL;
+	pWorker->bStop = false;
+
+	nRetVal = pWorker->queue.Init(DECODE_QUEUE_SIZE);
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = xnOSCreateEvent(&pWorker->hDataEvent, false);
+	}
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = xnOSCreateThread(DecodeThreadProc, pWorker, &pWorker->hThread);
+	}
+	if (nRetVal != XN_STATUS_OK)
+	{
+		if (pWorker->hDataEvent != NULL)
+		{
+			xnOSCloseEvent(&pWorker->hDataEvent);
+		}
+		XN_DELETE(pWorker);
+		return nRetVal;
+	}
+
+	char strThreadName[16];
+	uint32_t nChars;
+	xnOSStrFormat(strThreadName, sizeof(strThreadName), &nChars, "Decode-%u", nStreamID);
+	xnOSApplyThreadPolicy(pWorker->hThread, XN_THREAD_CLASS_DECODE, strThreadName);
+
+	xnLogVerbose(XN_MASK_LINK, "Stream %u packets will be parsed on a dedicated decode thread", nStreamID);
+	m_streamInfos[nStreamID].pDecodeWorker = pWorker;
+	return XN_STATUS_OK;
+}
+
+void LinkInputStreamsMgr::StopDecodeWorker(uint16_t nStreamID)
+{
+	StreamInfo& streamInfo = m_streamInfos[nStreamID];
+
+	//Stop routing packets to the worker before it goes away
+	DecodeWorker* pWorker = streamInfo.pDecodeWorker.exchange(NULL);
+	if (pWorker == NULL)
+	{
+		return;
+	}
+
+	//The receiving thread may still be pushing a packet it routed before the exchange. It signals once it lets go.
+	streamInfo.bDecodeWorkerStopping = true;
+	while (streamInfo.nDecodeWorkerUsers != 0)
+	{
+		xnOSWaitEvent(m_hDecodeWorkerReleasedEvent, DECODE_THREAD_WAIT_TIMEOUT);
+	}
+	streamInfo.bDecodeWorkerStopping = false;
+
+	pWorker->bStop = true;
+	xnOSSetEvent(pWorker->hDataEvent);
+	XnStatus nRetVal = xnOSWaitAndTerminateThread(&pWorker->hThread, DECODE_THREAD_TERMINATE_TIMEOUT);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_LINK, "Failed to shutdown decode thread of stream %u: %s", nStreamID, xnGetStatusString(nRetVal));
+		XN_ASSERT(false);
+	}
+
+	//Packets still queued belong to a stream that is going away - drop them
+	uint32_t nDropped = 0;
+	bool bPacketLoss = false;
+	while (pWorker->queue.Peek(bPacketLoss) != NULL)
+	{
+		pWorker->queue.Pop();
+		++nDropped;
+	}
+	if (nDropped != 0)
+	{
+		xnLogVerbose(XN_MASK_LINK, "Dropped %u packets queued for the decode thread of stream %u", nDropped, nStreamID);
+	}
+
+	xnOSCloseEvent(&pWorker->hDataEvent);
+	pWorker->queue.Shutdown();
+	XN_DELETE(pWorker);
+}
+
+void LinkInputStreamsMgr::ReleaseDecodeWorker(uint16_t nStreamID)
+{
+	StreamInfo& streamInfo = m_streamInfos[nStreamID];
+	if (--streamInfo.nDecodeWorkerUsers == 0 && streamInfo.bDecodeWorkerStopping)
+	{
+		xnOSSetEvent(m_hDecodeWorkerReleasedEvent);
+	}
+}
+
+XN_THREAD_PROC LinkInputStreamsMgr::DecodeThreadProc(XN_THREAD_PARAM pThreadParam)
+{
+	DecodeWorker* pWorker = reinterpret_cast<DecodeWorker*>(pThreadParam);
+	pWorker->pMgr->DecodeThreadLoop(pWorker);
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void LinkInputStreamsMgr::DecodeThreadLoop(DecodeWorker* pWorker)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	LinkInputStream* pInputStream = m_streamInfos[pWorker->nStreamID].pInputStream;
+
+	while (!pWorker->bStop)
+	{
+		//Packets come out in the order they were validated, each with the packet loss state it had then
+		bool bPacketLoss = false;
+		const LinkPacketHeader* pLinkPacketHeader = NULL;
+		while (!pWorker->bStop && (pLinkPacketHeader = pWorker->queue.Peek(bPacketLoss)) != NULL)
+		{
+			if (pInputStream->IsStreaming())
+			{
+				nRetVal = pInputStream->HandlePacket(*pLinkPacketHeader, pLinkPacketHeader->GetPacketData(), bPacketLoss);
+				if (nRetVal != XN_STATUS_OK)
+				{
+					xnLogWarning(XN_MASK_LINK, "Failed to handle packet of %u bytes in stream %u: %s",
+						pLinkPacketHeader->GetDataSize(), pWorker->nStreamID, xnGetStatusString(nRetVal));
+				}
+			}
+
+			pWorker->queue.Pop();
+		}
+
+		xnOSWaitEvent(pWorker->hDataEvent, DECODE_THREAD_WAIT_TIMEOUT);
+	}
+}
+
 XnStatus LinkInputStreamsMgr::HandleData(const void* pData, uint32_t nSize)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -25,8 +25,11 @@
 #include "XnLinkProtoLibDefs.h"
 #include "XnLinkProtoUtils.h"
 #include "XnLinkInputStream.h"
+#include "XnLinkPacketQueue.h"
 #include <XnStatus.h>
 #include <XnHash.h>
+#include <XnOS.h>
+#include <atomic>
 
 namespace xn
 {
@@ -60,12 +63,36 @@ public:
 
 	bool HasStreams() const;
 
+	/* When enabled, packets of frame streams initialized from now on are handed to a decode thread per stream
+	   instead of being parsed on the thread that received them. */
+	void SetDecodeThreadsEnabled(bool bEnabled) { m_bDecodeThreadsEnabled = bEnabled; }
+	bool IsDecodeThreadsEnabled() const { return m_bDecodeThreadsEnabled; }
+
 private:
+	struct DecodeWorker
+	{
+		LinkInputStreamsMgr* pMgr;
+		uint16_t nStreamID;
+		LinkPacketQueue queue;
+		XN_THREAD_HANDLE hThread;
+		XN_EVENT_HANDLE hDataEvent;
+		std::atomic<bool> bStop;
+	};
+
 	void HandlePacket(const LinkPacketHeader* pLinkPacketHeader);
+	void EnqueuePacket(DecodeWorker* pWorker, const LinkPacketHeader* pLinkPacketHeader);
+	XnStatus StartDecodeWorker(uint16_t nStreamID);
+	void StopDecodeWorker(uint16_t nStreamID);
+	void ReleaseDecodeWorker(uint16_t nStreamID);
+	static XN_THREAD_PROC DecodeThreadProc(XN_THREAD_PARAM pThreadParam);
+	void DecodeThreadLoop(DecodeWorker* pWorker);
 	int FindStreamByType(XnStreamType streamType, const char* strCreationInfo); //returns found streamId, or -1
 
 	static const uint32_t FRAG_FLAGS_ALLOWED_CHANGES[4][4];
 	static const uint16_t INITIAL_PACKET_ID;
+	static const uint32_t DECODE_QUEUE_SIZE;
+	static const uint32_t DECODE_THREAD_WAIT_TIMEOUT;
+	static const uint32_t DECODE_THREAD_TERMINATE_TIMEOUT;
 
 	struct StreamInfo
 	{
@@ -74,6 +101,12 @@ private:
 		XnLinkFragmentation prevFragmentation;
 		XnStreamFragLevel streamFragLevel;
 		LinkInputStream* pInputStream;
+		/* Set and cleared on the control thread, read on the receiving thread. The receiving thread counts itself
+		   in nDecodeWorkerUsers while it holds the pointer, so a stopped worker is only freed once nothing uses it.
+		   While bDecodeWorkerStopping is set, the last user to let go signals m_hDecodeWorkerReleasedEvent. */
+		std::atomic<DecodeWorker*> pDecodeWorker;
+		std::atomic<uint32_t> nDecodeWorkerUsers;
+		std::atomic<bool> bDecodeWorkerStopping;
 		bool packetLoss;
 
 		XnStreamType streamType;
@@ -82,6 +115,8 @@ private:
 	};
 
 	StreamInfo m_streamInfos[XN_LINK_MAX_STREAMS];
+	XN_EVENT_HANDLE m_hDecodeWorkerReleasedEvent;
+	bool m_bDecodeThreadsEnabled;
 };
 
 }
@@ -32,6 +32,7 @@ LinkMsgParser::LinkMsgParser()
 	m_pDestBuffer = NULL;
 	m_pCurrDest = NULL;
 	m_pDestEnd = NULL;
+	m_nCopiedBytes = 0;
 }
 
 LinkMsgParser::~LinkMsgParser()
@@ -57,14 +58,20 @@ XnStatus LinkMsgParser::BeginParsing(void* pDestBuffer, uint32_t nDestBufferSize
 	m_pDestBuffer = reinterpret_cast<uint8_t*>(pDestBuffer);
 	m_pCurrDest = m_pDestBuffer;
 	m_pDestEnd = m_pDestBuffer + nDestBufferSize;
+	m_nCopiedBytes = 0;
 
 	return XN_STATUS_OK;
 }
 
 XnStatus LinkMsgParser::ParsePacket(const LinkPacketHeader& header, const uint8_t* pData)
+{
+	return ParsePacket(header.GetFragmentationFlags(), pData, header.GetDataSize());
+}
+
+XnStatus LinkMsgParser::ParsePacket(XnLinkFragmentation fragmentation, const uint8_t* pData, uint32_t nDataSize)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
-	nRetVal = ParsePacketImpl(header.GetFragmentationFlags(), pData, pData + header.GetDataSize(), m_pCurrDest, m_pDestEnd);
+	nRetVal = ParsePacketImpl(fragmentation, pData, pData + nDataSize, m_pCurrDest, m_pDestEnd);
 	XN_IS_STATUS_OK(nRetVal);
 
 	return XN_STATUS_OK;
@@ -85,6 +92,11 @@ uint32_t LinkMsgParser::GetBufferSize() const
 	return uint32_t(m_pDestEnd - m_pDestBuffer);
 }
 
+uint32_t LinkMsgParser::GetCopiedSize() const
+{
+	return m_nCopiedBytes;
+}
+
 XnStatus LinkMsgParser::ParsePacketImpl(XnLinkFragmentation /*fragmentation*/,
 					const uint8_t* pSrc,
 					const uint8_t* pSrcEnd,
@@ -100,6 +112,7 @@ XnStatus LinkMsgParser::ParsePacketImpl(XnLinkFragmentation /*fragmentation*/,
 
 	xnOSMemCopy(pDst, pSrc, nPacketDataSize);
 	pDst += nPacketDataSize;
+	AddCopiedBytes((uint32_t)nPacketDataSize);
 
 	return XN_STATUS_OK;
 }
@@ -37,12 +37,18 @@ public:
 
 	XnStatus BeginParsing(void* pDestBuffer, uint32_t nDestBufferSize);
 	XnStatus ParsePacket(const LinkPacketHeader& header, const uint8_t* pData);
+	XnStatus ParsePacket(XnLinkFragmentation fragmentation, const uint8_t* pData, uint32_t nDataSize);
 
 	const void* GetParsedData() const;
 	uint32_t GetParsedSize() const;
 	uint32_t GetBufferSize() const;
 
+	/* Number of bytes copied as-is (to the destination or to internal staging buffers) since BeginParsing(). */
+	uint32_t GetCopiedSize() const;
+
 protected:
+	void AddCopiedBytes(uint32_t nBytes) { m_nCopiedBytes += nBytes; }
+
 	virtual XnStatus ParsePacketImpl(XnLinkFragmentation fragmentation,
 					const uint8_t* pSrc,
 	                                const uint8_t* pSrcEnd,
@@ -53,6 +59,7 @@ private:
 	uint8_t* m_pDestBuffer;
 	uint8_t* m_pCurrDest;
 	uint8_t* m_pDestEnd;
+	uint32_t m_nCopiedBytes;
 };
 
 }
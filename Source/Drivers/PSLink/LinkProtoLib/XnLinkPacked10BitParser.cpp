@@ -20,14 +20,44 @@
 *****************************************************************************/
 #include "XnLinkPacked10BitParser.h"
 #include "XnLinkProtoUtils.h"
+#include "XnLinkSimd.h"
 #include <XnOS.h>
 
+#if XN_LINK_SIMD_X86
+	#include <tmmintrin.h>
+#endif
+
 namespace xn
 {
 
+#if XN_LINK_SIMD_X86
+/* Unpacks whole 5 byte groups (4 words each) while at least 16 bytes can be loaded. Returns the first byte
+   that was not unpacked - always the beginning of a group. */
+static XN_LINK_TARGET_SSSE3 const uint8_t* Unpack10BitSSSE3(const uint8_t* pSrc, const uint8_t* pSrcEnd, uint16_t*& pDstWord)
+{
+	//Each 16 bit lane gets the two bytes its word spans, big endian (first byte is the high one)
+	const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 3, 2, 4, 3, 6, 5, 7, 6, 8, 7, 9, 8);
+	//Word k of a group starts 2k bits into its first byte - shift it to the top of the lane, then down to bit 0
+	const __m128i multiplier = _mm_setr_epi16(1, 4, 16, 64, 1, 4, 16, 64);
+
+	while (pSrcEnd - pSrc >= 16)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+		__m128i pairs = _mm_shuffle_epi8(bytes, shuffle);
+		__m128i words = _mm_srli_epi16(_mm_mullo_epi16(pairs, multiplier), 6);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDstWord), words);
+		pSrc += 10;
+		pDstWord += 8;
+	}
+
+	return pSrc;
+}
+#endif
+
 LinkPacked10BitParser::LinkPacked10BitParser()
 {
 	m_nState = 0;
+	m_bUseSSSE3 = (xnLinkGetSimdLevel() >= XN_LINK_SIMD_SSSE3);
 }
 
 LinkPacked10BitParser::~LinkPacked10BitParser()
@@ -69,8 +99,19 @@ XnStatus LinkPacked10BitParser::ParsePacketImpl(XnLinkFragmentation fragmentatio
 		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
 	}
 
+	bool bVectorize = m_bUseSSSE3;
+
 	while (pSrc < pSrcEnd)
 	{
+#if XN_LINK_SIMD_X86
+		if (bVectorize && m_nState == 0)
+		{
+			//Bulk of the packet - the rest (less than 16 bytes) is unpacked below
+			pSrc = Unpack10BitSSSE3(pSrc, pSrcEnd, pDstWord);
+			bVectorize = false;
+			continue;
+		}
+#endif
 		switch (m_nState)
 		{
 			case 0:
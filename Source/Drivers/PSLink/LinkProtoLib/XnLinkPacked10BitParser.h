@@ -40,6 +40,7 @@ public:
 
 private:
 	uint32_t m_nState;
+	bool m_bUseSSSE3;
 };
 
 }
@@ -0,0 +1,154 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnLinkPacketQueue.h"
+#include <XnOS.h>
+
+namespace xn
+{
+
+const uint32_t LinkPacketQueue::RECORD_ALIGNMENT = 8;
+
+static inline uint32_t AlignUp(uint32_t nValue, uint32_t nAlignment)
+{
+	return (nValue + nAlignment - 1) / nAlignment * nAlignment;
+}
+
+LinkPacketQueue::LinkPacketQueue() :
+	m_pBuffer(NULL),
+	m_nCapacity(0),
+	m_nReadPos(0),
+	m_nWritePos(0)
+{
+}
+
+LinkPacketQueue::~LinkPacketQueue()
+{
+	Shutdown();
+}
+
+XnStatus LinkPacketQueue::Init(uint32_t nCapacity)
+{
+	Shutdown();
+
+	//Keep every record aligned, so a wrap marker always fits at the end of the buffer
+	nCapacity = AlignUp(nCapacity, RECORD_ALIGNMENT);
+	m_pBuffer = reinterpret_cast<uint8_t*>(xnOSMallocAligned(nCapacity, XN_DEFAULT_MEM_ALIGN));
+	XN_VALIDATE_ALLOC_PTR(m_pBuffer);
+
+	m_nCapacity = nCapacity;
+	m_nReadPos = 0;
+	m_nWritePos = 0;
+
+	return XN_STATUS_OK;
+}
+
+void LinkPacketQueue::Shutdown()
+{
+	xnOSFreeAligned(m_pBuffer);
+	m_pBuffer = NULL;
+	m_nCapacity = 0;
+	m_nReadPos = 0;
+	m_nWritePos = 0;
+}
+
+bool LinkPacketQueue::Push(const LinkPacketHeader* pPacket, bool bPacketLoss, bool& bWasEmpty)
+{
+	bWasEmpty = false;
+
+	uint32_t nRecordSize = AlignUp(sizeof(RecordHeader) + pPacket->GetSize(), RECORD_ALIGNMENT);
+	uint32_t nWritePos = m_nWritePos.load(std::memory_order_relaxed);
+	uint32_t nReadPos = m_nReadPos.load();
+
+	//The write position may never catch up with the read position, as that would make the queue look empty
+	uint32_t nRecordPos = nWritePos;
+	if (nWritePos >= nReadPos)
+	{
+		uint32_t nSpaceToEnd = m_nCapacity - nWritePos;
+		if (nRecordSize > nSpaceToEnd || (nRecordSize == nSpaceToEnd && nReadPos == 0))
+		{
+			//Doesn't fit at the end - wrap around
+			if (nRecordSize >= nReadPos)
+			{
+				return false;
+			}
+			nRecordPos = 0;
+		}
+	}
+	else if (nRecordSize >= nReadPos - nWritePos)
+	{
+		return false;
+	}
+
+	RecordHeader* pRecord = reinterpret_cast<RecordHeader*>(m_pBuffer + nRecordPos);
+	pRecord->nSize = nRecordSize;
+	pRecord->nPacketLoss = bPacketLoss;
+	xnOSMemCopy(pRecord + 1, pPacket, pPacket->GetSize());
+
+	if (nRecordPos != nWritePos)
+	{
+		reinterpret_cast<RecordHeader*>(m_pBuffer + nWritePos)->nSize = 0;
+	}
+
+	//Publish the record, then check if the consumer had caught up with us before it
+	m_nWritePos.store((nRecordPos + nRecordSize) % m_nCapacity);
+	bWasEmpty = (m_nReadPos.load() == nWritePos);
+
+	return true;
+}
+
+const LinkPacketHeader* LinkPacketQueue::Peek(bool& bPacketLoss)
+{
+	uint32_t nReadPos = m_nReadPos.load(std::memory_order_relaxed);
+	if (nReadPos == m_nWritePos.load())
+	{
+		return NULL;
+	}
+
+	RecordHeader* pRecord = reinterpret_cast<RecordHeader*>(m_pBuffer + nReadPos);
+	if (pRecord->nSize == 0)
+	{
+		pRecord = reinterpret_cast<RecordHeader*>(m_pBuffer);
+	}
+
+	bPacketLoss = (pRecord->nPacketLoss != 0);
+	return reinterpret_cast<const LinkPacketHeader*>(pRecord + 1);
+}
+
+void LinkPacketQueue::Pop()
+{
+	uint32_t nReadPos = m_nReadPos.load(std::memory_order_relaxed);
+	if (nReadPos == m_nWritePos.load())
+	{
+		XN_ASSERT(false);
+		return;
+	}
+
+	const RecordHeader* pRecord = reinterpret_cast<const RecordHeader*>(m_pBuffer + nReadPos);
+	if (pRecord->nSize == 0)
+	{
+		nReadPos = 0;
+		pRecord = reinterpret_cast<const RecordHeader*>(m_pBuffer);
+	}
+
+	m_nReadPos.store((nReadPos + pRecord->nSize) % m_nCapacity);
+}
+
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNLINKPACKETQUEUE_H
+#define XNLINKPACKETQUEUE_H
+
+#include <atomic>
+
+#include "XnLinkProtoUtils.h"
+#include <XnStatus.h>
+
+namespace xn
+{
+
+/**
+ * A lock-free, single producer / single consumer queue of link packets. Packets are copied into a ring
+ * buffer by the producer and read in place by the consumer.
+ */
+class LinkPacketQueue
+{
+public:
+	LinkPacketQueue();
+	~LinkPacketQueue();
+
+	XnStatus Init(uint32_t nCapacity);
+	void Shutdown();
+
+	/* Producer side. Returns false if there isn't enough room for the packet. bWasEmpty is set to true if
+	   the consumer had already taken everything before this packet, i.e. it may be waiting for more. */
+	bool Push(const LinkPacketHeader* pPacket, bool bPacketLoss, bool& bWasEmpty);
+
+	/* Consumer side. Returns the oldest packet, or NULL if the queue is empty. The packet stays valid until Pop(). */
+	const LinkPacketHeader* Peek(bool& bPacketLoss);
+	void Pop();
+
+private:
+	struct RecordHeader
+	{
+		uint32_t nSize; //Size of the whole record. 0 means the next record is at the start of the buffer.
+		uint32_t nPacketLoss;
+	};
+
+	static const uint32_t RECORD_ALIGNMENT;
+
+	uint8_t* m_pBuffer;
+	uint32_t m_nCapacity;
+	std::atomic<uint32_t> m_nReadPos;
+	std::atomic<uint32_t> m_nWritePos;
+};
+
+}
+
+#endif // XNLINKPACKETQUEUE_H
@@ -58,9 +58,12 @@ typedef enum XnTransportType
 {
 	XN_TRANSPORT_TYPE_NONE = 0,
 	XN_TRANSPORT_TYPE_USB = 1,
-	XN_TRANSPORT_TYPE_SOCKETS = 2
+	XN_TRANSPORT_TYPE_SOCKETS = 2,
+	XN_TRANSPORT_TYPE_LOOPBACK = 3
 } XnTransportType;
 
+#define XN_LINK_LOOPBACK_URI_PREFIX "loopback://"
+
 #define XN_FORMAT_PASS_THROUGH_UNPACK  (OniPixelFormat)0
 #define XN_FORMAT_PASS_THROUGH_RAW     (OniPixelFormat)1
 
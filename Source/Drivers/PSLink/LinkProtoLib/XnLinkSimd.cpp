@@ -0,0 +1,105 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnLinkSimd.h"
+
+#if XN_LINK_SIMD_X86 && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace xn
+{
+
+static XnLinkSimdLevel DetectSimdLevel()
+{
+#if XN_LINK_SIMD_X86 && defined(_MSC_VER)
+	int aCPUInfo[4] = {0};
+	__cpuid(aCPUInfo, 1);
+	bool bSSSE3 = (aCPUInfo[2] & (1 << 9)) != 0;
+	//AVX state must also be enabled by the OS (OSXSAVE, and XMM/YMM state in XCR0)
+	bool bAVXEnabled = ((aCPUInfo[2] & (1 << 27)) != 0) && ((aCPUInfo[2] & (1 << 28)) != 0) && ((_xgetbv(0) & 0x6) == 0x6);
+
+	__cpuidex(aCPUInfo, 7, 0);
+	if (bAVXEnabled && (aCPUInfo[1] & (1 << 5)))
+	{
+		return XN_LINK_SIMD_AVX2;
+	}
+	if (bSSSE3)
+	{
+		return XN_LINK_SIMD_SSSE3;
+	}
+	return XN_LINK_SIMD_NONE;
+#elif XN_LINK_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return XN_LINK_SIMD_AVX2;
+	}
+	if (__builtin_cpu_supports("ssse3"))
+	{
+		return XN_LINK_SIMD_SSSE3;
+	}
+	return XN_LINK_SIMD_NONE;
+#else
+	return XN_LINK_SIMD_NONE;
+#endif
+}
+
+/* Both levels are function-local statics, so the CPU is only checked once, and parsers created while
+   initializing globals (in any order) see the detected level. */
+static XnLinkSimdLevel& CurrentSimdLevel()
+{
+	static XnLinkSimdLevel nLevel = xnLinkGetSupportedSimdLevel();
+	return nLevel;
+}
+
+XnLinkSimdLevel xnLinkGetSupportedSimdLevel()
+{
+	static const XnLinkSimdLevel nSupportedLevel = DetectSimdLevel();
+	return nSupportedLevel;
+}
+
+XnLinkSimdLevel xnLinkGetSimdLevel()
+{
+	return CurrentSimdLevel();
+}
+
+void xnLinkSetSimdLevel(XnLinkSimdLevel nLevel)
+{
+	XnLinkSimdLevel nSupportedLevel = xnLinkGetSupportedSimdLevel();
+	CurrentSimdLevel() = (nLevel < nSupportedLevel) ? nLevel : nSupportedLevel;
+}
+
+const char* xnLinkSimdLevelToName(XnLinkSimdLevel nLevel)
+{
+	switch (nLevel)
+	{
+		case XN_LINK_SIMD_NONE:
+			return "Scalar";
+		case XN_LINK_SIMD_SSSE3:
+			return "SSSE3";
+		case XN_LINK_SIMD_AVX2:
+			return "AVX2";
+		default:
+			return "Unknown";
+	}
+}
+
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNLINKSIMD_H
+#define XNLINKSIMD_H
+
+#include <XnPlatform.h>
+
+/* Vectorized parser paths are compiled on x86 only. Each kernel is built for its own instruction set
+   (no global compiler flags needed) and is only called after the CPU was checked to support it. */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+	#define XN_LINK_SIMD_X86 1
+	#define XN_LINK_TARGET_SSSE3 __attribute__((target("ssse3")))
+	#define XN_LINK_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	#define XN_LINK_SIMD_X86 1
+	#define XN_LINK_TARGET_SSSE3
+	#define XN_LINK_TARGET_AVX2
+#else
+	#define XN_LINK_SIMD_X86 0
+#endif
+
+namespace xn
+{
+
+enum XnLinkSimdLevel
+{
+	XN_LINK_SIMD_NONE = 0,
+	XN_LINK_SIMD_SSSE3 = 1,
+	XN_LINK_SIMD_AVX2 = 2,
+};
+
+/* Best instruction set the parsers can use on this CPU. */
+XnLinkSimdLevel xnLinkGetSupportedSimdLevel();
+
+/* Instruction set parsers created from now on will use. Defaults to the supported level. */
+XnLinkSimdLevel xnLinkGetSimdLevel();
+
+/* Limits parsers created from now on to nLevel (never above the supported level). XN_LINK_SIMD_NONE
+   forces the scalar code, which is useful for benchmarking and for checking the vectorized paths. */
+void xnLinkSetSimdLevel(XnLinkSimdLevel nLevel);
+
+const char* xnLinkSimdLevelToName(XnLinkSimdLevel nLevel);
+
+}
+
+#endif // XNLINKSIMD_H
@@ -0,0 +1,117 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnLoopbackConnectionFactory.h"
+#include "XnLoopbackInDataEndpoint.h"
+#include "XnLinkProtoUtils.h"
+#include <XnLog.h>
+
+namespace xn
+{
+
+LoopbackConnectionFactory::LoopbackConnectionFactory(uint16_t nInputConnections) :
+	m_nInputConnections(nInputConnections),
+	m_bInitialized(false)
+{
+}
+
+LoopbackConnectionFactory::~LoopbackConnectionFactory()
+{
+	Shutdown();
+}
+
+XnStatus LoopbackConnectionFactory::Init(const char* strConnString)
+{
+	XnStatus nRetVal = m_firmware.Init(strConnString);
+	XN_IS_STATUS_OK_LOG_ERROR("Init simulated firmware", nRetVal);
+
+	nRetVal = m_controlEndpoint.Init(&m_firmware);
+	XN_IS_STATUS_OK_LOG_ERROR("Init loopback control endpoint", nRetVal);
+
+	m_bInitialized = true;
+	return XN_STATUS_OK;
+}
+
+void LoopbackConnectionFactory::Shutdown()
+{
+	m_controlEndpoint.Shutdown();
+	m_firmware.Shutdown();
+	m_bInitialized = false;
+}
+
+uint16_t LoopbackConnectionFactory::GetNumInputDataConnections() const
+{
+	return m_nInputConnections;
+}
+
+uint16_t LoopbackConnectionFactory::GetNumOutputDataConnections() const
+{
+	return 0;
+}
+
+bool LoopbackConnectionFactory::IsInitialized() const
+{
+	return m_bInitialized;
+}
+
+XnStatus LoopbackConnectionFactory::GetControlConnection(ISyncIOConnection*& pConn)
+{
+	if (!m_bInitialized)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	pConn = &m_controlEndpoint;
+	return XN_STATUS_OK;
+}
+
+XnStatus LoopbackConnectionFactory::CreateOutputDataConnection(uint16_t /*nID*/, IOutputConnection*& /*pConn*/)
+{
+	//The simulated firmware has no output streams
+	return XN_STATUS_NOT_IMPLEMENTED;
+}
+
+XnStatus LoopbackConnectionFactory::CreateInputDataConnection(uint16_t nID, IAsyncInputConnection*& pConn)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (!m_bInitialized)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	LoopbackInDataEndpoint* pLoopbackInDataEndpoint = XN_NEW(LoopbackInDataEndpoint);
+	XN_VALIDATE_ALLOC_PTR(pLoopbackInDataEndpoint);
+	nRetVal = pLoopbackInDataEndpoint->Init(&m_firmware, nID);
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogError(XN_MASK_LINK, "Failed to initialize loopback input data endpoint %u: %s",
+			nID, xnGetStatusString(nRetVal));
+		XN_ASSERT(false);
+		XN_DELETE(pLoopbackInDataEndpoint);
+		return nRetVal;
+	}
+	pConn = pLoopbackInDataEndpoint;
+
+	return XN_STATUS_OK;
+}
+
+}
@@ -0,0 +1,62 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNLOOPBACKCONNECTIONFACTORY_H
+#define XNLOOPBACKCONNECTIONFACTORY_H
+
+#include "IConnectionFactory.h"
+#include "XnLinkProtoLibDefs.h"
+#include "XnLoopbackControlEndpoint.h"
+#include "XnSimulatedLinkFirmware.h"
+
+namespace xn
+{
+
+/* Connection factory that connects the link protocol stack to an in-process simulated firmware, so the
+   driver can be exercised without a device. The connection string is a XN_LINK_LOOPBACK_URI_PREFIX URI
+   (see SimulatedLinkFirmware for the supported options). */
+class LoopbackConnectionFactory : public IConnectionFactory
+{
+public:
+	LoopbackConnectionFactory(uint16_t nInputConnections);
+
+	virtual ~LoopbackConnectionFactory();
+	virtual XnStatus Init(const char* strConnString);
+	virtual void Shutdown();
+	virtual bool IsInitialized() const;
+
+	virtual uint16_t GetNumOutputDataConnections() const;
+	virtual uint16_t GetNumInputDataConnections() const;
+
+	virtual XnStatus GetControlConnection(ISyncIOConnection*& pConn);
+	virtual XnStatus CreateOutputDataConnection(uint16_t nID, IOutputConnection*& pConn);
+	virtual XnStatus CreateInputDataConnection(uint16_t nID, IAsyncInputConnection*& pConn);
+
+private:
+	uint16_t m_nInputConnections;
+
+	SimulatedLinkFirmware m_firmware;
+	LoopbackControlEndpoint m_controlEndpoint;
+	bool m_bInitialized;
+};
+
+}
+
+#endif // XNLOOPBACKCONNECTIONFACTORY_H
@@ -0,0 +1,118 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnLoopbackControlEndpoint.h"
+#include "XnSimulatedLinkFirmware.h"
+#include <XnOS.h>
+#include <XnLog.h>
+
+namespace xn
+{
+
+LoopbackControlEndpoint::LoopbackControlEndpoint() :
+	m_pFirmware(NULL),
+	m_nPendingResponseSize(0)
+{
+}
+
+LoopbackControlEndpoint::~LoopbackControlEndpoint()
+{
+	Shutdown();
+}
+
+XnStatus LoopbackControlEndpoint::Init(SimulatedLinkFirmware* pFirmware)
+{
+	XN_VALIDATE_INPUT_PTR(pFirmware);
+	m_pFirmware = pFirmware;
+	m_pendingResponse.resize(m_pFirmware->GetControlPacketSize());
+	m_nPendingResponseSize = 0;
+
+	return XN_STATUS_OK;
+}
+
+void LoopbackControlEndpoint::Shutdown()
+{
+	m_pFirmware = NULL;
+	m_nPendingResponseSize = 0;
+}
+
+XnStatus LoopbackControlEndpoint::Connect()
+{
+	//Nothing to do here - the simulated firmware is always there
+	return XN_STATUS_OK;
+}
+
+void LoopbackControlEndpoint::Disconnect()
+{
+}
+
+uint16_t LoopbackControlEndpoint::GetMaxPacketSize() const
+{
+	return (m_pFirmware != NULL) ? m_pFirmware->GetControlPacketSize() : 0;
+}
+
+XnStatus LoopbackControlEndpoint::Receive(void* pData, uint32_t& nSize)
+{
+	XN_VALIDATE_OUTPUT_PTR(pData);
+
+	if (m_nPendingResponseSize == 0)
+	{
+		xnLogError(XN_MASK_LINK, "Loopback control endpoint: receive called with no pending response");
+		XN_ASSERT(false);
+		return XN_STATUS_ERROR;
+	}
+
+	if (nSize < m_nPendingResponseSize)
+	{
+		xnLogError(XN_MASK_LINK, "Loopback control endpoint: response of %u bytes does not fit in %u bytes", m_nPendingResponseSize, nSize);
+		XN_ASSERT(false);
+		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
+	}
+
+	xnOSMemCopy(pData, &m_pendingResponse[0], m_nPendingResponseSize);
+	nSize = m_nPendingResponseSize;
+	m_nPendingResponseSize = 0;
+
+	return XN_STATUS_OK;
+}
+
+XnStatus LoopbackControlEndpoint::Send(const void* pData, uint32_t nSize)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (m_pFirmware == NULL)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	uint32_t nResponseSize = (uint32_t)m_pendingResponse.size();
+	nRetVal = m_pFirmware->HandleControlPacket(pData, nSize, &m_pendingResponse[0], nResponseSize);
+	XN_IS_STATUS_OK_LOG_ERROR("Handle control packet in simulated firmware", nRetVal);
+	m_nPendingResponseSize = nResponseSize;
+
+	return XN_STATUS_OK;
+}
+
+bool LoopbackControlEndpoint::IsConnected() const
+{
+	return (m_pFirmware != NULL);
+}
+
+}
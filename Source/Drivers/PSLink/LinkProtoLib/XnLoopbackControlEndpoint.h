@@ -0,0 +1,60 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNLOOPBACKCONTROLENDPOINT_H
+#define XNLOOPBACKCONTROLENDPOINT_H
+
+#include "ISyncIOConnection.h"
+#include <vector>
+
+namespace xn
+{
+
+class SimulatedLinkFirmware;
+
+/* Control connection that hands each packet to an in-process simulated firmware instead of a USB device. */
+class LoopbackControlEndpoint : virtual public ISyncIOConnection
+{
+public:
+	LoopbackControlEndpoint();
+	virtual ~LoopbackControlEndpoint();
+	// Operations
+	XnStatus Init(SimulatedLinkFirmware* pFirmware);
+	void Shutdown();
+
+	// ISyncIOConnection implementation
+	virtual XnStatus Connect();
+	virtual void Disconnect();
+	virtual bool IsConnected() const;
+	virtual uint16_t GetMaxPacketSize() const;
+
+	//nSize is max size on input, actual size on output
+	virtual XnStatus Receive(void* pData, uint32_t& nSize);
+	virtual XnStatus Send(const void* pData, uint32_t nSize);
+
+private:
+	SimulatedLinkFirmware* m_pFirmware;
+	std::vector<uint8_t> m_pendingResponse;
+	uint32_t m_nPendingResponseSize;
+};
+
+}
+
+#endif // XNLOOPBACKCONTROLENDPOINT_H
@@ -0,0 +1,166 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnLoopbackInDataEndpoint.h"
+#include "XnSimulatedLinkFirmware.h"
+#include <XnLog.h>
+
+namespace xn
+{
+
+const uint32_t LoopbackInDataEndpoint::READ_THREAD_BUFFER_NUM_PACKETS = 32;
+const uint32_t LoopbackInDataEndpoint::READ_THREAD_TERMINATE_TIMEOUT = 3000;
+
+LoopbackInDataEndpoint::LoopbackInDataEndpoint()
+{
+	m_pFirmware = NULL;
+	m_nEndpointID = 0;
+	m_pDataDestination = NULL;
+	m_hReadThread = NULL;
+	m_hStopEvent = NULL;
+	m_bStopReadThread = false;
+	m_bConnected = false;
+}
+
+LoopbackInDataEndpoint::~LoopbackInDataEndpoint()
+{
+	Shutdown();
+}
+
+XnStatus LoopbackInDataEndpoint::Init(SimulatedLinkFirmware* pFirmware, uint16_t nEndpointID)
+{
+	XN_VALIDATE_INPUT_PTR(pFirmware);
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	m_pFirmware = pFirmware;
+	m_nEndpointID = nEndpointID;
+
+	nRetVal = xnOSCreateEvent(&m_hStopEvent, false);
+	XN_IS_STATUS_OK_LOG_ERROR("Create loopback endpoint stop event", nRetVal);
+
+	return XN_STATUS_OK;
+}
+
+void LoopbackInDataEndpoint::Shutdown()
+{
+	Disconnect();
+
+	if (m_hStopEvent != NULL)
+	{
+		xnOSCloseEvent(&m_hStopEvent);
+		m_hStopEvent = NULL;
+	}
+
+	m_pFirmware = NULL;
+}
+
+XnStatus LoopbackInDataEndpoint::Connect()
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	Disconnect(); //In case we were connected already
+
+	if (m_pFirmware == NULL)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	m_bStopReadThread = false;
+	nRetVal = xnOSCreateThread(ReadThreadProc, this, &m_hReadThread);
+	XN_IS_STATUS_OK_LOG_ERROR("Create loopback endpoint read thread", nRetVal);
+	xnOSApplyThreadPolicy(m_hReadThread, XN_THREAD_CLASS_USB_READ, "LoopbackRead");
+	m_bConnected = true;
+
+	return XN_STATUS_OK;
+}
+
+void LoopbackInDataEndpoint::Disconnect()
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	if (m_bConnected)
+	{
+		xnLogVerbose(XN_MASK_LINK, "Shutting down loopback endpoint %u read thread...", m_nEndpointID);
+		m_bStopReadThread = true;
+		xnOSSetEvent(m_hStopEvent);
+		nRetVal = xnOSWaitAndTerminateThread(&m_hReadThread, READ_THREAD_TERMINATE_TIMEOUT);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_LINK, "Failed to shutdown loopback endpoint %u read thread: %s", m_nEndpointID, xnGetStatusString(nRetVal));
+			XN_ASSERT(false);
+		}
+		m_hReadThread = NULL;
+		m_bConnected = false;
+	}
+}
+
+uint16_t LoopbackInDataEndpoint::GetMaxPacketSize() const
+{
+	return (m_pFirmware != NULL) ? m_pFirmware->GetDataPacketSize() : 0;
+}
+
+XnStatus LoopbackInDataEndpoint::SetDataDestination(IDataDestination* pDataDestination)
+{
+	//NULL is allowed here, the input data endpoint clears its destination on disconnection
+	m_pDataDestination = pDataDestination;
+	return XN_STATUS_OK;
+}
+
+XN_THREAD_PROC LoopbackInDataEndpoint::ReadThreadProc(XN_THREAD_PARAM pThreadParam)
+{
+	LoopbackInDataEndpoint* pThis = reinterpret_cast<LoopbackInDataEndpoint*>(pThreadParam);
+	pThis->ReadThreadLoop();
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void LoopbackInDataEndpoint::ReadThreadLoop()
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	const uint32_t nMaxChunkSize = m_pFirmware->GetDataPacketSize() * READ_THREAD_BUFFER_NUM_PACKETS;
+
+	while (!m_bStopReadThread)
+	{
+		uint32_t nFrameSize = 0;
+		uint32_t nWaitMs = 0;
+		nRetVal = m_pFirmware->ReadNextFrame(m_nEndpointID, m_frameBuffer, nFrameSize, nWaitMs);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_LINK, "Loopback endpoint %u failed to read frame: %s", m_nEndpointID, xnGetStatusString(nRetVal));
+		}
+
+		//Frames are made of whole packets, and every packet but the last is full, so chunks are packet-aligned
+		IDataDestination* pDataDestination = m_pDataDestination;
+		for (uint32_t nOffset = 0; nOffset < nFrameSize && pDataDestination != NULL && !m_bStopReadThread; nOffset += nMaxChunkSize)
+		{
+			pDataDestination->IncomingData(&m_frameBuffer[nOffset], XN_MIN(nMaxChunkSize, nFrameSize - nOffset));
+		}
+
+		if (nWaitMs > 0)
+		{
+			xnOSWaitEvent(m_hStopEvent, nWaitMs);
+		}
+	}
+}
+
+bool LoopbackInDataEndpoint::IsConnected() const
+{
+	return m_bConnected;
+}
+
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNLOOPBACKINDATAENDPOINT_H
+#define XNLOOPBACKINDATAENDPOINT_H
+
+#include "IAsyncInputConnection.h"
+#include <XnOS.h>
+#include <vector>
+
+namespace xn
+{
+
+class SimulatedLinkFirmware;
+
+/* Input data connection fed by a thread that pulls frames from an in-process simulated firmware. */
+class LoopbackInDataEndpoint : virtual public IAsyncInputConnection
+{
+public:
+	LoopbackInDataEndpoint();
+
+	virtual ~LoopbackInDataEndpoint();
+
+	virtual XnStatus Init(SimulatedLinkFirmware* pFirmware, uint16_t nEndpointID);
+	virtual void Shutdown();
+	virtual XnStatus Connect();
+	virtual void Disconnect();
+	virtual bool IsConnected() const;
+	virtual uint16_t GetMaxPacketSize() const;
+	virtual XnStatus SetDataDestination(IDataDestination* pDataDestination);
+
+private:
+	static XN_THREAD_PROC ReadThreadProc(XN_THREAD_PARAM pThreadParam);
+	void ReadThreadLoop();
+
+	//Number of packets delivered to the destination in one call, like a USB read buffer
+	static const uint32_t READ_THREAD_BUFFER_NUM_PACKETS;
+	static const uint32_t READ_THREAD_TERMINATE_TIMEOUT;
+
+	SimulatedLinkFirmware* m_pFirmware;
+	uint16_t m_nEndpointID;
+	IDataDestination* m_pDataDestination;
+	XN_THREAD_HANDLE m_hReadThread;
+	XN_EVENT_HANDLE m_hStopEvent;
+	volatile bool m_bStopReadThread;
+	bool m_bConnected;
+	std::vector<uint8_t> m_frameBuffer;
+};
+
+}
+
+#endif // XNLOOPBACKINDATAENDPOINT_H
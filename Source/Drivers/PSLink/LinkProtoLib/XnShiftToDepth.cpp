@@ -24,10 +24,76 @@
 #include <XnOS.h>
 #include "XnShiftToDepth.h"
 #include "XnLinkStatusCodes.h"
+#include "XnLinkSimd.h"
+
+#if XN_LINK_SIMD_X86
+	#include <immintrin.h>
+#endif
 
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
+#if XN_LINK_SIMD_X86
+/* Looks up 8 shifts (32 bit lanes). Table entries are gathered as 32 bit words and their high half dropped. A word
+   at the last entry would be read past the end of the table, so those lanes take it from lastDepth instead. */
+static XN_LINK_TARGET_AVX2 inline __m256i LookupDepthsAVX2(const int* pTable, __m256i shifts, __m256i lastShift, __m256i lastDepth)
+{
+	__m256i gatherMask = _mm256_cmpgt_epi32(lastShift, shifts);
+	__m256i depths = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), pTable, shifts, gatherMask, sizeof(OniDepthPixel));
+	depths = _mm256_and_si256(depths, _mm256_set1_epi32(0xFFFF));
+	return _mm256_blendv_epi8(depths, lastDepth, _mm256_cmpeq_epi32(shifts, lastShift));
+}
+
+/* Converts whole blocks of 16 pixels of a line. Returns the number of pixels converted. */
+static XN_LINK_TARGET_AVX2 uint32_t ConvertLineAVX2(const XnShiftToDepthTables* pShiftToDepth,
+													const uint16_t* pInput,
+													uint32_t nLineSize,
+													OniDepthPixel nMinDepth,
+													OniDepthPixel nMaxDepth,
+													bool bMirror,
+													OniDepthPixel* pOutput)
+{
+	const int* pTable = reinterpret_cast<const int*>(pShiftToDepth->pShiftToDepthTable);
+	const __m256i lastShift = _mm256_set1_epi32(pShiftToDepth->nShiftsCount - 1);
+	const __m256i lastDepth = _mm256_set1_epi32(pShiftToDepth->pShiftToDepthTable[pShiftToDepth->nShiftsCount - 1]);
+	const __m256i minDepth = _mm256_set1_epi16(nMinDepth);
+	const __m256i maxDepth = _mm256_set1_epi16(nMaxDepth);
+	const bool bCutOff = (nMinDepth != 0 || nMaxDepth != XN_MAX_UINT16);
+	const __m256i reverseWords = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+												  14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+
+	uint32_t i = 0;
+	for (; i + 16 <= nLineSize; i += 16)
+	{
+		__m256i shifts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pInput + i));
+		__m256i low = LookupDepthsAVX2(pTable, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(shifts)), lastShift, lastDepth);
+		__m256i high = LookupDepthsAVX2(pTable, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(shifts, 1)), lastShift, lastDepth);
+		//Packing works per 128 bit half - put the 4 quarters back in order
+		__m256i depths = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+
+		if (bCutOff)
+		{
+			__m256i inRange = _mm256_and_si256(
+				_mm256_cmpeq_epi16(_mm256_max_epu16(depths, minDepth), depths),
+				_mm256_cmpeq_epi16(_mm256_min_epu16(depths, maxDepth), depths));
+			depths = _mm256_and_si256(depths, inRange);
+		}
+
+		if (bMirror)
+		{
+			depths = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(depths, reverseWords), _MM_SHUFFLE(1, 0, 3, 2));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput + nLineSize - i - 16), depths);
+		}
+		else
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput + i), depths);
+		}
+	}
+
+	return i;
+}
+#endif
+
 XnStatus XnShiftToDepthInit(XnShiftToDepthTables* pShiftToDepth, const XnShiftToDepthConfig* pConfig)
 {
 	XN_VALIDATE_INPUT_PTR(pShiftToDepth);
@@ -121,26 +187,51 @@ XnStatus XnShiftToDepthConvert(const XnShiftToDepthTables* pShiftToDepth,
 							   const uint16_t* pInput,
 							   uint32_t nInputSize,
 							   OniDepthPixel* pOutput)
+{
+	return XnShiftToDepthConvertLines(pShiftToDepth, pInput, nInputSize, 1, 0, XN_MAX_UINT16, false, pOutput);
+}
+
+XnStatus XnShiftToDepthConvertLines(const XnShiftToDepthTables* pShiftToDepth,
+									const uint16_t* pInput,
+									uint32_t nLineSize,
+									uint32_t nLines,
+									OniDepthPixel nMinDepth,
+									OniDepthPixel nMaxDepth,
+									bool bMirror,
+									OniDepthPixel* pOutput)
 {
 	XN_VALIDATE_INPUT_PTR(pShiftToDepth);
 	XN_VALIDATE_INPUT_PTR(pInput);
 	XN_VALIDATE_INPUT_PTR(pOutput);
 
-	const uint16_t* pInputEnd = pInput + nInputSize;
-	OniDepthPixel* pShiftToDepthTable = pShiftToDepth->pShiftToDepthTable;
+	const OniDepthPixel* pShiftToDepthTable = pShiftToDepth->pShiftToDepthTable;
+	const uint32_t nShiftsCount = pShiftToDepth->nShiftsCount;
+#if XN_LINK_SIMD_X86
+	const bool bUseAVX2 = (xn::xnLinkGetSimdLevel() >= xn::XN_LINK_SIMD_AVX2) && (nShiftsCount > 0);
+#endif
 
-	while (pInput != pInputEnd)
+	for (uint32_t nLine = 0; nLine < nLines; ++nLine)
 	{
-		if (*pInput >= pShiftToDepth->nShiftsCount)
+		uint32_t i = 0;
+#if XN_LINK_SIMD_X86
+		if (bUseAVX2)
 		{
-			*pOutput = 0;
+			i = ConvertLineAVX2(pShiftToDepth, pInput, nLineSize, nMinDepth, nMaxDepth, bMirror, pOutput);
 		}
-		else
+#endif
+
+		for (; i < nLineSize; ++i)
 		{
-			*pOutput = pShiftToDepthTable[*pInput];
+			OniDepthPixel nDepth = (pInput[i] < nShiftsCount) ? pShiftToDepthTable[pInput[i]] : 0;
+			if (nDepth < nMinDepth || nDepth > nMaxDepth)
+			{
+				nDepth = 0;
+			}
+			pOutput[bMirror ? (nLineSize - 1 - i) : i] = nDepth;
 		}
-		pOutput++;
-		pInput++;
+
+		pInput += nLineSize;
+		pOutput += nLineSize;
 	}
 
 	return XN_STATUS_OK;
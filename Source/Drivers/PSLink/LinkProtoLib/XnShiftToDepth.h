@@ -82,6 +82,24 @@ XnStatus XnShiftToDepthConvert(const XnShiftToDepthTables* pShiftToDepth,
 							   uint32_t nInputSize,
 							   OniDepthPixel* pOutput);
 
+/**
+* Converts nLines lines of nLineSize shifts each. Depths outside [nMinDepth, nMaxDepth] are written as 0, and
+* each line is written reversed if bMirror is set (pInput and pOutput must not overlap in that case).
+* Uses vector gathers when the CPU supports them.
+*
+* PSLink depth streams go through XnShiftToDepthConvert(), which passes no cut-off and no mirroring: the
+* device's cut-off is already built into the table by XnShiftToDepthUpdate(), the firmware mirrors the
+* stream itself, and the unpacked shift parser sees packets, not whole lines.
+*/
+XnStatus XnShiftToDepthConvertLines(const XnShiftToDepthTables* pShiftToDepth,
+									const uint16_t* pInput,
+									uint32_t nLineSize,
+									uint32_t nLines,
+									OniDepthPixel nMinDepth,
+									OniDepthPixel nMaxDepth,
+									bool bMirror,
+									OniDepthPixel* pOutput);
+
 XnStatus XnShiftToDepthFree(XnShiftToDepthTables* pShiftToDepth);
 
 #endif // XNSHIFTTODEPTH_H
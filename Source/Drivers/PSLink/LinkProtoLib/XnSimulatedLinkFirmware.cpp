@@ -0,0 +1,1329 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnSimulatedLinkFirmware.h"
+#include "XnLinkMsgEncoder.h"
+#include <XnOSCpp.h>
+#include <XnLog.h>
+#include <XnBitSet.h>
+#include <stdlib.h>
+
+#define MAX_SMALL_DIFF			6
+#define MAX_BIG_DIFF			63
+#define MAX_RLE_REPEATS			16
+#define NIBBLE_OPCODE_NOP		0x0D
+#define NIBBLE_OPCODE_RLE		0x0E
+#define NIBBLE_OPCODE_FULL		0x0F
+
+namespace xn
+{
+
+const uint16_t SimulatedLinkFirmware::CONTROL_PACKET_SIZE = 512;
+const uint16_t SimulatedLinkFirmware::DATA_PACKET_SIZE = 8192;
+const uint32_t SimulatedLinkFirmware::NUM_SYNTHETIC_FRAMES = 30;
+const uint32_t SimulatedLinkFirmware::IDLE_WAIT_MS = 100;
+
+//Msg types and properties we answer to. Each list is sorted by group, then by id.
+static const uint16_t SUPPORTED_MSG_TYPES[] =
+{
+	XN_LINK_MSG_CONTINUE_REPONSE,
+	XN_LINK_MSG_SOFT_RESET,
+	XN_LINK_MSG_HARD_RESET,
+	XN_LINK_MSG_START_STREAMING,
+	XN_LINK_MSG_STOP_STREAMING,
+	XN_LINK_MSG_GET_CAMERA_INTRINSICS,
+	XN_LINK_MSG_ENUMERATE_STREAMS,
+	XN_LINK_MSG_CREATE_STREAM,
+	XN_LINK_MSG_DESTROY_STREAM,
+	XN_LINK_MSG_GET_PROP,
+	XN_LINK_MSG_SET_PROP,
+	XN_LINK_MSG_GET_S2D_CONFIG,
+};
+
+static const uint16_t SUPPORTED_PROPS[] =
+{
+	XN_LINK_PROP_ID_CONTROL_MAX_PACKET_SIZE,
+	XN_LINK_PROP_ID_FW_VERSION,
+	XN_LINK_PROP_ID_PROTOCOL_VERSION,
+	XN_LINK_PROP_ID_SUPPORTED_MSG_TYPES,
+	XN_LINK_PROP_ID_SUPPORTED_PROPS,
+	XN_LINK_PROP_ID_HW_VERSION,
+	XN_LINK_PROP_ID_SERIAL_NUMBER,
+	XN_LINK_PROP_ID_SUPPORTED_VIDEO_MODES,
+	XN_LINK_PROP_ID_VIDEO_MODE,
+	XN_LINK_PROP_ID_STREAM_SUPPORTED_INTERFACES,
+	XN_LINK_PROP_ID_STREAM_FRAG_LEVEL,
+	XN_LINK_PROP_ID_MIRROR,
+	XN_LINK_PROP_ID_CROPPING,
+	XN_LINK_PROP_ID_GAIN,
+};
+
+SimulatedLinkFirmware::SimulatedLinkFirmware() :
+	m_nFPSOverride(-1),
+	m_nResponseOffset(0),
+	m_nResponseMsgType(XN_LINK_MSG_NONE),
+	m_nResponseStreamID(XN_LINK_STREAM_ID_NONE),
+	m_nResponseCode(XN_LINK_RESPONSE_OK),
+	m_nResponseCID(0),
+	m_nResponsePacketID(0),
+	m_hCriticalSection(NULL),
+	m_bInitialized(false)
+{
+	xnOSMemSet(m_strSerialNumber, 0, sizeof(m_strSerialNumber));
+}
+
+SimulatedLinkFirmware::~SimulatedLinkFirmware()
+{
+	Shutdown();
+}
+
+XnStatus SimulatedLinkFirmware::Init(const char* strConfig)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (m_bInitialized)
+	{
+		return XN_STATUS_OK;
+	}
+
+	nRetVal = xnOSCreateCriticalSection(&m_hCriticalSection);
+	XN_IS_STATUS_OK_LOG_ERROR("Create critical section", nRetVal);
+
+	xnOSStrCopy(m_strSerialNumber, "LOOPBACK0001", sizeof(m_strSerialNumber));
+	InitStream(m_streams[0], XN_LINK_STREAM_TYPE_SHIFTS, 1, 0, XN_FW_COMPRESSION_11_BIT_PACKED);
+	InitStream(m_streams[1], XN_LINK_STREAM_TYPE_IR, 2, 1, XN_FW_COMPRESSION_NONE);
+
+	nRetVal = ParseConfig(strConfig);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogError(XN_MASK_LINK, "Failed to parse simulated firmware configuration '%s': %s", strConfig, xnGetStatusString(nRetVal));
+		Shutdown();
+		return nRetVal;
+	}
+
+	xnLogInfo(XN_MASK_LINK, "Simulated firmware initialized (serial %s)", m_strSerialNumber);
+	m_bInitialized = true;
+	return XN_STATUS_OK;
+}
+
+void SimulatedLinkFirmware::Shutdown()
+{
+	for (uint16_t i = 0; i < NUM_STREAMS; i++)
+	{
+		m_streams[i].recordedFrames.clear();
+		m_streams[i].encodedFrames.clear();
+	}
+
+	m_command.clear();
+	m_response.clear();
+
+	if (m_hCriticalSection != NULL)
+	{
+		xnOSCloseCriticalSection(&m_hCriticalSection);
+		m_hCriticalSection = NULL;
+	}
+
+	m_bInitialized = false;
+}
+
+bool SimulatedLinkFirmware::IsInitialized() const
+{
+	return m_bInitialized;
+}
+
+uint16_t SimulatedLinkFirmware::GetControlPacketSize() const
+{
+	return CONTROL_PACKET_SIZE;
+}
+
+uint16_t SimulatedLinkFirmware::GetDataPacketSize() const
+{
+	return DATA_PACKET_SIZE;
+}
+
+void SimulatedLinkFirmware::InitStream(SimulatedStream& stream, XnLinkStreamType streamType, uint16_t nStreamID, uint16_t nEndpointID, XnFwCompressionType defaultCompression)
+{
+	static const uint16_t aResolutions[][2] = { { 640, 480 }, { 320, 240 } };
+	static const uint16_t aFPS[] = { 30, 60 };
+	static const XnFwCompressionType aDepthCompressions[] =
+	{
+		XN_FW_COMPRESSION_NONE,
+		XN_FW_COMPRESSION_11_BIT_PACKED,
+		XN_FW_COMPRESSION_12_BIT_PACKED,
+		XN_FW_COMPRESSION_16Z,
+	};
+	static const XnFwCompressionType aIRCompressions[] =
+	{
+		XN_FW_COMPRESSION_NONE,
+		XN_FW_COMPRESSION_10_BIT_PACKED,
+	};
+
+	const XnFwCompressionType* aCompressions = aDepthCompressions;
+	uint32_t nCompressions = sizeof(aDepthCompressions) / sizeof(aDepthCompressions[0]);
+	uint8_t nPixelFormat = XN_LINK_PIXEL_FORMAT_SHIFTS_9_3;
+	if (streamType == XN_LINK_STREAM_TYPE_IR)
+	{
+		aCompressions = aIRCompressions;
+		nCompressions = sizeof(aIRCompressions) / sizeof(aIRCompressions[0]);
+		nPixelFormat = XN_LINK_PIXEL_FORMAT_GRAYSCALE16;
+	}
+
+	stream.streamType = streamType;
+	stream.nStreamID = nStreamID;
+	stream.nEndpointID = nEndpointID;
+	stream.bCreated = false;
+	stream.bStreaming = false;
+
+	stream.supportedModes.clear();
+	for (uint32_t nRes = 0; nRes < sizeof(aResolutions) / sizeof(aResolutions[0]); nRes++)
+	{
+		for (uint32_t nFPS = 0; nFPS < sizeof(aFPS) / sizeof(aFPS[0]); nFPS++)
+		{
+			for (uint32_t nComp = 0; nComp < nCompressions; nComp++)
+			{
+				XnLinkVideoMode mode;
+				mode.m_nXRes = aResolutions[nRes][0];
+				mode.m_nYRes = aResolutions[nRes][1];
+				mode.m_nFPS = aFPS[nFPS];
+				mode.m_nPixelFormat = nPixelFormat;
+				mode.m_nCompression = (uint8_t)aCompressions[nComp];
+				stream.supportedModes.push_back(mode);
+			}
+		}
+	}
+
+	stream.videoMode = stream.supportedModes[0];
+	stream.videoMode.m_nCompression = (uint8_t)defaultCompression;
+
+	//Interfaces are added in ascending order
+	stream.supportedInterfaces.clear();
+	stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_MAP_GENERATOR);
+	stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_STREAM_MGMT);
+	stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_PROPS);
+	if (streamType == XN_LINK_STREAM_TYPE_SHIFTS)
+	{
+		stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_S2D);
+		stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_DEPTH_GENERATOR);
+	}
+	stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_MIRROR);
+	stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_CROPPING);
+	if (streamType == XN_LINK_STREAM_TYPE_IR)
+	{
+		stream.supportedInterfaces.push_back(XN_LINK_INTERFACE_GAIN);
+	}
+
+	stream.bMirror = false;
+	xnOSMemSet(&stream.cropping, 0, sizeof(stream.cropping));
+	stream.nGain = 0;
+
+	stream.recordedFrames.clear();
+	stream.encodedFrames.clear();
+	stream.bFramesDirty = true;
+	stream.nNextFrame = 0;
+	stream.nNextPacketID = 1;
+	stream.nNextFrameTime = 0;
+
+	stream.nStartTime = 0;
+	stream.nFramesSent = 0;
+	stream.nBytesSent = 0;
+}
+
+XnStatus SimulatedLinkFirmware::ParseConfig(const char* strConfig)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	char strBuffer[XN_FILE_MAX_PATH * 2];
+
+	if (strConfig == NULL)
+	{
+		return XN_STATUS_OK;
+	}
+
+	uint32_t nPrefixLength = xnOSStrLen(XN_LINK_LOOPBACK_URI_PREFIX);
+	if (strncmp(strConfig, XN_LINK_LOOPBACK_URI_PREFIX, nPrefixLength) == 0)
+	{
+		strConfig += nPrefixLength;
+	}
+
+	nRetVal = xnOSStrCopy(strBuffer, strConfig, sizeof(strBuffer));
+	XN_IS_STATUS_OK_LOG_ERROR("Copy configuration string", nRetVal);
+
+	char* pToken = strBuffer;
+	while (pToken != NULL && *pToken != '\0')
+	{
+		char* pNext = strchr(pToken, ';');
+		if (pNext != NULL)
+		{
+			*pNext++ = '\0';
+		}
+
+		char* pValue = strchr(pToken, '=');
+		if (pValue == NULL)
+		{
+			xnLogError(XN_MASK_LINK, "Simulated firmware: '%s' is not in the form key=value", pToken);
+			return XN_STATUS_BAD_PARAM;
+		}
+		*pValue++ = '\0';
+
+		if (xnOSStrCaseCmp(pToken, "fps") == 0)
+		{
+			m_nFPSOverride = atoi(pValue);
+		}
+		else if (xnOSStrCaseCmp(pToken, "depthCompression") == 0 || xnOSStrCaseCmp(pToken, "irCompression") == 0)
+		{
+			SimulatedStream& stream = (xnOSStrCaseCmp(pToken, "irCompression") == 0) ? m_streams[1] : m_streams[0];
+			bool bFound = false;
+			for (uint32_t i = 0; i < stream.supportedModes.size() && !bFound; i++)
+			{
+				XnFwCompressionType compression = (XnFwCompressionType)stream.supportedModes[i].m_nCompression;
+				if (xnOSStrCmp(pValue, xnLinkCompressionToName(compression)) == 0)
+				{
+					stream.videoMode.m_nCompression = (uint8_t)compression;
+					bFound = true;
+				}
+			}
+
+			if (!bFound)
+			{
+				xnLogError(XN_MASK_LINK, "Simulated firmware: compression '%s' is not supported by the %s stream", pValue, pToken);
+				return XN_STATUS_BAD_PARAM;
+			}
+		}
+		else if (xnOSStrCaseCmp(pToken, "depthFile") == 0)
+		{
+			nRetVal = LoadRecordedFrames(pValue, m_streams[0]);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+		else if (xnOSStrCaseCmp(pToken, "irFile") == 0)
+		{
+			nRetVal = LoadRecordedFrames(pValue, m_streams[1]);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+		else if (xnOSStrCaseCmp(pToken, "serial") == 0)
+		{
+			xnOSStrCopy(m_strSerialNumber, pValue, sizeof(m_strSerialNumber));
+		}
+		else
+		{
+			xnLogWarning(XN_MASK_LINK, "Simulated firmware: ignoring unknown configuration key '%s'", pToken);
+		}
+
+		pToken = pNext;
+	}
+
+	return XN_STATUS_OK;
+}
+
+XnStatus SimulatedLinkFirmware::LoadRecordedFrames(const char* strFileName, SimulatedStream& stream)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	uint64_t nFileSize = 0;
+
+	nRetVal = xnOSGetFileSize64(strFileName, &nFileSize);
+	XN_IS_STATUS_OK_LOG_ERROR("Get recorded endpoint file size", nRetVal);
+	if (nFileSize == 0 || nFileSize > XN_MAX_UINT32)
+	{
+		xnLogError(XN_MASK_LINK, "Simulated firmware: recorded endpoint file '%s' has bad size", strFileName);
+		return XN_STATUS_CORRUPT_FILE;
+	}
+
+	std::vector<uint8_t> fileData((size_t)nFileSize);
+	nRetVal = xnOSLoadFile(strFileName, &fileData[0], (uint32_t)nFileSize);
+	XN_IS_STATUS_OK_LOG_ERROR("Load recorded endpoint file", nRetVal);
+
+	//Collect the DATA messages of the first stream that appears in the file
+	uint16_t nRecordedStreamID = XN_LINK_STREAM_ID_INVALID;
+	std::vector<uint8_t> frame;
+	bool bInFrame = false;
+	const uint8_t* pData = &fileData[0];
+	uint32_t nBytesLeft = (uint32_t)nFileSize;
+
+	stream.recordedFrames.clear();
+
+	while (nBytesLeft > 0)
+	{
+		const LinkPacketHeader* pHeader = reinterpret_cast<const LinkPacketHeader*>(pData);
+		if (pHeader->Validate(nBytesLeft) != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_LINK, "Simulated firmware: recorded endpoint file '%s' has a corrupt packet at offset %u - ignoring the rest of the file",
+				strFileName, (uint32_t)(nFileSize - nBytesLeft));
+			break;
+		}
+
+		if (pHeader->GetMsgType() == XN_LINK_MSG_DATA)
+		{
+			if (nRecordedStreamID == XN_LINK_STREAM_ID_INVALID)
+			{
+				nRecordedStreamID = pHeader->GetStreamID();
+			}
+
+			if (pHeader->GetStreamID() == nRecordedStreamID)
+			{
+				const uint8_t* pPacketData = pHeader->GetPacketData();
+				uint32_t nPacketDataSize = pHeader->GetDataSize();
+				XnLinkFragmentation fragmentation = pHeader->GetFragmentationFlags();
+
+				if (fragmentation & XN_LINK_FRAG_BEGIN)
+				{
+					frame.clear();
+					bInFrame = (nPacketDataSize >= sizeof(XnLinkDataHeader));
+					pPacketData += sizeof(XnLinkDataHeader);
+					nPacketDataSize -= bInFrame ? sizeof(XnLinkDataHeader) : nPacketDataSize;
+				}
+
+				if (bInFrame)
+				{
+					frame.insert(frame.end(), pPacketData, pPacketData + nPacketDataSize);
+					if (fragmentation & XN_LINK_FRAG_END)
+					{
+						stream.recordedFrames.push_back(frame);
+						bInFrame = false;
+					}
+				}
+			}
+		}
+
+		pData += pHeader->GetSize();
+		nBytesLeft -= pHeader->GetSize();
+	}
+
+	if (stream.recordedFrames.empty())
+	{
+		xnLogError(XN_MASK_LINK, "Simulated firmware: no complete frames found in recorded endpoint file '%s'", strFileName);
+		return XN_STATUS_CORRUPT_FILE;
+	}
+
+	xnLogInfo(XN_MASK_LINK, "Simulated firmware: stream %u will replay %u frames of recorded stream %u from '%s'. The stream's video mode must match the recording.",
+		stream.nStreamID, (uint32_t)stream.recordedFrames.size(), nRecordedStreamID, strFileName);
+
+	stream.bFramesDirty = true;
+	return XN_STATUS_OK;
+}
+
+SimulatedLinkFirmware::SimulatedStream* SimulatedLinkFirmware::GetStream(uint16_t nStreamID)
+{
+	for (uint16_t i = 0; i < NUM_STREAMS; i++)
+	{
+		if (m_streams[i].nStreamID == nStreamID)
+		{
+			return &m_streams[i];
+		}
+	}
+
+	return NULL;
+}
+
+XnStatus SimulatedLinkFirmware::HandleControlPacket(const void* pPacket, uint32_t nPacketSize, void* pResponse, uint32_t& nResponseSize)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	XN_VALIDATE_INPUT_PTR(pPacket);
+	XN_VALIDATE_INPUT_PTR(pResponse);
+
+	if (!m_bInitialized)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	xnl::AutoCSLocker lock(m_hCriticalSection);
+
+	const LinkPacketHeader* pHeader = reinterpret_cast<const LinkPacketHeader*>(pPacket);
+	nRetVal = pHeader->Validate(nPacketSize);
+	XN_IS_STATUS_OK_LOG_ERROR("Validate control packet", nRetVal);
+
+	m_nResponseCID = pHeader->GetCID();
+	m_nResponsePacketID = pHeader->GetPacketID();
+
+	if (pHeader->GetMsgType() == XN_LINK_MSG_CONTINUE_REPONSE)
+	{
+		//Stream ID stays that of the original command
+		m_nResponseMsgType = XN_LINK_MSG_CONTINUE_REPONSE;
+		if (m_nResponseOffset >= m_response.size())
+		{
+			xnLogWarning(XN_MASK_LINK, "Simulated firmware: got continue response command but there's no pending response");
+			m_response.clear();
+			m_nResponseOffset = 0;
+			m_nResponseCode = XN_LINK_RESPONSE_CMD_ERROR;
+		}
+
+		return EncodeResponsePacket(pResponse, nResponseSize);
+	}
+
+	XnLinkFragmentation fragmentation = pHeader->GetFragmentationFlags();
+	if (fragmentation & XN_LINK_FRAG_BEGIN)
+	{
+		m_command.clear();
+	}
+	m_command.insert(m_command.end(), pHeader->GetPacketData(), pHeader->GetPacketData() + pHeader->GetDataSize());
+
+	m_nResponseMsgType = pHeader->GetMsgType();
+	m_nResponseStreamID = pHeader->GetStreamID();
+	m_response.clear();
+	m_nResponseOffset = 0;
+	m_nResponseCode = XN_LINK_RESPONSE_OK;
+
+	if (fragmentation & XN_LINK_FRAG_END)
+	{
+		m_nResponseCode = (uint16_t)ExecuteCommand(m_nResponseMsgType, m_nResponseStreamID,
+			m_command.empty() ? NULL : &m_command[0], (uint32_t)m_command.size());
+		if (m_nResponseCode != XN_LINK_RESPONSE_OK)
+		{
+			xnLogWarning(XN_MASK_LINK, "Simulated firmware: msg type 0x%04X on stream %u failed: %s",
+				m_nResponseMsgType, m_nResponseStreamID, xnLinkResponseCodeToStr(m_nResponseCode));
+			m_response.clear();
+		}
+		m_command.clear();
+	}
+
+	//Intermediate packets of a command get an empty single-packet response
+	return EncodeResponsePacket(pResponse, nResponseSize);
+}
+
+XnStatus SimulatedLinkFirmware::EncodeResponsePacket(void* pResponse, uint32_t& nResponseSize)
+{
+	const uint32_t nMaxChunkSize = CONTROL_PACKET_SIZE - sizeof(XnLinkResponseHeader);
+	uint32_t nChunkSize = XN_MIN(nMaxChunkSize, (uint32_t)m_response.size() - m_nResponseOffset);
+	uint32_t nPacketSize = sizeof(XnLinkResponseHeader) + nChunkSize;
+
+	if (nResponseSize < nPacketSize)
+	{
+		xnLogError(XN_MASK_LINK, "Simulated firmware: response packet of %u bytes does not fit in %u bytes", nPacketSize, nResponseSize);
+		XN_ASSERT(false);
+		return XN_STATUS_OUTPUT_BUFFER_OVERFLOW;
+	}
+
+	uint32_t nFragmentation = XN_LINK_FRAG_MIDDLE;
+	if (m_nResponseOffset == 0)
+	{
+		nFragmentation |= XN_LINK_FRAG_BEGIN;
+	}
+	if (m_nResponseOffset + nChunkSize == m_response.size())
+	{
+		nFragmentation |= XN_LINK_FRAG_END;
+	}
+
+	XnLinkResponseHeader* pResponseHeader = reinterpret_cast<XnLinkResponseHeader*>(pResponse);
+	LinkPacketHeader* pHeader = reinterpret_cast<LinkPacketHeader*>(&pResponseHeader->m_header);
+	pHeader->SetMagic();
+	pHeader->SetSize((uint16_t)nPacketSize);
+	pHeader->SetMsgType(m_nResponseMsgType);
+	pHeader->SetCID(m_nResponseCID);
+	pHeader->SetPacketID(m_nResponsePacketID);
+	pHeader->SetStreamID(m_nResponseStreamID);
+	pHeader->SetFragmentationFlags(XnLinkFragmentation(nFragmentation));
+	pResponseHeader->m_responseInfo.m_nResponseCode = XN_PREPARE_VAR16_IN_BUFFER(m_nResponseCode);
+	pResponseHeader->m_responseInfo.m_nReserverd = 0;
+
+	if (nChunkSize > 0)
+	{
+		xnOSMemCopy(pResponseHeader + 1, &m_response[m_nResponseOffset], nChunkSize);
+		m_nResponseOffset += nChunkSize;
+	}
+
+	nResponseSize = nPacketSize;
+	return XN_STATUS_OK;
+}
+
+void SimulatedLinkFirmware::AppendResponse(const void* pData, uint32_t nSize)
+{
+	const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(pData);
+	m_response.insert(m_response.end(), pBytes, pBytes + nSize);
+}
+
+void SimulatedLinkFirmware::AppendIntProp(XnLinkPropID propID, uint64_t nValue)
+{
+	XnLinkPropValHeader header;
+	header.m_nPropType = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)XN_LINK_PROP_TYPE_INT);
+	header.m_nPropID = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)propID);
+	header.m_nValueSize = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)sizeof(nValue));
+	nValue = XN_PREPARE_VAR64_IN_BUFFER(nValue);
+	AppendResponse(&header, sizeof(header));
+	AppendResponse(&nValue, sizeof(nValue));
+}
+
+void SimulatedLinkFirmware::AppendGeneralProp(XnLinkPropID propID, const void* pValue, uint32_t nSize)
+{
+	XnLinkPropValHeader header;
+	header.m_nPropType = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)XN_LINK_PROP_TYPE_GENERAL);
+	header.m_nPropID = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)propID);
+	header.m_nValueSize = XN_PREPARE_VAR32_IN_BUFFER(nSize);
+	AppendResponse(&header, sizeof(header));
+	AppendResponse(pValue, nSize);
+}
+
+void SimulatedLinkFirmware::AppendIDSetProp(XnLinkPropID propID, const uint16_t* aIDs, uint32_t nCount)
+{
+	std::vector<uint8_t> idSet(sizeof(XnLinkIDSetHeader));
+	uint16_t nNumGroups = 0;
+	uint32_t i = 0;
+
+	//IDs are sorted, so each group is a contiguous run. The bitmap is built with the same bitset the host parses it with.
+	while (i < nCount)
+	{
+		uint8_t nGroupID = (uint8_t)(aIDs[i] >> 8);
+		xnl::BitSet groupBits;
+		while (i < nCount && (aIDs[i] >> 8) == nGroupID)
+		{
+			groupBits.Set(aIDs[i] & 0xFF, true);
+			i++;
+		}
+
+		XnLinkIDSetGroupHeader groupHeader;
+		groupHeader.m_nGroupID = nGroupID;
+		groupHeader.m_nSize = (uint8_t)(sizeof(groupHeader) + groupBits.GetDataSizeInBytes());
+		const uint8_t* pGroupHeader = reinterpret_cast<const uint8_t*>(&groupHeader);
+		idSet.insert(idSet.end(), pGroupHeader, pGroupHeader + sizeof(groupHeader));
+		idSet.insert(idSet.end(), groupBits.GetData(), groupBits.GetData() + groupBits.GetDataSizeInBytes());
+		nNumGroups++;
+	}
+
+	XnLinkIDSetHeader* pHeader = reinterpret_cast<XnLinkIDSetHeader*>(&idSet[0]);
+	pHeader->m_nFormat = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)XN_LINK_ID_SET_FORMAT_BITSET);
+	pHeader->m_nNumGroups = XN_PREPARE_VAR16_IN_BUFFER(nNumGroups);
+
+	AppendGeneralProp(propID, &idSet[0], (uint32_t)idSet.size());
+}
+
+XnLinkResponseCode SimulatedLinkFirmware::ExecuteCommand(uint16_t nMsgType, uint16_t nStreamID, const uint8_t* pData, uint32_t nSize)
+{
+	SimulatedStream* pStream = NULL;
+
+	switch (nMsgType)
+	{
+	case XN_LINK_MSG_GET_PROP:
+		return GetProperty(nStreamID, pData, nSize);
+
+	case XN_LINK_MSG_SET_PROP:
+		return SetProperty(nStreamID, pData, nSize);
+
+	case XN_LINK_MSG_SOFT_RESET:
+	case XN_LINK_MSG_HARD_RESET:
+		for (uint16_t i = 0; i < NUM_STREAMS; i++)
+		{
+			StopStreaming(m_streams[i]);
+			m_streams[i].bCreated = false;
+		}
+		return XN_LINK_RESPONSE_OK;
+
+	case XN_LINK_MSG_ENUMERATE_STREAMS:
+		{
+			uint32_t nNumStreams = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)NUM_STREAMS);
+			AppendResponse(&nNumStreams, sizeof(nNumStreams));
+			for (uint16_t i = 0; i < NUM_STREAMS; i++)
+			{
+				XnLinkStreamInfo streamInfo;
+				xnOSMemSet(&streamInfo, 0, sizeof(streamInfo));
+				streamInfo.m_nStreamType = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)m_streams[i].streamType);
+				AppendResponse(&streamInfo, sizeof(streamInfo));
+			}
+			return XN_LINK_RESPONSE_OK;
+		}
+
+	case XN_LINK_MSG_CREATE_STREAM:
+		{
+			if (nSize != sizeof(XnLinkCreateStreamParams))
+			{
+				return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+			}
+
+			const XnLinkCreateStreamParams* pParams = reinterpret_cast<const XnLinkCreateStreamParams*>(pData);
+			uint32_t nStreamType = XN_PREPARE_VAR32_IN_BUFFER(pParams->m_nStreamType);
+			for (uint16_t i = 0; i < NUM_STREAMS && pStream == NULL; i++)
+			{
+				if (m_streams[i].streamType == nStreamType && !m_streams[i].bCreated)
+				{
+					pStream = &m_streams[i];
+				}
+			}
+
+			if (pStream == NULL)
+			{
+				return XN_LINK_RESPONSE_BAD_PARAMETERS;
+			}
+
+			pStream->bCreated = true;
+			pStream->nNextPacketID = 1;
+
+			XnLinkCreateStreamResponse response;
+			response.m_nStreamID = XN_PREPARE_VAR16_IN_BUFFER(pStream->nStreamID);
+			response.m_nEndpointID = XN_PREPARE_VAR16_IN_BUFFER(pStream->nEndpointID);
+			AppendResponse(&response, sizeof(response));
+			return XN_LINK_RESPONSE_OK;
+		}
+
+	default:
+		break;
+	}
+
+	//All other commands refer to a created stream
+	pStream = GetStream(nStreamID);
+	if (pStream == NULL || !pStream->bCreated)
+	{
+		if (nMsgType == XN_LINK_MSG_START_STREAMING || nMsgType == XN_LINK_MSG_STOP_STREAMING ||
+			nMsgType == XN_LINK_MSG_DESTROY_STREAM || nMsgType == XN_LINK_MSG_GET_CAMERA_INTRINSICS ||
+			nMsgType == XN_LINK_MSG_GET_S2D_CONFIG)
+		{
+			return XN_LINK_RESPONSE_BAD_PARAMETERS;
+		}
+		return XN_LINK_RESPONSE_CMD_NOT_SUPPORTED;
+	}
+
+	switch (nMsgType)
+	{
+	case XN_LINK_MSG_START_STREAMING:
+		StartStreaming(*pStream);
+		return XN_LINK_RESPONSE_OK;
+
+	case XN_LINK_MSG_STOP_STREAMING:
+		StopStreaming(*pStream);
+		return XN_LINK_RESPONSE_OK;
+
+	case XN_LINK_MSG_DESTROY_STREAM:
+		StopStreaming(*pStream);
+		pStream->bCreated = false;
+		return XN_LINK_RESPONSE_OK;
+
+	case XN_LINK_MSG_GET_CAMERA_INTRINSICS:
+		{
+			XnLinkCameraIntrinsics intrinsics;
+			intrinsics.m_nOpticalCenterX = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)(pStream->videoMode.m_nXRes / 2));
+			intrinsics.m_nOpticalCenterY = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)(pStream->videoMode.m_nYRes / 2));
+			intrinsics.m_fEffectiveFocalLengthInPixels = XN_PREPARE_VAR_FLOAT_IN_BUFFER(575.8f * pStream->videoMode.m_nXRes / 640);
+			AppendResponse(&intrinsics, sizeof(intrinsics));
+			return XN_LINK_RESPONSE_OK;
+		}
+
+	case XN_LINK_MSG_GET_S2D_CONFIG:
+		{
+			if (pStream->streamType != XN_LINK_STREAM_TYPE_SHIFTS)
+			{
+				return XN_LINK_RESPONSE_BAD_PARAMETERS;
+			}
+
+			XnLinkShiftToDepthConfig config;
+			xnOSMemSet(&config, 0, sizeof(config));
+			config.nZeroPlaneDistance = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)120);
+			config.fZeroPlanePixelSize = XN_PREPARE_VAR_FLOAT_IN_BUFFER(0.1042f);
+			config.fEmitterDCmosDistance = XN_PREPARE_VAR_FLOAT_IN_BUFFER(7.5f);
+			config.nDeviceMaxShiftValue = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)2047);
+			config.nDeviceMaxDepthValue = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)10000);
+			config.nConstShift = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)200);
+			config.nPixelSizeFactor = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)1);
+			config.nParamCoeff = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)4);
+			config.nShiftScale = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)10);
+			config.nDepthMinCutOff = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)0);
+			config.nDepthMaxCutOff = XN_PREPARE_VAR16_IN_BUFFER((uint16_t)10000);
+			AppendResponse(&config, sizeof(config));
+			return XN_LINK_RESPONSE_OK;
+		}
+
+	default:
+		return XN_LINK_RESPONSE_CMD_NOT_SUPPORTED;
+	}
+}
+
+XnLinkResponseCode SimulatedLinkFirmware::GetProperty(uint16_t nStreamID, const uint8_t* pData, uint32_t nSize)
+{
+	if (nSize != sizeof(XnLinkGetPropParams))
+	{
+		return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+	}
+
+	const XnLinkGetPropParams* pParams = reinterpret_cast<const XnLinkGetPropParams*>(pData);
+	XnLinkPropID propID = (XnLinkPropID)XN_PREPARE_VAR16_IN_BUFFER(pParams->m_nPropID);
+
+	if (nStreamID == XN_LINK_STREAM_ID_NONE)
+	{
+		switch (propID)
+		{
+		case XN_LINK_PROP_ID_CONTROL_MAX_PACKET_SIZE:
+			AppendIntProp(propID, CONTROL_PACKET_SIZE);
+			return XN_LINK_RESPONSE_OK;
+		case XN_LINK_PROP_ID_FW_VERSION:
+			{
+				XnLinkDetailedVersion version;
+				xnOSMemSet(&version, 0, sizeof(version));
+				version.m_nMajor = 1;
+				xnOSStrCopy(version.m_strModifier, "loopback", sizeof(version.m_strModifier));
+				AppendGeneralProp(propID, &version, sizeof(version));
+				return XN_LINK_RESPONSE_OK;
+			}
+		case XN_LINK_PROP_ID_PROTOCOL_VERSION:
+			{
+				XnLinkLeanVersion version;
+				version.m_nMajor = XN_LINK_PROTOCOL_MAJOR_VERSION;
+				version.m_nMinor = XN_LINK_PROTOCOL_MINOR_VERSION;
+				version.m_nReserved = 0;
+				AppendGeneralProp(propID, &version, sizeof(version));
+				return XN_LINK_RESPONSE_OK;
+			}
+		case XN_LINK_PROP_ID_SUPPORTED_MSG_TYPES:
+			AppendIDSetProp(propID, SUPPORTED_MSG_TYPES, sizeof(SUPPORTED_MSG_TYPES) / sizeof(SUPPORTED_MSG_TYPES[0]));
+			return XN_LINK_RESPONSE_OK;
+		case XN_LINK_PROP_ID_SUPPORTED_PROPS:
+			AppendIDSetProp(propID, SUPPORTED_PROPS, sizeof(SUPPORTED_PROPS) / sizeof(SUPPORTED_PROPS[0]));
+			return XN_LINK_RESPONSE_OK;
+		case XN_LINK_PROP_ID_HW_VERSION:
+			AppendIntProp(propID, 0);
+			return XN_LINK_RESPONSE_OK;
+		case XN_LINK_PROP_ID_SERIAL_NUMBER:
+			{
+				XnLinkSerialNumber serial;
+				xnOSMemSet(&serial, 0, sizeof(serial));
+				xnOSStrCopy(serial.m_strSerialNumber, m_strSerialNumber, sizeof(serial.m_strSerialNumber));
+				AppendGeneralProp(propID, &serial, sizeof(serial));
+				return XN_LINK_RESPONSE_OK;
+			}
+		default:
+			return XN_LINK_RESPONSE_BAD_PARAMETERS;
+		}
+	}
+
+	SimulatedStream* pStream = GetStream(nStreamID);
+	if (pStream == NULL || !pStream->bCreated)
+	{
+		return XN_LINK_RESPONSE_BAD_PARAMETERS;
+	}
+
+	//A stream property belongs to the interface in the high byte of its ID
+	bool bInterfaceSupported = false;
+	for (uint32_t i = 0; i < pStream->supportedInterfaces.size(); i++)
+	{
+		bInterfaceSupported |= (pStream->supportedInterfaces[i] == (propID >> 8));
+	}
+	if (!bInterfaceSupported)
+	{
+		return XN_LINK_RESPONSE_CMD_NOT_SUPPORTED;
+	}
+
+	switch (propID)
+	{
+	case XN_LINK_PROP_ID_SUPPORTED_VIDEO_MODES:
+		{
+			std::vector<uint8_t> value;
+			uint32_t nNumModes = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)pStream->supportedModes.size());
+			const uint8_t* pNumModes = reinterpret_cast<const uint8_t*>(&nNumModes);
+			value.insert(value.end(), pNumModes, pNumModes + sizeof(nNumModes));
+			for (uint32_t i = 0; i < pStream->supportedModes.size(); i++)
+			{
+				XnLinkVideoMode mode = pStream->supportedModes[i];
+				mode.m_nXRes = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nXRes);
+				mode.m_nYRes = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nYRes);
+				mode.m_nFPS = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nFPS);
+				const uint8_t* pMode = reinterpret_cast<const uint8_t*>(&mode);
+				value.insert(value.end(), pMode, pMode + sizeof(mode));
+			}
+			AppendGeneralProp(propID, &value[0], (uint32_t)value.size());
+			return XN_LINK_RESPONSE_OK;
+		}
+	case XN_LINK_PROP_ID_VIDEO_MODE:
+		{
+			XnLinkVideoMode mode = pStream->videoMode;
+			mode.m_nXRes = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nXRes);
+			mode.m_nYRes = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nYRes);
+			mode.m_nFPS = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nFPS);
+			AppendGeneralProp(propID, &mode, sizeof(mode));
+			return XN_LINK_RESPONSE_OK;
+		}
+	case XN_LINK_PROP_ID_STREAM_SUPPORTED_INTERFACES:
+		{
+			xnl::BitSet interfaces;
+			for (uint32_t i = 0; i < pStream->supportedInterfaces.size(); i++)
+			{
+				interfaces.Set(pStream->supportedInterfaces[i], true);
+			}
+			std::vector<uint8_t> value(sizeof(uint32_t) + interfaces.GetDataSizeInBytes());
+			uint32_t nBitSetSize = XN_PREPARE_VAR32_IN_BUFFER(interfaces.GetDataSizeInBytes());
+			xnOSMemCopy(&value[0], &nBitSetSize, sizeof(nBitSetSize));
+			xnOSMemCopy(&value[sizeof(uint32_t)], interfaces.GetData(), interfaces.GetDataSizeInBytes());
+			AppendGeneralProp(propID, &value[0], (uint32_t)value.size());
+			return XN_LINK_RESPONSE_OK;
+		}
+	case XN_LINK_PROP_ID_STREAM_FRAG_LEVEL:
+		AppendIntProp(propID, XN_LINK_STREAM_FRAG_LEVEL_FRAMES);
+		return XN_LINK_RESPONSE_OK;
+	case XN_LINK_PROP_ID_MIRROR:
+		AppendIntProp(propID, pStream->bMirror ? 1 : 0);
+		return XN_LINK_RESPONSE_OK;
+	case XN_LINK_PROP_ID_CROPPING:
+		{
+			XnLinkCropping cropping = pStream->cropping;
+			cropping.m_nXOffset = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nXOffset);
+			cropping.m_nYOffset = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nYOffset);
+			cropping.m_nXSize = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nXSize);
+			cropping.m_nYSize = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nYSize);
+			AppendGeneralProp(propID, &cropping, sizeof(cropping));
+			return XN_LINK_RESPONSE_OK;
+		}
+	case XN_LINK_PROP_ID_GAIN:
+		AppendIntProp(propID, pStream->nGain);
+		return XN_LINK_RESPONSE_OK;
+	default:
+		return XN_LINK_RESPONSE_BAD_PARAMETERS;
+	}
+}
+
+XnLinkResponseCode SimulatedLinkFirmware::SetProperty(uint16_t nStreamID, const uint8_t* pData, uint32_t nSize)
+{
+	if (nSize < sizeof(XnLinkPropValHeader))
+	{
+		return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+	}
+
+	const XnLinkPropVal* pPropVal = reinterpret_cast<const XnLinkPropVal*>(pData);
+	XnLinkPropID propID = (XnLinkPropID)XN_PREPARE_VAR16_IN_BUFFER(pPropVal->m_header.m_nPropID);
+	uint32_t nValueSize = XN_PREPARE_VAR32_IN_BUFFER(pPropVal->m_header.m_nValueSize);
+	if (nSize != sizeof(XnLinkPropValHeader) + nValueSize)
+	{
+		return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+	}
+
+	SimulatedStream* pStream = GetStream(nStreamID);
+	if (pStream == NULL || !pStream->bCreated)
+	{
+		//No global property is writable
+		return XN_LINK_RESPONSE_BAD_PARAMETERS;
+	}
+
+	bool bInterfaceSupported = false;
+	for (uint32_t i = 0; i < pStream->supportedInterfaces.size(); i++)
+	{
+		bInterfaceSupported |= (pStream->supportedInterfaces[i] == (propID >> 8));
+	}
+	if (!bInterfaceSupported)
+	{
+		return XN_LINK_RESPONSE_CMD_NOT_SUPPORTED;
+	}
+
+	switch (propID)
+	{
+	case XN_LINK_PROP_ID_VIDEO_MODE:
+		{
+			if (nValueSize != sizeof(XnLinkVideoMode))
+			{
+				return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+			}
+			if (pStream->bStreaming)
+			{
+				return XN_LINK_RESPONSE_BAD_PARAMETERS;
+			}
+
+			XnLinkVideoMode mode = *reinterpret_cast<const XnLinkVideoMode*>(pPropVal->m_value);
+			mode.m_nXRes = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nXRes);
+			mode.m_nYRes = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nYRes);
+			mode.m_nFPS = XN_PREPARE_VAR16_IN_BUFFER(mode.m_nFPS);
+			for (uint32_t i = 0; i < pStream->supportedModes.size(); i++)
+			{
+				if (xnOSMemCmp(&pStream->supportedModes[i], &mode, sizeof(mode)) == 0)
+				{
+					pStream->videoMode = mode;
+					pStream->cropping.m_bEnabled = false;
+					pStream->bFramesDirty = true;
+					return XN_LINK_RESPONSE_OK;
+				}
+			}
+			return XN_LINK_RESPONSE_BAD_PARAMETERS;
+		}
+	case XN_LINK_PROP_ID_MIRROR:
+		if (nValueSize != sizeof(uint64_t))
+		{
+			return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+		}
+		pStream->bMirror = (XN_PREPARE_VAR64_IN_BUFFER(*reinterpret_cast<const uint64_t*>(pPropVal->m_value)) != 0);
+		pStream->bFramesDirty = true;
+		return XN_LINK_RESPONSE_OK;
+	case XN_LINK_PROP_ID_CROPPING:
+		{
+			if (nValueSize != sizeof(XnLinkCropping))
+			{
+				return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+			}
+
+			XnLinkCropping cropping = *reinterpret_cast<const XnLinkCropping*>(pPropVal->m_value);
+			cropping.m_nXOffset = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nXOffset);
+			cropping.m_nYOffset = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nYOffset);
+			cropping.m_nXSize = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nXSize);
+			cropping.m_nYSize = XN_PREPARE_VAR16_IN_BUFFER(cropping.m_nYSize);
+			if (cropping.m_bEnabled &&
+				(cropping.m_nXSize == 0 || cropping.m_nYSize == 0 ||
+				 cropping.m_nXOffset + cropping.m_nXSize > pStream->videoMode.m_nXRes ||
+				 cropping.m_nYOffset + cropping.m_nYSize > pStream->videoMode.m_nYRes))
+			{
+				return XN_LINK_RESPONSE_BAD_PARAMETERS;
+			}
+			pStream->cropping = cropping;
+			pStream->bFramesDirty = true;
+			return XN_LINK_RESPONSE_OK;
+		}
+	case XN_LINK_PROP_ID_GAIN:
+		if (nValueSize != sizeof(uint64_t))
+		{
+			return XN_LINK_RESPONSE_BAD_CMD_SIZE;
+		}
+		pStream->nGain = XN_PREPARE_VAR64_IN_BUFFER(*reinterpret_cast<const uint64_t*>(pPropVal->m_value));
+		return XN_LINK_RESPONSE_OK;
+	default:
+		return XN_LINK_RESPONSE_BAD_PARAMETERS;
+	}
+}
+
+void SimulatedLinkFirmware::StartStreaming(SimulatedStream& stream)
+{
+	if (stream.bStreaming)
+	{
+		return;
+	}
+
+	uint64_t nNow = 0;
+	xnOSGetHighResTimeStamp(&nNow);
+	stream.bStreaming = true;
+	stream.nNextFrame = 0;
+	stream.nNextFrameTime = nNow;
+	stream.nStartTime = nNow;
+	stream.nFramesSent = 0;
+	stream.nBytesSent = 0;
+}
+
+void SimulatedLinkFirmware::StopStreaming(SimulatedStream& stream)
+{
+	if (!stream.bStreaming)
+	{
+		return;
+	}
+
+	uint64_t nNow = 0;
+	xnOSGetHighResTimeStamp(&nNow);
+	stream.bStreaming = false;
+
+	double dSeconds = (nNow - stream.nStartTime) / 1e6;
+	xnLogInfo(XN_MASK_LINK, "Simulated firmware: stream %u sent %u frames (%.1f MB) in %.2f seconds (%.1f fps)",
+		stream.nStreamID, stream.nFramesSent, stream.nBytesSent / (1024.0 * 1024.0), dSeconds,
+		dSeconds > 0 ? stream.nFramesSent / dSeconds : 0.0);
+}
+
+uint32_t SimulatedLinkFirmware::GetFrameIntervalUs(const SimulatedStream& stream) const
+{
+	uint32_t nFPS = (m_nFPSOverride >= 0) ? (uint32_t)m_nFPSOverride : stream.videoMode.m_nFPS;
+	return (nFPS == 0) ? 0 : (1000000 / nFPS);
+}
+
+void SimulatedLinkFirmware::GenerateFrame(const SimulatedStream& stream, uint32_t nFrame, std::vector<uint16_t>& pixels)
+{
+	uint32_t nXRes = stream.videoMode.m_nXRes;
+	uint32_t nYRes = stream.videoMode.m_nYRes;
+	uint32_t nXOffset = 0;
+	uint32_t nYOffset = 0;
+	uint32_t nWidth = nXRes;
+	uint32_t nHeight = nYRes;
+	if (stream.cropping.m_bEnabled)
+	{
+		nXOffset = stream.cropping.m_nXOffset;
+		nYOffset = stream.cropping.m_nYOffset;
+		nWidth = stream.cropping.m_nXSize;
+		nHeight = stream.cropping.m_nYSize;
+	}
+
+	//A box moving from left to right across the frames, a quarter of the image in size
+	uint32_t nBoxSize = nYRes / 4;
+	uint32_t nBoxLeft = (nFrame * (nXRes - nBoxSize)) / NUM_SYNTHETIC_FRAMES;
+	uint32_t nBoxTop = (nYRes - nBoxSize) / 2;
+
+	pixels.resize(nWidth * nHeight);
+	uint16_t* pPixel = &pixels[0];
+	for (uint32_t y = nYOffset; y < nYOffset + nHeight; y++)
+	{
+		for (uint32_t x = nXOffset; x < nXOffset + nWidth; x++)
+		{
+			uint32_t nSourceX = stream.bMirror ? (nXRes - 1 - x) : x;
+			if (stream.streamType == XN_LINK_STREAM_TYPE_SHIFTS)
+			{
+				//Tilted floor-like plane - shifts grow towards the bottom of the image
+				uint32_t nShift = 500 + (y * 480 / nYRes) / 2;
+				if (nSourceX >= nBoxLeft && nSourceX < nBoxLeft + nBoxSize && y >= nBoxTop && y < nBoxTop + nBoxSize)
+				{
+					nShift += 150;
+				}
+				*pPixel++ = (uint16_t)nShift;
+			}
+			else
+			{
+				*pPixel++ = (uint16_t)((nSourceX * 4 + y * 2 + nFrame * 8) & 0x3FF);
+			}
+		}
+	}
+}
+
+void SimulatedLinkFirmware::PackBits(const std::vector<uint16_t>& pixels, uint32_t nBitsPerPixel, std::vector<uint8_t>& output)
+{
+	uint32_t nMask = (1 << nBitsPerPixel) - 1;
+	uint32_t nAccumulator = 0;
+	uint32_t nBits = 0;
+
+	output.clear();
+	output.reserve((pixels.size() * nBitsPerPixel + 7) / 8);
+
+	//Most significant bits first, as the packed parsers read them
+	for (uint32_t i = 0; i < pixels.size(); i++)
+	{
+		nAccumulator = (nAccumulator << nBitsPerPixel) | (pixels[i] & nMask);
+		nBits += nBitsPerPixel;
+		while (nBits >= 8)
+		{
+			nBits -= 8;
+			output.push_back((uint8_t)(nAccumulator >> nBits));
+		}
+		nAccumulator &= ((1 << nBits) - 1);
+	}
+
+	if (nBits > 0)
+	{
+		output.push_back((uint8_t)(nAccumulator << (8 - nBits)));
+	}
+}
+
+void SimulatedLinkFirmware::Encode16z(const std::vector<uint16_t>& pixels, std::vector<uint8_t>& output)
+{
+	std::vector<uint8_t> nibbles;
+	nibbles.reserve(pixels.size());
+
+	uint32_t i = 0;
+	int32_t nLastShift = -1;
+	while (i < pixels.size())
+	{
+		int32_t nShift = pixels[i];
+
+		if (nShift == nLastShift)
+		{
+			//Repeat last value - up to 16 repeats per opcode
+			uint32_t nRepeats = 1;
+			while (i + nRepeats < pixels.size() && pixels[i + nRepeats] == nShift && nRepeats < MAX_RLE_REPEATS)
+			{
+				nRepeats++;
+			}
+			nibbles.push_back(NIBBLE_OPCODE_RLE);
+			nibbles.push_back((uint8_t)(nRepeats - 1));
+			i += nRepeats;
+			continue;
+		}
+
+		int32_t nDiff = nShift - nLastShift;
+		if (nLastShift >= 0 && nDiff >= -MAX_SMALL_DIFF && nDiff <= MAX_SMALL_DIFF)
+		{
+			nibbles.push_back((uint8_t)(nDiff + MAX_SMALL_DIFF));
+		}
+		else if (nLastShift >= 0 && nDiff >= -(MAX_BIG_DIFF + 1) && nDiff <= MAX_BIG_DIFF)
+		{
+			uint32_t nBigDiff = (uint32_t)(nDiff + MAX_BIG_DIFF + 1);
+			nibbles.push_back(NIBBLE_OPCODE_FULL);
+			nibbles.push_back((uint8_t)(0x08 | (nBigDiff >> 4)));
+			nibbles.push_back((uint8_t)(nBigDiff & 0x0F));
+		}
+		else
+		{
+			nibbles.push_back(NIBBLE_OPCODE_FULL);
+			nibbles.push_back(0);
+			nibbles.push_back((uint8_t)((nShift >> 8) & 0x0F));
+			nibbles.push_back((uint8_t)((nShift >> 4) & 0x0F));
+			nibbles.push_back((uint8_t)(nShift & 0x0F));
+		}
+
+		nLastShift = nShift;
+		i++;
+	}
+
+	//Pad to a whole byte with a no-op
+	if (nibbles.size() % 2 != 0)
+	{
+		nibbles.push_back(NIBBLE_OPCODE_NOP);
+	}
+
+	output.resize(nibbles.size() / 2);
+	for (uint32_t j = 0; j < output.size(); j++)
+	{
+		output[j] = (uint8_t)((nibbles[j * 2] << 4) | nibbles[j * 2 + 1]);
+	}
+}
+
+XnStatus SimulatedLinkFirmware::BuildFrames(SimulatedStream& stream)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	std::vector<std::vector<uint8_t> > payloads;
+
+	if (!stream.recordedFrames.empty())
+	{
+		payloads = stream.recordedFrames;
+	}
+	else
+	{
+		std::vector<uint16_t> pixels;
+		payloads.resize(NUM_SYNTHETIC_FRAMES);
+		for (uint32_t nFrame = 0; nFrame < NUM_SYNTHETIC_FRAMES; nFrame++)
+		{
+			GenerateFrame(stream, nFrame, pixels);
+			std::vector<uint8_t>& payload = payloads[nFrame];
+
+			switch (stream.videoMode.m_nCompression)
+			{
+			case XN_FW_COMPRESSION_10_BIT_PACKED:
+				PackBits(pixels, 10, payload);
+				break;
+			case XN_FW_COMPRESSION_11_BIT_PACKED:
+				PackBits(pixels, 11, payload);
+				break;
+			case XN_FW_COMPRESSION_12_BIT_PACKED:
+				PackBits(pixels, 12, payload);
+				break;
+			case XN_FW_COMPRESSION_16Z:
+				Encode16z(pixels, payload);
+				break;
+			case XN_FW_COMPRESSION_NONE:
+				payload.resize(pixels.size() * sizeof(uint16_t));
+				for (uint32_t i = 0; i < pixels.size(); i++)
+				{
+					uint16_t nPixel = XN_PREPARE_VAR16_IN_BUFFER(pixels[i]);
+					xnOSMemCopy(&payload[i * sizeof(uint16_t)], &nPixel, sizeof(nPixel));
+				}
+				break;
+			default:
+				xnLogError(XN_MASK_LINK, "Simulated firmware: unsupported compression %u", stream.videoMode.m_nCompression);
+				XN_ASSERT(false);
+				return XN_STATUS_NOT_IMPLEMENTED;
+			}
+		}
+	}
+
+	uint32_t nMaxPayloadSize = 0;
+	for (uint32_t i = 0; i < payloads.size(); i++)
+	{
+		nMaxPayloadSize = XN_MAX(nMaxPayloadSize, (uint32_t)payloads[i].size());
+	}
+
+	LinkMsgEncoder encoder;
+	nRetVal = encoder.Init(sizeof(XnLinkDataHeader) + nMaxPayloadSize, DATA_PACKET_SIZE);
+	XN_IS_STATUS_OK_LOG_ERROR("Init simulated data encoder", nRetVal);
+
+	//Packet IDs and timestamps are filled in when each frame is sent
+	XnLinkDataHeader dataHeader;
+	xnOSMemSet(&dataHeader, 0, sizeof(dataHeader));
+
+	stream.encodedFrames.resize(payloads.size());
+	for (uint32_t i = 0; i < payloads.size(); i++)
+	{
+		encoder.BeginEncoding(XN_LINK_MSG_DATA, 0, stream.nStreamID, XN_LINK_FRAG_BEGIN);
+		encoder.EncodeData(&dataHeader, sizeof(dataHeader));
+		if (!payloads[i].empty())
+		{
+			encoder.EncodeData(&payloads[i][0], (uint32_t)payloads[i].size());
+		}
+		encoder.EndEncoding(XN_LINK_FRAG_END);
+
+		const uint8_t* pEncoded = reinterpret_cast<const uint8_t*>(encoder.GetEncodedData());
+		stream.encodedFrames[i].assign(pEncoded, pEncoded + encoder.GetEncodedSize());
+	}
+
+	encoder.Shutdown();
+
+	stream.nNextFrame = 0;
+	stream.bFramesDirty = false;
+	return XN_STATUS_OK;
+}
+
+XnStatus SimulatedLinkFirmware::ReadNextFrame(uint16_t nEndpointID, std::vector<uint8_t>& buffer, uint32_t& nSize, uint32_t& nWaitMs)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	nSize = 0;
+	nWaitMs = IDLE_WAIT_MS;
+
+	if (!m_bInitialized)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	xnl::AutoCSLocker lock(m_hCriticalSection);
+
+	uint64_t nNow = 0;
+	xnOSGetHighResTimeStamp(&nNow);
+
+	//Pick the stream on this endpoint whose next frame is due first
+	SimulatedStream* pStream = NULL;
+	for (uint16_t i = 0; i < NUM_STREAMS; i++)
+	{
+		SimulatedStream& stream = m_streams[i];
+		if (stream.nEndpointID == nEndpointID && stream.bStreaming &&
+			(pStream == NULL || stream.nNextFrameTime < pStream->nNextFrameTime))
+		{
+			pStream = &stream;
+		}
+	}
+
+	if (pStream == NULL)
+	{
+		return XN_STATUS_OK;
+	}
+
+	if (pStream->nNextFrameTime > nNow)
+	{
+		nWaitMs = (uint32_t)((pStream->nNextFrameTime - nNow + 999) / 1000);
+		return XN_STATUS_OK;
+	}
+
+	if (pStream->bFramesDirty)
+	{
+		nRetVal = BuildFrames(*pStream);
+		XN_IS_STATUS_OK_LOG_ERROR("Build simulated frames", nRetVal);
+	}
+
+	const std::vector<uint8_t>& frame = pStream->encodedFrames[pStream->nNextFrame];
+	if (buffer.size() < frame.size())
+	{
+		buffer.resize(frame.size());
+	}
+	xnOSMemCopy(&buffer[0], &frame[0], frame.size());
+	nSize = (uint32_t)frame.size();
+
+	//Number the packets and stamp the frame
+	uint8_t* pPacket = &buffer[0];
+	uint8_t* pEnd = pPacket + nSize;
+	XnLinkDataHeader* pDataHeader = reinterpret_cast<XnLinkDataHeader*>(pPacket + sizeof(XnLinkPacketHeader));
+	pDataHeader->m_nTimestampLo = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)(nNow & 0xFFFFFFFF));
+	pDataHeader->m_nTimestampHi = XN_PREPARE_VAR32_IN_BUFFER((uint32_t)(nNow >> 32));
+	while (pPacket < pEnd)
+	{
+		LinkPacketHeader* pHeader = reinterpret_cast<LinkPacketHeader*>(pPacket);
+		pHeader->SetPacketID(pStream->nNextPacketID++);
+		pPacket += pHeader->GetSize();
+	}
+
+	pStream->nNextFrame = (pStream->nNextFrame + 1) % pStream->encodedFrames.size();
+	pStream->nFramesSent++;
+	pStream->nBytesSent += nSize;
+
+	//Keep a steady pace, but don't try to catch up if we fell more than a frame behind
+	uint32_t nInterval = GetFrameIntervalUs(*pStream);
+	pStream->nNextFrameTime += nInterval;
+	if (pStream->nNextFrameTime + nInterval < nNow)
+	{
+		pStream->nNextFrameTime = nNow;
+	}
+
+	nWaitMs = 0;
+	return XN_STATUS_OK;
+}
+
+}
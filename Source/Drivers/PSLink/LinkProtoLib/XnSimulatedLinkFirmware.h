@@ -0,0 +1,151 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef XNSIMULATEDLINKFIRMWARE_H
+#define XNSIMULATEDLINKFIRMWARE_H
+
+#include <vector>
+
+#include "XnLinkDefs.h"
+#include "XnLinkProto.h"
+#include "XnLinkProtoLibDefs.h"
+#include "XnLinkProtoUtils.h"
+#include <XnStatus.h>
+#include <XnOS.h>
+
+namespace xn
+{
+
+/**
+ * An in-process stand-in for the PS1200 firmware. It answers the control commands the client sends
+ * during connection and stream setup, and produces DATA messages for depth (shifts) and IR streams,
+ * either from a synthetic pattern or from recorded input endpoint dumps (EP.xxxxx.In.raw).
+ *
+ * The configuration string is a list of key=value pairs separated by ';', optionally preceded by
+ * XN_LINK_LOOPBACK_URI_PREFIX:
+ *   fps=<n>                  Overrides the frame rate of all streams. 0 means send frames as fast as possible.
+ *   depthCompression=<name>  Default compression of the depth stream (None, 11bit, 12bit or 16z).
+ *   irCompression=<name>     Default compression of the IR stream (None or 10bit).
+ *   depthFile=<path>         Replay DATA messages from a recorded endpoint dump on the depth stream.
+ *   irFile=<path>            Replay DATA messages from a recorded endpoint dump on the IR stream.
+ *   serial=<string>          Serial number reported to the host.
+ */
+class SimulatedLinkFirmware
+{
+public:
+	SimulatedLinkFirmware();
+	~SimulatedLinkFirmware();
+
+	XnStatus Init(const char* strConfig);
+	void Shutdown();
+	bool IsInitialized() const;
+
+	uint16_t GetControlPacketSize() const;
+	uint16_t GetDataPacketSize() const;
+
+	/* Handles a single control packet sent by the host. nResponseSize is max size on input, actual size on output. */
+	XnStatus HandleControlPacket(const void* pPacket, uint32_t nPacketSize, void* pResponse, uint32_t& nResponseSize);
+
+	/* Copies the next due frame of a stream on data endpoint nEndpointID to buffer. If no frame is due, nSize is 0
+	   and nWaitMs holds the time until the next one. */
+	XnStatus ReadNextFrame(uint16_t nEndpointID, std::vector<uint8_t>& buffer, uint32_t& nSize, uint32_t& nWaitMs);
+
+	/* Frame payload encoders, as used by the firmware. */
+	static void PackBits(const std::vector<uint16_t>& pixels, uint32_t nBitsPerPixel, std::vector<uint8_t>& output);
+	static void Encode16z(const std::vector<uint16_t>& pixels, std::vector<uint8_t>& output);
+
+private:
+	struct SimulatedStream
+	{
+		XnLinkStreamType streamType;
+		uint16_t nStreamID;
+		uint16_t nEndpointID;
+		bool bCreated;
+		bool bStreaming;
+
+		std::vector<XnLinkVideoMode> supportedModes;
+		std::vector<uint8_t> supportedInterfaces;
+		XnLinkVideoMode videoMode;
+		bool bMirror;
+		XnLinkCropping cropping;
+		uint64_t nGain;
+
+		//Recorded frame payloads (no timestamp) - when empty, a synthetic pattern is used
+		std::vector<std::vector<uint8_t> > recordedFrames;
+		//Frames encoded as link packets, ready to be sent (packet IDs and timestamps are set when sending)
+		std::vector<std::vector<uint8_t> > encodedFrames;
+		bool bFramesDirty;
+		uint32_t nNextFrame;
+		uint16_t nNextPacketID;
+		uint64_t nNextFrameTime;
+
+		uint64_t nStartTime;
+		uint32_t nFramesSent;
+		uint64_t nBytesSent;
+	};
+
+	XnStatus ParseConfig(const char* strConfig);
+	void InitStream(SimulatedStream& stream, XnLinkStreamType streamType, uint16_t nStreamID, uint16_t nEndpointID, XnFwCompressionType defaultCompression);
+	XnStatus LoadRecordedFrames(const char* strFileName, SimulatedStream& stream);
+	SimulatedStream* GetStream(uint16_t nStreamID);
+
+	XnLinkResponseCode ExecuteCommand(uint16_t nMsgType, uint16_t nStreamID, const uint8_t* pData, uint32_t nSize);
+	XnLinkResponseCode GetProperty(uint16_t nStreamID, const uint8_t* pData, uint32_t nSize);
+	XnLinkResponseCode SetProperty(uint16_t nStreamID, const uint8_t* pData, uint32_t nSize);
+	XnStatus EncodeResponsePacket(void* pResponse, uint32_t& nResponseSize);
+
+	void AppendResponse(const void* pData, uint32_t nSize);
+	void AppendIntProp(XnLinkPropID propID, uint64_t nValue);
+	void AppendGeneralProp(XnLinkPropID propID, const void* pValue, uint32_t nSize);
+	void AppendIDSetProp(XnLinkPropID propID, const uint16_t* aIDs, uint32_t nCount);
+
+	void StartStreaming(SimulatedStream& stream);
+	void StopStreaming(SimulatedStream& stream);
+	XnStatus BuildFrames(SimulatedStream& stream);
+	void GenerateFrame(const SimulatedStream& stream, uint32_t nFrame, std::vector<uint16_t>& pixels);
+	uint32_t GetFrameIntervalUs(const SimulatedStream& stream) const;
+
+	static const uint16_t CONTROL_PACKET_SIZE;
+	static const uint16_t DATA_PACKET_SIZE;
+	static const uint32_t NUM_SYNTHETIC_FRAMES;
+	static const uint32_t IDLE_WAIT_MS;
+	static const uint16_t NUM_STREAMS = 2;
+
+	SimulatedStream m_streams[NUM_STREAMS];
+	char m_strSerialNumber[XN_LINK_SERIAL_NUMBER_SIZE];
+	int32_t m_nFPSOverride;
+
+	//Command currently being received, and response currently being sent (may span several packets)
+	std::vector<uint8_t> m_command;
+	std::vector<uint8_t> m_response;
+	uint32_t m_nResponseOffset;
+	uint16_t m_nResponseMsgType;
+	uint16_t m_nResponseStreamID;
+	uint16_t m_nResponseCode;
+	uint16_t m_nResponseCID;
+	uint16_t m_nResponsePacketID;
+
+	XN_CRITICAL_SECTION_HANDLE m_hCriticalSection;
+	bool m_bInitialized;
+};
+
+}
+
+#endif // XNSIMULATEDLINKFIRMWARE_H
@@ -20,6 +20,7 @@
 *****************************************************************************/
 #include "PS1200Device.h"
 #include "XnClientUSBConnectionFactory.h"
+#include "XnLoopbackConnectionFactory.h"
 #include <PSLink.h>
 #include <XnLog.h>
 
@@ -37,6 +38,8 @@ PS1200Device::PS1200Device()
 {
 	m_hInputInterruptCallback = NULL;
 	m_bInitialized = false;
+	m_transportType = XN_TRANSPORT_TYPE_NONE;
+	m_nLoopbackAltInterface = 0;
 }
 
 PS1200Device::~PS1200Device()
@@ -48,14 +51,15 @@ XnStatus PS1200Device::Init(const char* strConnString, XnTransportType transport
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	if (transportType != XN_TRANSPORT_TYPE_USB)
+	if (transportType != XN_TRANSPORT_TYPE_USB && transportType != XN_TRANSPORT_TYPE_LOOPBACK)
 	{
 		xnLogError(XN_MASK_LINK, "Transport type not supported: %d", transportType);
 		XN_ASSERT(false);
 		return XN_STATUS_BAD_PARAM;
 	}
 
-	nRetVal = PrimeClient::Init(strConnString, XN_TRANSPORT_TYPE_USB);
+	m_transportType = transportType;
+	nRetVal = PrimeClient::Init(strConnString, transportType);
 	XN_IS_STATUS_OK_LOG_ERROR("Init EE Device", nRetVal);
 
 	m_bInitialized = true;
@@ -75,6 +79,11 @@ bool PS1200Device::IsInitialized() const
 
 IConnectionFactory* PS1200Device::CreateConnectionFactory(XnTransportType transportType)
 {
+	if (transportType == XN_TRANSPORT_TYPE_LOOPBACK)
+	{
+		return XN_NEW(LoopbackConnectionFactory, NUM_INPUT_CONNECTIONS);
+	}
+
 	if (transportType != XN_TRANSPORT_TYPE_USB)
 	{
 		XN_ASSERT(false);
@@ -99,11 +108,23 @@ const ClientUSBConnectionFactory* PS1200Device::GetConnectionFactory() const
 
 XnStatus PS1200Device::SetUsbAltInterface(uint8_t altInterface)
 {
+	if (m_transportType == XN_TRANSPORT_TYPE_LOOPBACK)
+	{
+		m_nLoopbackAltInterface = altInterface;
+		return XN_STATUS_OK;
+	}
+
 	return GetConnectionFactory()->SetUsbAltInterface(altInterface);
 }
 
 XnStatus PS1200Device::GetUsbAltInterface(uint8_t& altInterface) const
 {
+	if (m_transportType == XN_TRANSPORT_TYPE_LOOPBACK)
+	{
+		altInterface = m_nLoopbackAltInterface;
+		return XN_STATUS_OK;
+	}
+
 	return GetConnectionFactory()->GetUsbAltInterface(&altInterface);
 }
 
@@ -158,6 +179,12 @@ XnStatus PS1200Device::UsbTest(uint32_t nSeconds, uint32_t& endpointsCount, XnUs
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
+	if (m_transportType != XN_TRANSPORT_TYPE_USB)
+	{
+		xnLogWarning(XN_MASK_PS1200_DEVICE, "USB test is only available on USB devices");
+		return XN_STATUS_INVALID_OPERATION;
+	}
+
 	xn::ClientUSBConnectionFactory* pConnFactory = GetConnectionFactory();
 
 	if (m_linkInputStreamsMgr.HasStreams())
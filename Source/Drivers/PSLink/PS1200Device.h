@@ -61,6 +61,9 @@ private:
 
 	//Data members
 	bool m_bInitialized;
+	XnTransportType m_transportType;
+	//Loopback devices have no USB interface to switch, the selection is just kept
+	uint8_t m_nLoopbackAltInterface;
 
 	XnCallbackHandle m_hInputInterruptCallback;
 
@@ -0,0 +1,487 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// PSLinkParserBenchmark.cpp : Measures the throughput of the PSLink frame parsers, scalar against vectorized.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include <XnLinkProtoUtils.h>
+#include <XnLinkMsgParser.h>
+#include <XnLink6BitParser.h>
+#include <XnLinkPacked10BitParser.h>
+#include <XnLink16zParser.h>
+#include <XnLinkUnpackedS2DParser.h>
+#include <XnLinkSimd.h>
+#include <XnSimulatedLinkFirmware.h>
+
+using namespace xn;
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_ITERATIONS 200
+#define SYNTHETIC_FRAME_WIDTH 640
+#define SYNTHETIC_FRAME_HEIGHT 480
+#define SYNTHETIC_FRAMES 4
+#define SYNTHETIC_PACKET_DATA_SIZE (8192 - sizeof(XnLinkPacketHeader))
+#define MAX_SHIFT 2047
+#define OUTPUT_BUFFER_SIZE (1280 * 1024 * sizeof(uint16_t))
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+enum ParserType
+{
+	PARSER_6BIT,
+	PARSER_PACKED_10BIT,
+	PARSER_16Z,
+	PARSER_16Z_S2D,
+	PARSER_UNPACKED_S2D,
+	PARSER_COUNT,
+};
+
+typedef struct
+{
+	XnLinkFragmentation fragmentation;
+	uint32_t nOffset;
+	uint32_t nSize;
+} BenchmarkPacket;
+
+/* Payloads of one or more frames, split into packets the way they arrive from the device. */
+typedef struct
+{
+	std::vector<uint8_t> data;
+	std::vector<BenchmarkPacket> packets;
+	uint32_t nFrames;
+} BenchmarkInput;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const char* g_parserNames[PARSER_COUNT] = { "6bit", "10bit", "16z", "16z-s2d", "s2d" };
+static XnShiftToDepthTables g_shiftToDepthTables;
+static std::vector<OniDepthPixel> g_shiftToDepth;
+
+//---------------------------------------------------------------------------
+// Input
+//---------------------------------------------------------------------------
+void AddFrame(BenchmarkInput& input, const std::vector<uint8_t>& payload, uint32_t nPacketDataSize)
+{
+	uint32_t nOffset = 0;
+	while (nOffset < payload.size())
+	{
+		BenchmarkPacket packet;
+		packet.nOffset = (uint32_t)input.data.size() + nOffset;
+		packet.nSize = XN_MIN(nPacketDataSize, (uint32_t)payload.size() - nOffset);
+		packet.fragmentation = XN_LINK_FRAG_MIDDLE;
+		if (nOffset == 0)
+		{
+			packet.fragmentation = XnLinkFragmentation(packet.fragmentation | XN_LINK_FRAG_BEGIN);
+		}
+		if (nOffset + packet.nSize == payload.size())
+		{
+			packet.fragmentation = XnLinkFragmentation(packet.fragmentation | XN_LINK_FRAG_END);
+		}
+		input.packets.push_back(packet);
+		nOffset += packet.nSize;
+	}
+
+	input.data.insert(input.data.end(), payload.begin(), payload.end());
+	input.nFrames++;
+}
+
+void GenerateSyntheticInput(ParserType parserType, BenchmarkInput& input)
+{
+	std::vector<uint16_t> pixels(SYNTHETIC_FRAME_WIDTH * SYNTHETIC_FRAME_HEIGHT);
+	std::vector<uint8_t> payload;
+
+	srand(0);
+	for (uint32_t nFrame = 0; nFrame < SYNTHETIC_FRAMES; ++nFrame)
+	{
+		//A tilted plane with a box in front of it and some sensor noise - flat runs, small steps and edges
+		for (uint32_t y = 0; y < SYNTHETIC_FRAME_HEIGHT; ++y)
+		{
+			for (uint32_t x = 0; x < SYNTHETIC_FRAME_WIDTH; ++x)
+			{
+				uint32_t nShift = 400 + (x + nFrame * 8) / 4 + y / 8;
+				if (x > 200 && x < 440 && y > 120 && y < 360)
+				{
+					nShift = 1200;
+				}
+				else if (rand() % 4 == 0)
+				{
+					nShift += rand() % 5;
+				}
+				pixels[y * SYNTHETIC_FRAME_WIDTH + x] = (uint16_t)XN_MIN(nShift, (uint32_t)MAX_SHIFT);
+			}
+		}
+
+		switch (parserType)
+		{
+			case PARSER_6BIT:
+				//Every byte sequence is a valid 6 bit stream
+				payload.resize(pixels.size() * 6 / 8);
+				for (uint32_t i = 0; i < payload.size(); ++i)
+				{
+					payload[i] = (uint8_t)rand();
+				}
+				break;
+			case PARSER_PACKED_10BIT:
+				for (uint32_t i = 0; i < pixels.size(); ++i)
+				{
+					pixels[i] &= 0x3FF;
+				}
+				SimulatedLinkFirmware::PackBits(pixels, 10, payload);
+				break;
+			case PARSER_UNPACKED_S2D:
+				payload.resize(pixels.size() * sizeof(uint16_t));
+				xnOSMemCopy(&payload[0], &pixels[0], payload.size());
+				break;
+			default:
+				SimulatedLinkFirmware::Encode16z(pixels, payload);
+				break;
+		}
+
+		AddFrame(input, payload, SYNTHETIC_PACKET_DATA_SIZE);
+	}
+}
+
+/* Takes the DATA messages of the first stream in an input endpoint dump (EP.xxxxx.In.raw), keeping packet boundaries. */
+XnStatus LoadCapturedInput(const char* strFileName, BenchmarkInput& input)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	uint64_t nFileSize = 0;
+
+	nRetVal = xnOSGetFileSize64(strFileName, &nFileSize);
+	XN_IS_STATUS_OK(nRetVal);
+	if (nFileSize == 0 || nFileSize > XN_MAX_UINT32)
+	{
+		return XN_STATUS_CORRUPT_FILE;
+	}
+
+	std::vector<uint8_t> fileData((size_t)nFileSize);
+	nRetVal = xnOSLoadFile(strFileName, &fileData[0], (uint32_t)nFileSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	uint16_t nStreamID = XN_LINK_STREAM_ID_INVALID;
+	bool bInFrame = false;
+	uint32_t nFirstFramePacket = 0;
+	const uint8_t* pData = &fileData[0];
+	uint32_t nBytesLeft = (uint32_t)nFileSize;
+
+	while (nBytesLeft > 0)
+	{
+		const LinkPacketHeader* pHeader = reinterpret_cast<const LinkPacketHeader*>(pData);
+		if (pHeader->Validate(nBytesLeft) != XN_STATUS_OK)
+		{
+			printf("Corrupt packet at offset %u - ignoring the rest of the file\n", (uint32_t)(nFileSize - nBytesLeft));
+			break;
+		}
+
+		if (pHeader->GetMsgType() == XN_LINK_MSG_DATA)
+		{
+			if (nStreamID == XN_LINK_STREAM_ID_INVALID)
+			{
+				nStreamID = pHeader->GetStreamID();
+			}
+
+			if (pHeader->GetStreamID() == nStreamID)
+			{
+				const uint8_t* pPacketData = pHeader->GetPacketData();
+				uint32_t nPacketDataSize = pHeader->GetDataSize();
+				XnLinkFragmentation fragmentation = pHeader->GetFragmentationFlags();
+
+				if (fragmentation & XN_LINK_FRAG_BEGIN)
+				{
+					//Drop a frame that never ended, and the timestamp of the new one
+					input.packets.resize(nFirstFramePacket);
+					bInFrame = (nPacketDataSize >= sizeof(uint64_t));
+					pPacketData += sizeof(uint64_t);
+					nPacketDataSize -= bInFrame ? sizeof(uint64_t) : nPacketDataSize;
+				}
+
+				if (bInFrame)
+				{
+					BenchmarkPacket packet;
+					packet.fragmentation = fragmentation;
+					packet.nOffset = (uint32_t)input.data.size();
+					packet.nSize = nPacketDataSize;
+					input.packets.push_back(packet);
+					input.data.insert(input.data.end(), pPacketData, pPacketData + nPacketDataSize);
+
+					if (fragmentation & XN_LINK_FRAG_END)
+					{
+						nFirstFramePacket = (uint32_t)input.packets.size();
+						input.nFrames++;
+						bInFrame = false;
+					}
+				}
+			}
+		}
+
+		pData += pHeader->GetSize();
+		nBytesLeft -= pHeader->GetSize();
+	}
+
+	input.packets.resize(nFirstFramePacket);
+	return (input.nFrames > 0) ? XN_STATUS_OK : XN_STATUS_NO_MATCH;
+}
+
+//---------------------------------------------------------------------------
+// Benchmark
+//---------------------------------------------------------------------------
+/* Whether the parser has a code path of its own for the instruction set. 16z is a variable length code, its
+   fast path is the same for every instruction set. */
+bool HasSimdPath(ParserType parserType, XnLinkSimdLevel nLevel)
+{
+	switch (nLevel)
+	{
+		case XN_LINK_SIMD_NONE:
+			return true;
+		case XN_LINK_SIMD_SSSE3:
+			return (parserType == PARSER_6BIT || parserType == PARSER_PACKED_10BIT);
+		case XN_LINK_SIMD_AVX2:
+			return (parserType == PARSER_UNPACKED_S2D);
+		default:
+			return false;
+	}
+}
+
+void SelectSimdLevel(uint32_t nLevel)
+{
+	xnLinkSetSimdLevel(XnLinkSimdLevel(nLevel));
+}
+
+/* Parsers pick their code path when they are created, so this creates one for the selected kernels. */
+LinkMsgParser* CreateParser(ParserType parserType)
+{
+	switch (parserType)
+	{
+		case PARSER_6BIT:
+			return XN_NEW(Link6BitParser);
+		case PARSER_PACKED_10BIT:
+			return XN_NEW(LinkPacked10BitParser);
+		case PARSER_16Z:
+			return XN_NEW(Link16zParser<false>, g_shiftToDepthTables);
+		case PARSER_16Z_S2D:
+			return XN_NEW(Link16zParser<true>, g_shiftToDepthTables);
+		case PARSER_UNPACKED_S2D:
+			return XN_NEW(LinkUnpackedS2DParser, g_shiftToDepthTables);
+		default:
+			return NULL;
+	}
+}
+
+/* Parses all frames of the input, leaving the last one in outputs. Returns the number of packets that failed to parse. */
+uint32_t ParseInput(LinkMsgParser* pParser, const BenchmarkInput& input, std::vector<uint8_t>& output)
+{
+	uint32_t nErrors = 0;
+
+	for (uint32_t i = 0; i < input.packets.size(); ++i)
+	{
+		const BenchmarkPacket& packet = input.packets[i];
+		if (packet.fragmentation & XN_LINK_FRAG_BEGIN)
+		{
+			pParser->BeginParsing(&output[0], (uint32_t)output.size());
+		}
+		if (pParser->ParsePacket(packet.fragmentation, &input.data[packet.nOffset], packet.nSize) != XN_STATUS_OK)
+		{
+			nErrors++;
+		}
+	}
+
+	return nErrors;
+}
+
+/* Checks the parser with the kernels of pass nPass gives the same output as the scalar one, frame by frame. */
+bool VerifyParser(xnl::Benchmark& benchmark, ParserType parserType, const BenchmarkInput& input, uint32_t nPass)
+{
+	benchmark.SelectKernels(0);
+	LinkMsgParser* pScalar = CreateParser(parserType);
+	benchmark.SelectKernels(nPass);
+	LinkMsgParser* pVector = CreateParser(parserType);
+	std::vector<uint8_t> scalarOutput(OUTPUT_BUFFER_SIZE);
+	std::vector<uint8_t> vectorOutput(OUTPUT_BUFFER_SIZE);
+	bool bMatch = true;
+
+	for (uint32_t i = 0; i < input.packets.size() && bMatch; ++i)
+	{
+		const BenchmarkPacket& packet = input.packets[i];
+		if (packet.fragmentation & XN_LINK_FRAG_BEGIN)
+		{
+			pScalar->BeginParsing(&scalarOutput[0], (uint32_t)scalarOutput.size());
+			pVector->BeginParsing(&vectorOutput[0], (uint32_t)vectorOutput.size());
+		}
+
+		XnStatus nScalarRetVal = pScalar->ParsePacket(packet.fragmentation, &input.data[packet.nOffset], packet.nSize);
+		XnStatus nVectorRetVal = pVector->ParsePacket(packet.fragmentation, &input.data[packet.nOffset], packet.nSize);
+
+		bMatch = (nScalarRetVal == nVectorRetVal) &&
+			(pScalar->GetParsedSize() == pVector->GetParsedSize()) &&
+			(xnOSMemCmp(pScalar->GetParsedData(), pVector->GetParsedData(), pScalar->GetParsedSize()) == 0);
+	}
+
+	XN_DELETE(pScalar);
+	XN_DELETE(pVector);
+
+	if (!bMatch)
+	{
+		benchmark.Fail("%s: %s output differs from scalar output!", g_parserNames[parserType], benchmark.GetKernelName());
+	}
+
+	return bMatch;
+}
+
+void BenchmarkParser(xnl::Benchmark& benchmark, ParserType parserType, const BenchmarkInput& input, uint32_t nIterations)
+{
+	LinkMsgParser* pParser = CreateParser(parserType);
+	std::vector<uint8_t> output(OUTPUT_BUFFER_SIZE);
+	uint32_t nErrors = 0;
+
+	//Warm up caches and page in the output buffer
+	ParseInput(pParser, input, output);
+
+	benchmark.ResetTimes();
+	for (uint32_t i = 0; i < nIterations; ++i)
+	{
+		benchmark.StartRun();
+		nErrors += ParseInput(pParser, input, output);
+		benchmark.EndRun();
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %u frames", g_parserNames[parserType], input.nFrames);
+	benchmark.ReportThroughput(strCase, input.data.size());
+	if (nErrors != 0)
+	{
+		printf("%-32s %u packets failed to parse\n", "", nErrors);
+	}
+
+	XN_DELETE(pParser);
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	const char* strParser = NULL;
+	const char* strFileName = NULL;
+	int32_t nParser = -1;
+	uint32_t nIterations = DEFAULT_ITERATIONS;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("parser", "6bit|10bit|16z|16z-s2d|s2d", "Benchmark a single parser. By default, all parsers are benchmarked.", &strParser);
+	benchmark.AddOption("file", "fileName", "Parse the first stream of a recorded input endpoint dump (EP.xxxxx.In.raw) instead of synthetic frames. Requires -parser.", &strFileName);
+	benchmark.AddOption("iterations", "Number of times the input is parsed.", &nIterations);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	if (strParser != NULL)
+	{
+		for (nParser = 0; nParser < PARSER_COUNT; ++nParser)
+		{
+			if (xnOSStrCaseCmp(strParser, g_parserNames[nParser]) == 0)
+			{
+				break;
+			}
+		}
+		if (nParser == PARSER_COUNT)
+		{
+			printf("Unknown parser: %s\n", strParser);
+			return -1;
+		}
+	}
+
+	if (strFileName != NULL && nParser < 0)
+	{
+		printf("-file requires -parser, since recordings don't say how their frames are compressed.\n");
+		return -1;
+	}
+
+	//Only the size of the table matters for the benchmark, not real calibration
+	g_shiftToDepth.resize(MAX_SHIFT + 1);
+	for (uint32_t i = 0; i < g_shiftToDepth.size(); ++i)
+	{
+		g_shiftToDepth[i] = (OniDepthPixel)(i * 4);
+	}
+	xnOSMemSet(&g_shiftToDepthTables, 0, sizeof(g_shiftToDepthTables));
+	g_shiftToDepthTables.bIsInitialized = true;
+	g_shiftToDepthTables.pShiftToDepthTable = &g_shiftToDepth[0];
+	g_shiftToDepthTables.nShiftsCount = (uint32_t)g_shiftToDepth.size();
+
+	const char* astrLevels[] = { xnLinkSimdLevelToName(XN_LINK_SIMD_NONE), xnLinkSimdLevelToName(XN_LINK_SIMD_SSSE3), xnLinkSimdLevelToName(XN_LINK_SIMD_AVX2) };
+	benchmark.SetKernels(SelectSimdLevel, astrLevels, xnLinkGetSupportedSimdLevel());
+
+	for (int32_t i = 0; i < PARSER_COUNT; ++i)
+	{
+		if (nParser >= 0 && i != nParser)
+		{
+			continue;
+		}
+
+		ParserType parserType = ParserType(i);
+		BenchmarkInput input;
+		input.nFrames = 0;
+
+		if (strFileName != NULL)
+		{
+			nRetVal = LoadCapturedInput(strFileName, input);
+			if (nRetVal != XN_STATUS_OK)
+			{
+				printf("Failed to load frames from %s: %s\n", strFileName, xnGetStatusString(nRetVal));
+				return -1;
+			}
+		}
+		else
+		{
+			GenerateSyntheticInput(parserType, input);
+		}
+
+		// only the instruction sets the parser has a path for, so each result is named after the code that ran
+		for (uint32_t nPass = 0; nPass < benchmark.GetKernelPasses(); ++nPass)
+		{
+			if (!HasSimdPath(parserType, XnLinkSimdLevel(nPass)))
+			{
+				continue;
+			}
+
+			if (nPass > 0)
+			{
+				VerifyParser(benchmark, parserType, input, nPass);
+			}
+
+			benchmark.SelectKernels(nPass);
+			BenchmarkParser(benchmark, parserType, input, nIterations);
+		}
+	}
+
+	return benchmark.GetResult();
+}
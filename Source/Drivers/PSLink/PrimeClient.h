@@ -127,6 +127,9 @@ public:
 
 	virtual void HandleLinkDataEndpointDisconnection(uint16_t nEndpointID);
 
+	/* Parse the packets of each frame stream on its own thread. Applies to streams created afterwards. */
+	void SetStreamDecodeThreads(bool bEnabled) { m_linkInputStreamsMgr.SetDecodeThreadsEnabled(bEnabled); }
+
 protected:
 	virtual XnStatus ConnectOutputDataEndpoint();
 	virtual IConnectionFactory* CreateConnectionFactory(XnTransportType transportType) = 0;
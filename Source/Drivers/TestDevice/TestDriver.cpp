@@ -82,6 +82,26 @@ OniStatus TestDriver::tryDevice(const char* uri)
 	return ONI_STATUS_OK;
 }
 
+// Frames of test streams are issued by the application, so there is nothing to synchronize here. Frames
+// issued to all streams of the group in the same order get the same index, and are matched by OpenNI.
+void* TestDriver::enableFrameSync(oni::driver::StreamBase** /*pStreams*/, int streamCount)
+{
+	FrameSyncGroup* pGroup = XN_NEW(FrameSyncGroup);
+	if (pGroup == NULL)
+	{
+		return NULL;
+	}
+
+	pGroup->streamCount = streamCount;
+	return pGroup;
+}
+
+void TestDriver::disableFrameSync(void* frameSyncGroup)
+{
+	FrameSyncGroup* pGroup = (FrameSyncGroup*)frameSyncGroup;
+	XN_DELETE(pGroup);
+}
+
 void TestDriver::shutdown()
 {}
 
@@ -34,9 +34,17 @@ public:
 	virtual void deviceClose(oni::driver::DeviceBase* pDevice);
 	virtual OniStatus tryDevice(const char* uri);
 
+	virtual void* enableFrameSync(oni::driver::StreamBase** pStreams, int streamCount);
+	virtual void disableFrameSync(void* frameSyncGroup);
+
 	void shutdown();
 
 protected:
+	typedef struct
+	{
+		int streamCount;
+	} FrameSyncGroup;
+
 	XN_THREAD_HANDLE m_threadHandle;
 	xnl::Hash<OniDeviceInfo*, oni::driver::DeviceBase*> m_devices;
 };
@@ -0,0 +1,193 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include <OniFrameSubscriber.h>
+#include "../Core/OniSharedFrameRing.h"
+#include <XnOS.h>
+
+using namespace oni::implementation;
+
+struct _OniFrameSubscriber
+{
+	XN_SHARED_MEMORY_HANDLE hSharedMemory;
+	SharedFrameRingHeader* pHeader;
+	uint64_t lastSequence;
+
+	// Frames are read in place, so a held frame is identified by the slot it's in.
+	OniFrame frames[ONI_SHARED_FRAME_RING_MAX_SLOTS];
+	bool held[ONI_SHARED_FRAME_RING_MAX_SLOTS];
+};
+
+ONI_SUBSCRIBER_C_API OniStatus oniSubscriberOpen(const char* name, OniFrameSubscriberHandle* pSubscriber)
+{
+	if (name == NULL || pSubscriber == NULL)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	XN_SHARED_MEMORY_HANDLE hSharedMemory;
+	// Subscribers write to the shared memory as well, to pin the frames they hold.
+	XnStatus rc = xnOSOpenSharedMemory(name, XN_OS_FILE_READ | XN_OS_FILE_WRITE, &hSharedMemory);
+	if (rc != XN_STATUS_OK)
+	{
+		return ONI_STATUS_NO_DEVICE;
+	}
+
+	void* pAddress = NULL;
+	xnOSSharedMemoryGetAddress(hSharedMemory, &pAddress);
+	SharedFrameRingHeader* pHeader = (SharedFrameRingHeader*)pAddress;
+
+	// The publisher may still be initializing the header.
+	if (pHeader->magic.load(std::memory_order_acquire) != ONI_SHARED_FRAME_RING_MAGIC)
+	{
+		xnOSCloseSharedMemory(hSharedMemory);
+		return ONI_STATUS_NO_DEVICE;
+	}
+
+	if (pHeader->version != ONI_SHARED_FRAME_RING_VERSION || pHeader->slotCount > ONI_SHARED_FRAME_RING_MAX_SLOTS)
+	{
+		xnOSCloseSharedMemory(hSharedMemory);
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	_OniFrameSubscriber* pResult = XN_NEW(_OniFrameSubscriber);
+	xnOSMemSet(pResult, 0, sizeof(_OniFrameSubscriber));
+	pResult->hSharedMemory = hSharedMemory;
+	pResult->pHeader = pHeader;
+
+	*pSubscriber = pResult;
+	return ONI_STATUS_OK;
+}
+
+ONI_SUBSCRIBER_C_API void oniSubscriberClose(OniFrameSubscriberHandle subscriber)
+{
+	if (subscriber == NULL)
+	{
+		return;
+	}
+
+	for (uint32_t i = 0; i < subscriber->pHeader->slotCount; ++i)
+	{
+		if (subscriber->held[i])
+		{
+			oniSubscriberReleaseFrame(subscriber, &subscriber->frames[i]);
+		}
+	}
+
+	xnOSCloseSharedMemory(subscriber->hSharedMemory);
+	XN_DELETE(subscriber);
+}
+
+ONI_SUBSCRIBER_C_API OniStatus oniSubscriberReadFrame(OniFrameSubscriberHandle subscriber, int timeout, OniFrame** pFrame)
+{
+	if (subscriber == NULL || pFrame == NULL)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	SharedFrameRingHeader* pHeader = subscriber->pHeader;
+
+	uint64_t nStart;
+	xnOSGetTimeStamp(&nStart);
+
+	for (;;)
+	{
+		// Read the count before the latest frame, so a frame published in between ends the wait below.
+		int32_t notifyCount = pHeader->notifyCount.load();
+		uint64_t latest = pHeader->latest.load(std::memory_order_acquire);
+		uint64_t sequence = latest >> 8;
+		uint32_t slot = (uint32_t)(latest & 0xFF);
+
+		if (sequence > subscriber->lastSequence && slot < pHeader->slotCount)
+		{
+			// Pin the slot, then make sure the publisher didn't start overwriting it (see OniSharedFrameRing.h).
+			SharedFrameSlot* pSlot = sharedFrameRingGetSlot(pHeader, slot);
+			pSlot->readers.fetch_add(1);
+			if (pSlot->sequence.load() == sequence)
+			{
+				OniFrame& frame = subscriber->frames[slot];
+				frame.dataSize = pSlot->dataSize;
+				frame.data = sharedFrameRingGetSlotData(pSlot);
+				frame.sensorType = (OniSensorType)pSlot->sensorType;
+				frame.timestamp = pSlot->timestamp;
+				frame.frameIndex = pSlot->frameIndex;
+				frame.width = pSlot->width;
+				frame.height = pSlot->height;
+				frame.videoMode = pSlot->videoMode;
+				frame.croppingEnabled = (pSlot->croppingEnabled != 0);
+				frame.cropOriginX = pSlot->cropOriginX;
+				frame.cropOriginY = pSlot->cropOriginY;
+				frame.stride = pSlot->stride;
+
+				subscriber->held[slot] = true;
+				subscriber->lastSequence = sequence;
+				*pFrame = &frame;
+				return ONI_STATUS_OK;
+			}
+
+			// It's being overwritten, with a newer frame. Wait for it.
+			pSlot->readers.fetch_sub(1);
+		}
+
+		if (pHeader->closed.load() != 0)
+		{
+			return ONI_STATUS_NO_DEVICE;
+		}
+
+		uint32_t nWait = XN_WAIT_INFINITE;
+		if (timeout != ONI_TIMEOUT_FOREVER)
+		{
+			uint64_t nNow;
+			xnOSGetTimeStamp(&nNow);
+			if (nNow - nStart >= (uint64_t)timeout)
+			{
+				return ONI_STATUS_TIME_OUT;
+			}
+			nWait = (uint32_t)(timeout - (nNow - nStart));
+		}
+
+		xnOSWaitSharedAddress(sharedFrameRingNotifyAddress(pHeader), notifyCount, nWait);
+	}
+}
+
+ONI_SUBSCRIBER_C_API void oniSubscriberReleaseFrame(OniFrameSubscriberHandle subscriber, OniFrame* pFrame)
+{
+	if (subscriber == NULL || pFrame < subscriber->frames || pFrame >= subscriber->frames + subscriber->pHeader->slotCount)
+	{
+		return;
+	}
+
+	uint32_t slot = (uint32_t)(pFrame - subscriber->frames);
+	if (subscriber->held[slot])
+	{
+		subscriber->held[slot] = false;
+		sharedFrameRingGetSlot(subscriber->pHeader, slot)->readers.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+ONI_SUBSCRIBER_C_API OniSensorType oniSubscriberGetSensorType(OniFrameSubscriberHandle subscriber)
+{
+	return (OniSensorType)subscriber->pHeader->sensorType;
+}
+
+ONI_SUBSCRIBER_C_API uint64_t oniSubscriberGetDroppedFrames(OniFrameSubscriberHandle subscriber)
+{
+	return subscriber->pHeader->droppedFrames.load(std::memory_order_relaxed);
+}
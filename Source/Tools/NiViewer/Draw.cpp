@@ -37,6 +37,7 @@
 #endif
 #include "MouseInput.h"
 #include <XnPlatform.h>
+#include <DepthHistogram.h>
 
 #if (XN_PLATFORM == XN_PLATFORM_WIN32)
 	#ifdef __INTEL_COMPILER
@@ -121,7 +122,8 @@ static uint8_t PalletIntsG [256] = {0};
 static uint8_t PalletIntsB [256] = {0};
 
 /* Histograms */
-static float* g_pDepthHist = NULL;
+static depth_histogram::DepthHistogram g_depthHist;
+static depth_histogram::ColorMap g_depthColorMap;
 static int g_nMaxDepth = 0;
 static unsigned short g_nMaxGrayscale16Value = 0;
 
@@ -589,49 +591,8 @@ void calculateHistogram()
 	if (!depthGen.isValid() || !getDepthFrame().isValid())
 		return;
 
-	int maxDepthValue = getDepthStream().getMaxPixelValue() + 1;
-	if (g_pDepthHist == NULL || maxDepthValue > g_nMaxDepth)
-	{
-		delete[] g_pDepthHist;
-		g_pDepthHist = new float[maxDepthValue];
-		g_nMaxDepth = maxDepthValue;
-	}
-
-	xnOSMemSet(g_pDepthHist, 0, g_nMaxDepth*sizeof(float));
-	int nNumberOfPoints = 0;
-
-	openni::DepthPixel nValue;
-
-	const openni::DepthPixel* pDepth = (const openni::DepthPixel*)getDepthFrame().getData();
-	const openni::DepthPixel* pDepthEnd = pDepth + (getDepthFrame().getDataSize() / sizeof(openni::DepthPixel));
-
-	while (pDepth != pDepthEnd)
-	{
-		nValue = *pDepth;
-
-		XN_ASSERT(nValue <= g_nMaxDepth);
-
-		if (nValue != 0)
-		{
-			g_pDepthHist[nValue]++;
-			nNumberOfPoints++;
-		}
-
-		pDepth++;
-	}
-
-	int nIndex;
-	for (nIndex = 1; nIndex<g_nMaxDepth; nIndex++)
-	{
-		g_pDepthHist[nIndex] += g_pDepthHist[nIndex-1];
-	}
-	for (nIndex = 1; nIndex<g_nMaxDepth; nIndex++)
-	{
-		if (g_pDepthHist[nIndex] != 0)
-		{
-			g_pDepthHist[nIndex] = (nNumberOfPoints-g_pDepthHist[nIndex]) / nNumberOfPoints;
-		}
-	}
+	g_nMaxDepth = getDepthStream().getMaxPixelValue() + 1;
+	g_depthHist.calculate(getDepthFrame(), g_nMaxDepth);
 }
 
 // --------------------------------
@@ -989,11 +950,13 @@ void drawColor(IntRect* pLocation, IntPair* pPointer, int pointerRed, int pointe
 	int originX = colorMD.getCropOriginX();
 	int originY = colorMD.getCropOriginY();
 
-	uint8_t* pColor = (uint8_t*)colorMD.getData();
+	const uint8_t* pColorRow = (const uint8_t*)colorMD.getData();
+	int colorStride = colorMD.getStrideInBytes();
 	bool useDepth = false;
 	openni::PixelFormat format = colorMD.getVideoMode().getPixelFormat();
 
 	openni::DepthPixel* pDepth = NULL;
+	int depthRowSize = 0;
 
 	if (depthMetaData.isValid())
 	{
@@ -1006,18 +969,21 @@ void drawColor(IntRect* pLocation, IntPair* pPointer, int pointerRed, int pointe
 		depthOriginY = depthMetaData.getCropOriginY();
 
 		pDepth = (openni::DepthPixel*)depthMetaData.getData();
+		depthRowSize = depthMetaData.getStrideInBytes() / sizeof(openni::DepthPixel);
 	}
 
 	// create IR histogram
 	double grayscale16Factor = 1.0;
 	if (colorMD.getVideoMode().getPixelFormat() == openni::PIXEL_FORMAT_GRAY16)
 	{
-		int nPixelsCount = colorMD.getWidth() * colorMD.getHeight();
-		uint16_t* pPixel = (uint16_t*)colorMD.getData();
-		for (int i = 0; i < nPixelsCount; ++i,++pPixel)
+		for (int nY = 0; nY < height; ++nY)
 		{
-			if (*pPixel > g_nMaxGrayscale16Value)
-				g_nMaxGrayscale16Value = *pPixel;
+			const uint16_t* pPixel = (const uint16_t*)(pColorRow + nY*colorStride);
+			for (int nX = 0; nX < width; ++nX,++pPixel)
+			{
+				if (*pPixel > g_nMaxGrayscale16Value)
+					g_nMaxGrayscale16Value = *pPixel;
+			}
 		}
 
 		if (g_nMaxGrayscale16Value > 0)
@@ -1029,16 +995,15 @@ void drawColor(IntRect* pLocation, IntPair* pPointer, int pointerRed, int pointe
 	for (uint16_t nY = 0; nY < height; nY++)
 	{
 		uint8_t* pTexture = TextureMapGetLine(&g_texColor, nY + originY) + originX*4;
+		const uint8_t* pColor = pColorRow + nY*colorStride;
 
 		if (format == openni::PIXEL_FORMAT_YUV422)
  		{
 			YUV422ToRGB888(pColor, pTexture, width*2, g_texColor.Size.X*g_texColor.nBytesPerPixel);
- 			pColor += width*2;
  		}
 		else if (format == openni::PIXEL_FORMAT_YUYV)
 		{
 			YUYVToRGB888(pColor, pTexture, width*2, g_texColor.Size.X*g_texColor.nBytesPerPixel);
-			pColor += width*2;
 		}
  		else
 		{
@@ -1061,11 +1026,11 @@ void drawColor(IntRect* pLocation, IntPair* pPointer, int pointerRed, int pointe
 					}
 					else
 					{
-						nDepthIndex = nDepthY*depthWidth + nDepthX;
+						nDepthIndex = nDepthY*depthRowSize + nDepthX;
 					}
 				}
 
-				uint16_t* p16;
+				const uint16_t* p16;
 
 				switch (format)
  				{
@@ -1080,7 +1045,7 @@ void drawColor(IntRect* pLocation, IntPair* pPointer, int pointerRed, int pointe
  					pColor+=1;
  					break;
 				case openni::PIXEL_FORMAT_GRAY16:
-					p16 = (uint16_t*)pColor;
+					p16 = (const uint16_t*)pColor;
 					pTexture[0] = pTexture[1] = pTexture[2] = (uint8_t)((*p16) * grayscale16Factor);
  					pColor+=2;
  					break;
@@ -1129,8 +1094,9 @@ void drawDepth(IntRect* pLocation, IntPair* pPointer)
 			return;
 		}
 
-		const openni::DepthPixel* pDepth = (openni::DepthPixel*)pDepthMD->getData();
-		XN_ASSERT(pDepth);
+		const openni::DepthPixel* pDepthRow = (openni::DepthPixel*)pDepthMD->getData();
+		XN_ASSERT(pDepthRow);
+		int rowSize = pDepthMD->getStrideInBytes() / sizeof(openni::DepthPixel);
 
 		int width = pDepthMD->getWidth();
 		int height = pDepthMD->getHeight();
@@ -1142,105 +1108,113 @@ void drawDepth(IntRect* pLocation, IntPair* pPointer)
 			return;
 		}
 
-		// copy depth into texture-map
-		for (uint16_t nY = originY; nY < height + originY; nY++)
+		// histogram colorings are a single table lookup per pixel
+		if (g_DrawConfig.Streams.Depth.Coloring == LINEAR_HISTOGRAM || g_DrawConfig.Streams.Depth.Coloring == CYCLIC_RAINBOW_HISTOGRAM)
 		{
-			uint8_t* pTexture = TextureMapGetLine(&g_texDepth, nY) + originX*4;
-			for (uint16_t nX = 0; nX < width; nX++, pDepth++, pTexture+=4)
+			uint8_t nAlpha = g_DrawConfig.Streams.Depth.fTransparency*255;
+			if (g_DrawConfig.Streams.Depth.Coloring == LINEAR_HISTOGRAM)
 			{
-				uint8_t nRed = 0;
-				uint8_t nGreen = 0;
-				uint8_t nBlue = 0;
-				uint8_t nAlpha = g_DrawConfig.Streams.Depth.fTransparency*255;
-
-				uint16_t nColIndex;
+				g_depthColorMap.build(g_depthHist, 255, 255, 0, nAlpha);
+			}
+			else
+			{
+				g_depthColorMap.build(g_depthHist, PalletIntsR, PalletIntsG, PalletIntsB, nAlpha);
+			}
 
-				switch (g_DrawConfig.Streams.Depth.Coloring)
+			uint8_t* pTexture = TextureMapGetLine(&g_texDepth, originY) + originX*4;
+			g_depthColorMap.colorizeRGBA(*pDepthMD, pTexture, g_texDepth.Size.X*g_texDepth.nBytesPerPixel);
+		}
+		else
+		{
+			// copy depth into texture-map
+			for (uint16_t nY = originY; nY < height + originY; nY++)
+			{
+				uint8_t* pTexture = TextureMapGetLine(&g_texDepth, nY) + originX*4;
+				const openni::DepthPixel* pDepth = pDepthRow + (nY - originY)*rowSize;
+				for (uint16_t nX = 0; nX < width; nX++, pDepth++, pTexture+=4)
 				{
-				case LINEAR_HISTOGRAM:
-					nRed = nGreen = g_pDepthHist[*pDepth]*255;
-					break;
-				case PSYCHEDELIC_SHADES:
-					nAlpha *= (((float)(*pDepth % 10) / 20) + 0.5);
-					/* fallthrough */
-				case PSYCHEDELIC:
-
-					switch ((*pDepth/10) % 10)
+					uint8_t nRed = 0;
+					uint8_t nGreen = 0;
+					uint8_t nBlue = 0;
+					uint8_t nAlpha = g_DrawConfig.Streams.Depth.fTransparency*255;
+
+					uint16_t nColIndex;
+
+					switch (g_DrawConfig.Streams.Depth.Coloring)
 					{
-					case 0:
-						nRed = 255;
-						break;
-					case 1:
-						nGreen = 255;
-						break;
-					case 2:
-						nBlue = 255;
-						break;
-					case 3:
-						nRed = 255;
-						nGreen = 255;
-						break;
-					case 4:
-						nGreen = 255;
-						nBlue = 255;
-						break;
-					case 5:
-						nRed = 255;
-						nBlue = 255;
+					case PSYCHEDELIC_SHADES:
+						nAlpha *= (((float)(*pDepth % 10) / 20) + 0.5);
+						/* fallthrough */
+					case PSYCHEDELIC:
+
+						switch ((*pDepth/10) % 10)
+						{
+						case 0:
+							nRed = 255;
+							break;
+						case 1:
+							nGreen = 255;
+							break;
+						case 2:
+							nBlue = 255;
+							break;
+						case 3:
+							nRed = 255;
+							nGreen = 255;
+							break;
+						case 4:
+							nGreen = 255;
+							nBlue = 255;
+							break;
+						case 5:
+							nRed = 255;
+							nBlue = 255;
+							break;
+						case 6:
+							nRed = 255;
+							nGreen = 255;
+							nBlue = 255;
+							break;
+						case 7:
+							nRed = 127;
+							nBlue = 255;
+							break;
+						case 8:
+							nRed = 255;
+							nBlue = 127;
+							break;
+						case 9:
+							nRed = 127;
+							nGreen = 255;
+							break;
+						}
 						break;
-					case 6:
-						nRed = 255;
-						nGreen = 255;
-						nBlue = 255;
+					case RAINBOW:
+						nColIndex = (uint16_t)((*pDepth / (g_nMaxDepth / 256.)));
+						nRed   = PalletIntsR[nColIndex];
+						nGreen = PalletIntsG[nColIndex];
+						nBlue  = PalletIntsB[nColIndex];
 						break;
-					case 7:
-						nRed = 127;
-						nBlue = 255;
-						break;
-					case 8:
-						nRed = 255;
-						nBlue = 127;
-						break;
-					case 9:
-						nRed = 127;
-						nGreen = 255;
+					case CYCLIC_RAINBOW:
+						nColIndex = (*pDepth % 256);
+						nRed   = PalletIntsR[nColIndex];
+						nGreen = PalletIntsG[nColIndex];
+						nBlue  = PalletIntsB[nColIndex];
 						break;
+					default:
+						assert(0);
+						return;
 					}
-					break;
-				case RAINBOW:
-					nColIndex = (uint16_t)((*pDepth / (g_nMaxDepth / 256.)));
-					nRed   = PalletIntsR[nColIndex];
-					nGreen = PalletIntsG[nColIndex];
-					nBlue  = PalletIntsB[nColIndex];
-					break;
-				case CYCLIC_RAINBOW:
-					nColIndex = (*pDepth % 256);
-					nRed   = PalletIntsR[nColIndex];
-					nGreen = PalletIntsG[nColIndex];
-					nBlue  = PalletIntsB[nColIndex];
-					break;
-				case CYCLIC_RAINBOW_HISTOGRAM:
-				{
-					float fHist = g_pDepthHist[*pDepth];
-					nColIndex = (*pDepth % 256);
-					nRed   = PalletIntsR[nColIndex] * fHist;
-					nGreen = PalletIntsG[nColIndex] * fHist;
-					nBlue  = PalletIntsB[nColIndex] * fHist;
-					break;
-				}
-				default:
-					assert(0);
-					return;
-				}
 
-				pTexture[0] = nRed;
-				pTexture[1] = nGreen;
-				pTexture[2] = nBlue;
+					pTexture[0] = nRed;
+					pTexture[1] = nGreen;
+					pTexture[2] = nBlue;
 
-				if (*pDepth == 0)
-					pTexture[3] = 0;
-				else
-					pTexture[3] = nAlpha;
+					if (*pDepth == 0)
+						pTexture[3] = 0;
+					else
+						pTexture[3] = nAlpha;
+				}
 			}
 		}
 
@@ -1286,9 +1260,9 @@ void drawPointerMode(IntPair* pPointer)
 
 		// Print the scale data
 		glBegin(GL_POINTS);
-		for (int i = 0; i < g_nMaxDepth; i += 1)
+		for (int i = 0; i < g_depthHist.getSize(); i += 1)
 		{
-			float fNewColor = g_pDepthHist[i];
+			float fNewColor = g_depthHist.getIntensities()[i] / 256.0f;
 			if ((fNewColor > 0.004) && (fNewColor < 0.996))
 			{
 				glColor3f(fNewColor, fNewColor, 0);
@@ -1310,7 +1284,7 @@ void drawPointerMode(IntPair* pPointer)
 				pointerInDepth.Y < (int)pDepthMD->getHeight() &&
 				pointerInDepth.Y >= 0)
 			{
-				nPointerValue = ((openni::DepthPixel*)(pDepthMD->getData()))[pointerInDepth.Y*pDepthMD->getWidth()+pointerInDepth.X];
+				nPointerValue = ((openni::DepthPixel*)(pDepthMD->getData()))[pointerInDepth.Y*(pDepthMD->getStrideInBytes()/sizeof(openni::DepthPixel))+pointerInDepth.X];
 
 				glBegin(GL_POINTS);
 				glColor3f(1,0,0);
@@ -1808,7 +1782,7 @@ void drawFrame()
 
 			// try to translate depth pixel to image
 			openni::DepthPixel* pDepthPixels = (openni::DepthPixel*)pDepthMD->getData();
-			openni::DepthPixel pointerDepth = pDepthPixels[(pointerInDepth.Y - pDepthMD->getCropOriginY()) * pDepthMD->getWidth() + (pointerInDepth.X - pDepthMD->getCropOriginX())];
+			openni::DepthPixel pointerDepth = pDepthPixels[(pointerInDepth.Y - pDepthMD->getCropOriginY()) * (pDepthMD->getStrideInBytes()/sizeof(openni::DepthPixel)) + (pointerInDepth.X - pDepthMD->getCropOriginX())];
 			if (convertDepthPointToColor(pointerInDepth.X, pointerInDepth.Y, pointerDepth, &pointerInColor.X, &pointerInColor.Y))
 			{
 				bDrawImagePointer = true;
@@ -0,0 +1,864 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// OniBenchmark.cpp : Streams frames through OpenNI without any hardware or display, and reports throughput,
+// latency and CPU time of the polling, callback and frame-sync delivery paths.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+#include <algorithm>
+
+#include <OpenNI.h>
+#include <OniTest.h>
+#include <XnOS.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if (XN_PLATFORM != XN_PLATFORM_WIN32)
+	#include <time.h>
+#endif
+
+using namespace openni;
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_FRAMES 300
+#define DEFAULT_RESOLUTION_X 640
+#define DEFAULT_RESOLUTION_Y 480
+#define DEFAULT_FPS 30
+#define WAIT_TIMEOUT_MS 200
+#define MAX_STREAMS 2
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+enum DeliveryPath
+{
+	PATH_POLL,
+	PATH_CALLBACK,
+	PATH_SYNC,
+	PATH_COUNT,
+};
+
+typedef struct
+{
+	PixelFormat format;
+	const char* strName;
+	int nBytesPerPixel;
+} BenchmarkFormat;
+
+typedef struct
+{
+	const char* strFileName;
+	const char* strRecordPrefix;
+	SensorType sensorType;
+	const BenchmarkFormat* pFormat;
+	int nResX;
+	int nResY;
+	int nFPS;
+	float fSpeed;
+	uint32_t nFrames;
+	int nPath;
+} BenchmarkOptions;
+
+/* Measurements of a single run. Times are in microseconds. */
+class RunStatistics
+{
+public:
+	RunStatistics() : m_nFramesReceived(0), m_nBytes(0), m_nFramesIssued(0), m_nProduceWallTime(0), m_nProduceCPUTime(0),
+		m_nConsumeWallTime(0), m_nConsumeCPUTime(0), m_nChecksum(0), m_nLastFrameTime(0)
+	{
+		xnOSCreateCriticalSection(&m_hLock);
+	}
+
+	~RunStatistics()
+	{
+		xnOSCloseCriticalSection(&m_hLock);
+	}
+
+	void AddFrame(const VideoFrameRef& frame, bool bTimestampIsIssueTime, uint64_t nConsumeWallTime, uint64_t nConsumeCPUTime, uint64_t nChecksum);
+
+	std::vector<uint64_t> m_latencies;
+	uint32_t m_nFramesReceived;
+	uint64_t m_nBytes;
+	uint32_t m_nFramesIssued;
+	uint64_t m_nProduceWallTime;
+	uint64_t m_nProduceCPUTime;
+	uint64_t m_nConsumeWallTime;
+	uint64_t m_nConsumeCPUTime;
+	uint64_t m_nChecksum;
+	uint64_t m_nLastFrameTime;
+	XN_CRITICAL_SECTION_HANDLE m_hLock;
+};
+
+/* Issues frames to test device streams from a separate thread, like a device would. */
+typedef struct
+{
+	VideoStream* apStreams[MAX_STREAMS];
+	int nStreams;
+	std::vector<uint8_t> frameData[MAX_STREAMS];
+	uint32_t nFrames;
+	int nFPS;
+	RunStatistics* pStatistics;
+	volatile bool bDone;
+} Producer;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const char* g_pathNames[PATH_COUNT] = { "poll", "callback", "sync" };
+
+static const BenchmarkFormat g_formats[] =
+{
+	{ PIXEL_FORMAT_DEPTH_1_MM, "depth1mm", 2 },
+	{ PIXEL_FORMAT_DEPTH_100_UM, "depth100um", 2 },
+	{ PIXEL_FORMAT_GRAY8, "gray8", 1 },
+	{ PIXEL_FORMAT_GRAY16, "gray16", 2 },
+	{ PIXEL_FORMAT_RGB888, "rgb888", 3 },
+	{ PIXEL_FORMAT_YUV422, "yuv422", 2 },
+};
+
+//---------------------------------------------------------------------------
+// Time
+//---------------------------------------------------------------------------
+static uint64_t GetWallTime()
+{
+	uint64_t nNow;
+	xnOSGetHighResTimeStamp(&nNow);
+	return nNow;
+}
+
+#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+static uint64_t FileTimesToMicroseconds(const FILETIME& kernel, const FILETIME& user)
+{
+	ULARGE_INTEGER nKernel;
+	nKernel.LowPart = kernel.dwLowDateTime;
+	nKernel.HighPart = kernel.dwHighDateTime;
+	ULARGE_INTEGER nUser;
+	nUser.LowPart = user.dwLowDateTime;
+	nUser.HighPart = user.dwHighDateTime;
+	// FILETIME is in 100 nanoseconds units
+	return (nKernel.QuadPart + nUser.QuadPart) / 10;
+}
+#endif
+
+/* CPU time used by the calling thread. */
+static uint64_t GetThreadCPUTime()
+{
+#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+	FILETIME creation, exit, kernel, user;
+	GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+	return FileTimesToMicroseconds(kernel, user);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+/* CPU time used by all threads of the process (including the ones of OpenNI and its drivers). */
+static uint64_t GetProcessCPUTime()
+{
+#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	return FileTimesToMicroseconds(kernel, user);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+//---------------------------------------------------------------------------
+// Consuming
+//---------------------------------------------------------------------------
+void RunStatistics::AddFrame(const VideoFrameRef& frame, bool bTimestampIsIssueTime, uint64_t nConsumeWallTime, uint64_t nConsumeCPUTime, uint64_t nChecksum)
+{
+	uint64_t nNow = GetWallTime();
+
+	xnOSEnterCriticalSection(&m_hLock);
+
+	// test device frames carry the time they were issued at. Recorded frames carry the time they were
+	// recorded at, which says nothing about us, so the time between delivered frames is used instead.
+	if (bTimestampIsIssueTime)
+	{
+		m_latencies.push_back((nNow >= frame.getTimestamp()) ? nNow - frame.getTimestamp() : 0);
+	}
+	else if (m_nLastFrameTime != 0)
+	{
+		m_latencies.push_back(nNow - m_nLastFrameTime);
+	}
+	m_nLastFrameTime = nNow;
+
+	m_nFramesReceived++;
+	m_nBytes += frame.getDataSize();
+	m_nConsumeWallTime += nConsumeWallTime;
+	m_nConsumeCPUTime += nConsumeCPUTime;
+	m_nChecksum += nChecksum;
+
+	xnOSLeaveCriticalSection(&m_hLock);
+}
+
+/* Touches the frame the way an application would (once per cache line), so data is actually delivered. */
+static uint64_t TouchFrame(const VideoFrameRef& frame)
+{
+	const uint8_t* pData = (const uint8_t*)frame.getData();
+	uint64_t nChecksum = 0;
+	for (int i = 0; i < frame.getDataSize(); i += 64)
+	{
+		nChecksum += pData[i];
+	}
+	return nChecksum;
+}
+
+static Status ConsumeFrame(VideoStream& stream, bool bTimestampIsIssueTime, RunStatistics& statistics)
+{
+	uint64_t nWallStart = GetWallTime();
+	uint64_t nCPUStart = GetThreadCPUTime();
+
+	VideoFrameRef frame;
+	Status rc = stream.readFrame(&frame);
+	if (rc != STATUS_OK)
+	{
+		return rc;
+	}
+
+	uint64_t nChecksum = TouchFrame(frame);
+
+	statistics.AddFrame(frame, bTimestampIsIssueTime, GetWallTime() - nWallStart, GetThreadCPUTime() - nCPUStart, nChecksum);
+
+	return STATUS_OK;
+}
+
+class BenchmarkFrameListener final : public VideoStream::NewFrameListener
+{
+public:
+	BenchmarkFrameListener(bool bTimestampIsIssueTime, RunStatistics& statistics) :
+		m_bTimestampIsIssueTime(bTimestampIsIssueTime), m_statistics(statistics)
+	{}
+
+	void onNewFrame(VideoStream& stream) override
+	{
+		ConsumeFrame(stream, m_bTimestampIsIssueTime, m_statistics);
+	}
+
+private:
+	BenchmarkFrameListener& operator=(const BenchmarkFrameListener&);
+
+	bool m_bTimestampIsIssueTime;
+	RunStatistics& m_statistics;
+};
+
+//---------------------------------------------------------------------------
+// Producing
+//---------------------------------------------------------------------------
+static XN_THREAD_PROC ProducerThread(XN_THREAD_PARAM pThreadParam)
+{
+	Producer* pProducer = (Producer*)pThreadParam;
+	RunStatistics* pStatistics = pProducer->pStatistics;
+
+	uint64_t nStartTime = GetWallTime();
+
+	for (uint32_t nFrame = 0; nFrame < pProducer->nFrames; ++nFrame)
+	{
+		if (pProducer->nFPS > 0)
+		{
+			uint64_t nDueTime = nStartTime + (uint64_t)nFrame * 1000000 / pProducer->nFPS;
+			while (GetWallTime() < nDueTime)
+			{
+				xnOSSleep(1);
+			}
+		}
+
+		for (int i = 0; i < pProducer->nStreams; ++i)
+		{
+			uint64_t nWallStart = GetWallTime();
+			uint64_t nCPUStart = GetThreadCPUTime();
+
+			// this runs the driver and the whole OpenNI frame path (frame holder, recorders) on this thread
+			TestCommandIssueFrame command;
+			command.timestamp = nWallStart;
+			command.data = &pProducer->frameData[i][0];
+			Status rc = pProducer->apStreams[i]->invoke(TEST_COMMAND_ISSUE_FRAME, command);
+
+			uint64_t nWallTime = GetWallTime() - nWallStart;
+			uint64_t nCPUTime = GetThreadCPUTime() - nCPUStart;
+
+			if (rc == STATUS_OK)
+			{
+				xnOSEnterCriticalSection(&pStatistics->m_hLock);
+				pStatistics->m_nFramesIssued++;
+				pStatistics->m_nProduceWallTime += nWallTime;
+				pStatistics->m_nProduceCPUTime += nCPUTime;
+				xnOSLeaveCriticalSection(&pStatistics->m_hLock);
+			}
+		}
+	}
+
+	pProducer->bDone = true;
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+//---------------------------------------------------------------------------
+// Setup
+//---------------------------------------------------------------------------
+static Status CreateStream(Device& device, SensorType sensorType, const BenchmarkOptions& options, VideoStream& stream)
+{
+	Status rc = stream.create(device, sensorType);
+	if (rc != STATUS_OK)
+	{
+		printf("Couldn't create stream: %s\n", OpenNI::getExtendedError());
+		return rc;
+	}
+
+	if (options.strFileName == NULL)
+	{
+		VideoMode videoMode = stream.getVideoMode();
+		videoMode.setResolution(options.nResX, options.nResY);
+		videoMode.setFps(options.nFPS);
+		if (sensorType == options.sensorType)
+		{
+			videoMode.setPixelFormat(options.pFormat->format);
+		}
+
+		rc = stream.setVideoMode(videoMode);
+		if (rc != STATUS_OK)
+		{
+			printf("Couldn't set video mode: %s\n", OpenNI::getExtendedError());
+			return rc;
+		}
+	}
+
+	return STATUS_OK;
+}
+
+static int GetBytesPerPixel(PixelFormat format)
+{
+	for (uint32_t i = 0; i < sizeof(g_formats) / sizeof(g_formats[0]); ++i)
+	{
+		if (g_formats[i].format == format)
+		{
+			return g_formats[i].nBytesPerPixel;
+		}
+	}
+	return 0;
+}
+
+static void FillFrame(const VideoMode& videoMode, std::vector<uint8_t>& data)
+{
+	data.resize(videoMode.getResolutionX() * videoMode.getResolutionY() * GetBytesPerPixel(videoMode.getPixelFormat()));
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = (uint8_t)(i * 7 + i / 640);
+	}
+}
+
+//---------------------------------------------------------------------------
+// Reporting
+//---------------------------------------------------------------------------
+static uint64_t GetPercentile(const std::vector<uint64_t>& sorted, uint32_t nPercent)
+{
+	if (sorted.empty())
+	{
+		return 0;
+	}
+	return sorted[(sorted.size() - 1) * nPercent / 100];
+}
+
+static void PrintHeader(bool bTimestampIsIssueTime)
+{
+	printf("%-9s %7s %7s %9s %8s | %-8s %7s %7s %7s %8s | %-9s %9s %9s | %8s\n",
+		"path", "frames", "issued", "frames/s", "MB/s",
+		bTimestampIsIssueTime ? "latency" : "interval", "p50", "p90", "p99", "max",
+		"us/frame", "produce", "consume", "cpu %");
+}
+
+static void PrintResults(DeliveryPath path, const RunStatistics& statistics, uint64_t nWallTime, uint64_t nProcessCPUTime, VideoStream** apStreams, int nStreams)
+{
+	std::vector<uint64_t> sorted(statistics.m_latencies);
+	std::sort(sorted.begin(), sorted.end());
+
+	uint32_t nFrames = statistics.m_nFramesReceived;
+	double dSeconds = nWallTime / 1000000.0;
+
+	printf("%-9s %7u %7u %9.1f %8.1f | %-8s %7llu %7llu %7llu %8llu | %-9s %9.1f %9.1f | %8.1f\n",
+		g_pathNames[path], nFrames, statistics.m_nFramesIssued,
+		nFrames / dSeconds, statistics.m_nBytes / (1024.0 * 1024.0) / dSeconds,
+		"us", (unsigned long long)GetPercentile(sorted, 50), (unsigned long long)GetPercentile(sorted, 90),
+		(unsigned long long)GetPercentile(sorted, 99), (unsigned long long)(sorted.empty() ? 0 : sorted.back()),
+		"wall",
+		(statistics.m_nFramesIssued == 0) ? 0.0 : (double)statistics.m_nProduceWallTime / statistics.m_nFramesIssued,
+		(nFrames == 0) ? 0.0 : (double)statistics.m_nConsumeWallTime / nFrames,
+		100.0 * nProcessCPUTime / nWallTime);
+
+	printf("%-9s %7s %7s %9s %8s | %-8s %7s %7s %7s %8s | %-9s %9.1f %9.1f |\n",
+		"", "", "", "", "", "", "", "", "", "",
+		"cpu",
+		(statistics.m_nFramesIssued == 0) ? 0.0 : (double)statistics.m_nProduceCPUTime / statistics.m_nFramesIssued,
+		(nFrames == 0) ? 0.0 : (double)statistics.m_nConsumeCPUTime / nFrames);
+
+	for (int i = 0; i < nStreams; ++i)
+	{
+		OniStreamTelemetry telemetry;
+		if (apStreams[i]->getProperty(STREAM_PROPERTY_TELEMETRY, &telemetry) == STATUS_OK)
+		{
+			printf("%-9s stream %d: %llu received, %llu dropped unread, %llu read, %llu recorded, buffer pool %d/%d (peak %d)\n",
+				"", i,
+				(unsigned long long)telemetry.frameHolderFramesReceived,
+				(unsigned long long)telemetry.frameHolderFramesDropped,
+				(unsigned long long)telemetry.frameHolderFramesRead,
+				(unsigned long long)telemetry.recorderFramesRecorded,
+				telemetry.bufferPoolInUse, telemetry.bufferPoolSize, telemetry.bufferPoolPeakInUse);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// Running
+//---------------------------------------------------------------------------
+static Status RunPath(Device& device, DeliveryPath path, const BenchmarkOptions& options)
+{
+	bool bTestDevice = (options.strFileName == NULL);
+	Status rc = STATUS_OK;
+
+	if (!bTestDevice)
+	{
+		// frames are only played manually when waiting for them, which the callback path doesn't do
+		float fSpeed = (path == PATH_CALLBACK && options.fSpeed < 0) ? 0.0f : options.fSpeed;
+		device.getPlaybackControl()->setSpeed(fSpeed);
+	}
+
+	// create the streams
+	VideoStream streams[MAX_STREAMS];
+	VideoStream* apStreams[MAX_STREAMS];
+	int nStreams = 0;
+
+	if (path == PATH_SYNC)
+	{
+		// depth and color, latched together by OpenNI
+		rc = CreateStream(device, SENSOR_DEPTH, options, streams[0]);
+		if (rc != STATUS_OK) return rc;
+		rc = CreateStream(device, SENSOR_COLOR, options, streams[1]);
+		if (rc != STATUS_OK) return rc;
+		nStreams = 2;
+	}
+	else
+	{
+		rc = CreateStream(device, options.sensorType, options, streams[0]);
+		if (rc != STATUS_OK) return rc;
+		nStreams = 1;
+	}
+
+	for (int i = 0; i < nStreams; ++i)
+	{
+		apStreams[i] = &streams[i];
+	}
+
+	// optionally record
+	Recorder recorder;
+	if (options.strRecordPrefix != NULL)
+	{
+		char strRecordFile[XN_FILE_MAX_PATH];
+		sprintf(strRecordFile, "%s.%s.oni", options.strRecordPrefix, g_pathNames[path]);
+
+		rc = recorder.create(strRecordFile);
+		if (rc != STATUS_OK)
+		{
+			printf("Couldn't create recorder: %s\n", OpenNI::getExtendedError());
+			return rc;
+		}
+
+		for (int i = 0; i < nStreams; ++i)
+		{
+			recorder.attach(streams[i]);
+		}
+	}
+
+	RunStatistics statistics;
+	BenchmarkFrameListener listener(bTestDevice, statistics);
+
+	for (int i = 0; i < nStreams; ++i)
+	{
+		rc = streams[i].start();
+		if (rc != STATUS_OK)
+		{
+			printf("Couldn't start stream: %s\n", OpenNI::getExtendedError());
+			return rc;
+		}
+	}
+
+	if (path == PATH_SYNC)
+	{
+		rc = device.setDepthColorSyncEnabled(true);
+		if (rc != STATUS_OK)
+		{
+			printf("Couldn't enable frame sync: %s\n", OpenNI::getExtendedError());
+			return rc;
+		}
+	}
+
+	if (path == PATH_CALLBACK)
+	{
+		streams[0].addNewFrameListener(&listener);
+	}
+
+	if (recorder.isValid())
+	{
+		recorder.start();
+	}
+
+	uint64_t nStartTime = GetWallTime();
+	uint64_t nStartCPUTime = GetProcessCPUTime();
+
+	// start producing
+	Producer producer;
+	producer.bDone = false;
+	XN_THREAD_HANDLE hProducerThread = NULL;
+	if (bTestDevice)
+	{
+		producer.nStreams = nStreams;
+		for (int i = 0; i < nStreams; ++i)
+		{
+			producer.apStreams[i] = &streams[i];
+			FillFrame(streams[i].getVideoMode(), producer.frameData[i]);
+		}
+		producer.nFrames = options.nFrames;
+		producer.nFPS = options.nFPS;
+		producer.pStatistics = &statistics;
+
+		XnStatus nRetVal = xnOSCreateThread(ProducerThread, &producer, &hProducerThread);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			printf("Couldn't create producer thread: %s\n", xnGetStatusString(nRetVal));
+			return STATUS_ERROR;
+		}
+	}
+
+	// consume until all issued frames arrived (or were dropped), or enough frames were played back
+	uint32_t nExpectedFrames = options.nFrames * nStreams;
+	uint32_t nLastReceived = 0;
+	uint64_t nLastProgressTime = nStartTime;
+	for (;;)
+	{
+		xnOSEnterCriticalSection(&statistics.m_hLock);
+		uint32_t nReceived = statistics.m_nFramesReceived;
+		xnOSLeaveCriticalSection(&statistics.m_hLock);
+
+		if (nReceived >= nExpectedFrames)
+		{
+			break;
+		}
+
+		if (path == PATH_CALLBACK)
+		{
+			uint64_t nNow = GetWallTime();
+			if (nReceived != nLastReceived)
+			{
+				nLastReceived = nReceived;
+				nLastProgressTime = nNow;
+			}
+			else if ((!bTestDevice || producer.bDone) && nNow - nLastProgressTime > WAIT_TIMEOUT_MS * 1000)
+			{
+				// no more frames are coming
+				break;
+			}
+
+			xnOSSleep(1);
+			continue;
+		}
+
+		int nReadyIndex = -1;
+		rc = OpenNI::waitForAnyStream(apStreams, nStreams, &nReadyIndex, WAIT_TIMEOUT_MS);
+		if (rc == STATUS_TIME_OUT)
+		{
+			if (!bTestDevice || producer.bDone)
+			{
+				break;
+			}
+			continue;
+		}
+		else if (rc != STATUS_OK)
+		{
+			printf("Wait failed: %s\n", OpenNI::getExtendedError());
+			break;
+		}
+
+		ConsumeFrame(streams[nReadyIndex], bTestDevice, statistics);
+	}
+
+	uint64_t nWallTime = GetWallTime() - nStartTime;
+	uint64_t nProcessCPUTime = GetProcessCPUTime() - nStartCPUTime;
+
+	if (hProducerThread != NULL)
+	{
+		xnOSWaitAndTerminateThread(&hProducerThread, XN_WAIT_INFINITE);
+	}
+
+	PrintResults(path, statistics, nWallTime, nProcessCPUTime, apStreams, nStreams);
+
+	// tear down
+	if (path == PATH_CALLBACK)
+	{
+		streams[0].removeNewFrameListener(&listener);
+	}
+
+	if (path == PATH_SYNC)
+	{
+		device.setDepthColorSyncEnabled(false);
+	}
+
+	if (recorder.isValid())
+	{
+		recorder.stop();
+		recorder.destroy();
+	}
+
+	for (int i = 0; i < nStreams; ++i)
+	{
+		streams[i].stop();
+		streams[i].destroy();
+	}
+
+	return STATUS_OK;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+static void PrintUsage(const char* strProgram)
+{
+	printf("USAGE\n");
+	printf("\t%s [-file <fileName>] [-path poll|callback|sync] [-frames <count>] [-record <prefix>]\n", strProgram);
+	printf("\t\t[-sensor depth|color|ir] [-format <format>] [-res <x>x<y>] [-fps <fps>] [-speed <speed>]\n");
+	printf("OPTIONS\n");
+	printf("\t-file <fileName>\n");
+	printf("\t\tPlay back a recording instead of streaming from the test device.\n");
+	printf("\t-path <path>\n");
+	printf("\t\tBenchmark a single delivery path. By default, all paths are benchmarked (sync requires the test device).\n");
+	printf("\t-frames <count>\n");
+	printf("\t\tNumber of frames to stream in each run. Default is %u.\n", DEFAULT_FRAMES);
+	printf("\t-record <prefix>\n");
+	printf("\t\tAlso record the streams of each run, to <prefix>.<path>.oni.\n");
+	printf("\t-sensor <sensor>\n");
+	printf("\t\tSensor to stream from. Default is depth.\n");
+	printf("TEST DEVICE OPTIONS\n");
+	printf("\t-format <format>\n");
+	printf("\t\tPixel format of the benchmarked sensor: depth1mm, depth100um, gray8, gray16, rgb888 or yuv422.\n");
+	printf("\t-res <x>x<y>\n");
+	printf("\t\tResolution. Default is %dx%d.\n", DEFAULT_RESOLUTION_X, DEFAULT_RESOLUTION_Y);
+	printf("\t-fps <fps>\n");
+	printf("\t\tRate frames are issued at. 0 issues frames back to back (they may be replaced before they are read). Default is %d.\n", DEFAULT_FPS);
+	printf("RECORDING OPTIONS\n");
+	printf("\t-speed <speed>\n");
+	printf("\t\tPlayback speed. Default is -1 (each frame is played after the previous one was read), except for the\n");
+	printf("\t\tcallback path, which plays as fast as possible (0).\n");
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	options.strFileName = NULL;
+	options.strRecordPrefix = NULL;
+	options.sensorType = SENSOR_DEPTH;
+	options.pFormat = NULL;
+	options.nResX = DEFAULT_RESOLUTION_X;
+	options.nResY = DEFAULT_RESOLUTION_Y;
+	options.nFPS = DEFAULT_FPS;
+	options.fSpeed = -1.0f;
+	options.nFrames = DEFAULT_FRAMES;
+	options.nPath = -1;
+
+	int nArgIndex = 1;
+	while (nArgIndex < argc)
+	{
+		const char* strArg = argv[nArgIndex];
+		const char* strValue = (nArgIndex + 1 < argc) ? argv[nArgIndex + 1] : NULL;
+		nArgIndex += 2;
+
+		if (strValue != NULL && xnOSStrCaseCmp(strArg, "-file") == 0)
+		{
+			options.strFileName = strValue;
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-record") == 0)
+		{
+			options.strRecordPrefix = strValue;
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-frames") == 0)
+		{
+			options.nFrames = (uint32_t)atoi(strValue);
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-fps") == 0)
+		{
+			options.nFPS = atoi(strValue);
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-speed") == 0)
+		{
+			options.fSpeed = (float)atof(strValue);
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-res") == 0)
+		{
+			if (sscanf(strValue, "%dx%d", &options.nResX, &options.nResY) != 2 || options.nResX <= 0 || options.nResY <= 0)
+			{
+				printf("Bad resolution: %s\n", strValue);
+				return -1;
+			}
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-path") == 0)
+		{
+			for (options.nPath = 0; options.nPath < PATH_COUNT; ++options.nPath)
+			{
+				if (xnOSStrCaseCmp(strValue, g_pathNames[options.nPath]) == 0)
+				{
+					break;
+				}
+			}
+			if (options.nPath == PATH_COUNT)
+			{
+				printf("Unknown path: %s\n", strValue);
+				return -1;
+			}
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-sensor") == 0)
+		{
+			if (xnOSStrCaseCmp(strValue, "depth") == 0)
+			{
+				options.sensorType = SENSOR_DEPTH;
+			}
+			else if (xnOSStrCaseCmp(strValue, "color") == 0)
+			{
+				options.sensorType = SENSOR_COLOR;
+			}
+			else if (xnOSStrCaseCmp(strValue, "ir") == 0)
+			{
+				options.sensorType = SENSOR_IR;
+			}
+			else
+			{
+				printf("Unknown sensor: %s\n", strValue);
+				return -1;
+			}
+		}
+		else if (strValue != NULL && xnOSStrCaseCmp(strArg, "-format") == 0)
+		{
+			for (uint32_t i = 0; i < sizeof(g_formats) / sizeof(g_formats[0]); ++i)
+			{
+				if (xnOSStrCaseCmp(strValue, g_formats[i].strName) == 0)
+				{
+					options.pFormat = &g_formats[i];
+				}
+			}
+			if (options.pFormat == NULL)
+			{
+				printf("Unknown format: %s\n", strValue);
+				return -1;
+			}
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return (xnOSStrCaseCmp(strArg, "-help") == 0) ? 0 : -1;
+		}
+	}
+
+	if (options.pFormat == NULL)
+	{
+		// the test device defaults
+		PixelFormat format = (options.sensorType == SENSOR_DEPTH) ? PIXEL_FORMAT_DEPTH_1_MM :
+			(options.sensorType == SENSOR_COLOR) ? PIXEL_FORMAT_RGB888 : PIXEL_FORMAT_GRAY16;
+		for (uint32_t i = 0; i < sizeof(g_formats) / sizeof(g_formats[0]); ++i)
+		{
+			if (g_formats[i].format == format)
+			{
+				options.pFormat = &g_formats[i];
+			}
+		}
+	}
+
+	bool bDepthFormat = (options.pFormat->format == PIXEL_FORMAT_DEPTH_1_MM || options.pFormat->format == PIXEL_FORMAT_DEPTH_100_UM);
+	if (bDepthFormat != (options.sensorType == SENSOR_DEPTH))
+	{
+		printf("Format %s can't be used with this sensor.\n", options.pFormat->strName);
+		return -1;
+	}
+
+	Status rc = OpenNI::initialize();
+	if (rc != STATUS_OK)
+	{
+		printf("Initialize failed: %s\n", OpenNI::getExtendedError());
+		return -1;
+	}
+
+	Device device;
+	rc = device.open((options.strFileName != NULL) ? options.strFileName : TEST_DEVICE_NAME);
+	if (rc != STATUS_OK)
+	{
+		printf("Couldn't open device: %s\n", OpenNI::getExtendedError());
+		OpenNI::shutdown();
+		return -1;
+	}
+
+	if (options.strFileName != NULL)
+	{
+		device.getPlaybackControl()->setRepeatEnabled(true);
+		printf("Playing %s, %u frames per run, speed %.1f\n", options.strFileName, options.nFrames, options.fSpeed);
+	}
+	else
+	{
+		printf("Test device, %u frames per run, %dx%d %s at %d fps\n",
+			options.nFrames, options.nResX, options.nResY, options.pFormat->strName, options.nFPS);
+	}
+
+	PrintHeader(options.strFileName == NULL);
+
+	int nResult = 0;
+	for (int i = 0; i < PATH_COUNT; ++i)
+	{
+		if (options.nPath >= 0 && i != options.nPath)
+		{
+			continue;
+		}
+
+		if (i == PATH_SYNC && options.strFileName != NULL)
+		{
+			if (options.nPath == PATH_SYNC)
+			{
+				printf("Frame sync is not supported for recordings.\n");
+				nResult = -1;
+			}
+			continue;
+		}
+
+		if (RunPath(device, DeliveryPath(i), options) != STATUS_OK)
+		{
+			nResult = -1;
+		}
+	}
+
+	device.close();
+	OpenNI::shutdown();
+
+	return nResult;
+}
@@ -122,7 +122,8 @@ typedef	struct XnMutex* XN_MUTEX_HANDLE;
 // Critical Sections
 //---------------------------------------------------------------------------
 /** A Xiron critical sections type. */
-typedef	XN_MUTEX_HANDLE XN_CRITICAL_SECTION_HANDLE;
+struct XnCriticalSection;
+typedef	struct XnCriticalSection* XN_CRITICAL_SECTION_HANDLE;
 
 //---------------------------------------------------------------------------
 // Events
@@ -0,0 +1,315 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _XN_BENCHMARK_H_
+#define _XN_BENCHMARK_H_
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <XnPlatform.h>
+#include <XnOS.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_BENCHMARK_MAX_OPTIONS	8
+#define XN_BENCHMARK_MAX_KERNELS	4
+
+namespace xnl
+{
+
+/**
+* What the benchmarks have in common: the command line and its usage text, running the checks and the
+* measurements once for each kernel set the CPU supports (scalar first), timing each run, and reporting
+* the results in the same format.
+*/
+class Benchmark
+{
+public:
+	/* Selects kernel set nKernels, 0 being the scalar one. */
+	typedef void (*SelectKernelsFunc)(uint32_t nKernels);
+	typedef void (*SetVectorizedFunc)(bool bVectorized);
+	typedef bool (*IsVectorizedFunc)();
+
+	Benchmark() :
+		m_nOptions(0),
+		m_nExitCode(0),
+		m_pSelectKernels(NULL),
+		m_pSetVectorized(NULL),
+		m_nKernels(1),
+		m_nSelectedKernels(0),
+		m_nResult(0)
+	{
+		m_astrKernelNames[0] = "Scalar";
+		ResetTimes();
+	}
+
+	/* Adds a "-<name> <count>" option. The default value, shown in the usage text, is the one in *pnValue. */
+	void AddOption(const char* strName, const char* strDescription, uint32_t* pnValue)
+	{
+		Option* pOption = NewOption(strName, "count", strDescription);
+		pOption->pnValue = pnValue;
+	}
+
+	/* Adds a "-<name> <strArgument>" option, which has no default. */
+	void AddOption(const char* strName, const char* strArgument, const char* strDescription, const char** pstrValue)
+	{
+		Option* pOption = NewOption(strName, strArgument, strDescription);
+		pOption->pstrValue = pstrValue;
+	}
+
+	/* Parses the command line. Returns false when the benchmark should exit with GetExitCode() (after -help, or
+	   on a bad argument). */
+	bool ParseCommandLine(int argc, char* argv[])
+	{
+		int nArgIndex = 1;
+		while (nArgIndex < argc)
+		{
+			const Option* pOption = FindOption(argv[nArgIndex]);
+			if (pOption == NULL || nArgIndex + 1 >= argc)
+			{
+				PrintUsage(argv[0]);
+				m_nExitCode = (xnOSStrCaseCmp(argv[nArgIndex], "-help") == 0) ? 0 : -1;
+				return false;
+			}
+
+			++nArgIndex;
+			if (pOption->pnValue != NULL)
+			{
+				*pOption->pnValue = (uint32_t)atoi(argv[nArgIndex++]);
+			}
+			else
+			{
+				*pOption->pstrValue = argv[nArgIndex++];
+			}
+		}
+
+		return true;
+	}
+
+	int GetExitCode() const { return m_nExitCode; }
+
+	/* Sets the kernel sets the CPU supports: astrNames[0] is the scalar one, and nSupported the best one. Prints
+	   the best one. */
+	void SetKernels(SelectKernelsFunc pSelectKernels, const char* const* astrNames, uint32_t nSupported)
+	{
+		m_pSelectKernels = pSelectKernels;
+		m_pSetVectorized = NULL;
+		m_nKernels = XN_MIN(nSupported + 1, (uint32_t)XN_BENCHMARK_MAX_KERNELS);
+		for (uint32_t i = 0; i < m_nKernels; ++i)
+		{
+			m_astrKernelNames[i] = astrNames[i];
+		}
+		PrintKernels();
+	}
+
+	/* Same, for kernels that are either scalar or vectorized. */
+	void SetKernels(SetVectorizedFunc pSetVectorized, IsVectorizedFunc pIsVectorized, const char* strVectorizedName)
+	{
+		m_pSelectKernels = NULL;
+		m_pSetVectorized = pSetVectorized;
+		m_pSetVectorized(true);
+		m_nKernels = pIsVectorized() ? 2 : 1;
+		m_astrKernelNames[1] = strVectorizedName;
+		PrintKernels();
+	}
+
+	/* Number of kernel sets to run with, the scalar one included. */
+	uint32_t GetKernelPasses() const { return m_nKernels; }
+
+	/* Pass 0 selects the scalar kernels. */
+	void SelectKernels(uint32_t nPass)
+	{
+		m_nSelectedKernels = XN_MIN(nPass, m_nKernels - 1);
+		if (m_pSelectKernels != NULL)
+		{
+			m_pSelectKernels(m_nSelectedKernels);
+		}
+		else if (m_pSetVectorized != NULL)
+		{
+			m_pSetVectorized(m_nSelectedKernels != 0);
+		}
+	}
+
+	const char* GetKernelName() const { return m_astrKernelNames[m_nSelectedKernels]; }
+
+	/* Prints a failed check (a single line). The benchmark then exits with -1 (see GetResult()). */
+	void Fail(const char* strFormat, ...)
+	{
+		va_list args;
+		va_start(args, strFormat);
+		vprintf(strFormat, args);
+		va_end(args);
+		printf("\n");
+		m_nResult = -1;
+	}
+
+	int GetResult() const { return m_nResult; }
+
+	/* Only the time between StartRun() and EndRun() is measured. */
+	void ResetTimes()
+	{
+		m_nRuns = 0;
+		m_nTotal = 0;
+		m_nWorst = 0;
+		m_nRunStart = 0;
+	}
+
+	void StartRun()
+	{
+		xnOSGetHighResTimeStamp(&m_nRunStart);
+	}
+
+	void EndRun()
+	{
+		uint64_t nEnd;
+		xnOSGetHighResTimeStamp(&nEnd);
+		m_nTotal += nEnd - m_nRunStart;
+		m_nWorst = XN_MAX(m_nWorst, nEnd - m_nRunStart);
+		++m_nRuns;
+	}
+
+	/* The reports print the runs measured since ResetTimes(). The kernels name defaults to the selected ones, and
+	   names whatever is being compared when there are no kernels. */
+
+	/* Also prints the share of the frame time a run takes at nFPS. */
+	void ReportFrameTime(const char* strCase, uint32_t nFPS, const char* strKernels = NULL) const
+	{
+		double dAverage = GetAverage();
+		PrintRuns(strCase, strKernels);
+		printf(" %9.1f%% of frame time\n", dAverage * nFPS / 10000.0);
+	}
+
+	/* Also prints the throughput, for nBytes processed in each run. */
+	void ReportThroughput(const char* strCase, uint64_t nBytes, const char* strKernels = NULL) const
+	{
+		double dAverage = GetAverage();
+		PrintRuns(strCase, strKernels);
+		printf(" %9.1f MB/s\n", (dAverage > 0) ? nBytes / dAverage * 1000000.0 / (1024 * 1024) : 0.0);
+	}
+
+	/* Also prints the time of a single operation, for nOperations done in each run. */
+	void ReportOperationTime(const char* strCase, uint64_t nOperations, const char* strKernels = NULL) const
+	{
+		double dAverage = GetAverage();
+		PrintRuns(strCase, strKernels);
+		printf(" %9.1f ns/op\n", (nOperations > 0) ? dAverage * 1000.0 / nOperations : 0.0);
+	}
+
+private:
+	typedef struct
+	{
+		const char* strName;
+		const char* strArgument;
+		const char* strDescription;
+		uint32_t* pnValue;
+		const char** pstrValue;
+	} Option;
+
+	Option* NewOption(const char* strName, const char* strArgument, const char* strDescription)
+	{
+		XN_ASSERT(m_nOptions < XN_BENCHMARK_MAX_OPTIONS);
+		Option* pOption = &m_aOptions[m_nOptions++];
+		pOption->strName = strName;
+		pOption->strArgument = strArgument;
+		pOption->strDescription = strDescription;
+		pOption->pnValue = NULL;
+		pOption->pstrValue = NULL;
+		return pOption;
+	}
+
+	const Option* FindOption(const char* strArg) const
+	{
+		if (strArg[0] != '-')
+		{
+			return NULL;
+		}
+
+		for (uint32_t i = 0; i < m_nOptions; ++i)
+		{
+			if (xnOSStrCaseCmp(strArg + 1, m_aOptions[i].strName) == 0)
+			{
+				return &m_aOptions[i];
+			}
+		}
+
+		return NULL;
+	}
+
+	void PrintUsage(const char* strProgram) const
+	{
+		printf("USAGE\n");
+		printf("\t%s", strProgram);
+		for (uint32_t i = 0; i < m_nOptions; ++i)
+		{
+			printf(" [-%s <%s>]", m_aOptions[i].strName, m_aOptions[i].strArgument);
+		}
+		printf("\n");
+
+		printf("OPTIONS\n");
+		for (uint32_t i = 0; i < m_nOptions; ++i)
+		{
+			printf("\t-%s <%s>\n", m_aOptions[i].strName, m_aOptions[i].strArgument);
+			printf("\t\t%s", m_aOptions[i].strDescription);
+			if (m_aOptions[i].pnValue != NULL)
+			{
+				printf(" Default is %u.", *m_aOptions[i].pnValue);
+			}
+			printf("\n");
+		}
+	}
+
+	void PrintKernels() const
+	{
+		printf("Vectorized kernels: %s\n", (m_nKernels > 1) ? m_astrKernelNames[m_nKernels - 1] : "not supported");
+	}
+
+	double GetAverage() const { return (m_nRuns == 0) ? 0.0 : (double)m_nTotal / m_nRuns; }
+
+	void PrintRuns(const char* strCase, const char* strKernels) const
+	{
+		printf("%-32s %-8s %9.1f us avg %8llu us worst",
+			strCase, (strKernels != NULL) ? strKernels : GetKernelName(), GetAverage(), (unsigned long long)m_nWorst);
+	}
+
+	Option m_aOptions[XN_BENCHMARK_MAX_OPTIONS];
+	uint32_t m_nOptions;
+	int m_nExitCode;
+
+	SelectKernelsFunc m_pSelectKernels;
+	SetVectorizedFunc m_pSetVectorized;
+	const char* m_astrKernelNames[XN_BENCHMARK_MAX_KERNELS];
+	uint32_t m_nKernels;
+	uint32_t m_nSelectedKernels;
+	int m_nResult;
+
+	uint32_t m_nRuns;
+	uint64_t m_nTotal;
+	uint64_t m_nWorst;
+	uint64_t m_nRunStart;
+};
+
+}
+
+#endif // _XN_BENCHMARK_H_
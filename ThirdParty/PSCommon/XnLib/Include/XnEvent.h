@@ -22,7 +22,8 @@
 #define _XN_EVENT_H_
 
 #include <algorithm>
-#include <list>
+#include <atomic>
+#include <vector>
 
 #include "XnOSCpp.h"
 
@@ -38,6 +39,14 @@ struct CallbackT
 	void* pCookie;
 };
 
+/**
+ * Base of all events. The registered callbacks are kept in an immutable snapshot which is replaced
+ * (copy-on-write) whenever a callback is registered or unregistered, so raising an event takes no lock
+ * and allocates nothing. Modifications are serialized by a lock and may be done from inside a callback;
+ * a raise in progress keeps calling the callbacks of the snapshot it started with.
+ *
+ * Snapshots and callbacks that were replaced are only freed once no raise is in progress.
+ */
 template <typename FuncPtr>
 class EventInterface
 {
@@ -49,7 +58,6 @@ public:
 	~EventInterface()
 	{
 		Clear();
-		xnOSCloseCriticalSection(&m_hLock);
 		xnOSCloseCriticalSection(&m_hModLock);
 	}
 	XnStatus Register(FuncPtr pFunc, void* pCookie, XnCallbackHandle& handle)
@@ -58,10 +66,13 @@ public:
 
 		Callback* pCallback = NULL;
 		pCallback = XN_NEW(Callback, pFunc, pCookie);
+		XN_VALIDATE_ALLOC_PTR(pCallback);
 
 		{
 			AutoCSLocker locker(m_hModLock);
-			m_toAdd.push_back(pCallback);
+			CallbackList* pNewList = CopyCallbacks(NULL);
+			pNewList->push_back(pCallback);
+			Publish(pNewList);
 		}
 
 		handle = (XnCallbackHandle)pCallback;
@@ -73,14 +84,21 @@ public:
 
 		{
 			AutoCSLocker locker(m_hModLock);
-			if (!RemoveCallback(m_toAdd, pCallback))
+			const CallbackList* pList = m_pCallbacks.load(std::memory_order_relaxed);
+			if (pList == NULL || std::find(pList->begin(), pList->end(), pCallback) == pList->end())
 			{
-				m_toRemove.push_back(pCallback);
+				// already unregistered
+				return XN_STATUS_OK;
 			}
+
+			m_retiredCallbacks.push_back(pCallback);
+			Publish(CopyCallbacks(pCallback));
 		}
 		return XN_STATUS_OK;
 	}
 protected:
+	typedef std::vector<Callback*> CallbackList;
+
 	EventInterface()
 	{
 		Init();
@@ -92,94 +110,143 @@ protected:
 	}
 	EventInterface& operator=(const EventInterface& other)
 	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
 		Clear();
-		AutoCSLocker otherLocker(other.m_hLock);
 		AutoCSLocker otherModLocker(other.m_hModLock);
-		AutoCSLocker locker(m_hLock);
 		AutoCSLocker modLocker(m_hModLock);
 
-		m_callbacks = other.m_callbacks;
-		m_toAdd = other.m_toAdd;
-		m_toRemove = other.m_toRemove;
-
-		ApplyListChanges();
+		// each event owns its callbacks, so copy them
+		CallbackList* pNewList = XN_NEW(CallbackList);
+		const CallbackList* pOtherList = other.m_pCallbacks.load(std::memory_order_relaxed);
+		if (pOtherList != NULL)
+		{
+			for (typename CallbackList::const_iterator it = pOtherList->begin(); it != pOtherList->end(); ++it)
+			{
+				pNewList->push_back(XN_NEW(Callback, (*it)->pFunc, (*it)->pCookie));
+			}
+		}
+		Publish(pNewList);
 
 		return *this;
 	}
 	XnStatus Clear()
 	{
-		AutoCSLocker locker(m_hLock);
 		AutoCSLocker modLocker(m_hModLock);
 
-		ApplyListChanges();
-
-		for (typename std::list<Callback*>::const_iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
+		const CallbackList* pList = m_pCallbacks.load(std::memory_order_relaxed);
+		if (pList != NULL)
 		{
-			Callback* pCallback = *it;
-			XN_DELETE(pCallback);
+			m_retiredCallbacks.insert(m_retiredCallbacks.end(), pList->begin(), pList->end());
 		}
-
-		m_callbacks.clear();
-		m_toRemove.clear();
-		m_toAdd.clear();
+		Publish(NULL);
 
 		return XN_STATUS_OK;
 	}
 
-	XnStatus ApplyListChanges()
+	/** Starts a raise. Returns the callbacks to call (may be NULL). Must be followed by EndRaise(). **/
+	const CallbackList* BeginRaise()
 	{
-		AutoCSLocker locker(m_hLock);
-		AutoCSLocker modLocker(m_hModLock);
+		// The counter must be visible before the list is read, see ReclaimRetired()
+		m_nActiveRaises.fetch_add(1, std::memory_order_seq_cst);
+		return m_pCallbacks.load(std::memory_order_seq_cst);
+	}
 
-		for (typename std::list<Callback*>::const_iterator it = m_toAdd.begin(); it != m_toAdd.end(); ++it)
+	void EndRaise()
+	{
+		if (m_nActiveRaises.fetch_sub(1, std::memory_order_seq_cst) == 1 && m_bHasRetired.load(std::memory_order_relaxed))
 		{
-			m_callbacks.push_back(*it);
+			// last raise to finish, and the list was modified while raising
+			AutoCSLocker modLocker(m_hModLock);
+			ReclaimRetired();
 		}
-		m_toAdd.clear();
+	}
 
-		for (typename std::list<Callback*>::const_iterator it = m_toRemove.begin(); it != m_toRemove.end(); ++it)
+private:
+	/** Returns a modifiable copy of the current callbacks, without pExclude. Must be called under m_hModLock. **/
+	CallbackList* CopyCallbacks(Callback* pExclude)
+	{
+		CallbackList* pNewList = XN_NEW(CallbackList);
+		const CallbackList* pList = m_pCallbacks.load(std::memory_order_relaxed);
+		if (pList != NULL)
 		{
-			Callback* pCallback = *it;
-			RemoveCallback(m_callbacks, pCallback);
+			pNewList->reserve(pList->size() + 1);
+			for (typename CallbackList::const_iterator it = pList->begin(); it != pList->end(); ++it)
+			{
+				if (*it != pExclude)
+				{
+					pNewList->push_back(*it);
+				}
+			}
 		}
-		m_toRemove.clear();
-
-		return XN_STATUS_OK;
+		return pNewList;
 	}
 
-	bool RemoveCallback(std::list<Callback*>& list, Callback* pCallback)
+	/** Replaces the current callbacks with pNewList. Must be called under m_hModLock. **/
+	void Publish(const CallbackList* pNewList)
 	{
-		typename std::list<Callback*>::iterator it = std::find(list.begin(), list.end(), pCallback);
-		if (it != list.end())
+		const CallbackList* pOldList = m_pCallbacks.exchange(pNewList, std::memory_order_seq_cst);
+		if (pOldList != NULL)
 		{
-			list.erase(it);
-			XN_DELETE(pCallback);
-			return true;
+			m_retiredLists.push_back(pOldList);
 		}
-		return false;
+		ReclaimRetired();
 	}
-	XN_CRITICAL_SECTION_HANDLE m_hLock;
-	std::list<Callback*> m_callbacks;
-	std::list<Callback*> m_toAdd;
-	std::list<Callback*> m_toRemove;
-private:
-	XN_CRITICAL_SECTION_HANDLE m_hModLock;
-	void Init()
+
+	/** Frees replaced lists and callbacks if no raise can still see them. Must be called under m_hModLock. **/
+	void ReclaimRetired()
 	{
-		m_hLock = NULL;
-		XnStatus retVal = xnOSCreateCriticalSection(&m_hLock);
-		if (retVal != XN_STATUS_OK)
+		if (m_retiredLists.empty() && m_retiredCallbacks.empty())
 		{
-			//XN_ASSERT(false);
+			m_bHasRetired.store(false, std::memory_order_relaxed);
+			return;
+		}
+
+		// Everything was retired before this check. A raise that starts after it will read the new list.
+		if (m_nActiveRaises.load(std::memory_order_seq_cst) != 0)
+		{
+			m_bHasRetired.store(true, std::memory_order_relaxed);
+			return;
 		}
 
+		for (typename std::vector<const CallbackList*>::const_iterator it = m_retiredLists.begin(); it != m_retiredLists.end(); ++it)
+		{
+			XN_DELETE(*it);
+		}
+		m_retiredLists.clear();
+
+		for (typename CallbackList::const_iterator it = m_retiredCallbacks.begin(); it != m_retiredCallbacks.end(); ++it)
+		{
+			XN_DELETE(*it);
+		}
+		m_retiredCallbacks.clear();
+
+		m_bHasRetired.store(false, std::memory_order_relaxed);
+	}
+
+	void Init()
+	{
+		m_pCallbacks.store(NULL, std::memory_order_relaxed);
+		m_nActiveRaises.store(0, std::memory_order_relaxed);
+		m_bHasRetired.store(false, std::memory_order_relaxed);
+
 		m_hModLock = NULL;
-		retVal = xnOSCreateCriticalSection(&m_hModLock);
+		XnStatus retVal = xnOSCreateCriticalSection(&m_hModLock);
 		if (retVal != XN_STATUS_OK)
 		{
 			//XN_ASSERT(false);
 		}
 	}
+
+	std::atomic<const CallbackList*> m_pCallbacks;
+	std::atomic<uint32_t> m_nActiveRaises;
+	std::atomic<bool> m_bHasRetired;
+	XN_CRITICAL_SECTION_HANDLE m_hModLock;
+	std::vector<const CallbackList*> m_retiredLists;
+	CallbackList m_retiredCallbacks;
 };
 
 struct HandlerFuncNoArgs
@@ -226,19 +293,21 @@ public:
 
 class EventNoArgs : public EventBase<HandlerFuncNoArgs::FuncPtr>
 {
+	typedef EventBase<HandlerFuncNoArgs::FuncPtr> Base;
 public:
 	XnStatus Raise()
 	{
-		AutoCSLocker locker(this->m_hLock);
-		ApplyListChanges();
-
-		for (std::list<Callback*>::const_iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
+		const Base::CallbackList* pCallbacks = this->BeginRaise();
+		if (pCallbacks != NULL)
 		{
-			Callback* pCallback = *it;
-			pCallback->pFunc(pCallback->pCookie);
+			for (Base::CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
+			{
+				Base::Callback* pCallback = *it;
+				pCallback->pFunc(pCallback->pCookie);
+			}
 		}
+		this->EndRaise();
 
-		ApplyListChanges();
 		return XN_STATUS_OK;
 	}
 };
@@ -250,16 +319,17 @@ class Event1Arg : public EventBase<typename HandlerFunc1Arg<Arg1>::FuncPtr>
 public:
 	XnStatus Raise(Arg1 arg)
 	{
-		AutoCSLocker locker(this->m_hLock);
-		this->ApplyListChanges();
-
-		for (typename std::list<typename Base::Callback*>::const_iterator it = this->m_callbacks.begin(); it != this->m_callbacks.end(); ++it)
+		const typename Base::CallbackList* pCallbacks = this->BeginRaise();
+		if (pCallbacks != NULL)
 		{
-			typename Base::Callback* pCallback = *it;
-			pCallback->pFunc(arg, pCallback->pCookie);
+			for (typename Base::CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
+			{
+				typename Base::Callback* pCallback = *it;
+				pCallback->pFunc(arg, pCallback->pCookie);
+			}
 		}
+		this->EndRaise();
 
-		this->ApplyListChanges();
 		return XN_STATUS_OK;
 	}
 };
@@ -275,16 +345,17 @@ class Event2Args : public EventBase<typename HandlerFunc2Args<Arg1, Arg2>::FuncP
 public:
 	XnStatus Raise(Arg1 arg1, Arg2 arg2)
 	{
-		AutoCSLocker locker(this->m_hLock);
-		this->ApplyListChanges();
-
-		for (typename std::list<typename Base::Callback*>::const_iterator it = this->m_callbacks.begin(); it != this->m_callbacks.end(); ++it)
+		const typename Base::CallbackList* pCallbacks = this->BeginRaise();
+		if (pCallbacks != NULL)
 		{
-			typename Base::Callback* pCallback = *it;
-			pCallback->pFunc(arg1, arg2, pCallback->pCookie);
+			for (typename Base::CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
+			{
+				typename Base::Callback* pCallback = *it;
+				pCallback->pFunc(arg1, arg2, pCallback->pCookie);
+			}
 		}
+		this->EndRaise();
 
-		this->ApplyListChanges();
 		return XN_STATUS_OK;
 	}
 };
@@ -296,16 +367,17 @@ class Event3Args : public EventBase<typename HandlerFunc3Args<Arg1, Arg2, Arg3>:
 public:
 	XnStatus Raise(Arg1 arg1, Arg2 arg2, Arg3 arg3)
 	{
-		AutoCSLocker locker(this->m_hLock);
-		this->ApplyListChanges();
-
-		for (typename std::list<typename Base::Callback*>::const_iterator it = this->m_callbacks.begin(); it != this->m_callbacks.end(); ++it)
+		const typename Base::CallbackList* pCallbacks = this->BeginRaise();
+		if (pCallbacks != NULL)
 		{
-			typename Base::Callback* pCallback = *it;
-			pCallback->pFunc(arg1, arg2, arg3, pCallback->pCookie);
+			for (typename Base::CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
+			{
+				typename Base::Callback* pCallback = *it;
+				pCallback->pFunc(arg1, arg2, arg3, pCallback->pCookie);
+			}
 		}
+		this->EndRaise();
 
-		this->ApplyListChanges();
 		return XN_STATUS_OK;
 	}
 };
@@ -317,16 +389,17 @@ class Event4Args : public EventBase<typename HandlerFunc4Args<Arg1, Arg2, Arg3,
 public:
 	XnStatus Raise(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
 	{
-		AutoCSLocker locker(this->m_hLock);
-		this->ApplyListChanges();
-
-		for (typename std::list<typename Base::Callback*>::const_iterator it = this->m_callbacks.begin(); it != this->m_callbacks.end(); ++it)
+		const typename Base::CallbackList* pCallbacks = this->BeginRaise();
+		if (pCallbacks != NULL)
 		{
-			typename Base::Callback* pCallback = *it;
-			pCallback->pFunc(arg1, arg2, arg3, arg4, pCallback->pCookie);
+			for (typename Base::CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
+			{
+				typename Base::Callback* pCallback = *it;
+				pCallback->pFunc(arg1, arg2, arg3, arg4, pCallback->pCookie);
+			}
 		}
+		this->EndRaise();
 
-		this->ApplyListChanges();
 		return XN_STATUS_OK;
 	}
 };
@@ -338,16 +411,17 @@ class Event5Args : public EventBase<typename HandlerFunc5Args<Arg1, Arg2, Arg3,
 public:
 	XnStatus Raise(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
 	{
-		AutoCSLocker locker(this->m_hLock);
-		this->ApplyListChanges();
-
-		for (typename std::list<typename Base::Callback*>::const_iterator it = this->m_callbacks.begin(); it != this->m_callbacks.end(); ++it)
+		const typename Base::CallbackList* pCallbacks = this->BeginRaise();
+		if (pCallbacks != NULL)
 		{
-			typename Base::Callback* pCallback = *it;
-			pCallback->pFunc(arg1, arg2, arg3, arg4, arg5, pCallback->pCookie);
+			for (typename Base::CallbackList::const_iterator it = pCallbacks->begin(); it != pCallbacks->end(); ++it)
+			{
+				typename Base::Callback* pCallback = *it;
+				pCallback->pFunc(arg1, arg2, arg3, arg4, arg5, pCallback->pCookie);
+			}
 		}
+		this->EndRaise();
 
-		this->ApplyListChanges();
 		return XN_STATUS_OK;
 	}
 };
@@ -57,4 +57,21 @@ XnStatus XnStreamInitUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncomp
 XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, const uint8_t* pInput, const uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnOutputSize);
 XnStatus XnStreamFreeUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext);
 
+/**
+* Sets decoding options. Fast DCT (JDCT_IFAST) and disabling fancy upsampling trade a little quality for speed.
+* When nDecodeThreads is more than 1, XnStreamUncompressImageJ() splits images that have restart markers into strips
+* of MCU rows, and decodes them in parallel (one strip on the calling thread). Other images are decoded serially.
+* The output is the same as a serial decode.
+*/
+XnStatus XnStreamSetUncompressImageJOptions(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, bool bFastDCT, bool bFancyUpsampling, uint32_t nDecodeThreads);
+
+/**
+* Incremental decompression, for data that arrives in chunks. The input is read from a single buffer that
+* grows as data arrives: every call receives the buffer start and the number of bytes received so far.
+* Decoded scanlines are written to the output buffer as soon as their data is available.
+*/
+XnStatus XnStreamStartUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, uint8_t* pOutput, const uint32_t nOutputSize);
+XnStatus XnStreamContinueUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, const uint8_t* pInput, const uint32_t nInputSize);
+XnStatus XnStreamFinishUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, const uint8_t* pInput, const uint32_t nInputSize, uint32_t* pnOutputSize);
+
 #endif // _XN_JPEG_H_
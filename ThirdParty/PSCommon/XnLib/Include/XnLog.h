@@ -107,6 +107,27 @@ XN_C_API XnStatus XN_C_DECL xnLogSetConsoleOutput(bool bConsoleOutput);
 */
 XN_C_API XnStatus XN_C_DECL xnLogSetFileOutput(bool bFileOutput);
 
+/**
+* Configures if log entries are handed to the writers by a background thread (the default), or by
+* the thread that writes them. In asynchronous mode, entries are formatted by the background thread, and
+* entries written faster than the writers can handle are dropped (and counted).
+*
+* @param	bAsynchronous	[in]	true to write entries from a background thread, false otherwise.
+*/
+XN_C_API XnStatus XN_C_DECL xnLogSetAsynchronous(bool bAsynchronous);
+
+/**
+* Hands all entries queued so far to the writers. Returns once they were written.
+*/
+XN_C_API XnStatus XN_C_DECL xnLogFlush();
+
+/**
+* Gets the number of entries dropped so far because the queue of the writing thread was full.
+*
+* @param	pnDropped	[out]	The number of dropped entries.
+*/
+XN_C_API XnStatus XN_C_DECL xnLogGetDroppedEntriesCount(uint64_t* pnDropped);
+
 // @}
 
 /**
@@ -522,6 +522,63 @@ XN_C_API XnStatus XN_C_DECL xnOSGetCurrentThreadID(XN_THREAD_ID* pThreadID);
 XN_C_API XnStatus XN_C_DECL xnOSWaitAndTerminateThread(XN_THREAD_HANDLE* pThreadHandle, uint32_t nMilliseconds);
 XN_C_API bool XN_C_DECL xnOSDoesThreadExistByID(XN_THREAD_ID threadId);
 
+// Thread placement
+typedef enum XnThreadSchedPolicy
+{
+	/** Keep the current scheduling policy. */
+	XN_THREAD_SCHED_DEFAULT,
+	/** Regular time sharing. */
+	XN_THREAD_SCHED_NORMAL,
+	/** Real-time, taking turns with threads of the same priority. */
+	XN_THREAD_SCHED_RR,
+	/** Real-time, runs until it blocks or a higher priority thread is ready. */
+	XN_THREAD_SCHED_FIFO
+} XnThreadSchedPolicy;
+
+/** Number of 64-bit words in a CPU affinity mask (supports up to 256 CPUs). */
+#define XN_THREAD_AFFINITY_WORDS	4
+
+/** Placement of a class of threads (see xnOSApplyThreadPolicy()). */
+typedef struct XnThreadPolicy
+{
+	/** CPUs the threads may run on. Bit N of word N/64 stands for CPU N. All zeros keeps the current affinity. */
+	uint64_t anAffinity[XN_THREAD_AFFINITY_WORDS];
+	XnThreadSchedPolicy nSchedPolicy;
+	/** Priority for the real-time policies (1 to 99 on Linux). */
+	int32_t nSchedPriority;
+} XnThreadPolicy;
+
+/** Thread classes used by OpenNI and its drivers. Threads are named after their class unless given a more specific name. */
+#define XN_THREAD_CLASS_USB_READ		"USBRead"
+#define XN_THREAD_CLASS_USB_EVENTS		"USBEvents"
+#define XN_THREAD_CLASS_DECODE			"Decode"
+#define XN_THREAD_CLASS_NEW_FRAME		"NewFrame"
+#define XN_THREAD_CLASS_RECORDER		"Recorder"
+#define XN_THREAD_CLASS_PLAYER			"Player"
+#define XN_THREAD_CLASS_SERVICE			"Service"
+
+/** Sets the name of a thread, as shown by top, perf and debuggers. Linux keeps the first 15 characters. */
+XN_C_API XnStatus XN_C_DECL xnOSSetThreadName(XN_THREAD_HANDLE ThreadHandle, const char* strName);
+/** Restricts a thread to the CPUs in anAffinity (XN_THREAD_AFFINITY_WORDS words). */
+XN_C_API XnStatus XN_C_DECL xnOSSetThreadAffinity(XN_THREAD_HANDLE ThreadHandle, const uint64_t* anAffinity);
+/** Sets the scheduling policy of a thread. nPriority is only used by the real-time policies. */
+XN_C_API XnStatus XN_C_DECL xnOSSetThreadScheduling(XN_THREAD_HANDLE ThreadHandle, XnThreadSchedPolicy nPolicy, int32_t nPriority);
+
+/** Sets the placement of a class of threads. Applies to threads started from now on. */
+XN_C_API XnStatus XN_C_DECL xnOSSetThreadClassPolicy(const char* strClass, const XnThreadPolicy* pPolicy);
+/** Gets the placement of a class of threads. Returns XN_STATUS_NO_MATCH if none was set. */
+XN_C_API XnStatus XN_C_DECL xnOSGetThreadClassPolicy(const char* strClass, XnThreadPolicy* pPolicy);
+/**
+ * Reads the placement of the known thread classes from an INI file. The placement of class X is read
+ * from section "<csSection>.X", using the keys:
+ *   CPUs=<list>       CPUs the threads may run on, for example 0-3,8
+ *   Policy=<name>     Normal, RR or FIFO
+ *   Priority=<n>      Real-time priority
+ */
+XN_C_API XnStatus XN_C_DECL xnOSLoadThreadPoliciesFromINI(const char* csINIFile, const char* csSection);
+/** Names a thread (strName, or the class name if NULL) and applies the placement of its class, if any. */
+XN_C_API XnStatus XN_C_DECL xnOSApplyThreadPolicy(XN_THREAD_HANDLE ThreadHandle, const char* strClass, const char* strName);
+
 // Processes
 XN_C_API XnStatus XN_C_DECL xnOSGetCurrentProcessID(XN_PROCESS_ID* pProcID);
 XN_C_API XnStatus XN_C_DECL xnOSCreateProcess(const char* strExecutable, uint32_t nArgs, const char** pstrArgs, XN_PROCESS_ID* pProcID);
@@ -609,6 +666,25 @@ XN_C_API XnStatus XN_C_DECL xnOSCloseSharedMemory(XN_SHARED_MEMORY_HANDLE hShare
  */
 XN_C_API XnStatus XN_C_DECL xnOSSharedMemoryGetAddress(XN_SHARED_MEMORY_HANDLE hSharedMem, void** ppAddress);
 
+/**
+ * Waits while a 32-bit word holds a value, or until xnOSWakeSharedAddress() is called on it. The word may be
+ * in a shared memory block, and be waited on and woken from different processes. The wait may also end
+ * spuriously, so callers should check their condition again when it returns.
+ *
+ * @param	pAddress		[in]	The address of the word.
+ * @param	nValue			[in]	Don't wait if the word no longer holds this value.
+ * @param	nMilliseconds	[in]	A timeout in milliseconds to wait. Returns XN_STATUS_OS_EVENT_TIMEOUT when it expires.
+ */
+XN_C_API XnStatus XN_C_DECL xnOSWaitSharedAddress(volatile int32_t* pAddress, int32_t nValue, uint32_t nMilliseconds);
+
+/**
+ * Wakes all the threads (of all processes) waiting on a word with xnOSWaitSharedAddress(). Callers should
+ * change the word before waking.
+ *
+ * @param	pAddress		[in]	The address of the word.
+ */
+XN_C_API void XN_C_DECL xnOSWakeSharedAddress(volatile int32_t* pAddress);
+
 // Keyboard
 XN_C_API bool XN_C_DECL xnOSWasKeyboardHit();
 XN_C_API char XN_C_DECL xnOSReadCharFromInput();
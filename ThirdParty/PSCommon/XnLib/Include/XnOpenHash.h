@@ -0,0 +1,483 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _XN_OPEN_HASH_H_
+#define _XN_OPEN_HASH_H_
+
+#include <new>
+
+#include "XnMemory.h"
+#include "XnHash.h"
+
+namespace xnl
+{
+
+/**
+* Key manager of an OpenHash. Unlike the one of a Hash, its hash code should use all 32 bits (the table
+* spreads them, so they don't have to be well mixed).
+*/
+template <class TKey>
+class OpenHashKeyManager : public DefaultKeyManager<TKey>
+{
+public:
+	static uint32_t Hash(const TKey& key)
+	{
+		uint64_t nKey = (uint64_t)(size_t)key;
+		return (uint32_t)(nKey ^ (nKey >> 32));
+	}
+};
+
+/**
+* A hash table with the interface of Hash, stored in two flat arrays using open addressing with linear
+* probing: a byte per slot holding 7 bits of the key's hash (or marking the slot as empty or deleted),
+* and the key-value pairs themselves. Most lookups touch a single control byte and a single pair, and
+* inserts don't allocate until the table grows.
+*
+* Removing an entry doesn't move the others, so iterators to them stay valid. Adding an entry may grow
+* the table, which invalidates all iterators and pointers to values.
+*/
+template <class TKey, class TValue, class KeyManager = OpenHashKeyManager<TKey> >
+class OpenHash
+{
+public:
+	typedef KeyValuePair<TKey, TValue> TPair;
+
+	class ConstIterator
+	{
+	public:
+		ConstIterator() : m_pHash(NULL), m_nSlot(0) {}
+		ConstIterator(const OpenHash* pHash, uint32_t nSlot) : m_pHash(pHash), m_nSlot(nSlot) {}
+		ConstIterator(const ConstIterator& other) : m_pHash(other.m_pHash), m_nSlot(other.m_nSlot) {}
+
+		ConstIterator& operator=(const ConstIterator& other) = default;
+
+		ConstIterator& operator++()
+		{
+			XN_ASSERT(m_nSlot < m_pHash->m_nCapacity);
+			m_nSlot = m_pHash->NextFullSlot(m_nSlot + 1);
+			return *this;
+		}
+		ConstIterator operator++(int32_t)
+		{
+			ConstIterator retVal(*this);
+			++*this;
+			return retVal;
+		}
+
+		inline bool operator==(const ConstIterator& other) const
+		{
+			return m_nSlot == other.m_nSlot && m_pHash == other.m_pHash;
+		}
+		inline bool operator!=(const ConstIterator& other) const
+		{
+			return !operator==(other);
+		}
+
+		inline const TPair& operator*() const
+		{
+			return m_pHash->m_pSlots[m_nSlot];
+		}
+		inline const TPair* operator->() const
+		{
+			return &m_pHash->m_pSlots[m_nSlot];
+		}
+	protected:
+		friend class OpenHash;
+
+		const OpenHash* m_pHash;
+		uint32_t m_nSlot;
+	};
+
+	class Iterator : public ConstIterator
+	{
+	public:
+		Iterator() : ConstIterator() {}
+		Iterator(OpenHash* pHash, uint32_t nSlot) : ConstIterator(pHash, nSlot) {}
+		Iterator(const Iterator& other) : ConstIterator(other) {}
+
+		Iterator& operator++()
+		{
+			++(*(ConstIterator*)this);
+			return *this;
+		}
+		Iterator operator++(int32_t)
+		{
+			Iterator retVal(*this);
+			++*this;
+			return retVal;
+		}
+		inline TPair& operator*() const
+		{
+			return const_cast<TPair&>(ConstIterator::operator*());
+		}
+		inline TPair* operator->() const
+		{
+			return const_cast<TPair*>(ConstIterator::operator->());
+		}
+		Iterator& operator=(const Iterator& other) = default;
+	};
+
+	OpenHash() : m_pControl(NULL), m_pSlots(NULL), m_nCapacity(0), m_nSize(0), m_nDeleted(0) {}
+	OpenHash(const OpenHash& other) : m_pControl(NULL), m_pSlots(NULL), m_nCapacity(0), m_nSize(0), m_nDeleted(0)
+	{
+		*this = other;
+	}
+
+	OpenHash& operator=(const OpenHash& other)
+	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
+		Clear();
+
+		XnStatus retVal = XN_STATUS_OK;
+		for (ConstIterator it = other.Begin(); it != other.End(); ++it)
+		{
+			retVal = Set(it->Key(), it->Value());
+			XN_ASSERT(retVal == XN_STATUS_OK);
+			XN_REFERENCE_VARIABLE(retVal);
+		}
+		return *this;
+	}
+
+	~OpenHash()
+	{
+		Clear();
+		xnOSFree(m_pControl);
+		xnOSFree(m_pSlots);
+	}
+
+	Iterator Begin()
+	{
+		return Iterator(this, NextFullSlot(0));
+	}
+	ConstIterator Begin() const
+	{
+		return ConstIterator(this, NextFullSlot(0));
+	}
+	Iterator End()
+	{
+		return Iterator(this, m_nCapacity);
+	}
+	ConstIterator End() const
+	{
+		return ConstIterator(this, m_nCapacity);
+	}
+
+	XnStatus Set(const TKey& key, const TValue& value)
+	{
+		uint32_t nSlot = FindSlot(key);
+		if (nSlot != m_nCapacity)
+		{
+			// Replace
+			m_pSlots[nSlot].Value() = value;
+			return XN_STATUS_OK;
+		}
+
+		return Insert(key, value, nSlot);
+	}
+
+	ConstIterator Find(const TKey& key) const
+	{
+		return ConstIterator(this, FindSlot(key));
+	}
+	Iterator Find(const TKey& key)
+	{
+		return Iterator(this, FindSlot(key));
+	}
+	XnStatus Find(const TKey& key, ConstIterator& it) const
+	{
+		it = Find(key);
+		return it == End() ? XN_STATUS_NO_MATCH : XN_STATUS_OK;
+	}
+	XnStatus Find(const TKey& key, Iterator& it)
+	{
+		it = Find(key);
+		return it == End() ? XN_STATUS_NO_MATCH : XN_STATUS_OK;
+	}
+
+	XnStatus Get(const TKey& key, TValue& value) const
+	{
+		uint32_t nSlot = FindSlot(key);
+		if (nSlot == m_nCapacity)
+		{
+			return XN_STATUS_NO_MATCH;
+		}
+
+		value = m_pSlots[nSlot].Value();
+		return XN_STATUS_OK;
+	}
+	XnStatus Get(const TKey& key, const TValue*& pValue) const
+	{
+		uint32_t nSlot = FindSlot(key);
+		if (nSlot == m_nCapacity)
+		{
+			return XN_STATUS_NO_MATCH;
+		}
+
+		pValue = &m_pSlots[nSlot].Value();
+		return XN_STATUS_OK;
+	}
+	XnStatus Get(const TKey& key, TValue*& pValue)
+	{
+		uint32_t nSlot = FindSlot(key);
+		if (nSlot == m_nCapacity)
+		{
+			return XN_STATUS_NO_MATCH;
+		}
+
+		pValue = &m_pSlots[nSlot].Value();
+		return XN_STATUS_OK;
+	}
+
+	TValue& operator[](const TKey& key)
+	{
+		uint32_t nSlot = FindSlot(key);
+		if (nSlot == m_nCapacity)
+		{
+			XnStatus retVal = Insert(key, TValue(), nSlot);
+			XN_ASSERT(retVal == XN_STATUS_OK);
+			XN_REFERENCE_VARIABLE(retVal);
+		}
+		return m_pSlots[nSlot].Value();
+	}
+
+	XnStatus Remove(ConstIterator it)
+	{
+		if (it == End())
+		{
+			XN_ASSERT(false);
+			return XN_STATUS_ILLEGAL_POSITION;
+		}
+
+		XN_ASSERT(it.m_pHash == this);
+		XN_ASSERT(IsFull(m_pControl[it.m_nSlot]));
+
+		uint32_t nSlot = it.m_nSlot;
+		m_pSlots[nSlot].~TPair();
+		--m_nSize;
+
+		if (m_nSize == 0)
+		{
+			// nothing left to probe past
+			xnOSMemSet(m_pControl, CONTROL_EMPTY, m_nCapacity);
+			m_nDeleted = 0;
+		}
+		else if (m_pControl[(nSlot + 1) & (m_nCapacity - 1)] == CONTROL_EMPTY)
+		{
+			// no probe sequence goes on past this slot, so it can be reused as if it was never taken
+			m_pControl[nSlot] = CONTROL_EMPTY;
+		}
+		else
+		{
+			m_pControl[nSlot] = CONTROL_DELETED;
+			++m_nDeleted;
+		}
+
+		return XN_STATUS_OK;
+	}
+
+	XnStatus Remove(const TKey& key)
+	{
+		ConstIterator it = Find(key);
+		if (it == End())
+		{
+			return XN_STATUS_NO_MATCH;
+		}
+
+		return Remove(it);
+	}
+
+	XnStatus Clear()
+	{
+		for (uint32_t i = 0; i < m_nCapacity; ++i)
+		{
+			if (IsFull(m_pControl[i]))
+			{
+				m_pSlots[i].~TPair();
+			}
+		}
+
+		if (m_nCapacity != 0)
+		{
+			xnOSMemSet(m_pControl, CONTROL_EMPTY, m_nCapacity);
+		}
+		m_nSize = 0;
+		m_nDeleted = 0;
+
+		return XN_STATUS_OK;
+	}
+
+	bool IsEmpty() const
+	{
+		return (m_nSize == 0);
+	}
+
+	uint32_t Size() const
+	{
+		return m_nSize;
+	}
+
+private:
+	enum
+	{
+		CONTROL_EMPTY = 0x80,
+		CONTROL_DELETED = 0xFE,
+		MIN_CAPACITY = 8,
+	};
+
+	static inline bool IsFull(uint8_t nControl)
+	{
+		return (nControl & 0x80) == 0;
+	}
+
+	static inline uint32_t HashOf(const TKey& key)
+	{
+		// spread the hash over all bits, as key managers may return small integers or aligned pointers
+		uint32_t nHash = (uint32_t)KeyManager::Hash(key) * 0x9E3779B1;
+		return nHash ^ (nHash >> 15);
+	}
+
+	uint32_t NextFullSlot(uint32_t nSlot) const
+	{
+		while (nSlot < m_nCapacity && !IsFull(m_pControl[nSlot]))
+		{
+			++nSlot;
+		}
+		return nSlot;
+	}
+
+	/* Returns the slot of the key, or m_nCapacity if it isn't in the table. */
+	uint32_t FindSlot(const TKey& key) const
+	{
+		if (m_nSize == 0)
+		{
+			return m_nCapacity;
+		}
+
+		uint32_t nHash = HashOf(key);
+		uint8_t nTag = (uint8_t)(nHash & 0x7F);
+		uint32_t nMask = m_nCapacity - 1;
+
+		// there is always an empty slot, which ends the probe sequence
+		for (uint32_t nSlot = (nHash >> 7) & nMask; ; nSlot = (nSlot + 1) & nMask)
+		{
+			uint8_t nControl = m_pControl[nSlot];
+			if (nControl == nTag && KeyManager::Compare(m_pSlots[nSlot].Key(), key) == 0)
+			{
+				return nSlot;
+			}
+			if (nControl == CONTROL_EMPTY)
+			{
+				return m_nCapacity;
+			}
+		}
+	}
+
+	/* Returns the first empty or deleted slot in the probe sequence of a hash. */
+	static uint32_t FindFreeSlot(const uint8_t* pControl, uint32_t nCapacity, uint32_t nHash)
+	{
+		uint32_t nMask = nCapacity - 1;
+		uint32_t nSlot = (nHash >> 7) & nMask;
+		while (IsFull(pControl[nSlot]))
+		{
+			nSlot = (nSlot + 1) & nMask;
+		}
+		return nSlot;
+	}
+
+	/* Adds a key that isn't in the table. */
+	XnStatus Insert(const TKey& key, const TValue& value, uint32_t& nSlot)
+	{
+		// keep at least 1/8 of the slots empty, so probe sequences stay short
+		if ((m_nSize + m_nDeleted + 1) * 8 > m_nCapacity * 7)
+		{
+			uint32_t nCapacity = (m_nCapacity < MIN_CAPACITY) ? (uint32_t)MIN_CAPACITY : m_nCapacity;
+			while ((m_nSize + 1) * 16 > nCapacity * 7)
+			{
+				nCapacity *= 2;
+			}
+
+			// same capacity means most taken slots were deleted ones, and are cleaned up
+			XnStatus nRetVal = Rehash(nCapacity);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+
+		uint32_t nHash = HashOf(key);
+		nSlot = FindFreeSlot(m_pControl, m_nCapacity, nHash);
+		if (m_pControl[nSlot] == CONTROL_DELETED)
+		{
+			--m_nDeleted;
+		}
+
+		new (&m_pSlots[nSlot]) TPair(key, value);
+		m_pControl[nSlot] = (uint8_t)(nHash & 0x7F);
+		++m_nSize;
+
+		return XN_STATUS_OK;
+	}
+
+	XnStatus Rehash(uint32_t nCapacity)
+	{
+		uint8_t* pControl = (uint8_t*)xnOSMalloc(nCapacity);
+		TPair* pSlots = (TPair*)xnOSMalloc(nCapacity * sizeof(TPair));
+		if (pControl == NULL || pSlots == NULL)
+		{
+			xnOSFree(pControl);
+			xnOSFree(pSlots);
+			return XN_STATUS_ALLOC_FAILED;
+		}
+
+		xnOSMemSet(pControl, CONTROL_EMPTY, nCapacity);
+
+		for (uint32_t i = 0; i < m_nCapacity; ++i)
+		{
+			if (IsFull(m_pControl[i]))
+			{
+				uint32_t nHash = HashOf(m_pSlots[i].Key());
+				uint32_t nSlot = FindFreeSlot(pControl, nCapacity, nHash);
+				new (&pSlots[nSlot]) TPair(m_pSlots[i]);
+				pControl[nSlot] = (uint8_t)(nHash & 0x7F);
+				m_pSlots[i].~TPair();
+			}
+		}
+
+		xnOSFree(m_pControl);
+		xnOSFree(m_pSlots);
+		m_pControl = pControl;
+		m_pSlots = pSlots;
+		m_nCapacity = nCapacity;
+		m_nDeleted = 0;
+
+		return XN_STATUS_OK;
+	}
+
+	uint8_t* m_pControl;
+	TPair* m_pSlots;
+	uint32_t m_nCapacity;
+	uint32_t m_nSize;
+	uint32_t m_nDeleted;
+};
+
+} // xnl
+
+#endif // _XN_OPEN_HASH_H_
@@ -30,12 +30,31 @@
 // Defines
 //---------------------------------------------------------------------------
 #define INVALID_PROFILING_HANDLE	-1
+#define XN_PROFILING_MAX_SECTION_NAME	256
 
 //---------------------------------------------------------------------------
 // Types
 //---------------------------------------------------------------------------
 typedef int32_t XnProfilingHandle;
 
+/** Statistics of a profiled section, accumulated over all threads since profiling was initialized. Times are in microseconds. */
+typedef struct XnProfilingSectionStatistics
+{
+	char strName[XN_PROFILING_MAX_SECTION_NAME];
+	/** Nesting depth of the section when it first executed. */
+	uint32_t nIndentation;
+	/** Number of threads that executed the section. */
+	uint32_t nThreads;
+	uint64_t nTimesExecuted;
+	uint64_t nTotalTime;
+	uint64_t nMinTime;
+	uint64_t nMaxTime;
+	/** Percentiles, taken from a histogram (accurate to about 25%, but never above nMaxTime). */
+	uint64_t nMedianTime;
+	uint64_t nP90Time;
+	uint64_t nP99Time;
+} XnProfilingSectionStatistics;
+
 //---------------------------------------------------------------------------
 // Exported Function Declaration
 //---------------------------------------------------------------------------
@@ -49,7 +68,8 @@ typedef int32_t XnProfilingHandle;
 XN_C_API XnStatus XN_C_DECL xnProfilingInit(uint32_t nProfilingInterval = 0);
 
 /**
- * Initializes using INI file.
+ * Initializes using INI file. Reads the ProfilingInterval key, and the optional ProfilingFile key
+ * (see @ref xnProfilingDumpToFile, the file is rewritten every interval).
  *
  * @param	cpINIFileName	[in]	Name of INI file.
  * @param	cpSectionName	[in]	Name of section in INI file.
@@ -71,7 +91,7 @@ XN_C_API bool XN_C_DECL xnProfilingIsActive();
  * XN_PROFILING_START_SECTION macro.
  *
  * @param	csSectionName	[in]		The name of the profiled section.
- * @param	bMT				[in]		true if this section is multi-threaded, false otherwise.
+ * @param	bMT				[in]		Ignored. Sections are always measured separately in each thread.
  * @param	pHandle			[out]		A handle to be used each time this section executes again.
  */
 XN_C_API XnStatus XN_C_DECL xnProfilingSectionStart(const char* csSectionName, bool bMT, XnProfilingHandle* pHandle);
@@ -84,13 +104,28 @@ XN_C_API XnStatus XN_C_DECL xnProfilingSectionStart(const char* csSectionName, b
  */
 XN_C_API XnStatus XN_C_DECL xnProfilingSectionEnd(XnProfilingHandle* pHandle);
 
+/**
+ * Gets the statistics of all profiled sections.
+ *
+ * @param	aStatistics		[in]		An array to be filled.
+ * @param	pnCount			[in/out]	In: the size of the array. Out: the number of sections filled.
+ */
+XN_C_API XnStatus XN_C_DECL xnProfilingGetStatistics(XnProfilingSectionStatistics* aStatistics, uint32_t* pnCount);
+
+/**
+ * Writes the statistics of all profiled sections, including their full histograms, to a JSON file.
+ *
+ * @param	strFileName		[in]		Name of the file.
+ */
+XN_C_API XnStatus XN_C_DECL xnProfilingDumpToFile(const char* strFileName);
+
 
 /**
  * Starts a profiled section. The code section between this declaration
  * and the following XN_PROFILING_END_SECTION declaration will be time-measured.
  *
  * @param	name		[in]	The name of the section (for printing purposes).
- * @param	mt			[in]	true if this section is multi-threaded, false otherwise.
+ * @param	mt			[in]	Ignored (sections are measured per thread).
  */
 #define _XN_PROFILING_START_SECTION(name, mt)									\
 	{																			\
@@ -25,6 +25,7 @@
 // Includes
 //---------------------------------------------------------------------------
 #include "XnHash.h"
+#include "XnOpenHash.h"
 
 namespace xnl
 {
@@ -71,6 +72,42 @@ public:
 	}
 };
 
+class XnStringsOpenHashKeyManager : public XnStringsHashKeyManager
+{
+public:
+	static uint32_t Hash(const char* const& key)
+	{
+		// FNV-1a
+		uint32_t nHash = 2166136261u;
+		for (const char* pChar = key; *pChar != '\0'; ++pChar)
+		{
+			nHash = (nHash ^ (uint8_t)*pChar) * 16777619u;
+		}
+		return nHash;
+	}
+};
+
+template<class TValue>
+class XnStringsOpenHashT : public xnl::OpenHash<const char*, TValue, XnStringsOpenHashKeyManager>
+{
+	typedef xnl::OpenHash<const char*, TValue, XnStringsOpenHashKeyManager> Base;
+
+public:
+	XnStringsOpenHashT() : Base() {}
+
+	XnStringsOpenHashT(const XnStringsOpenHashT& other) : Base()
+	{
+		*this = other;
+	}
+
+	XnStringsOpenHashT& operator=(const XnStringsOpenHashT& other)
+	{
+		Base::operator=(other);
+		// no other members
+		return *this;
+	}
+};
+
 }  // namespace xnl
 
 #endif // _XN_STRINGS_HASH_H_
@@ -22,26 +22,188 @@
 // Includes
 //---------------------------------------------------------------------------
 #include <XnOS.h>
+#include <errno.h>
+#include <pthread.h>
+#include "XnLinuxFutex.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+/** Number of times a contended lock is polled before the thread goes to sleep. **/
+#define XN_CRITICAL_SECTION_SPIN_COUNT 100
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/**
+ * Critical sections are never shared between processes, so they do not need the named-mutex
+ * machinery of XnMutex. On Linux they are a recursive futex lock, taken without a system call
+ * when uncontended. Elsewhere, they are a recursive pthread mutex with adaptive spinning.
+ */
+struct XnCriticalSection
+{
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+	// 0 - unlocked, 1 - locked, 2 - locked and other threads may be sleeping on it
+	std::atomic<int32_t> nState;
+	std::atomic<pthread_t> owner;
+	uint32_t nRecursion;
+#else
+	pthread_mutex_t mutex;
+#endif
+};
 
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
 XN_C_API XnStatus xnOSCreateCriticalSection(XN_CRITICAL_SECTION_HANDLE* pCriticalSectionHandle)
 {
-	return xnOSCreateMutex(pCriticalSectionHandle);
+	XN_VALIDATE_OUTPUT_PTR(pCriticalSectionHandle);
+
+	XnCriticalSection* pCS = XN_NEW(XnCriticalSection);
+	XN_VALIDATE_ALLOC_PTR(pCS);
+
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+	pCS->nState.store(0, std::memory_order_relaxed);
+	pCS->owner.store(pthread_t(), std::memory_order_relaxed);
+	pCS->nRecursion = 0;
+#else
+	pthread_mutexattr_t tAttributes;
+	if (0 != pthread_mutexattr_init(&tAttributes))
+	{
+		XN_DELETE(pCS);
+		return (XN_STATUS_OS_MUTEX_CREATION_FAILED);
+	}
+
+	int rc = pthread_mutexattr_settype(&tAttributes, PTHREAD_MUTEX_RECURSIVE);
+	if (rc == 0)
+	{
+		rc = pthread_mutex_init(&pCS->mutex, &tAttributes);
+	}
+	pthread_mutexattr_destroy(&tAttributes);
+
+	if (rc != 0)
+	{
+		XN_DELETE(pCS);
+		return (XN_STATUS_OS_MUTEX_CREATION_FAILED);
+	}
+#endif
+
+	*pCriticalSectionHandle = pCS;
+
+	return (XN_STATUS_OK);
 }
 
 XN_C_API XnStatus xnOSCloseCriticalSection(XN_CRITICAL_SECTION_HANDLE* pCriticalSectionHandle)
 {
-	return xnOSCloseMutex(pCriticalSectionHandle);
+	XN_VALIDATE_INPUT_PTR(pCriticalSectionHandle);
+	XN_RET_IF_NULL(*pCriticalSectionHandle, XN_STATUS_OS_INVALID_CRITICAL_SECTION);
+
+	XnCriticalSection* pCS = *pCriticalSectionHandle;
+
+#ifndef XN_LINUX_FUTEX_SUPPORTED
+	if (0 != pthread_mutex_destroy(&pCS->mutex))
+	{
+		return (XN_STATUS_OS_MUTEX_CLOSE_FAILED);
+	}
+#endif
+
+	XN_DELETE(pCS);
+	*pCriticalSectionHandle = NULL;
+
+	return (XN_STATUS_OK);
 }
 
 XN_C_API XnStatus xnOSEnterCriticalSection(XN_CRITICAL_SECTION_HANDLE* pCriticalSectionHandle)
 {
-	return xnOSLockMutex(*pCriticalSectionHandle, XN_WAIT_INFINITE);
+	XN_VALIDATE_INPUT_PTR(pCriticalSectionHandle);
+	XnCriticalSection* pCS = *pCriticalSectionHandle;
+	XN_RET_IF_NULL(pCS, XN_STATUS_OS_INVALID_CRITICAL_SECTION);
+
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+	pthread_t self = pthread_self();
+	if (pthread_equal(pCS->owner.load(std::memory_order_relaxed), self))
+	{
+		// only this thread could have stored itself as the owner
+		++pCS->nRecursion;
+		return (XN_STATUS_OK);
+	}
+
+	int32_t nState = 0;
+	if (!pCS->nState.compare_exchange_strong(nState, 1, std::memory_order_acquire))
+	{
+		// contended. The owner usually leaves shortly, so poll a bit before sleeping.
+		bool bLocked = false;
+		for (uint32_t i = 0; i < XN_CRITICAL_SECTION_SPIN_COUNT && !bLocked; ++i)
+		{
+			xnLinuxCpuRelax();
+			nState = 0;
+			bLocked = (pCS->nState.load(std::memory_order_relaxed) == 0 &&
+				pCS->nState.compare_exchange_weak(nState, 1, std::memory_order_acquire));
+		}
+
+		if (!bLocked)
+		{
+			// mark as contended, so the owner wakes us when leaving
+			nState = pCS->nState.exchange(2, std::memory_order_acquire);
+			while (nState != 0)
+			{
+				xnLinuxFutexWait(&pCS->nState, 2, NULL);
+				nState = pCS->nState.exchange(2, std::memory_order_acquire);
+			}
+		}
+	}
+
+	pCS->owner.store(self, std::memory_order_relaxed);
+	pCS->nRecursion = 1;
+#else
+	int rc = pthread_mutex_trylock(&pCS->mutex);
+	for (uint32_t i = 0; rc == EBUSY && i < XN_CRITICAL_SECTION_SPIN_COUNT; ++i)
+	{
+		rc = pthread_mutex_trylock(&pCS->mutex);
+	}
+
+	if (rc == EBUSY)
+	{
+		rc = pthread_mutex_lock(&pCS->mutex);
+	}
+
+	if (rc != 0)
+	{
+		return (XN_STATUS_OS_MUTEX_LOCK_FAILED);
+	}
+#endif
+
+	return (XN_STATUS_OK);
 }
 
 XN_C_API XnStatus xnOSLeaveCriticalSection(XN_CRITICAL_SECTION_HANDLE* pCriticalSectionHandle)
 {
-	return xnOSUnLockMutex(*pCriticalSectionHandle);
+	XN_VALIDATE_INPUT_PTR(pCriticalSectionHandle);
+	XnCriticalSection* pCS = *pCriticalSectionHandle;
+	XN_RET_IF_NULL(pCS, XN_STATUS_OS_INVALID_CRITICAL_SECTION);
+
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+	if (!pthread_equal(pCS->owner.load(std::memory_order_relaxed), pthread_self()))
+	{
+		return (XN_STATUS_OS_MUTEX_UNLOCK_FAILED);
+	}
+
+	if (--pCS->nRecursion > 0)
+	{
+		return (XN_STATUS_OK);
+	}
+
+	pCS->owner.store(pthread_t(), std::memory_order_relaxed);
+	if (pCS->nState.exchange(0, std::memory_order_release) == 2)
+	{
+		xnLinuxFutexWake(&pCS->nState, 1);
+	}
+#else
+	if (0 != pthread_mutex_unlock(&pCS->mutex))
+	{
+		return (XN_STATUS_OS_MUTEX_UNLOCK_FAILED);
+	}
+#endif
+
+	return (XN_STATUS_OK);
 }
@@ -23,6 +23,7 @@
 //---------------------------------------------------------------------------
 #include <XnOS.h>
 #include "XnLinuxPosixEvents.h"
+#include "XnLinuxFutexEvents.h"
 #include "XnLinuxPosixNamedEvents.h"
 #include "XnLinuxSysVNamedEvents.h"
 
@@ -40,7 +41,11 @@ XN_C_API XnStatus xnOSCreateEvent(XN_EVENT_HANDLE* pEventHandle, bool bManualRes
 	*pEventHandle = NULL;
 
 	XnLinuxEvent* pEvent = NULL;
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+	XN_VALIDATE_NEW(pEvent, XnLinuxFutexEvent, bManualReset);
+#else
 	XN_VALIDATE_NEW(pEvent, XnLinuxPosixEvent, bManualReset);
+#endif
 
 	nRetVal = pEvent->Init();
 	if (nRetVal != XN_STATUS_OK)
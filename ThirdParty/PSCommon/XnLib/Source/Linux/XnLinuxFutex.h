@@ -0,0 +1,80 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __LINUX_FUTEX_H__
+#define __LINUX_FUTEX_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnPlatform.h>
+#include <atomic>
+
+#if (XN_PLATFORM == XN_PLATFORM_LINUX_X86 || XN_PLATFORM == XN_PLATFORM_LINUX_ARM)
+
+#define XN_LINUX_FUTEX_SUPPORTED
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+//---------------------------------------------------------------------------
+// Functions
+//---------------------------------------------------------------------------
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "futex words must be plain 32-bit integers");
+
+/** Sleeps while *pWord equals nExpected, for at most pTimeout (relative, NULL for infinite). Returns 0 or -1 (see errno). **/
+inline int xnLinuxFutexWait(std::atomic<int32_t>* pWord, int32_t nExpected, const struct timespec* pTimeout)
+{
+	return (int)syscall(SYS_futex, reinterpret_cast<int32_t*>(pWord), FUTEX_WAIT_PRIVATE, nExpected, pTimeout, NULL, 0);
+}
+
+/** Wakes up to nCount threads sleeping on pWord. **/
+inline void xnLinuxFutexWake(std::atomic<int32_t>* pWord, int32_t nCount)
+{
+	syscall(SYS_futex, reinterpret_cast<int32_t*>(pWord), FUTEX_WAKE_PRIVATE, nCount, NULL, NULL, 0);
+}
+
+/** Same as xnLinuxFutexWait(), for a word that may be shared with other processes. **/
+inline int xnLinuxFutexWaitShared(std::atomic<int32_t>* pWord, int32_t nExpected, const struct timespec* pTimeout)
+{
+	return (int)syscall(SYS_futex, reinterpret_cast<int32_t*>(pWord), FUTEX_WAIT, nExpected, pTimeout, NULL, 0);
+}
+
+/** Same as xnLinuxFutexWake(), for a word that may be shared with other processes. **/
+inline void xnLinuxFutexWakeShared(std::atomic<int32_t>* pWord, int32_t nCount)
+{
+	syscall(SYS_futex, reinterpret_cast<int32_t*>(pWord), FUTEX_WAKE, nCount, NULL, NULL, 0);
+}
+
+/** Hints the CPU that we are busy-waiting. **/
+inline void xnLinuxCpuRelax()
+{
+#if (XN_PLATFORM == XN_PLATFORM_LINUX_X86)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+#endif // Linux
+
+#endif // __LINUX_FUTEX_H__
@@ -0,0 +1,141 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "XnLinuxFutexEvents.h"
+
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+
+#include <limits.h>
+
+XnLinuxFutexEvent::XnLinuxFutexEvent(bool bManualReset) : XnLinuxEvent(bManualReset)
+{
+	m_nState.store(0, std::memory_order_relaxed);
+	m_nWaiters.store(0, std::memory_order_relaxed);
+}
+
+XnStatus XnLinuxFutexEvent::Init()
+{
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnLinuxFutexEvent::Destroy()
+{
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnLinuxFutexEvent::Set()
+{
+	m_nState.store(1, std::memory_order_seq_cst);
+
+	// A waiter registers itself before checking the state (in the kernel), so it either sees
+	// the event set, or is counted here.
+	if (m_nWaiters.load(std::memory_order_seq_cst) > 0)
+	{
+		xnLinuxFutexWake(&m_nState, m_bManualReset ? INT_MAX : 1);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnLinuxFutexEvent::Reset()
+{
+	m_nState.store(0, std::memory_order_release);
+
+	return (XN_STATUS_OK);
+}
+
+bool XnLinuxFutexEvent::TryConsume()
+{
+	if (m_bManualReset)
+	{
+		return (m_nState.load(std::memory_order_acquire) == 1);
+	}
+
+	int32_t nSignaled = 1;
+	return m_nState.compare_exchange_strong(nSignaled, 0, std::memory_order_acquire);
+}
+
+XnStatus XnLinuxFutexEvent::Wait(uint32_t nMilliseconds)
+{
+	if (TryConsume())
+	{
+		return (XN_STATUS_OK);
+	}
+
+	if (nMilliseconds == 0)
+	{
+		return (XN_STATUS_OS_EVENT_TIMEOUT);
+	}
+
+	struct timespec deadline = {0, 0};
+	if (nMilliseconds != XN_WAIT_INFINITE)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += nMilliseconds / 1000;
+		deadline.tv_nsec += (nMilliseconds % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	for (;;)
+	{
+		// futex timeouts are relative, so recalculate what's left after each wake up
+		struct timespec remaining;
+		struct timespec* pTimeout = NULL;
+		if (nMilliseconds != XN_WAIT_INFINITE)
+		{
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+			remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+			if (remaining.tv_nsec < 0)
+			{
+				remaining.tv_sec--;
+				remaining.tv_nsec += 1000000000L;
+			}
+			if (remaining.tv_sec < 0)
+			{
+				return (XN_STATUS_OS_EVENT_TIMEOUT);
+			}
+			pTimeout = &remaining;
+		}
+
+		m_nWaiters.fetch_add(1, std::memory_order_seq_cst);
+		int rc = xnLinuxFutexWait(&m_nState, 0, pTimeout);
+		int nError = errno;
+		m_nWaiters.fetch_sub(1, std::memory_order_relaxed);
+
+		if (TryConsume())
+		{
+			return (XN_STATUS_OK);
+		}
+
+		if (rc != 0 && nError != EAGAIN && nError != EINTR && nError != ETIMEDOUT)
+		{
+			xnLogWarning(XN_MASK_OS, "Failed to wait on event: futex returned %d", nError);
+			return (XN_STATUS_OS_EVENT_WAIT_FAILED);
+		}
+	}
+}
+
+#endif // XN_LINUX_FUTEX_SUPPORTED
@@ -0,0 +1,54 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __LINUX_FUTEX_EVENTS_H__
+#define __LINUX_FUTEX_EVENTS_H__
+
+#include "XnLinuxEvents.h"
+#include "XnLinuxFutex.h"
+
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+
+/**
+ * An unnamed event implemented directly on a futex. Setting an event nobody waits on, and waiting
+ * on an event that is already set, do not enter the kernel. An auto-reset event wakes a single waiter.
+ */
+class XnLinuxFutexEvent : public XnLinuxEvent
+{
+public:
+	XnLinuxFutexEvent(bool bManualReset);
+
+	virtual XnStatus Init();
+	virtual XnStatus Destroy();
+	virtual XnStatus Set();
+	virtual XnStatus Reset();
+	virtual XnStatus Wait(uint32_t nMilliseconds);
+
+private:
+	bool TryConsume();
+
+	// 0 - not signaled, 1 - signaled
+	std::atomic<int32_t> m_nState;
+	std::atomic<int32_t> m_nWaiters;
+};
+
+#endif // XN_LINUX_FUTEX_SUPPORTED
+
+#endif // __LINUX_FUTEX_EVENTS_H__
@@ -25,6 +25,8 @@
 #include <XnLog.h>
 #include <sys/mman.h>
 #include <errno.h>
+#include <climits>
+#include "XnLinuxFutex.h"
 
 //---------------------------------------------------------------------------
 // Types
@@ -271,3 +273,78 @@ XN_C_API XnStatus xnOSSharedMemoryGetAddress(XN_SHARED_MEMORY_HANDLE hSharedMem,
 }
 
 #endif
+
+//---------------------------------------------------------------------------
+// Waiting on shared words
+//---------------------------------------------------------------------------
+#ifdef XN_LINUX_FUTEX_SUPPORTED
+
+XN_C_API XnStatus xnOSWaitSharedAddress(volatile int32_t* pAddress, int32_t nValue, uint32_t nMilliseconds)
+{
+	XN_VALIDATE_INPUT_PTR(pAddress);
+
+	struct timespec timeout;
+	struct timespec* pTimeout = NULL;
+	if (nMilliseconds != XN_WAIT_INFINITE)
+	{
+		timeout.tv_sec = nMilliseconds / 1000;
+		timeout.tv_nsec = (nMilliseconds % 1000) * 1000000L;
+		pTimeout = &timeout;
+	}
+
+	// shared futex, as the word may be mapped at different addresses by other processes
+	if (xnLinuxFutexWaitShared(reinterpret_cast<std::atomic<int32_t>*>(const_cast<int32_t*>(pAddress)), nValue, pTimeout) != 0)
+	{
+		int nError = errno;
+		if (nError == ETIMEDOUT)
+		{
+			return (XN_STATUS_OS_EVENT_TIMEOUT);
+		}
+		else if (nError != EAGAIN && nError != EINTR)
+		{
+			xnLogWarning(XN_MASK_OS, "Failed to wait on shared address: futex returned %d", nError);
+			return (XN_STATUS_OS_EVENT_WAIT_FAILED);
+		}
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API void xnOSWakeSharedAddress(volatile int32_t* pAddress)
+{
+	if (pAddress != NULL)
+	{
+		xnLinuxFutexWakeShared(reinterpret_cast<std::atomic<int32_t>*>(const_cast<int32_t*>(pAddress)), INT_MAX);
+	}
+}
+
+#else
+
+XN_C_API XnStatus xnOSWaitSharedAddress(volatile int32_t* pAddress, int32_t nValue, uint32_t nMilliseconds)
+{
+	XN_VALIDATE_INPUT_PTR(pAddress);
+
+	// no futexes - poll
+	uint64_t nStart = 0;
+	xnOSGetTimeStamp(&nStart);
+
+	while (*pAddress == nValue)
+	{
+		uint64_t nNow = 0;
+		xnOSGetTimeStamp(&nNow);
+		if (nMilliseconds != XN_WAIT_INFINITE && nNow - nStart >= nMilliseconds)
+		{
+			return (XN_STATUS_OS_EVENT_TIMEOUT);
+		}
+
+		xnOSSleep(1);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API void xnOSWakeSharedAddress(volatile int32_t* /*pAddress*/)
+{
+}
+
+#endif // XN_LINUX_FUTEX_SUPPORTED
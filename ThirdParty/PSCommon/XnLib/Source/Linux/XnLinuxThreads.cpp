@@ -25,6 +25,7 @@
 #include <errno.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <sched.h>
 #include <XnLog.h>
 
 //---------------------------------------------------------------------------
@@ -172,6 +173,115 @@ XN_C_API XnStatus xnOSSetThreadPriority(XN_THREAD_HANDLE ThreadHandle, XnThreadP
 
 	return (XN_STATUS_OK);
 }
+
+XN_C_API XnStatus xnOSSetThreadName(XN_THREAD_HANDLE ThreadHandle, const char* strName)
+{
+	XN_VALIDATE_INPUT_PTR(strName);
+
+	// Make sure the actual thread handle isn't NULL
+	XN_RET_IF_NULL(ThreadHandle, XN_STATUS_OS_INVALID_THREAD);
+
+#if (XN_PLATFORM == XN_PLATFORM_LINUX_X86 || XN_PLATFORM == XN_PLATFORM_LINUX_ARM)
+	// the kernel keeps 15 characters (and the terminating null)
+	char strShortName[16];
+	xnOSStrCopy(strShortName, strName, sizeof(strShortName));
+	strShortName[sizeof(strShortName) - 1] = '\0';
+
+	int rc = pthread_setname_np(*ThreadHandle, strShortName);
+	if (rc != 0)
+	{
+		xnLogVerbose(XN_MASK_OS, "Failed to set thread name to '%s' (%d)", strShortName, rc);
+		return (XN_STATUS_ERROR);
+	}
+
+	return (XN_STATUS_OK);
+#else
+	// other platforms can only name the calling thread
+	return (XN_STATUS_NOT_IMPLEMENTED);
+#endif
+}
+
+XN_C_API XnStatus xnOSSetThreadAffinity(XN_THREAD_HANDLE ThreadHandle, const uint64_t* anAffinity)
+{
+	XN_VALIDATE_INPUT_PTR(anAffinity);
+
+	// Make sure the actual thread handle isn't NULL
+	XN_RET_IF_NULL(ThreadHandle, XN_STATUS_OS_INVALID_THREAD);
+
+#if (XN_PLATFORM == XN_PLATFORM_LINUX_X86 || XN_PLATFORM == XN_PLATFORM_LINUX_ARM)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+
+	for (uint32_t nCPU = 0; nCPU < XN_THREAD_AFFINITY_WORDS * 64 && nCPU < CPU_SETSIZE; ++nCPU)
+	{
+		if (anAffinity[nCPU / 64] & (1ULL << (nCPU % 64)))
+		{
+			CPU_SET(nCPU, &cpuSet);
+		}
+	}
+
+	int rc = pthread_setaffinity_np(*ThreadHandle, sizeof(cpuSet), &cpuSet);
+	if (rc != 0)
+	{
+		xnLogWarning(XN_MASK_OS, "Failed to set thread affinity (%d)", rc);
+		return (XN_STATUS_ERROR);
+	}
+
+	return (XN_STATUS_OK);
+#else
+	return (XN_STATUS_NOT_IMPLEMENTED);
+#endif
+}
+
+XN_C_API XnStatus xnOSSetThreadScheduling(XN_THREAD_HANDLE ThreadHandle, XnThreadSchedPolicy nPolicy, int32_t nPriority)
+{
+	// Make sure the actual thread handle isn't NULL
+	XN_RET_IF_NULL(ThreadHandle, XN_STATUS_OS_INVALID_THREAD);
+
+	int nOSPolicy = 0;
+	switch (nPolicy)
+	{
+		case XN_THREAD_SCHED_DEFAULT:
+			return (XN_STATUS_OK);
+		case XN_THREAD_SCHED_NORMAL:
+			nOSPolicy = SCHED_OTHER;
+			nPriority = 0;
+			break;
+		case XN_THREAD_SCHED_RR:
+			nOSPolicy = SCHED_RR;
+			break;
+		case XN_THREAD_SCHED_FIFO:
+			nOSPolicy = SCHED_FIFO;
+			break;
+		default:
+			return (XN_STATUS_OS_THREAD_UNSUPPORTED_PRIORITY);
+	}
+
+	int nMinPriority = sched_get_priority_min(nOSPolicy);
+	int nMaxPriority = sched_get_priority_max(nOSPolicy);
+	if (nPriority < nMinPriority || nPriority > nMaxPriority)
+	{
+		xnLogWarning(XN_MASK_OS, "Thread priority %d is out of range (%d-%d)", nPriority, nMinPriority, nMaxPriority);
+		return (XN_STATUS_OS_THREAD_UNSUPPORTED_PRIORITY);
+	}
+
+	sched_param param;
+	memset(&param, 0, sizeof(param));
+#ifndef XN_PLATFORM_HAS_NO_SCHED_PARAM
+	param.sched_priority = nPriority;
+#endif
+
+	int rc = pthread_setschedparam(*ThreadHandle, nOSPolicy, &param);
+	if (rc != 0)
+	{
+		// real-time policies need CAP_SYS_NICE (or an RLIMIT_RTPRIO limit allowing this priority)
+		xnLogWarning(XN_MASK_OS, "Failed to set thread scheduling policy (%d)", rc);
+		return (XN_STATUS_OS_THREAD_SET_PRIORITY_FAILED);
+	}
+
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSGetCurrentThreadID(XN_THREAD_ID* pThreadID)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
@@ -398,6 +398,7 @@ XnStatus xnUSBPlatformSpecificInit()
 		xnUSBPlatformSpecificShutdown();
 		return nRetVal;
 	}
+	xnOSApplyThreadPolicy(g_hUDEVThread, XN_THREAD_CLASS_SERVICE, "USBHotplug");
 #endif
 
 	xnLogInfo(XN_MASK_USB, "USB is initialized.");
@@ -428,13 +429,20 @@ XnStatus xnUSBAsynchThreadAddRef()
 			return nRetVal;
 		}
 
-		// set thread priority to critical
-		nRetVal = xnOSSetThreadPriority(g_InitData.hThread, XN_PRIORITY_CRITICAL);
-		if (nRetVal != 0)
+		// set thread priority to critical, unless a scheduling policy was configured for it
+		XnThreadPolicy policy;
+		if (xnOSGetThreadClassPolicy(XN_THREAD_CLASS_USB_EVENTS, &policy) != XN_STATUS_OK || policy.nSchedPolicy == XN_THREAD_SCHED_DEFAULT)
 		{
-			xnLogWarning(XN_MASK_USB, "USB events thread: Failed to set thread priority to critical. This might cause loss of data...");
-			printf("Warning: USB events thread - failed to set priority. This might cause loss of data...\n");
+			nRetVal = xnOSSetThreadPriority(g_InitData.hThread, XN_PRIORITY_CRITICAL);
+			if (nRetVal != 0)
+			{
+				xnLogWarning(XN_MASK_USB, "USB events thread: Failed to set thread priority to critical. This might cause loss of data...");
+				printf("Warning: USB events thread - failed to set priority. This might cause loss of data...\n");
+			}
 		}
+
+		// name it, pin it and apply the configured scheduling, if any
+		xnOSApplyThreadPolicy(g_InitData.hThread, XN_THREAD_CLASS_USB_EVENTS, NULL);
 	}
 
 	return (XN_STATUS_OK);
@@ -1305,11 +1313,15 @@ XN_THREAD_PROC xnUSBReadThreadMain(XN_THREAD_PARAM pThreadParam)
 {
 	XnUSBReadThreadData* pThreadData = (XnUSBReadThreadData*)pThreadParam;
 
-	// set thread priority to critical
-	XnStatus nRetVal = xnOSSetThreadPriority(pThreadData->hReadThread, XN_PRIORITY_CRITICAL);
-	if (nRetVal != 0)
+	// set thread priority to critical, unless a scheduling policy was configured for read threads
+	XnThreadPolicy policy;
+	if (xnOSGetThreadClassPolicy(XN_THREAD_CLASS_USB_READ, &policy) != XN_STATUS_OK || policy.nSchedPolicy == XN_THREAD_SCHED_DEFAULT)
 	{
-		xnLogWarning(XN_MASK_USB, "Failed to set thread priority to critical. This might cause loss of data...");
+		XnStatus nRetVal = xnOSSetThreadPriority(pThreadData->hReadThread, XN_PRIORITY_CRITICAL);
+		if (nRetVal != 0)
+		{
+			xnLogWarning(XN_MASK_USB, "Failed to set thread priority to critical. This might cause loss of data...");
+		}
 	}
 
 	// first of all, submit all transfers
@@ -1607,6 +1619,11 @@ XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, uint32_t nBuff
 		return (nRetVal);
 	}
 
+	char strThreadName[16];
+	uint32_t nChars;
+	xnOSStrFormat(strThreadName, sizeof(strThreadName), &nChars, "USBRead-0x%02x", pEPHandle->nAddress);
+	xnOSApplyThreadPolicy(pThreadData->hReadThread, XN_THREAD_CLASS_USB_READ, strThreadName);
+
 	pThreadData->bIsRunning = true;
 
 	xnLogInfo(XN_MASK_USB, "USB read thread was started.");
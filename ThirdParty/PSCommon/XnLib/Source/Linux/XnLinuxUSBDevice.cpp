@@ -759,6 +759,7 @@ XN_C_API XnStatus XN_C_DECL xnUSBDeviceInit(const XnUSBDeviceDescriptorHolder* p
 		xnUSBDeviceShutdown(pDevice);
 		return (nRetVal);
 	}
+	xnOSApplyThreadPolicy(pDevice->hThread, XN_THREAD_CLASS_SERVICE, "USBDeviceEP0");
 
 	pDevice->pDump = xnDumpFileOpen("Gadget", "gadget.csv");
 	xnDumpFileWriteString(pDevice->pDump, "Time,HostState,DeviceState,Event,NewHostState,NewDeviceState\n","");
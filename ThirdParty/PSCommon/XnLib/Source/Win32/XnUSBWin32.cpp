@@ -1512,6 +1512,8 @@ XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, uint32_t nBuff
 	nRetVal = xnOSCreateThread(xnUSBReadThreadMain, &pEPHandle->ThreadData, &pThreadData->hReadThread);
 	XN_IS_STATUS_OK(nRetVal); // Add cleanup memory!
 
+	xnOSApplyThreadPolicy(pThreadData->hReadThread, XN_THREAD_CLASS_USB_READ, NULL);
+
 	// Mark that this EP has a valid read thread
 	pThreadData->bInUse = true;
 
@@ -235,3 +235,30 @@ XN_C_API XnStatus xnOSSharedMemoryGetAddress(XN_SHARED_MEMORY_HANDLE hSharedMem,
 
 	return (XN_STATUS_OK);
 }
+
+XN_C_API XnStatus xnOSWaitSharedAddress(volatile int32_t* pAddress, int32_t nValue, uint32_t nMilliseconds)
+{
+	XN_VALIDATE_INPUT_PTR(pAddress);
+
+	// WaitOnAddress() doesn't work across processes - poll
+	uint64_t nStart = 0;
+	xnOSGetTimeStamp(&nStart);
+
+	while (*pAddress == nValue)
+	{
+		uint64_t nNow = 0;
+		xnOSGetTimeStamp(&nNow);
+		if (nMilliseconds != XN_WAIT_INFINITE && nNow - nStart >= nMilliseconds)
+		{
+			return (XN_STATUS_OS_EVENT_TIMEOUT);
+		}
+
+		xnOSSleep(1);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API void xnOSWakeSharedAddress(volatile int32_t* /*pAddress*/)
+{
+}
@@ -152,6 +152,44 @@ XN_C_API XnStatus xnOSSetThreadPriority(XN_THREAD_HANDLE ThreadHandle, XnThreadP
 	return XN_STATUS_OK;
 }
 
+XN_C_API XnStatus xnOSSetThreadName(XN_THREAD_HANDLE /*ThreadHandle*/, const char* strName)
+{
+	XN_VALIDATE_INPUT_PTR(strName);
+
+	// SetThreadDescription() is not available on all supported Windows versions
+	return XN_STATUS_NOT_IMPLEMENTED;
+}
+
+XN_C_API XnStatus xnOSSetThreadAffinity(XN_THREAD_HANDLE ThreadHandle, const uint64_t* anAffinity)
+{
+	XN_VALIDATE_INPUT_PTR(anAffinity);
+
+	// only the processor group of the process is supported
+	if (SetThreadAffinityMask(ThreadHandle, (DWORD_PTR)anAffinity[0]) == 0)
+	{
+		return XN_STATUS_ERROR;
+	}
+
+	return XN_STATUS_OK;
+}
+
+XN_C_API XnStatus xnOSSetThreadScheduling(XN_THREAD_HANDLE ThreadHandle, XnThreadSchedPolicy nPolicy, int32_t nPriority)
+{
+	// Windows has no real-time policies. Map them to the highest priorities.
+	switch (nPolicy)
+	{
+		case XN_THREAD_SCHED_DEFAULT:
+			return XN_STATUS_OK;
+		case XN_THREAD_SCHED_NORMAL:
+			return xnOSSetThreadPriority(ThreadHandle, XN_PRIORITY_NORMAL);
+		case XN_THREAD_SCHED_RR:
+		case XN_THREAD_SCHED_FIFO:
+			return xnOSSetThreadPriority(ThreadHandle, (nPriority >= 50) ? XN_PRIORITY_CRITICAL : XN_PRIORITY_HIGH);
+		default:
+			return XN_STATUS_OS_THREAD_UNSUPPORTED_PRIORITY;
+	}
+}
+
 XN_C_API XnStatus xnOSGetCurrentThreadID(XN_THREAD_ID* pThreadID)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
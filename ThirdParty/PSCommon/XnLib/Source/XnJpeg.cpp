@@ -33,6 +33,20 @@
 // Definitions
 //---------------------------------------------------------------------------
 #define XN_MASK_JPEG "JPEG"
+#define XN_JPEG_STRIP_THREAD_TERMINATE_TIMEOUT 3000
+
+// JPEG marker codes (the byte following 0xFF)
+#define JPEG_SOF0_MARKER	0xC0
+#define JPEG_SOF1_MARKER	0xC1
+#define JPEG_DHT_MARKER		0xC4
+#define JPEG_JPG_MARKER		0xC8
+#define JPEG_DAC_MARKER		0xCC
+#define JPEG_RST0_MARKER	0xD0
+#define JPEG_RST7_MARKER	0xD7
+#define JPEG_SOI_MARKER		0xD8
+#define JPEG_EOI_MARKER		0xD9
+#define JPEG_SOS_MARKER		0xDA
+#define JPEG_DRI_MARKER		0xDD
 
 //---------------------------------------------------------------------------
 // Types
@@ -53,13 +67,94 @@ typedef struct XnStreamCompJPEGContext
 	struct jpeg_destination_mgr	jDestMgr;
 } XnStreamCompJPEGContext;
 
+typedef enum XnJpegIncrementalState
+{
+	XN_JPEG_INCREMENTAL_IDLE,
+	XN_JPEG_INCREMENTAL_HEADER,
+	XN_JPEG_INCREMENTAL_START,
+	XN_JPEG_INCREMENTAL_SCANLINES,
+	XN_JPEG_INCREMENTAL_FINISH,
+	XN_JPEG_INCREMENTAL_DONE,
+} XnJpegIncrementalState;
+
+struct XnStreamUncompJPEGContext;
+
+// Decodes a strip of MCU rows of a parallel decoded image, as a JPEG image of its own
+typedef struct XnJpegStripDecoder
+{
+	jpeg_decompress_struct	jDecompStruct;
+	XnLibJpegErrorMgr	jErrMgr;
+	struct jpeg_source_mgr	jSrcMgr;
+
+	// the strip image: the original headers with the strip height, followed by its restart intervals
+	uint8_t*	pStripData;
+	uint32_t	nStripDataMaxSize;
+
+	// current task. The strip image has nRows rows. The first nSkipRows of them and any after the following
+	// nOutputRows only give the upsampler its context, and are decoded into pDiscardLine.
+	uint32_t	nFirstInterval;
+	uint32_t	nLastInterval;
+	uint32_t	nRows;
+	uint32_t	nSkipRows;
+	uint32_t	nOutputRows;
+	uint8_t*	pOutput;
+	XnStatus	nResult;
+	uint8_t*	pDiscardLine;
+	uint32_t	nDiscardLineMaxSize;
+
+	// worker thread (the first strip is decoded on the calling thread, and has none)
+	struct XnStreamUncompJPEGContext*	pContext;
+	XN_THREAD_HANDLE	hThread;
+	XN_EVENT_HANDLE		hStartEvent;
+	XN_EVENT_HANDLE		hDoneEvent;
+	volatile bool		bStop;
+} XnJpegStripDecoder;
+
+// Layout of a JPEG image, as needed for splitting it at its restart markers
+typedef struct XnJpegLayout
+{
+	uint32_t	nHeightOffset;
+	uint32_t	nScanDataOffset;
+	uint32_t	nWidth;
+	uint32_t	nHeight;
+	uint32_t	nMCUWidth;
+	uint32_t	nMCUHeight;
+	uint32_t	nRestartInterval;
+	bool		bVerticalSubsampling; // some chroma component has fewer rows than the image
+} XnJpegLayout;
+
 typedef struct XnStreamUncompJPEGContext
 {
 	jpeg_decompress_struct	jDecompStruct;
 	XnLibJpegErrorMgr	jErrMgr;
 	struct jpeg_source_mgr	jSrcMgr;
+
+	// incremental decompression
+	struct jpeg_source_mgr	jIncrementalSrcMgr;
+	XnJpegIncrementalState	incrementalState;
+	uint8_t*	pIncrementalOutput;
+	uint32_t	nIncrementalOutputMaxSize;
+	uint32_t	nIncrementalOutputSize;
+	uint32_t	nInputConsumed;
+	uint32_t	nInputToSkip;
+	bool		bEndOfInput;
+
+	// decoding options
+	bool		bFastDCT;
+	bool		bFancyUpsampling;
+
+	// parallel decompression
+	XnJpegStripDecoder*	pStripDecoders;
+	uint32_t	nStripDecoders;
+	const uint8_t*	pParallelInput;
+	XnJpegLayout	parallelLayout;
+	uint32_t*	pIntervalOffsets; // start and end offset of every restart interval
+	uint32_t	nIntervalOffsetsMaxCount;
+	uint32_t	nIntervals;
 } XnStreamUncompJPEGContext;
 
+static const JOCTET XN_JPEG_FAKE_EOI[] = { 0xFF, JPEG_EOI_MARKER };
+
 void XnStreamJPEGDecompSkipFunction(struct jpeg_decompress_struct* pjDecompStruct, long nNumBytes)
 {
 	// Skip bytes in the internal buffer
@@ -78,6 +173,41 @@ void XnStreamJPEGDecompDummyFunction(struct jpeg_decompress_struct* /*pjDecompSt
 	// Dummy libjpeg function to wrap internal buffers usage...
 }
 
+boolean XnStreamJPEGDecompIncrementalFillFunction(struct jpeg_decompress_struct* pjDecompStruct)
+{
+	XnStreamUncompJPEGContext* pContext = (XnStreamUncompJPEGContext*)pjDecompStruct->client_data;
+	if (!pContext->bEndOfInput)
+	{
+		// suspend until more data arrives
+		return (false);
+	}
+
+	// data ended before the EOI marker. Insert a fake one so the image can be completed.
+	WARNMS(pjDecompStruct, JWRN_JPEG_EOF);
+	pjDecompStruct->src->next_input_byte = XN_JPEG_FAKE_EOI;
+	pjDecompStruct->src->bytes_in_buffer = sizeof(XN_JPEG_FAKE_EOI);
+	return (true);
+}
+
+void XnStreamJPEGDecompIncrementalSkipFunction(struct jpeg_decompress_struct* pjDecompStruct, long nNumBytes)
+{
+	XnStreamUncompJPEGContext* pContext = (XnStreamUncompJPEGContext*)pjDecompStruct->client_data;
+	if (nNumBytes <= 0)
+	{
+		return;
+	}
+
+	if ((size_t)nNumBytes > pjDecompStruct->src->bytes_in_buffer)
+	{
+		// skip the rest once it arrives
+		pContext->nInputToSkip += (uint32_t)(nNumBytes - pjDecompStruct->src->bytes_in_buffer);
+		nNumBytes = (long)pjDecompStruct->src->bytes_in_buffer;
+	}
+
+	pjDecompStruct->src->next_input_byte += (size_t)nNumBytes;
+	pjDecompStruct->src->bytes_in_buffer -= (size_t)nNumBytes;
+}
+
 void XnStreamJPEGDummyErrorExit(j_common_ptr cinfo)
 {
 	XnLibJpegErrorMgr* errMgr = (XnLibJpegErrorMgr*)cinfo->err;
@@ -275,6 +405,44 @@ XnStatus XnStreamInitCompressImageJ(XnStreamCompJPEGContext** ppStreamCompJPEGCo
 	return (XN_STATUS_OK);
 }
 
+static void XnStreamJPEGInitSource(struct jpeg_source_mgr* pSrcMgr)
+{
+	pSrcMgr->init_source = XnStreamJPEGDecompDummyFunction;
+	pSrcMgr->fill_input_buffer = XnStreamJPEGDecompDummyFailFunction;
+	pSrcMgr->skip_input_data = XnStreamJPEGDecompSkipFunction;
+	pSrcMgr->resync_to_restart = jpeg_resync_to_restart;
+	pSrcMgr->term_source = XnStreamJPEGDecompDummyFunction;
+}
+
+static void XnStreamJPEGInitDecompressor(XnStreamUncompJPEGContext* pContext)
+{
+	pContext->jDecompStruct.err = jpeg_std_error(&pContext->jErrMgr.pub);
+	pContext->jErrMgr.pub.output_message = XnStreamJPEGOutputMessage;
+	pContext->jErrMgr.pub.error_exit = XnStreamJPEGDummyErrorExit;
+
+	jpeg_create_decompress(&pContext->jDecompStruct);
+
+	pContext->jDecompStruct.src = &pContext->jSrcMgr;
+	XnStreamJPEGInitSource(pContext->jDecompStruct.src);
+	pContext->jDecompStruct.client_data = pContext;
+}
+
+// Recovers the decompressor after an error. Options and strip decoders are kept.
+static void XnStreamJPEGResetDecompressor(XnStreamUncompJPEGContext* pContext)
+{
+	jpeg_destroy_decompress(&pContext->jDecompStruct);
+	XnStreamJPEGInitDecompressor(pContext);
+	pContext->incrementalState = XN_JPEG_INCREMENTAL_IDLE;
+}
+
+static void XnStreamJPEGApplyOptions(const XnStreamUncompJPEGContext* pContext, jpeg_decompress_struct* pjDecompStruct)
+{
+	pjDecompStruct->dct_method = pContext->bFastDCT ? JDCT_IFAST : JDCT_ISLOW;
+	pjDecompStruct->do_fancy_upsampling = pContext->bFancyUpsampling;
+}
+
+static void XnStreamJPEGFreeStripDecoders(XnStreamUncompJPEGContext* pContext);
+
 XnStatus XnStreamInitUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
@@ -291,18 +459,29 @@ XnStatus XnStreamInitUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncomp
 		return XN_STATUS_ERROR;
 	}
 
-	pStreamUncompJPEGContext->jDecompStruct.err = jpeg_std_error(&pStreamUncompJPEGContext->jErrMgr.pub);
-	pStreamUncompJPEGContext->jErrMgr.pub.output_message = XnStreamJPEGOutputMessage;
- 	pStreamUncompJPEGContext->jErrMgr.pub.error_exit = XnStreamJPEGDummyErrorExit;
+	XnStreamJPEGInitDecompressor(pStreamUncompJPEGContext);
+
+	pStreamUncompJPEGContext->jIncrementalSrcMgr = pStreamUncompJPEGContext->jSrcMgr;
+	pStreamUncompJPEGContext->jIncrementalSrcMgr.fill_input_buffer = XnStreamJPEGDecompIncrementalFillFunction;
+	pStreamUncompJPEGContext->jIncrementalSrcMgr.skip_input_data = XnStreamJPEGDecompIncrementalSkipFunction;
 
-	jpeg_create_decompress(&pStreamUncompJPEGContext->jDecompStruct);
+	pStreamUncompJPEGContext->incrementalState = XN_JPEG_INCREMENTAL_IDLE;
+	pStreamUncompJPEGContext->pIncrementalOutput = NULL;
+	pStreamUncompJPEGContext->nIncrementalOutputMaxSize = 0;
+	pStreamUncompJPEGContext->nIncrementalOutputSize = 0;
+	pStreamUncompJPEGContext->nInputConsumed = 0;
+	pStreamUncompJPEGContext->nInputToSkip = 0;
+	pStreamUncompJPEGContext->bEndOfInput = false;
 
-	pStreamUncompJPEGContext->jDecompStruct.src = &pStreamUncompJPEGContext->jSrcMgr;
-	pStreamUncompJPEGContext->jDecompStruct.src->init_source = XnStreamJPEGDecompDummyFunction;
-	pStreamUncompJPEGContext->jDecompStruct.src->fill_input_buffer = XnStreamJPEGDecompDummyFailFunction;
-	pStreamUncompJPEGContext->jDecompStruct.src->skip_input_data = XnStreamJPEGDecompSkipFunction;
-	pStreamUncompJPEGContext->jDecompStruct.src->resync_to_restart = jpeg_resync_to_restart;
-	pStreamUncompJPEGContext->jDecompStruct.src->term_source = XnStreamJPEGDecompDummyFunction;
+	pStreamUncompJPEGContext->bFastDCT = false;
+	pStreamUncompJPEGContext->bFancyUpsampling = true;
+
+	pStreamUncompJPEGContext->pStripDecoders = NULL;
+	pStreamUncompJPEGContext->nStripDecoders = 0;
+	pStreamUncompJPEGContext->pParallelInput = NULL;
+	pStreamUncompJPEGContext->pIntervalOffsets = NULL;
+	pStreamUncompJPEGContext->nIntervalOffsetsMaxCount = 0;
+	pStreamUncompJPEGContext->nIntervals = 0;
 
 	// Update the output context pointer.
 	*ppStreamUncompJPEGContext = pStreamUncompJPEGContext;
@@ -321,6 +500,9 @@ XnStatus XnStreamFreeUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncomp
 		return XN_STATUS_OK; // Already NULL. Nothing to do.
 	}
 
+	XnStreamJPEGFreeStripDecoders(*ppStreamUncompJPEGContext);
+	xnOSFree((*ppStreamUncompJPEGContext)->pIntervalOffsets);
+
 	jpeg_destroy_decompress(&(*ppStreamUncompJPEGContext)->jDecompStruct);
 
 	XN_DELETE(*ppStreamUncompJPEGContext);
@@ -337,6 +519,538 @@ XnStatus XnStreamFreeUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncomp
 #pragma warning(disable: 4611)
 #endif
 
+static uint16_t XnStreamJPEGReadUInt16(const uint8_t* pData)
+{
+	return (uint16_t)((pData[0] << 8) | pData[1]);
+}
+
+// Finds the frame header, restart interval and start of scan data. Fails with XN_STATUS_NOT_IMPLEMENTED for images
+// that can not be split: no restart markers, progressive or multi-scan images.
+static XnStatus XnStreamJPEGParseLayout(const uint8_t* pInput, uint32_t nInputSize, XnJpegLayout* pLayout)
+{
+	uint32_t nComponents = 0;
+	uint32_t nMaxH = 1;
+	uint32_t nMaxV = 1;
+	uint32_t nMinV = 0xF;
+	bool bHasFrameHeader = false;
+
+	pLayout->nRestartInterval = 0;
+
+	if (nInputSize < 4 || pInput[0] != 0xFF || pInput[1] != JPEG_SOI_MARKER)
+	{
+		return (XN_STATUS_NOT_IMPLEMENTED);
+	}
+
+	uint32_t nPos = 2;
+	while (nPos + 4 <= nInputSize)
+	{
+		if (pInput[nPos] != 0xFF)
+		{
+			return (XN_STATUS_NOT_IMPLEMENTED);
+		}
+
+		uint8_t nMarker = pInput[nPos + 1];
+		if (nMarker == 0xFF)
+		{
+			// fill byte
+			++nPos;
+			continue;
+		}
+
+		uint32_t nLength = XnStreamJPEGReadUInt16(pInput + nPos + 2);
+		if (nLength < 2 || nPos + 2 + nLength > nInputSize)
+		{
+			return (XN_STATUS_NOT_IMPLEMENTED);
+		}
+
+		const uint8_t* pSegment = pInput + nPos + 4;
+		switch (nMarker)
+		{
+		case JPEG_SOF0_MARKER:
+		case JPEG_SOF1_MARKER:
+			// baseline or extended sequential, huffman coded
+			if (nLength < 8)
+			{
+				return (XN_STATUS_NOT_IMPLEMENTED);
+			}
+			pLayout->nHeightOffset = nPos + 5;
+			pLayout->nHeight = XnStreamJPEGReadUInt16(pSegment + 1);
+			pLayout->nWidth = XnStreamJPEGReadUInt16(pSegment + 3);
+			nComponents = pSegment[5];
+			if (pLayout->nHeight == 0 || pLayout->nWidth == 0 || nComponents == 0 || nLength < 8 + 3 * nComponents)
+			{
+				return (XN_STATUS_NOT_IMPLEMENTED);
+			}
+			for (uint32_t i = 0; i < nComponents; ++i)
+			{
+				uint8_t nSampling = pSegment[6 + 3 * i + 1];
+				nMaxH = XN_MAX(nMaxH, (uint32_t)(nSampling >> 4));
+				nMaxV = XN_MAX(nMaxV, (uint32_t)(nSampling & 0x0F));
+				nMinV = XN_MIN(nMinV, (uint32_t)(nSampling & 0x0F));
+			}
+			bHasFrameHeader = true;
+			break;
+		case JPEG_DRI_MARKER:
+			pLayout->nRestartInterval = XnStreamJPEGReadUInt16(pSegment);
+			break;
+		case JPEG_SOS_MARKER:
+			// a scan with part of the components means the image has several scans
+			if (!bHasFrameHeader || pLayout->nRestartInterval == 0 || pSegment[0] != nComponents)
+			{
+				return (XN_STATUS_NOT_IMPLEMENTED);
+			}
+			pLayout->nScanDataOffset = nPos + 2 + nLength;
+			// in a single component scan every block is an MCU
+			pLayout->nMCUWidth = (nComponents == 1) ? DCTSIZE : DCTSIZE * nMaxH;
+			pLayout->nMCUHeight = (nComponents == 1) ? DCTSIZE : DCTSIZE * nMaxV;
+			pLayout->bVerticalSubsampling = (nComponents > 1 && nMinV < nMaxV);
+			return (XN_STATUS_OK);
+		default:
+			if ((nMarker & 0xF0) == 0xC0 && nMarker != JPEG_DHT_MARKER && nMarker != JPEG_JPG_MARKER && nMarker != JPEG_DAC_MARKER)
+			{
+				// progressive, lossless or arithmetic coded
+				return (XN_STATUS_NOT_IMPLEMENTED);
+			}
+			break;
+		}
+
+		nPos += 2 + nLength;
+	}
+
+	return (XN_STATUS_NOT_IMPLEMENTED);
+}
+
+// Finds the data of every restart interval in the scan
+static XnStatus XnStreamJPEGFindIntervals(XnStreamUncompJPEGContext* pContext, const uint8_t* pInput, uint32_t nInputSize)
+{
+	const XnJpegLayout& layout = pContext->parallelLayout;
+	uint32_t nMCUsPerRow = (layout.nWidth + layout.nMCUWidth - 1) / layout.nMCUWidth;
+	uint32_t nMCURows = (layout.nHeight + layout.nMCUHeight - 1) / layout.nMCUHeight;
+	uint32_t nExpectedIntervals = (nMCUsPerRow * nMCURows + layout.nRestartInterval - 1) / layout.nRestartInterval;
+
+	if (pContext->nIntervalOffsetsMaxCount < nExpectedIntervals)
+	{
+		uint32_t* pOffsets = (uint32_t*)xnOSRealloc(pContext->pIntervalOffsets, nExpectedIntervals * 2 * sizeof(uint32_t));
+		XN_VALIDATE_ALLOC_PTR(pOffsets);
+		pContext->pIntervalOffsets = pOffsets;
+		pContext->nIntervalOffsetsMaxCount = nExpectedIntervals;
+	}
+
+	uint32_t nIntervals = 0;
+	uint32_t nIntervalStart = layout.nScanDataOffset;
+	const uint8_t* pEnd = pInput + nInputSize;
+	const uint8_t* pCurr = pInput + layout.nScanDataOffset;
+	for (;;)
+	{
+		const uint8_t* pMarker = (const uint8_t*)memchr(pCurr, 0xFF, pEnd - pCurr);
+		if (pMarker == NULL)
+		{
+			// no EOI. Let the decoder deal with the missing data.
+			pMarker = pEnd;
+		}
+
+		pCurr = pMarker;
+		uint8_t nCode = JPEG_EOI_MARKER;
+		if (pCurr < pEnd)
+		{
+			while (pCurr < pEnd && *pCurr == 0xFF)
+			{
+				++pCurr;
+			}
+			if (pCurr == pEnd)
+			{
+				pMarker = pEnd;
+			}
+			else
+			{
+				nCode = *pCurr++;
+			}
+		}
+
+		if (nCode == 0x00)
+		{
+			// stuffed 0xFF data byte
+			continue;
+		}
+
+		bool bRestart = (nCode >= JPEG_RST0_MARKER && nCode <= JPEG_RST7_MARKER);
+		if (!bRestart && nCode != JPEG_EOI_MARKER)
+		{
+			// another scan follows
+			return (XN_STATUS_NOT_IMPLEMENTED);
+		}
+
+		if (nIntervals == nExpectedIntervals)
+		{
+			return (XN_STATUS_NOT_IMPLEMENTED);
+		}
+		pContext->pIntervalOffsets[2 * nIntervals] = nIntervalStart;
+		pContext->pIntervalOffsets[2 * nIntervals + 1] = (uint32_t)(pMarker - pInput);
+		++nIntervals;
+		nIntervalStart = (uint32_t)(pCurr - pInput);
+
+		if (!bRestart)
+		{
+			break;
+		}
+	}
+
+	if (nIntervals != nExpectedIntervals)
+	{
+		return (XN_STATUS_NOT_IMPLEMENTED);
+	}
+
+	pContext->nIntervals = nIntervals;
+	return (XN_STATUS_OK);
+}
+
+// Builds the strip image (headers, restart intervals renumbered from 0, EOI), and decodes it
+static XnStatus XnStreamJPEGDecodeStrip(XnStreamUncompJPEGContext* pContext, XnJpegStripDecoder* pStrip)
+{
+	const XnJpegLayout& layout = pContext->parallelLayout;
+	const uint8_t* pInput = pContext->pParallelInput;
+	const uint32_t* pOffsets = pContext->pIntervalOffsets;
+
+	uint32_t nStripSize = layout.nScanDataOffset + 2;
+	for (uint32_t i = pStrip->nFirstInterval; i < pStrip->nLastInterval; ++i)
+	{
+		nStripSize += pOffsets[2 * i + 1] - pOffsets[2 * i] + 2;
+	}
+
+	if (pStrip->nStripDataMaxSize < nStripSize)
+	{
+		uint8_t* pData = (uint8_t*)xnOSRealloc(pStrip->pStripData, nStripSize);
+		XN_VALIDATE_ALLOC_PTR(pData);
+		pStrip->pStripData = pData;
+		pStrip->nStripDataMaxSize = nStripSize;
+	}
+
+	uint8_t* pWrite = pStrip->pStripData;
+	xnOSMemCopy(pWrite, pInput, layout.nScanDataOffset);
+	pWrite[layout.nHeightOffset] = (uint8_t)(pStrip->nRows >> 8);
+	pWrite[layout.nHeightOffset + 1] = (uint8_t)(pStrip->nRows & 0xFF);
+	pWrite += layout.nScanDataOffset;
+
+	for (uint32_t i = pStrip->nFirstInterval; i < pStrip->nLastInterval; ++i)
+	{
+		if (i != pStrip->nFirstInterval)
+		{
+			*pWrite++ = 0xFF;
+			*pWrite++ = (uint8_t)(JPEG_RST0_MARKER + ((i - pStrip->nFirstInterval - 1) & 7));
+		}
+		uint32_t nSize = pOffsets[2 * i + 1] - pOffsets[2 * i];
+		xnOSMemCopy(pWrite, pInput + pOffsets[2 * i], nSize);
+		pWrite += nSize;
+	}
+	*pWrite++ = 0xFF;
+	*pWrite++ = JPEG_EOI_MARKER;
+
+	jpeg_decompress_struct* pjDecompStruct = &pStrip->jDecompStruct;
+	pjDecompStruct->src->next_input_byte = pStrip->pStripData;
+	pjDecompStruct->src->bytes_in_buffer = (size_t)(pWrite - pStrip->pStripData);
+
+	if (setjmp(pStrip->jErrMgr.setjmpBuffer))
+	{
+		jpeg_abort_decompress(pjDecompStruct);
+		return (XN_STATUS_ERROR);
+	}
+
+	jpeg_read_header(pjDecompStruct, true);
+	XnStreamJPEGApplyOptions(pContext, pjDecompStruct);
+	jpeg_start_decompress(pjDecompStruct);
+
+	uint32_t nScanLineSize = pjDecompStruct->output_width * pjDecompStruct->num_components;
+	while (pjDecompStruct->output_scanline < pjDecompStruct->output_height)
+	{
+		uint32_t nOutputRow = pjDecompStruct->output_scanline - pStrip->nSkipRows;
+		uint8_t* pCurrScanline = (pjDecompStruct->output_scanline >= pStrip->nSkipRows && nOutputRow < pStrip->nOutputRows) ?
+			pStrip->pOutput + nOutputRow * nScanLineSize : pStrip->pDiscardLine;
+		if (jpeg_read_scanlines(pjDecompStruct, &pCurrScanline, 1) == 0)
+		{
+			jpeg_abort_decompress(pjDecompStruct);
+			return (XN_STATUS_ERROR);
+		}
+	}
+
+	jpeg_finish_decompress(pjDecompStruct);
+
+	return (XN_STATUS_OK);
+}
+
+XN_THREAD_PROC XnStreamJPEGStripThread(XN_THREAD_PARAM pThreadParam)
+{
+	XnJpegStripDecoder* pStrip = (XnJpegStripDecoder*)pThreadParam;
+
+	for (;;)
+	{
+		xnOSWaitEvent(pStrip->hStartEvent, XN_WAIT_INFINITE);
+		if (pStrip->bStop)
+		{
+			break;
+		}
+
+		pStrip->nResult = XnStreamJPEGDecodeStrip(pStrip->pContext, pStrip);
+		xnOSSetEvent(pStrip->hDoneEvent);
+	}
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+static void XnStreamJPEGFreeStripDecoders(XnStreamUncompJPEGContext* pContext)
+{
+	for (uint32_t i = 0; i < pContext->nStripDecoders; ++i)
+	{
+		XnJpegStripDecoder* pStrip = &pContext->pStripDecoders[i];
+		if (pStrip->hThread != NULL)
+		{
+			pStrip->bStop = true;
+			xnOSSetEvent(pStrip->hStartEvent);
+			xnOSWaitAndTerminateThread(&pStrip->hThread, XN_JPEG_STRIP_THREAD_TERMINATE_TIMEOUT);
+		}
+		if (pStrip->hStartEvent != NULL)
+		{
+			xnOSCloseEvent(&pStrip->hStartEvent);
+		}
+		if (pStrip->hDoneEvent != NULL)
+		{
+			xnOSCloseEvent(&pStrip->hDoneEvent);
+		}
+		jpeg_destroy_decompress(&pStrip->jDecompStruct);
+		xnOSFree(pStrip->pStripData);
+		xnOSFree(pStrip->pDiscardLine);
+	}
+
+	XN_DELETE_ARR(pContext->pStripDecoders);
+	pContext->pStripDecoders = NULL;
+	pContext->nStripDecoders = 0;
+}
+
+static XnStatus XnStreamJPEGCreateStripDecoders(XnStreamUncompJPEGContext* pContext, uint32_t nCount)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	pContext->pStripDecoders = XN_NEW_ARR(XnJpegStripDecoder, nCount);
+	XN_VALIDATE_ALLOC_PTR(pContext->pStripDecoders);
+	pContext->nStripDecoders = nCount;
+
+	for (uint32_t i = 0; i < nCount; ++i)
+	{
+		XnJpegStripDecoder* pStrip = &pContext->pStripDecoders[i];
+		pStrip->pStripData = NULL;
+		pStrip->nStripDataMaxSize = 0;
+		pStrip->pDiscardLine = NULL;
+		pStrip->nDiscardLineMaxSize = 0;
+		pStrip->pContext = pContext;
+		pStrip->hThread = NULL;
+		pStrip->hStartEvent = NULL;
+		pStrip->hDoneEvent = NULL;
+		pStrip->bStop = false;
+
+		pStrip->jDecompStruct.err = jpeg_std_error(&pStrip->jErrMgr.pub);
+		pStrip->jErrMgr.pub.output_message = XnStreamJPEGOutputMessage;
+		pStrip->jErrMgr.pub.error_exit = XnStreamJPEGDummyErrorExit;
+		jpeg_create_decompress(&pStrip->jDecompStruct);
+		pStrip->jDecompStruct.src = &pStrip->jSrcMgr;
+		XnStreamJPEGInitSource(pStrip->jDecompStruct.src);
+
+		// the first strip is decoded by the calling thread
+		if (i == 0)
+		{
+			continue;
+		}
+
+		nRetVal = xnOSCreateEvent(&pStrip->hStartEvent, false);
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = xnOSCreateEvent(&pStrip->hDoneEvent, false);
+		}
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = xnOSCreateThread(XnStreamJPEGStripThread, pStrip, &pStrip->hThread);
+		}
+		if (nRetVal != XN_STATUS_OK)
+		{
+			pContext->nStripDecoders = i + 1;
+			XnStreamJPEGFreeStripDecoders(pContext);
+			return (nRetVal);
+		}
+
+		char strThreadName[16];
+		uint32_t nChars;
+		xnOSStrFormat(strThreadName, sizeof(strThreadName), &nChars, "JpegStrip-%u", i);
+		xnOSApplyThreadPolicy(pStrip->hThread, XN_THREAD_CLASS_DECODE, strThreadName);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnStreamSetUncompressImageJOptions(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, bool bFastDCT, bool bFancyUpsampling, uint32_t nDecodeThreads)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(ppStreamUncompJPEGContext);
+	XN_VALIDATE_INPUT_PTR(*ppStreamUncompJPEGContext);
+
+	XnStreamUncompJPEGContext* pContext = *ppStreamUncompJPEGContext;
+	pContext->bFastDCT = bFastDCT;
+	pContext->bFancyUpsampling = bFancyUpsampling;
+
+	uint32_t nStripDecoders = (nDecodeThreads > 1) ? nDecodeThreads : 0;
+	if (nStripDecoders != pContext->nStripDecoders)
+	{
+		XnStreamJPEGFreeStripDecoders(pContext);
+		if (nStripDecoders > 0)
+		{
+			nRetVal = XnStreamJPEGCreateStripDecoders(pContext, nStripDecoders);
+			XN_IS_STATUS_OK_LOG_ERROR("Create JPEG strip decoders", nRetVal);
+		}
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+// Lets libjpeg work out the output size. Kept apart from the parallel decoder, so none of its locals live across
+// the setjmp.
+static XnStatus XnStreamJPEGCalcOutputSize(XnStreamUncompJPEGContext* pContext, const uint8_t* pInput, const uint32_t nInputSize, uint32_t* pnScanLineSize, uint32_t* pnOutputSize)
+{
+	jpeg_decompress_struct* pjDecompStruct = &pContext->jDecompStruct;
+	pjDecompStruct->src = &pContext->jSrcMgr;
+	pjDecompStruct->src->next_input_byte = pInput;
+	pjDecompStruct->src->bytes_in_buffer = nInputSize;
+	if (setjmp(pContext->jErrMgr.setjmpBuffer))
+	{
+		XnStreamJPEGResetDecompressor(pContext);
+		return (XN_STATUS_NOT_IMPLEMENTED);
+	}
+	jpeg_read_header(pjDecompStruct, true);
+	XnStreamJPEGApplyOptions(pContext, pjDecompStruct);
+	jpeg_calc_output_dimensions(pjDecompStruct);
+	*pnScanLineSize = pjDecompStruct->output_width * pjDecompStruct->output_components;
+	*pnOutputSize = *pnScanLineSize * pjDecompStruct->output_height;
+	jpeg_abort_decompress(pjDecompStruct);
+
+	return (XN_STATUS_OK);
+}
+
+// Decodes an image in strips, in parallel. Fails with XN_STATUS_NOT_IMPLEMENTED if the image can not be split.
+static XnStatus XnStreamJPEGUncompressParallel(XnStreamUncompJPEGContext* pContext, const uint8_t* pInput, const uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnOutputSize)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	XnJpegLayout& layout = pContext->parallelLayout;
+
+	nRetVal = XnStreamJPEGParseLayout(pInput, nInputSize, &layout);
+	XN_IS_STATUS_OK(nRetVal);
+
+	// strips must start on a restart interval that starts a new MCU row
+	uint32_t nMCUsPerRow = (layout.nWidth + layout.nMCUWidth - 1) / layout.nMCUWidth;
+	uint32_t nMCURows = (layout.nHeight + layout.nMCUHeight - 1) / layout.nMCUHeight;
+	uint32_t a = nMCUsPerRow;
+	uint32_t b = layout.nRestartInterval;
+	while (b != 0)
+	{
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	uint32_t nUnitMCUs = nMCUsPerRow / a * layout.nRestartInterval;
+	uint32_t nUnitRows = nUnitMCUs / nMCUsPerRow;
+	uint32_t nUnitIntervals = nUnitMCUs / layout.nRestartInterval;
+	uint32_t nUnits = (nMCURows + nUnitRows - 1) / nUnitRows;
+
+	uint32_t nStrips = XN_MIN(pContext->nStripDecoders, nUnits);
+	if (nStrips < 2)
+	{
+		return (XN_STATUS_NOT_IMPLEMENTED);
+	}
+
+	nRetVal = XnStreamJPEGFindIntervals(pContext, pInput, nInputSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	uint32_t nOutputSize = 0;
+	uint32_t nScanLineSize = 0;
+	nRetVal = XnStreamJPEGCalcOutputSize(pContext, pInput, nInputSize, &nScanLineSize, &nOutputSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	if (nOutputSize > *pnOutputSize)
+	{
+		*pnOutputSize = 0;
+		return (XN_STATUS_OUTPUT_BUFFER_OVERFLOW);
+	}
+
+	pContext->pParallelInput = pInput;
+
+	// Fancy upsampling of vertically subsampled chroma blends each chroma row with the ones above and below it.
+	// Strips then also decode the unit before and after them, so their edge rows come out as in a serial decode.
+	uint32_t nOverlapUnits = (pContext->bFancyUpsampling && layout.bVerticalSubsampling) ? 1 : 0;
+	uint32_t nUnitHeight = nUnitRows * layout.nMCUHeight;
+
+	for (uint32_t i = 0; i < nStrips; ++i)
+	{
+		XnJpegStripDecoder* pStrip = &pContext->pStripDecoders[i];
+		uint32_t nFirstUnit = i * nUnits / nStrips;
+		uint32_t nLastUnit = (i + 1) * nUnits / nStrips;
+		uint32_t nDecodeFirstUnit = (nFirstUnit > nOverlapUnits) ? nFirstUnit - nOverlapUnits : 0;
+		uint32_t nDecodeLastUnit = XN_MIN(nLastUnit + nOverlapUnits, nUnits);
+		uint32_t nFirstRow = nFirstUnit * nUnitHeight;
+		uint32_t nLastRow = XN_MIN(nLastUnit * nUnitHeight, layout.nHeight);
+		uint32_t nDecodeFirstRow = nDecodeFirstUnit * nUnitHeight;
+		uint32_t nDecodeLastRow = XN_MIN(nDecodeLastUnit * nUnitHeight, layout.nHeight);
+
+		pStrip->nFirstInterval = nDecodeFirstUnit * nUnitIntervals;
+		pStrip->nLastInterval = XN_MIN(nDecodeLastUnit * nUnitIntervals, pContext->nIntervals);
+		pStrip->nRows = nDecodeLastRow - nDecodeFirstRow;
+		pStrip->nSkipRows = nFirstRow - nDecodeFirstRow;
+		pStrip->nOutputRows = nLastRow - nFirstRow;
+		pStrip->pOutput = pOutput + nFirstRow * nScanLineSize;
+		pStrip->nResult = XN_STATUS_OK;
+
+		if (pStrip->nRows > pStrip->nOutputRows && pStrip->nDiscardLineMaxSize < nScanLineSize)
+		{
+			uint8_t* pLine = (uint8_t*)xnOSRealloc(pStrip->pDiscardLine, nScanLineSize);
+			if (pLine == NULL)
+			{
+				pContext->pParallelInput = NULL;
+				return (XN_STATUS_ALLOC_FAILED);
+			}
+			pStrip->pDiscardLine = pLine;
+			pStrip->nDiscardLineMaxSize = nScanLineSize;
+		}
+	}
+
+	for (uint32_t i = 1; i < nStrips; ++i)
+	{
+		xnOSSetEvent(pContext->pStripDecoders[i].hStartEvent);
+	}
+
+	XnStatus nResult = XnStreamJPEGDecodeStrip(pContext, &pContext->pStripDecoders[0]);
+
+	for (uint32_t i = 1; i < nStrips; ++i)
+	{
+		XnJpegStripDecoder* pStrip = &pContext->pStripDecoders[i];
+		xnOSWaitEvent(pStrip->hDoneEvent, XN_WAIT_INFINITE);
+		if (nResult == XN_STATUS_OK)
+		{
+			nResult = pStrip->nResult;
+		}
+	}
+
+	pContext->pParallelInput = NULL;
+
+	if (nResult != XN_STATUS_OK)
+	{
+		*pnOutputSize = 0;
+		xnLogError(XN_MASK_JPEG, "Xiron I/O decompression failed!");
+		return (nResult);
+	}
+
+	*pnOutputSize = nOutputSize;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, const uint8_t* pInput, const uint32_t nInputSize, uint8_t* pOutput, uint32_t* pnOutputSize)
 {
 	// Local function variables
@@ -360,18 +1074,28 @@ XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEG
 		return (XN_STATUS_INPUT_BUFFER_OVERFLOW);
 	}
 
+	if ((*ppStreamUncompJPEGContext)->nStripDecoders > 0)
+	{
+		XnStatus nRetVal = XnStreamJPEGUncompressParallel(*ppStreamUncompJPEGContext, pInput, nInputSize, pOutput, pnOutputSize);
+		if (nRetVal != XN_STATUS_NOT_IMPLEMENTED)
+		{
+			return (nRetVal);
+		}
+		// no suitable restart markers. decode serially.
+	}
+
 	pOutputEnd = pOutput + *pnOutputSize;
 
 	pjDecompStruct = &(*ppStreamUncompJPEGContext)->jDecompStruct;
 
+	pjDecompStruct->src = &(*ppStreamUncompJPEGContext)->jSrcMgr;
 	pjDecompStruct->src->bytes_in_buffer = nInputSize;
 	pjDecompStruct->src->next_input_byte = pInput;
 
 	if (setjmp((*ppStreamUncompJPEGContext)->jErrMgr.setjmpBuffer))
 	{
 		//If we get here, the JPEG code has signaled an error.
-		XnStreamFreeUncompressImageJ(ppStreamUncompJPEGContext);
-		XnStreamInitUncompressImageJ(ppStreamUncompJPEGContext);
+		XnStreamJPEGResetDecompressor(*ppStreamUncompJPEGContext);
 
 		*pnOutputSize = 0;
 		xnLogError(XN_MASK_JPEG, "Xiron I/O decompression failed!");
@@ -379,6 +1103,7 @@ XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEG
 	}
 
 	jpeg_read_header(pjDecompStruct, true);
+	XnStreamJPEGApplyOptions(*ppStreamUncompJPEGContext, pjDecompStruct);
 
 	jpeg_start_decompress(pjDecompStruct);
 
@@ -387,8 +1112,7 @@ XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEG
 	nOutputSize = pjDecompStruct->output_height * nScanLineSize;
 	if (nOutputSize > *pnOutputSize)
 	{
-		XnStreamFreeUncompressImageJ(ppStreamUncompJPEGContext);
-		XnStreamInitUncompressImageJ(ppStreamUncompJPEGContext);
+		XnStreamJPEGResetDecompressor(*ppStreamUncompJPEGContext);
 
 		*pnOutputSize = 0;
 
@@ -401,8 +1125,7 @@ XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEG
 
 		if (pNextScanline > pOutputEnd)
 		{
-			XnStreamFreeUncompressImageJ(ppStreamUncompJPEGContext);
-			XnStreamInitUncompressImageJ(ppStreamUncompJPEGContext);
+			XnStreamJPEGResetDecompressor(*ppStreamUncompJPEGContext);
 
 			*pnOutputSize = 0;
 
@@ -421,6 +1144,185 @@ XnStatus XnStreamUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEG
 	return (XN_STATUS_OK);
 }
 
+XnStatus XnStreamStartUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, uint8_t* pOutput, const uint32_t nOutputSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(ppStreamUncompJPEGContext);
+	XN_VALIDATE_INPUT_PTR(*ppStreamUncompJPEGContext);
+	XN_VALIDATE_OUTPUT_PTR(pOutput);
+
+	XnStreamUncompJPEGContext* pContext = *ppStreamUncompJPEGContext;
+
+	// drop any image that was not completed
+	if (pContext->incrementalState != XN_JPEG_INCREMENTAL_IDLE && pContext->incrementalState != XN_JPEG_INCREMENTAL_DONE)
+	{
+		jpeg_abort_decompress(&pContext->jDecompStruct);
+	}
+
+	pContext->jDecompStruct.src = &pContext->jIncrementalSrcMgr;
+	pContext->jDecompStruct.src->next_input_byte = NULL;
+	pContext->jDecompStruct.src->bytes_in_buffer = 0;
+
+	pContext->incrementalState = XN_JPEG_INCREMENTAL_HEADER;
+	pContext->pIncrementalOutput = pOutput;
+	pContext->nIncrementalOutputMaxSize = nOutputSize;
+	pContext->nIncrementalOutputSize = 0;
+	pContext->nInputConsumed = 0;
+	pContext->nInputToSkip = 0;
+	pContext->bEndOfInput = false;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnStreamContinueUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, const uint8_t* pInput, const uint32_t nInputSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(ppStreamUncompJPEGContext);
+	XN_VALIDATE_INPUT_PTR(*ppStreamUncompJPEGContext);
+	XN_VALIDATE_INPUT_PTR(pInput);
+
+	XnStreamUncompJPEGContext* pContext = *ppStreamUncompJPEGContext;
+	jpeg_decompress_struct* pjDecompStruct = &pContext->jDecompStruct;
+
+	if (pContext->incrementalState == XN_JPEG_INCREMENTAL_IDLE)
+	{
+		xnLogError(XN_MASK_JPEG, "Incremental decompression was not started!");
+		return (XN_STATUS_ERROR);
+	}
+
+	if (pContext->incrementalState == XN_JPEG_INCREMENTAL_DONE)
+	{
+		return (XN_STATUS_OK);
+	}
+
+	// hand libjpeg everything it did not consume yet
+	uint32_t nOffset = pContext->nInputConsumed + pContext->nInputToSkip;
+	if (nOffset > nInputSize)
+	{
+		pContext->nInputToSkip = nOffset - nInputSize;
+		nOffset = nInputSize;
+	}
+	else
+	{
+		pContext->nInputToSkip = 0;
+	}
+
+	pjDecompStruct->src->next_input_byte = pInput + nOffset;
+	pjDecompStruct->src->bytes_in_buffer = nInputSize - nOffset;
+
+	if (setjmp(pContext->jErrMgr.setjmpBuffer))
+	{
+		//If we get here, the JPEG code has signaled an error.
+		XnStreamJPEGResetDecompressor(*ppStreamUncompJPEGContext);
+		xnLogError(XN_MASK_JPEG, "Xiron I/O decompression failed!");
+		return (XN_STATUS_ERROR);
+	}
+
+	// advance as far as the available data allows. Every step returns early when libjpeg suspends.
+	switch (pContext->incrementalState)
+	{
+	case XN_JPEG_INCREMENTAL_HEADER:
+		if (jpeg_read_header(pjDecompStruct, true) == JPEG_SUSPENDED)
+		{
+			break;
+		}
+		XnStreamJPEGApplyOptions(pContext, pjDecompStruct);
+		pContext->incrementalState = XN_JPEG_INCREMENTAL_START;
+		// fall through
+	case XN_JPEG_INCREMENTAL_START:
+		if (!jpeg_start_decompress(pjDecompStruct))
+		{
+			break;
+		}
+
+		pContext->nIncrementalOutputSize = pjDecompStruct->output_height * pjDecompStruct->output_width * pjDecompStruct->num_components;
+		if (pContext->nIncrementalOutputSize > pContext->nIncrementalOutputMaxSize)
+		{
+			XnStreamJPEGResetDecompressor(*ppStreamUncompJPEGContext);
+			return (XN_STATUS_OUTPUT_BUFFER_OVERFLOW);
+		}
+
+		pContext->incrementalState = XN_JPEG_INCREMENTAL_SCANLINES;
+		// fall through
+	case XN_JPEG_INCREMENTAL_SCANLINES:
+		{
+			uint32_t nScanLineSize = pjDecompStruct->output_width * pjDecompStruct->num_components;
+			while (pjDecompStruct->output_scanline < pjDecompStruct->output_height)
+			{
+				uint8_t* pCurrScanline = pContext->pIncrementalOutput + pjDecompStruct->output_scanline * nScanLineSize;
+				if (jpeg_read_scanlines(pjDecompStruct, &pCurrScanline, 1) == 0)
+				{
+					break;
+				}
+			}
+
+			if (pjDecompStruct->output_scanline < pjDecompStruct->output_height)
+			{
+				break;
+			}
+		}
+		pContext->incrementalState = XN_JPEG_INCREMENTAL_FINISH;
+		// fall through
+	case XN_JPEG_INCREMENTAL_FINISH:
+		if (!jpeg_finish_decompress(pjDecompStruct))
+		{
+			break;
+		}
+		pContext->incrementalState = XN_JPEG_INCREMENTAL_DONE;
+		break;
+	default:
+		break;
+	}
+
+	// remember where libjpeg stopped (unless it is already reading the fake EOI)
+	if (pjDecompStruct->src->next_input_byte >= pInput && pjDecompStruct->src->next_input_byte <= pInput + nInputSize)
+	{
+		pContext->nInputConsumed = (uint32_t)(pjDecompStruct->src->next_input_byte - pInput);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnStreamFinishUncompressImageJ(XnStreamUncompJPEGContext** ppStreamUncompJPEGContext, const uint8_t* pInput, const uint32_t nInputSize, uint32_t* pnOutputSize)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(ppStreamUncompJPEGContext);
+	XN_VALIDATE_INPUT_PTR(*ppStreamUncompJPEGContext);
+	XN_VALIDATE_OUTPUT_PTR(pnOutputSize);
+
+	*pnOutputSize = 0;
+
+	if (nInputSize == 0)
+	{
+		xnLogError(XN_MASK_JPEG, "The compressed input buffer is too small to be valid!");
+		return (XN_STATUS_INPUT_BUFFER_OVERFLOW);
+	}
+
+	// no more data will arrive, so libjpeg must not suspend anymore
+	(*ppStreamUncompJPEGContext)->bEndOfInput = true;
+
+	nRetVal = XnStreamContinueUncompressImageJ(ppStreamUncompJPEGContext, pInput, nInputSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnStreamUncompJPEGContext* pContext = *ppStreamUncompJPEGContext;
+	if (pContext->incrementalState != XN_JPEG_INCREMENTAL_DONE)
+	{
+		XnStreamJPEGResetDecompressor(*ppStreamUncompJPEGContext);
+		xnLogError(XN_MASK_JPEG, "JPEG image is incomplete!");
+		return (XN_STATUS_ERROR);
+	}
+
+	pContext->incrementalState = XN_JPEG_INCREMENTAL_IDLE;
+	*pnOutputSize = pContext->nIncrementalOutputSize;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 #if (XN_PLATFORM == XN_PLATFORM_WIN32)
 #pragma warning(pop)
 #endif
@@ -31,6 +31,7 @@
 
 #include "XnLogConsoleWriter.h"
 #include "XnLogFileWriter.h"
+#include "XnLogAsyncQueue.h"
 
 //---------------------------------------------------------------------------
 // Defines
@@ -74,6 +75,10 @@ public:
 		// (like writers list). But the order can't be controlled, so some objects might be destroyed *after*
 		// log has. Those objects might write down to the log during destruction which will cause access violation.
 		// So, when the log is destroyed, we're turning it off, so that no writing will take place.
+		// Entries still queued are written first.
+		this->asyncQueue.Stop();
+		this->bAsync = false;
+		xnLogFlush();
 		Reset();
 	}
 
@@ -101,6 +106,11 @@ public:
 	char strSessionTimestamp[25];
 	XN_CRITICAL_SECTION_HANDLE hLock;
 
+	// Entries queued for the writer thread. Drained under hLock.
+	XnLogAsyncQueue asyncQueue;
+	bool bAsync;
+	bool bDraining;
+
 	// Writers
 	XnLogConsoleWriter consoleWriter;
 	XnLogFileWriter fileWriter;
@@ -123,6 +133,8 @@ private:
 		XN_REFERENCE_VARIABLE(nRetVal);
 
 		this->anyWriters = false;
+		this->bAsync = true;
+		this->bDraining = false;
 
 		Reset();
 	}
@@ -184,10 +196,70 @@ static void xnLogCreateEntry(XnBufferedLogEntry* pEntry, const char* csLogMask,
 	va_end(args);
 }
 
+static void xnLogWriteQueuedEntry(XnLogEntry* pEntry)
+{
+	LogData& logData = LogData::GetInstance();
+	pEntry->strSeverity = xnLogGetSeverityString(pEntry->nSeverity);
+	for (std::list<XnLogWriter*>::const_iterator it = logData.writers.begin(); it != logData.writers.end(); ++it)
+	{
+		const XnLogWriter* pWriter = *it;
+		pWriter->WriteEntry(pEntry, pWriter->pCookie);
+	}
+}
+
+static void xnLogWriteQueuedUnformatted(const char* strMessage)
+{
+	LogData& logData = LogData::GetInstance();
+	for (std::list<XnLogWriter*>::const_iterator it = logData.writers.begin(); it != logData.writers.end(); ++it)
+	{
+		const XnLogWriter* pWriter = *it;
+		pWriter->WriteUnformatted(strMessage, pWriter->pCookie);
+	}
+}
+
+static void xnLogDrainQueue()
+{
+	LogData& logData = LogData::GetInstance();
+	xnl::AutoCSLocker locker(logData.hLock);
+
+	// a writer might flush the log while we're draining it
+	if (logData.bDraining)
+	{
+		return;
+	}
+
+	logData.bDraining = true;
+	logData.asyncQueue.Drain(xnLogWriteQueuedEntry, xnLogWriteQueuedUnformatted);
+	logData.bDraining = false;
+}
+
+static bool xnLogStartQueue()
+{
+	LogData& logData = LogData::GetInstance();
+	xnl::AutoCSLocker locker(logData.hLock);
+	if (!logData.bAsync)
+	{
+		return false;
+	}
+
+	if (logData.asyncQueue.Start(xnLogDrainQueue) != XN_STATUS_OK)
+	{
+		// write synchronously from now on
+		logData.bAsync = false;
+		return false;
+	}
+
+	return true;
+}
+
 static void xnLogWriteEntry(XnLogEntry* pEntry)
 {
 	LogData& logData = LogData::GetInstance();
 	xnl::AutoCSLocker locker(logData.hLock);
+
+	// anything queued before this entry should be written before it
+	xnLogDrainQueue();
+
 	for (std::list<XnLogWriter*>::const_iterator it = logData.writers.begin(); it != logData.writers.end(); ++it)
 	{
 		const XnLogWriter* pWriter = *it;
@@ -207,6 +279,14 @@ static void xnLogWriteImplV(const char* csLogMask, XnLogSeverity nSeverity, cons
 		return;
 	}
 
+	if (logData.bAsync && (logData.asyncQueue.IsRunning() || xnLogStartQueue()))
+	{
+		if (logData.asyncQueue.Push(csLogMask, nSeverity, csFile, nLine, csFormat, args))
+		{
+			return;
+		}
+	}
+
 	XnBufferedLogEntry entry;
 	xnLogCreateEntryV(&entry, csLogMask, nSeverity, csFile, nLine, csFormat, args);
 
@@ -434,6 +514,13 @@ XN_C_API XnStatus xnLogInitFromINIFile(const char* cpINIFileName, const char* cp
 		XN_IS_STATUS_OK(nRetVal);
 	}
 
+	nRetVal = xnOSReadIntFromINI(cpINIFileName, cpSectionName, "LogAsynchronous", &nTemp);
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = xnLogSetAsynchronous(nTemp);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
 	return XN_STATUS_OK;
 }
 
@@ -461,6 +548,10 @@ XN_C_API void xnLogUnregisterLogWriter(XnLogWriter* pWriter)
 	LogData& logData = LogData::GetInstance();
 
 	xnl::AutoCSLocker locker(logData.hLock);
+
+	// the writer should get everything written while it was registered
+	xnLogDrainQueue();
+
 	std::list<XnLogWriter*>::iterator it = std::find(logData.writers.begin(), logData.writers.end(), pWriter);
 	if (it != logData.writers.end())
 	{
@@ -488,10 +579,15 @@ XN_C_API XnStatus xnLogStartNewFile()
 
 XN_C_API XnStatus xnLogClose()
 {
-	// notify all writers (while allowing them to unregister themselves)
 	LogData& logData = LogData::GetInstance();
 
+	// stop the writer thread (it is started again if the log is reopened), and write what it left behind
+	logData.asyncQueue.Stop();
+
+	// notify all writers (while allowing them to unregister themselves)
 	xnl::AutoCSLocker locker(logData.hLock);
+	xnLogDrainQueue();
+
 	std::list<XnLogWriter*>::const_iterator it = logData.writers.begin();
 	while (it != logData.writers.end())
 	{
@@ -548,6 +644,41 @@ XN_C_API XnStatus xnLogSetFileOutput(bool bFileOutput)
 	return XN_STATUS_OK;
 }
 
+XN_C_API XnStatus XN_C_DECL xnLogSetAsynchronous(bool bAsynchronous)
+{
+	LogData& logData = LogData::GetInstance();
+
+	{
+		xnl::AutoCSLocker locker(logData.hLock);
+		logData.bAsync = bAsynchronous;
+	}
+
+	if (!bAsynchronous)
+	{
+		// writer thread must not hold the lock while we wait for it
+		logData.asyncQueue.Stop();
+		xnLogDrainQueue();
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus XN_C_DECL xnLogFlush()
+{
+	xnLogDrainQueue();
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus XN_C_DECL xnLogGetDroppedEntriesCount(uint64_t* pnDropped)
+{
+	XN_VALIDATE_OUTPUT_PTR(pnDropped);
+
+	LogData& logData = LogData::GetInstance();
+	*pnDropped = logData.asyncQueue.GetDroppedCount();
+
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnLogSetLineInfo(bool bLineInfo)
 {
 	LogData& logData = LogData::GetInstance();
@@ -648,7 +779,16 @@ void xnLogWriteNoEntryImplV(const char* csFormat, va_list args)
 	xnOSStrFormatV(csMessage, nMaxMessageSize, &nChars, csFormat, args);
 
 	LogData& logData = LogData::GetInstance();
+	if (logData.bAsync && (logData.asyncQueue.IsRunning() || xnLogStartQueue()))
+	{
+		if (logData.asyncQueue.PushUnformatted(csMessage))
+		{
+			return;
+		}
+	}
+
 	xnl::AutoCSLocker locker(logData.hLock);
+	xnLogDrainQueue();
 	for (std::list<XnLogWriter*>::const_iterator it = logData.writers.begin(); it != logData.writers.end(); ++it)
 	{
 		const XnLogWriter* pWriter = *it;
@@ -0,0 +1,996 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <stddef.h>
+#include <string.h>
+
+#include "XnLogAsyncQueue.h"
+#include <XnOSCpp.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_LOG_ASYNC_RING_SIZE			(64 * 1024)
+#define XN_LOG_ASYNC_MAX_RECORD_SIZE	4096
+#define XN_LOG_ASYNC_MAX_MESSAGE_LENGTH	2048
+#define XN_LOG_ASYNC_WRITE_INTERVAL		20
+#define XN_LOG_ASYNC_THREAD_TIMEOUT		5000
+#define XN_LOG_ASYNC_RECORD_ALIGNMENT	8
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef enum
+{
+	XN_LOG_RECORD_PADDING = 0,
+	XN_LOG_RECORD_ENTRY = 1,
+	XN_LOG_RECORD_UNFORMATTED = 2,
+} XnLogRecordKind;
+
+// The format string holds the final message, and there are no arguments
+#define XN_LOG_RECORD_FLAG_FORMATTED	0x1
+
+/* A record is this header, followed by the mask, file and format strings (each NULL terminated), and the arguments. */
+typedef struct XnLogRecordHeader
+{
+	uint32_t nSize; // including the header, a multiple of XN_LOG_ASYNC_RECORD_ALIGNMENT
+	uint16_t nKind;
+	uint16_t nFlags;
+	uint64_t nTimestamp;
+	uint32_t nSeverity;
+	uint32_t nLine;
+	uint16_t nMaskLength;
+	uint16_t nFileLength;
+	uint16_t nFormatLength;
+	uint16_t nArgsSize;
+} XnLogRecordHeader;
+
+/* Each argument is stored as its type followed by its value. Strings are a uint16_t length (including
+   the NULL) followed by the characters. */
+typedef enum
+{
+	XN_LOG_ARG_NONE,
+	XN_LOG_ARG_INT,
+	XN_LOG_ARG_LONG,
+	XN_LOG_ARG_LONG_LONG,
+	XN_LOG_ARG_UINT,
+	XN_LOG_ARG_ULONG,
+	XN_LOG_ARG_ULONG_LONG,
+	XN_LOG_ARG_INTMAX,
+	XN_LOG_ARG_UINTMAX,
+	XN_LOG_ARG_PTRDIFF,
+	XN_LOG_ARG_SIZE,
+	XN_LOG_ARG_DOUBLE,
+	XN_LOG_ARG_LONG_DOUBLE,
+	XN_LOG_ARG_POINTER,
+	XN_LOG_ARG_STRING,
+} XnLogArgType;
+
+typedef struct XnLogFormatSpec
+{
+	const char* pStart; // the '%'
+	const char* pEnd; // one past the conversion character
+	bool bStarWidth;
+	bool bStarPrecision;
+	XnLogArgType argType; // NONE for "%%"
+} XnLogFormatSpec;
+
+struct XnLogThreadRing
+{
+	XnLogThreadRing() : nWritePos(0), nReadPos(0), nDropped(0), bOrphaned(false) {}
+
+	// Written by the owning thread only
+	std::atomic<uint64_t> nWritePos;
+	uint8_t aPadding1[64 - sizeof(std::atomic<uint64_t>)];
+	// Written by the draining thread only
+	std::atomic<uint64_t> nReadPos;
+	uint8_t aPadding2[64 - sizeof(std::atomic<uint64_t>)];
+	std::atomic<uint64_t> nDropped;
+	// Set when the owning thread exits. The ring is freed once it was drained.
+	std::atomic<bool> bOrphaned;
+	uint8_t aBuffer[XN_LOG_ASYNC_RING_SIZE];
+};
+
+/* Marks the ring of a thread as orphaned when the thread exits. */
+class XnLogThreadRingHolder
+{
+public:
+	XnLogThreadRingHolder() : pRing(NULL) {}
+	~XnLogThreadRingHolder()
+	{
+		if (pRing != NULL)
+		{
+			pRing->bOrphaned.store(true, std::memory_order_release);
+		}
+	}
+
+	XnLogThreadRing* pRing;
+};
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static thread_local XnLogThreadRingHolder g_threadRing;
+
+//---------------------------------------------------------------------------
+// Format Strings
+//---------------------------------------------------------------------------
+/* Parses a conversion specification starting at pFormat (a '%'). Returns false for the ones
+   that can't be captured (wide characters, %n, platform specific length modifiers). */
+static bool xnLogParseFormatSpec(const char* pFormat, XnLogFormatSpec& spec)
+{
+	const char* p = pFormat + 1;
+	spec.pStart = pFormat;
+	spec.bStarWidth = false;
+	spec.bStarPrecision = false;
+	spec.argType = XN_LOG_ARG_NONE;
+
+	if (*p == '%')
+	{
+		spec.pEnd = p + 1;
+		return true;
+	}
+
+	// flags
+	while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'')
+	{
+		++p;
+	}
+
+	// width
+	if (*p == '*')
+	{
+		spec.bStarWidth = true;
+		++p;
+	}
+	else
+	{
+		while (*p >= '0' && *p <= '9')
+		{
+			++p;
+		}
+	}
+
+	// precision
+	if (*p == '.')
+	{
+		++p;
+		if (*p == '*')
+		{
+			spec.bStarPrecision = true;
+			++p;
+		}
+		else
+		{
+			while (*p >= '0' && *p <= '9')
+			{
+				++p;
+			}
+		}
+	}
+
+	// length
+	enum { LENGTH_NONE, LENGTH_LONG, LENGTH_LONG_LONG, LENGTH_INTMAX, LENGTH_SIZE, LENGTH_PTRDIFF, LENGTH_LONG_DOUBLE } length = LENGTH_NONE;
+	switch (*p)
+	{
+	case 'h':
+		// char and short are promoted to int
+		++p;
+		if (*p == 'h')
+		{
+			++p;
+		}
+		break;
+	case 'l':
+		++p;
+		length = LENGTH_LONG;
+		if (*p == 'l')
+		{
+			++p;
+			length = LENGTH_LONG_LONG;
+		}
+		break;
+	case 'j':
+		++p;
+		length = LENGTH_INTMAX;
+		break;
+	case 'z':
+		++p;
+		length = LENGTH_SIZE;
+		break;
+	case 't':
+		++p;
+		length = LENGTH_PTRDIFF;
+		break;
+	case 'L':
+		++p;
+		length = LENGTH_LONG_DOUBLE;
+		break;
+	}
+
+	switch (*p)
+	{
+	case 'd':
+	case 'i':
+		spec.argType =
+			(length == LENGTH_LONG) ? XN_LOG_ARG_LONG :
+			(length == LENGTH_LONG_LONG) ? XN_LOG_ARG_LONG_LONG :
+			(length == LENGTH_INTMAX) ? XN_LOG_ARG_INTMAX :
+			(length == LENGTH_SIZE || length == LENGTH_PTRDIFF) ? XN_LOG_ARG_PTRDIFF :
+			XN_LOG_ARG_INT;
+		break;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		spec.argType =
+			(length == LENGTH_LONG) ? XN_LOG_ARG_ULONG :
+			(length == LENGTH_LONG_LONG) ? XN_LOG_ARG_ULONG_LONG :
+			(length == LENGTH_INTMAX) ? XN_LOG_ARG_UINTMAX :
+			(length == LENGTH_SIZE || length == LENGTH_PTRDIFF) ? XN_LOG_ARG_SIZE :
+			XN_LOG_ARG_UINT;
+		break;
+	case 'c':
+		if (length != LENGTH_NONE)
+		{
+			return false;
+		}
+		spec.argType = XN_LOG_ARG_INT;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		spec.argType = (length == LENGTH_LONG_DOUBLE) ? XN_LOG_ARG_LONG_DOUBLE : XN_LOG_ARG_DOUBLE;
+		break;
+	case 's':
+		if (length != LENGTH_NONE)
+		{
+			return false;
+		}
+		spec.argType = XN_LOG_ARG_STRING;
+		break;
+	case 'p':
+		spec.argType = XN_LOG_ARG_POINTER;
+		break;
+	default:
+		return false;
+	}
+
+	spec.pEnd = p + 1;
+	return true;
+}
+
+template <typename T>
+static inline bool xnLogPutArg(uint8_t*& pOut, const uint8_t* pEnd, XnLogArgType type, T value)
+{
+	if (pOut + 1 + sizeof(T) > pEnd)
+	{
+		return false;
+	}
+
+	*pOut++ = (uint8_t)type;
+	memcpy(pOut, &value, sizeof(T));
+	pOut += sizeof(T);
+	return true;
+}
+
+template <typename T>
+static inline bool xnLogGetArg(const uint8_t*& pIn, const uint8_t* pEnd, XnLogArgType type, T& value)
+{
+	if (pIn + 1 + sizeof(T) > pEnd || *pIn != (uint8_t)type)
+	{
+		return false;
+	}
+
+	memcpy(&value, pIn + 1, sizeof(T));
+	pIn += 1 + sizeof(T);
+	return true;
+}
+
+/* Captures the arguments of strFormat into pOut. Returns the number of bytes used, or -1 if they
+   can't be captured or don't fit. */
+static int32_t xnLogCaptureArgs(const char* strFormat, va_list args, uint8_t* pOut, uint32_t nMaxSize)
+{
+	uint8_t* pCurr = pOut;
+	const uint8_t* pEnd = pOut + nMaxSize;
+	XnLogFormatSpec spec;
+
+	for (const char* p = strchr(strFormat, '%'); p != NULL; p = strchr(spec.pEnd, '%'))
+	{
+		if (!xnLogParseFormatSpec(p, spec))
+		{
+			return -1;
+		}
+
+		if (spec.bStarWidth && !xnLogPutArg(pCurr, pEnd, XN_LOG_ARG_INT, va_arg(args, int)))
+		{
+			return -1;
+		}
+
+		if (spec.bStarPrecision && !xnLogPutArg(pCurr, pEnd, XN_LOG_ARG_INT, va_arg(args, int)))
+		{
+			return -1;
+		}
+
+		bool bFits = true;
+		switch (spec.argType)
+		{
+		case XN_LOG_ARG_NONE:
+			break;
+		case XN_LOG_ARG_INT:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, int));
+			break;
+		case XN_LOG_ARG_LONG:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, long));
+			break;
+		case XN_LOG_ARG_LONG_LONG:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, long long));
+			break;
+		case XN_LOG_ARG_UINT:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, unsigned int));
+			break;
+		case XN_LOG_ARG_ULONG:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, unsigned long));
+			break;
+		case XN_LOG_ARG_ULONG_LONG:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, unsigned long long));
+			break;
+		case XN_LOG_ARG_INTMAX:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, intmax_t));
+			break;
+		case XN_LOG_ARG_UINTMAX:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, uintmax_t));
+			break;
+		case XN_LOG_ARG_PTRDIFF:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, ptrdiff_t));
+			break;
+		case XN_LOG_ARG_SIZE:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, size_t));
+			break;
+		case XN_LOG_ARG_DOUBLE:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, double));
+			break;
+		case XN_LOG_ARG_LONG_DOUBLE:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, long double));
+			break;
+		case XN_LOG_ARG_POINTER:
+			bFits = xnLogPutArg(pCurr, pEnd, spec.argType, va_arg(args, void*));
+			break;
+		case XN_LOG_ARG_STRING:
+			{
+				const char* strValue = va_arg(args, const char*);
+				if (strValue == NULL)
+				{
+					strValue = "(null)";
+				}
+
+				size_t nLength = strlen(strValue) + 1;
+				if (nLength > XN_LOG_ASYNC_MAX_MESSAGE_LENGTH || pCurr + 1 + sizeof(uint16_t) + nLength > pEnd)
+				{
+					return -1;
+				}
+
+				uint16_t nLength16 = (uint16_t)nLength;
+				*pCurr++ = (uint8_t)XN_LOG_ARG_STRING;
+				memcpy(pCurr, &nLength16, sizeof(nLength16));
+				pCurr += sizeof(nLength16);
+				memcpy(pCurr, strValue, nLength);
+				pCurr += nLength;
+			}
+			break;
+		}
+
+		if (!bFits)
+		{
+			return -1;
+		}
+	}
+
+	return (int32_t)(pCurr - pOut);
+}
+
+/* Appends a formatted value to the message. Returns false when the message is full. */
+static bool xnLogAppend(char*& pDst, char* pDstEnd, const char* strFormat, ...)
+{
+	va_list args;
+	va_start(args, strFormat);
+	uint32_t nWritten = 0;
+	XnStatus nRetVal = xnOSStrFormatV(pDst, (uint32_t)(pDstEnd - pDst), &nWritten, strFormat, args);
+	va_end(args);
+
+	if (nRetVal != XN_STATUS_OK || nWritten >= (uint32_t)(pDstEnd - pDst))
+	{
+		// truncated
+		pDst = pDstEnd - 1;
+		*pDst = '\0';
+		return false;
+	}
+
+	pDst += nWritten;
+	return true;
+}
+
+/* Formats a captured message. Returns false if the arguments don't match the format (should not happen). */
+static bool xnLogFormatCaptured(const char* strFormat, const uint8_t* pArgs, uint32_t nArgsSize, char* strMessage, uint32_t nMessageSize)
+{
+	const uint8_t* pIn = pArgs;
+	const uint8_t* pInEnd = pArgs + nArgsSize;
+	char* pDst = strMessage;
+	char* pDstEnd = strMessage + nMessageSize;
+	*pDst = '\0';
+
+	XnLogFormatSpec spec;
+	const char* pLiteral = strFormat;
+	for (const char* p = strchr(strFormat, '%'); p != NULL; p = strchr(spec.pEnd, '%'))
+	{
+		// copy the text before this specification
+		uint32_t nLiteralLength = (uint32_t)(p - pLiteral);
+		if (nLiteralLength >= (uint32_t)(pDstEnd - pDst))
+		{
+			nLiteralLength = (uint32_t)(pDstEnd - pDst) - 1;
+		}
+		memcpy(pDst, pLiteral, nLiteralLength);
+		pDst += nLiteralLength;
+		*pDst = '\0';
+
+		if (!xnLogParseFormatSpec(p, spec))
+		{
+			return false;
+		}
+		pLiteral = spec.pEnd;
+
+		if (spec.argType == XN_LOG_ARG_NONE)
+		{
+			if (!xnLogAppend(pDst, pDstEnd, "%%"))
+			{
+				return true;
+			}
+			continue;
+		}
+
+		// rebuild the specification, with star width / precision replaced by their values
+		char strSpec[64];
+		char* pSpec = strSpec;
+		char* pSpecEnd = strSpec + sizeof(strSpec);
+		for (const char* pChar = spec.pStart; pChar < spec.pEnd; ++pChar)
+		{
+			if (*pChar == '*')
+			{
+				int nValue = 0;
+				if (!xnLogGetArg(pIn, pInEnd, XN_LOG_ARG_INT, nValue) || !xnLogAppend(pSpec, pSpecEnd, "%d", nValue))
+				{
+					return false;
+				}
+			}
+			else if (pSpec + 1 < pSpecEnd)
+			{
+				*pSpec++ = *pChar;
+				*pSpec = '\0';
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		bool bValid = true;
+		switch (spec.argType)
+		{
+		case XN_LOG_ARG_INT:
+			{
+				int nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_LONG:
+			{
+				long nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_LONG_LONG:
+			{
+				long long nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_UINT:
+			{
+				unsigned int nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_ULONG:
+			{
+				unsigned long nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_ULONG_LONG:
+			{
+				unsigned long long nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_INTMAX:
+			{
+				intmax_t nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_UINTMAX:
+			{
+				uintmax_t nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_PTRDIFF:
+			{
+				ptrdiff_t nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_SIZE:
+			{
+				size_t nValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, nValue) && (xnLogAppend(pDst, pDstEnd, strSpec, nValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_DOUBLE:
+			{
+				double dValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, dValue) && (xnLogAppend(pDst, pDstEnd, strSpec, dValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_LONG_DOUBLE:
+			{
+				long double dValue = 0;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, dValue) && (xnLogAppend(pDst, pDstEnd, strSpec, dValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_POINTER:
+			{
+				void* pValue = NULL;
+				bValid = xnLogGetArg(pIn, pInEnd, spec.argType, pValue) && (xnLogAppend(pDst, pDstEnd, strSpec, pValue) || true);
+			}
+			break;
+		case XN_LOG_ARG_STRING:
+			{
+				uint16_t nLength = 0;
+				if (pIn + 1 + sizeof(nLength) > pInEnd || *pIn != (uint8_t)XN_LOG_ARG_STRING)
+				{
+					return false;
+				}
+				memcpy(&nLength, pIn + 1, sizeof(nLength));
+				const char* strValue = (const char*)(pIn + 1 + sizeof(nLength));
+				pIn += 1 + sizeof(nLength) + nLength;
+				bValid = (pIn <= pInEnd && nLength > 0 && strValue[nLength - 1] == '\0');
+				if (bValid)
+				{
+					xnLogAppend(pDst, pDstEnd, strSpec, strValue);
+				}
+			}
+			break;
+		case XN_LOG_ARG_NONE:
+			break;
+		}
+
+		if (!bValid)
+		{
+			return false;
+		}
+	}
+
+	// and the text after the last specification
+	xnLogAppend(pDst, pDstEnd, "%s", pLiteral);
+	return true;
+}
+
+//---------------------------------------------------------------------------
+// XnLogAsyncQueue
+//---------------------------------------------------------------------------
+XnLogAsyncQueue::XnLogAsyncQueue() :
+	m_hRingsLock(NULL),
+	m_hWakeEvent(NULL),
+	m_hThread(NULL),
+	m_pDrainFunc(NULL),
+	m_bRunning(false),
+	m_nTotalDropped(0),
+	m_nReportedDropped(0)
+{
+	XnStatus nRetVal = xnOSCreateCriticalSection(&m_hRingsLock);
+	XN_ASSERT(nRetVal == XN_STATUS_OK);
+	XN_REFERENCE_VARIABLE(nRetVal);
+}
+
+XnLogAsyncQueue::~XnLogAsyncQueue()
+{
+	Stop();
+
+	// Rings of threads that are still alive are left alone - they will mark them as orphaned when they exit.
+	// This only happens when the process goes down.
+	xnl::AutoCSLocker locker(m_hRingsLock);
+	for (std::vector<XnLogThreadRing*>::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+	{
+		if ((*it)->bOrphaned.load(std::memory_order_acquire))
+		{
+			XN_DELETE(*it);
+		}
+	}
+	m_rings.clear();
+}
+
+XnStatus XnLogAsyncQueue::Start(DrainFunc pDrainFunc)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (IsRunning())
+	{
+		return (XN_STATUS_OK);
+	}
+
+	m_pDrainFunc = pDrainFunc;
+
+	if (m_hWakeEvent == NULL)
+	{
+		nRetVal = xnOSCreateEvent(&m_hWakeEvent, false);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
+	m_bRunning.store(true, std::memory_order_release);
+
+	nRetVal = xnOSCreateThread(WriterThread, this, &m_hThread);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		m_bRunning.store(false, std::memory_order_release);
+		return (nRetVal);
+	}
+
+	// The writer thread doesn't log through the queue, so the log itself can't tell about this
+	xnOSApplyThreadPolicy(m_hThread, XN_THREAD_CLASS_SERVICE, "LogWriter");
+
+	return (XN_STATUS_OK);
+}
+
+void XnLogAsyncQueue::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	m_bRunning.store(false, std::memory_order_release);
+	xnOSSetEvent(m_hWakeEvent);
+	xnOSWaitAndTerminateThread(&m_hThread, XN_LOG_ASYNC_THREAD_TIMEOUT);
+	m_hThread = NULL;
+
+	xnOSCloseEvent(&m_hWakeEvent);
+	m_hWakeEvent = NULL;
+}
+
+XN_THREAD_PROC XnLogAsyncQueue::WriterThread(XN_THREAD_PARAM pThreadParam)
+{
+	XnLogAsyncQueue* pThis = (XnLogAsyncQueue*)pThreadParam;
+
+	while (pThis->IsRunning())
+	{
+		// Entries are written in batches. Errors wake us up right away.
+		xnOSWaitEvent(pThis->m_hWakeEvent, XN_LOG_ASYNC_WRITE_INTERVAL);
+		pThis->m_pDrainFunc();
+	}
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+XnLogThreadRing* XnLogAsyncQueue::GetThreadRing()
+{
+	XnLogThreadRing* pRing = g_threadRing.pRing;
+	if (pRing == NULL)
+	{
+		// first entry written by this thread
+		pRing = XN_NEW(XnLogThreadRing);
+		if (pRing == NULL)
+		{
+			return NULL;
+		}
+
+		xnl::AutoCSLocker locker(m_hRingsLock);
+		m_rings.push_back(pRing);
+		g_threadRing.pRing = pRing;
+	}
+
+	return pRing;
+}
+
+bool XnLogAsyncQueue::PushRecord(const uint8_t* pRecord, uint32_t nSize, XnLogSeverity nSeverity)
+{
+	XnLogThreadRing* pRing = GetThreadRing();
+	if (pRing == NULL)
+	{
+		return false;
+	}
+
+	uint64_t nWritePos = pRing->nWritePos.load(std::memory_order_relaxed);
+	uint64_t nFree = XN_LOG_ASYNC_RING_SIZE - (nWritePos - pRing->nReadPos.load(std::memory_order_acquire));
+	uint32_t nOffset = (uint32_t)(nWritePos % XN_LOG_ASYNC_RING_SIZE);
+
+	// records are contiguous. If this one doesn't fit before the end of the buffer, pad up to the end.
+	uint32_t nPadding = (nOffset + nSize > XN_LOG_ASYNC_RING_SIZE) ? (XN_LOG_ASYNC_RING_SIZE - nOffset) : 0;
+	if (nPadding + nSize > nFree)
+	{
+		pRing->nDropped.fetch_add(1, std::memory_order_relaxed);
+		m_nTotalDropped.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	if (nPadding > 0)
+	{
+		XnLogRecordHeader* pPadding = (XnLogRecordHeader*)(pRing->aBuffer + nOffset);
+		pPadding->nSize = nPadding;
+		pPadding->nKind = XN_LOG_RECORD_PADDING;
+		nOffset = 0;
+	}
+
+	memcpy(pRing->aBuffer + nOffset, pRecord, nSize);
+	pRing->nWritePos.store(nWritePos + nPadding + nSize, std::memory_order_release);
+
+	if (nSeverity >= XN_LOG_ERROR || nFree - nPadding - nSize < XN_LOG_ASYNC_RING_SIZE / 2)
+	{
+		// errors should be out as soon as possible, and a filling ring shouldn't wait for the next batch
+		xnOSSetEvent(m_hWakeEvent);
+	}
+
+	return true;
+}
+
+static uint8_t* xnLogPutString(uint8_t* pOut, const char* strValue, uint16_t& nLength)
+{
+	nLength = (uint16_t)(strlen(strValue) + 1);
+	memcpy(pOut, strValue, nLength);
+	return pOut + nLength;
+}
+
+bool XnLogAsyncQueue::Push(const char* strMask, XnLogSeverity nSeverity, const char* strFile, uint32_t nLine, const char* strFormat, va_list args)
+{
+	if (!IsRunning())
+	{
+		return false;
+	}
+
+	// mask, file and format are copied, as they may belong to a module that is unloaded before the entry is written
+	size_t nStringsSize = strlen(strMask) + strlen(strFile) + strlen(strFormat) + 3;
+	if (nStringsSize > XN_LOG_ASYNC_MAX_RECORD_SIZE - sizeof(XnLogRecordHeader) - XN_LOG_ASYNC_MAX_MESSAGE_LENGTH)
+	{
+		return false;
+	}
+
+	uint64_t aRecord[XN_LOG_ASYNC_MAX_RECORD_SIZE / sizeof(uint64_t)];
+	XnLogRecordHeader* pHeader = (XnLogRecordHeader*)aRecord;
+	xnOSGetHighResTimeStamp(&pHeader->nTimestamp);
+	pHeader->nKind = XN_LOG_RECORD_ENTRY;
+	pHeader->nFlags = 0;
+	pHeader->nSeverity = nSeverity;
+	pHeader->nLine = nLine;
+
+	uint8_t* pOut = (uint8_t*)(pHeader + 1);
+	pOut = xnLogPutString(pOut, strMask, pHeader->nMaskLength);
+	pOut = xnLogPutString(pOut, strFile, pHeader->nFileLength);
+	uint8_t* pFormat = pOut;
+	pOut = xnLogPutString(pOut, strFormat, pHeader->nFormatLength);
+
+	uint8_t* pRecordEnd = (uint8_t*)aRecord + sizeof(aRecord);
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	int32_t nArgsSize = xnLogCaptureArgs(strFormat, argsCopy, pOut, (uint32_t)(pRecordEnd - pOut));
+	va_end(argsCopy);
+
+	if (nArgsSize >= 0)
+	{
+		pHeader->nArgsSize = (uint16_t)nArgsSize;
+		pOut += nArgsSize;
+	}
+	else
+	{
+		// can't defer this one - format it now, in place of the format string
+		uint32_t nChars = 0;
+		uint32_t nMaxChars = XN_MIN((uint32_t)(pRecordEnd - pFormat), XN_LOG_ASYNC_MAX_MESSAGE_LENGTH);
+		xnOSStrFormatV((char*)pFormat, nMaxChars, &nChars, strFormat, args);
+		nChars = XN_MIN(nChars, nMaxChars - 1);
+		pFormat[nChars] = '\0';
+
+		pHeader->nFlags = XN_LOG_RECORD_FLAG_FORMATTED;
+		pHeader->nFormatLength = (uint16_t)(nChars + 1);
+		pHeader->nArgsSize = 0;
+		pOut = pFormat + nChars + 1;
+	}
+
+	uint32_t nSize = (uint32_t)(pOut - (uint8_t*)aRecord);
+	pHeader->nSize = (nSize + XN_LOG_ASYNC_RECORD_ALIGNMENT - 1) & ~(XN_LOG_ASYNC_RECORD_ALIGNMENT - 1);
+
+	return PushRecord((const uint8_t*)aRecord, pHeader->nSize, nSeverity);
+}
+
+bool XnLogAsyncQueue::PushUnformatted(const char* strMessage)
+{
+	if (!IsRunning())
+	{
+		return false;
+	}
+
+	uint64_t aRecord[XN_LOG_ASYNC_MAX_RECORD_SIZE / sizeof(uint64_t)];
+	XnLogRecordHeader* pHeader = (XnLogRecordHeader*)aRecord;
+	xnOSGetHighResTimeStamp(&pHeader->nTimestamp);
+	pHeader->nKind = XN_LOG_RECORD_UNFORMATTED;
+	pHeader->nFlags = XN_LOG_RECORD_FLAG_FORMATTED;
+	pHeader->nSeverity = XN_LOG_INFO;
+	pHeader->nLine = 0;
+	pHeader->nMaskLength = 0;
+	pHeader->nFileLength = 0;
+	pHeader->nArgsSize = 0;
+
+	uint32_t nLength = (uint32_t)XN_MIN(strlen(strMessage), sizeof(aRecord) - sizeof(XnLogRecordHeader) - 1);
+	char* pMessage = (char*)(pHeader + 1);
+	memcpy(pMessage, strMessage, nLength);
+	pMessage[nLength] = '\0';
+	pHeader->nFormatLength = (uint16_t)(nLength + 1);
+
+	uint32_t nSize = sizeof(XnLogRecordHeader) + nLength + 1;
+	pHeader->nSize = (nSize + XN_LOG_ASYNC_RECORD_ALIGNMENT - 1) & ~(XN_LOG_ASYNC_RECORD_ALIGNMENT - 1);
+
+	return PushRecord((const uint8_t*)aRecord, pHeader->nSize, XN_LOG_INFO);
+}
+
+/* Skips padding at the read position of a ring. Returns the next record, or NULL if there is none before nEnd. */
+static const XnLogRecordHeader* xnLogPeekRecord(XnLogThreadRing* pRing, uint64_t nEnd)
+{
+	uint64_t nReadPos = pRing->nReadPos.load(std::memory_order_relaxed);
+	while (nReadPos < nEnd)
+	{
+		const XnLogRecordHeader* pHeader = (const XnLogRecordHeader*)(pRing->aBuffer + nReadPos % XN_LOG_ASYNC_RING_SIZE);
+		if (pHeader->nKind != XN_LOG_RECORD_PADDING)
+		{
+			return pHeader;
+		}
+
+		nReadPos += pHeader->nSize;
+		pRing->nReadPos.store(nReadPos, std::memory_order_release);
+	}
+
+	return NULL;
+}
+
+void XnLogAsyncQueue::Drain(WriteEntryFunc pWriteEntry, WriteUnformattedFunc pWriteUnformatted)
+{
+	{
+		xnl::AutoCSLocker locker(m_hRingsLock);
+		m_drainRings = m_rings;
+	}
+
+	// Only what was written until now is drained, so busy writers can't keep us here forever
+	std::vector<uint64_t> ends(m_drainRings.size());
+	for (uint32_t i = 0; i < m_drainRings.size(); ++i)
+	{
+		ends[i] = m_drainRings[i]->nWritePos.load(std::memory_order_acquire);
+	}
+
+	char strMessage[XN_LOG_ASYNC_MAX_MESSAGE_LENGTH];
+	XnLogEntry entry;
+
+	for (;;)
+	{
+		// merge the rings by timestamp
+		const XnLogRecordHeader* pNext = NULL;
+		uint32_t nNextRing = 0;
+		for (uint32_t i = 0; i < m_drainRings.size(); ++i)
+		{
+			const XnLogRecordHeader* pHeader = xnLogPeekRecord(m_drainRings[i], ends[i]);
+			if (pHeader != NULL && (pNext == NULL || pHeader->nTimestamp < pNext->nTimestamp))
+			{
+				pNext = pHeader;
+				nNextRing = i;
+			}
+		}
+
+		if (pNext == NULL)
+		{
+			break;
+		}
+
+		const char* strMask = (const char*)(pNext + 1);
+		const char* strFile = strMask + pNext->nMaskLength;
+		const char* strFormat = strFile + pNext->nFileLength;
+		const uint8_t* pArgs = (const uint8_t*)(strFormat + pNext->nFormatLength);
+
+		const char* strText = strFormat;
+		if ((pNext->nFlags & XN_LOG_RECORD_FLAG_FORMATTED) == 0)
+		{
+			if (!xnLogFormatCaptured(strFormat, pArgs, pNext->nArgsSize, strMessage, sizeof(strMessage)))
+			{
+				XN_ASSERT(false);
+			}
+			strText = strMessage;
+		}
+
+		if (pNext->nKind == XN_LOG_RECORD_UNFORMATTED)
+		{
+			pWriteUnformatted(strText);
+		}
+		else
+		{
+			entry.nTimestamp = pNext->nTimestamp;
+			entry.nSeverity = (XnLogSeverity)pNext->nSeverity;
+			entry.strSeverity = NULL;
+			entry.strMask = strMask;
+			entry.strMessage = strText;
+			entry.strFile = strFile;
+			entry.nLine = pNext->nLine;
+			pWriteEntry(&entry);
+		}
+
+		XnLogThreadRing* pRing = m_drainRings[nNextRing];
+		pRing->nReadPos.store(pRing->nReadPos.load(std::memory_order_relaxed) + pNext->nSize, std::memory_order_release);
+	}
+
+	// tell about dropped entries
+	uint64_t nTotalDropped = m_nTotalDropped.load(std::memory_order_relaxed);
+	if (nTotalDropped != m_nReportedDropped)
+	{
+		uint32_t nChars;
+		xnOSStrFormat(strMessage, sizeof(strMessage), &nChars, "%llu log entries were dropped - log is written slower than entries are added",
+			(unsigned long long)(nTotalDropped - m_nReportedDropped));
+		m_nReportedDropped = nTotalDropped;
+
+		xnOSGetHighResTimeStamp(&entry.nTimestamp);
+		entry.nSeverity = XN_LOG_WARNING;
+		entry.strSeverity = NULL;
+		entry.strMask = XN_MASK_LOG;
+		entry.strMessage = strMessage;
+		entry.strFile = __FILE__;
+		entry.nLine = __LINE__;
+		pWriteEntry(&entry);
+	}
+
+	// free the rings of threads that are gone
+	xnl::AutoCSLocker locker(m_hRingsLock);
+	for (uint32_t i = 0; i < m_rings.size(); )
+	{
+		XnLogThreadRing* pRing = m_rings[i];
+		if (pRing->bOrphaned.load(std::memory_order_acquire) &&
+			pRing->nReadPos.load(std::memory_order_relaxed) == pRing->nWritePos.load(std::memory_order_acquire))
+		{
+			m_rings.erase(m_rings.begin() + i);
+			XN_DELETE(pRing);
+		}
+		else
+		{
+			++i;
+		}
+	}
+	m_drainRings.clear();
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __XN_LOG_ASYNC_QUEUE_H__
+#define __XN_LOG_ASYNC_QUEUE_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <atomic>
+#include <vector>
+#include <stdarg.h>
+
+#include <XnOS.h>
+#include <XnLogTypes.h>
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+struct XnLogThreadRing;
+
+/**
+ * Queues log entries from any thread to a background writer thread.
+ *
+ * Each writing thread has its own single-producer ring of binary records, so queueing takes no lock.
+ * Formatting is deferred: a record holds the format string and the values of its arguments (strings
+ * are copied), and is formatted by the writer thread. Format strings the queue can't capture are
+ * formatted on the spot instead. When a thread's ring is full, its entries are dropped and counted.
+ */
+class XnLogAsyncQueue
+{
+public:
+	typedef void (*DrainFunc)();
+	typedef void (*WriteEntryFunc)(XnLogEntry* pEntry);
+	typedef void (*WriteUnformattedFunc)(const char* strMessage);
+
+	XnLogAsyncQueue();
+	~XnLogAsyncQueue();
+
+	/** Starts the writer thread, which calls pDrainFunc periodically and whenever an error is queued. **/
+	XnStatus Start(DrainFunc pDrainFunc);
+	/** Stops the writer thread. Entries still queued are left for a last Drain(). **/
+	void Stop();
+	bool IsRunning() const { return m_bRunning.load(std::memory_order_acquire); }
+
+	/** Queues an entry. Returns false if the queue isn't running (the caller should write it synchronously). **/
+	bool Push(const char* strMask, XnLogSeverity nSeverity, const char* strFile, uint32_t nLine, const char* strFormat, va_list args);
+	/** Queues an already formatted message, to be written without an entry format. **/
+	bool PushUnformatted(const char* strMessage);
+
+	/** Writes all queued entries, in timestamp order. Calls must be serialized by the caller. **/
+	void Drain(WriteEntryFunc pWriteEntry, WriteUnformattedFunc pWriteUnformatted);
+
+	/** Number of entries dropped so far because a thread's ring was full. **/
+	uint64_t GetDroppedCount() const { return m_nTotalDropped.load(std::memory_order_relaxed); }
+
+private:
+	XnLogThreadRing* GetThreadRing();
+	bool PushRecord(const uint8_t* pRecord, uint32_t nSize, XnLogSeverity nSeverity);
+
+	static XN_THREAD_PROC WriterThread(XN_THREAD_PARAM pThreadParam);
+
+	std::vector<XnLogThreadRing*> m_rings;
+	std::vector<XnLogThreadRing*> m_drainRings;
+	XN_CRITICAL_SECTION_HANDLE m_hRingsLock;
+	XN_EVENT_HANDLE m_hWakeEvent;
+	XN_THREAD_HANDLE m_hThread;
+	DrainFunc m_pDrainFunc;
+	std::atomic<bool> m_bRunning;
+	std::atomic<uint64_t> m_nTotalDropped;
+	uint64_t m_nReportedDropped;
+};
+
+#endif // __XN_LOG_ASYNC_QUEUE_H__
@@ -21,15 +21,24 @@
 //---------------------------------------------------------------------------
 // Includes
 //---------------------------------------------------------------------------
+#include <atomic>
+#include <vector>
+
 #include <XnProfiling.h>
 #include <XnLog.h>
+#include <XnOSCpp.h>
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 #define MAX_PROFILED_SECTIONS	100
-#define MAX_SECTION_NAME		256
-#define MAX_CALL_STACK_SIZE		10
+#define MAX_CALL_STACK_SIZE		32
+
+// Histogram buckets are powers of 2, each split into 4 linear sub-buckets
+#define XN_PROFILING_SUB_BUCKETS_SHIFT	2
+#define XN_PROFILING_SUB_BUCKETS		(1 << XN_PROFILING_SUB_BUCKETS_SHIFT)
+// Enough for ~12 days
+#define XN_PROFILING_HISTOGRAM_SIZE		(40 * XN_PROFILING_SUB_BUCKETS)
 
 #define XN_MASK_PROFILING		"Profiler"
 
@@ -38,88 +47,255 @@
 //---------------------------------------------------------------------------
 typedef struct
 {
-	char csName[MAX_SECTION_NAME];
-	bool bMultiThreaded;
-	XN_CRITICAL_SECTION_HANDLE hLock;
-	uint64_t nCurrStartTime;
-	uint64_t nTotalTime;
-	uint32_t nTimesExecuted;
+	char csName[XN_PROFILING_MAX_SECTION_NAME];
 	uint32_t nIndentation;
 } XnProfiledSection;
 
-typedef struct
+/* Accumulated by a single thread. The profiling thread only reads it (except for nIntervalMaxTime, which it resets). */
+typedef struct XnProfiledSectionThreadStats
+{
+	std::atomic<uint64_t> nTimesExecuted;
+	std::atomic<uint64_t> nTotalTime;
+	std::atomic<uint64_t> nMinTime;
+	std::atomic<uint64_t> nMaxTime;
+	std::atomic<uint64_t> nIntervalMaxTime;
+	std::atomic<uint64_t> aHistogram[XN_PROFILING_HISTOGRAM_SIZE];
+} XnProfiledSectionThreadStats;
+
+typedef struct XnProfilingStackEntry
+{
+	XnProfilingHandle nHandle;
+	uint64_t nStartTime;
+} XnProfilingStackEntry;
+
+typedef struct XnProfilingThreadData
+{
+	// allocated by the thread the first time it ends each section
+	std::atomic<XnProfiledSectionThreadStats*> apSections[MAX_PROFILED_SECTIONS];
+	XnProfilingStackEntry aStack[MAX_CALL_STACK_SIZE];
+	uint32_t nStackDepth;
+} XnProfilingThreadData;
+
+/* A section summed over all threads. */
+typedef struct XnProfiledSectionTotals
+{
+	uint32_t nThreads;
+	uint64_t nTimesExecuted;
+	uint64_t nTotalTime;
+	uint64_t nMinTime;
+	uint64_t nMaxTime;
+	uint64_t nIntervalMaxTime;
+	uint64_t aHistogram[XN_PROFILING_HISTOGRAM_SIZE];
+} XnProfiledSectionTotals;
+
+typedef struct XnProfilingData
 {
 	bool bInitialized;
-	XnProfiledSection* aSections;
 	uint32_t nSectionCount;
 	XN_THREAD_HANDLE hThread;
 	XN_CRITICAL_SECTION_HANDLE hCriticalSection;
 	size_t nMaxSectionName;
 	uint32_t nProfilingInterval;
 	bool bKillThread;
+	// bumped on shutdown, so that threads allocate new data when profiling is initialized again
+	uint32_t nGeneration;
+	std::vector<XnProfilingThreadData*> threads;
+	char strDumpFile[XN_FILE_MAX_PATH];
 } XnProfilingData;
 
 //---------------------------------------------------------------------------
 // Global Variables
 //---------------------------------------------------------------------------
-static XnProfilingData g_ProfilingData = {false, NULL, 0, NULL, NULL, 0, 0, false};
-static XN_THREAD_STATIC uint32_t gt_nStackDepth = 0;
+// Sections are kept for the lifetime of the process, as handles to them are kept in static variables
+static XnProfiledSection g_aSections[MAX_PROFILED_SECTIONS];
+static XnProfilingData g_ProfilingData;
+static XN_THREAD_STATIC XnProfilingThreadData* gt_pThreadData = NULL;
+static XN_THREAD_STATIC uint32_t gt_nThreadGeneration = 0;
 
 //---------------------------------------------------------------------------
-// Code
+// Histogram
 //---------------------------------------------------------------------------
-XN_THREAD_PROC xnProfilingThread(XN_THREAD_PARAM /*pThreadParam*/)
+static inline uint32_t xnProfilingGetHighestBit(uint64_t nValue)
 {
-	char csReport[4096];
-	int nReportChars;
+	uint32_t nBit = 0;
+	for (uint32_t nShift = 32; nShift > 0; nShift >>= 1)
+	{
+		if (nValue >> nShift)
+		{
+			nValue >>= nShift;
+			nBit += nShift;
+		}
+	}
+	return nBit;
+}
 
-	uint64_t nLastTime;
-	xnOSGetHighResTimeStamp(&nLastTime);
+static inline uint32_t xnProfilingGetBucket(uint64_t nTime)
+{
+	if (nTime < XN_PROFILING_SUB_BUCKETS)
+	{
+		return (uint32_t)nTime;
+	}
 
-	while (!g_ProfilingData.bKillThread)
+	uint32_t nExponent = xnProfilingGetHighestBit(nTime);
+	uint32_t nSubBucket = (uint32_t)(nTime >> (nExponent - XN_PROFILING_SUB_BUCKETS_SHIFT)) & (XN_PROFILING_SUB_BUCKETS - 1);
+	uint32_t nBucket = (nExponent - XN_PROFILING_SUB_BUCKETS_SHIFT + 1) * XN_PROFILING_SUB_BUCKETS + nSubBucket;
+	return XN_MIN(nBucket, (uint32_t)XN_PROFILING_HISTOGRAM_SIZE - 1);
+}
+
+static inline uint64_t xnProfilingGetBucketLowerBound(uint32_t nBucket)
+{
+	if (nBucket < XN_PROFILING_SUB_BUCKETS)
 	{
-		xnOSSleep(g_ProfilingData.nProfilingInterval);
+		return nBucket;
+	}
 
-		uint64_t nNow;
-		xnOSGetHighResTimeStamp(&nNow);
+	uint32_t nShift = nBucket / XN_PROFILING_SUB_BUCKETS - 1;
+	return (uint64_t)(XN_PROFILING_SUB_BUCKETS + nBucket % XN_PROFILING_SUB_BUCKETS) << nShift;
+}
+
+/* Returns the upper bound of the bucket holding the requested percentile, clamped to the maximum. */
+static uint64_t xnProfilingGetPercentile(const uint64_t* aHistogram, uint64_t nCount, uint64_t nMaxTime, uint32_t nPercentile)
+{
+	if (nCount == 0)
+	{
+		return 0;
+	}
+
+	uint64_t nRank = (nCount * nPercentile + 99) / 100;
+	uint64_t nSum = 0;
+	for (uint32_t i = 0; i < XN_PROFILING_HISTOGRAM_SIZE - 1; ++i)
+	{
+		nSum += aHistogram[i];
+		if (nSum >= nRank)
+		{
+			return XN_MIN(xnProfilingGetBucketLowerBound(i + 1) - 1, nMaxTime);
+		}
+	}
 
-		// print profiled sections
-		nReportChars = 0;
-		nReportChars += sprintf(csReport + nReportChars, "Profiling Report:\n");
-		nReportChars += sprintf(csReport + nReportChars, "%-*s %-5s %-6s %-9s %-7s\n", (int)g_ProfilingData.nMaxSectionName, "TaskName", "Times", "% Time", "TotalTime", "AvgTime");
-		nReportChars += sprintf(csReport + nReportChars, "%-*s %-5s %-6s %-9s %-7s\n", (int)g_ProfilingData.nMaxSectionName, "========", "=====", "======", "=========", "=======");
+	return nMaxTime;
+}
 
-		uint64_t nTotalTime = 0;
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+/* Sums a section over all threads. Must be called with hCriticalSection locked. */
+static void xnProfilingGetTotals(XnProfilingHandle nHandle, XnProfiledSectionTotals& totals, bool bResetIntervalMax)
+{
+	xnOSMemSet(&totals, 0, sizeof(totals));
+	totals.nMinTime = UINT64_MAX;
 
-		for (uint32_t i = 0; i < g_ProfilingData.nSectionCount; ++i)
+	for (std::vector<XnProfilingThreadData*>::const_iterator it = g_ProfilingData.threads.begin(); it != g_ProfilingData.threads.end(); ++it)
+	{
+		const XnProfiledSectionThreadStats* pStats = (*it)->apSections[nHandle].load(std::memory_order_acquire);
+		if (pStats == NULL)
 		{
-			XnProfiledSection* pSection = &g_ProfilingData.aSections[i];
+			continue;
+		}
 
-			uint64_t nAvgTime = 0;
-			double dCPUPercentage = ((double)pSection->nTotalTime) / (nNow - nLastTime) * 100.0;
+		++totals.nThreads;
+		totals.nTimesExecuted += pStats->nTimesExecuted.load(std::memory_order_relaxed);
+		totals.nTotalTime += pStats->nTotalTime.load(std::memory_order_relaxed);
+		totals.nMinTime = XN_MIN(totals.nMinTime, pStats->nMinTime.load(std::memory_order_relaxed));
+		totals.nMaxTime = XN_MAX(totals.nMaxTime, pStats->nMaxTime.load(std::memory_order_relaxed));
 
-			if (pSection->nTimesExecuted != 0)
-			{
-				nAvgTime = pSection->nTotalTime / pSection->nTimesExecuted;
-			}
+		// a racing update may be lost to the next interval, but not its total or its histogram bucket
+		std::atomic<uint64_t>& nIntervalMax = const_cast<XnProfiledSectionThreadStats*>(pStats)->nIntervalMaxTime;
+		uint64_t nThreadIntervalMax = bResetIntervalMax ? nIntervalMax.exchange(0, std::memory_order_relaxed) : nIntervalMax.load(std::memory_order_relaxed);
+		totals.nIntervalMaxTime = XN_MAX(totals.nIntervalMaxTime, nThreadIntervalMax);
+
+		for (uint32_t i = 0; i < XN_PROFILING_HISTOGRAM_SIZE; ++i)
+		{
+			totals.aHistogram[i] += pStats->aHistogram[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	if (totals.nTimesExecuted == 0)
+	{
+		totals.nMinTime = 0;
+	}
+}
+
+static void xnProfilingPrintReport(std::vector<XnProfiledSectionTotals>& lastTotals, uint64_t nInterval)
+{
+	char csReport[8192];
+	int nReportChars = 0;
+	int nNameWidth = (int)g_ProfilingData.nMaxSectionName;
 
-			nReportChars += sprintf(csReport + nReportChars, "%-*s %5u %6.2f %9" PRIu64 " %7" PRIu64 "\n", (int)g_ProfilingData.nMaxSectionName,
-				pSection->csName, pSection->nTimesExecuted, dCPUPercentage, pSection->nTotalTime, nAvgTime);
+	nReportChars += sprintf(csReport + nReportChars, "Profiling Report:\n");
+	nReportChars += sprintf(csReport + nReportChars, "%-*s %-5s %-6s %-9s %-7s %-7s %-7s %-7s\n", nNameWidth, "TaskName", "Times", "% Time", "TotalTime", "AvgTime", "P50", "P99", "MaxTime");
+	nReportChars += sprintf(csReport + nReportChars, "%-*s %-5s %-6s %-9s %-7s %-7s %-7s %-7s\n", nNameWidth, "========", "=====", "======", "=========", "=======", "=======", "=======", "=======");
 
-			if (pSection->nIndentation == 0)
-				nTotalTime += pSection->nTotalTime;
+	uint64_t nTotalTime = 0;
+	XnProfiledSectionTotals totals;
+	uint64_t aIntervalHistogram[XN_PROFILING_HISTOGRAM_SIZE];
 
-			// clear accumulated data
-			pSection->nTotalTime = 0;
-			pSection->nTimesExecuted = 0;
+	xnl::AutoCSLocker locker(g_ProfilingData.hCriticalSection);
+	lastTotals.resize(g_ProfilingData.nSectionCount);
+
+	for (uint32_t i = 0; i < g_ProfilingData.nSectionCount; ++i)
+	{
+		XnProfiledSection* pSection = &g_aSections[i];
+		XnProfiledSectionTotals& last = lastTotals[i];
+
+		// the report covers this interval only
+		xnProfilingGetTotals(i, totals, true);
+		uint64_t nTimesExecuted = totals.nTimesExecuted - last.nTimesExecuted;
+		uint64_t nSectionTime = totals.nTotalTime - last.nTotalTime;
+		for (uint32_t j = 0; j < XN_PROFILING_HISTOGRAM_SIZE; ++j)
+		{
+			aIntervalHistogram[j] = totals.aHistogram[j] - last.aHistogram[j];
 		}
+		xnOSMemCopy(&last, &totals, sizeof(totals));
 
-		// print total
-		double dCPUPercentage = ((double)nTotalTime) / (nNow - nLastTime) * 100.0;
-		sprintf(csReport + nReportChars, "%-*s %5s %6.2f %9" PRIu64 " %7s\n",
-			(int)g_ProfilingData.nMaxSectionName, "*** Total ***", "-", dCPUPercentage, nTotalTime, "-");
+		uint64_t nAvgTime = (nTimesExecuted != 0) ? nSectionTime / nTimesExecuted : 0;
+		double dCPUPercentage = ((double)nSectionTime) / nInterval * 100.0;
+		uint64_t nMaxTime = totals.nIntervalMaxTime;
 
-		xnLogVerbose(XN_MASK_PROFILING, "%s", csReport);
+		if (nReportChars + 2 * XN_PROFILING_MAX_SECTION_NAME > (int)sizeof(csReport))
+		{
+			// no room - still counted in the dump file
+			continue;
+		}
+
+		nReportChars += sprintf(csReport + nReportChars, "%*s%-*s %5" PRIu64 " %6.2f %9" PRIu64 " %7" PRIu64 " %7" PRIu64 " %7" PRIu64 " %7" PRIu64 "\n",
+			pSection->nIndentation * 2, "", nNameWidth - pSection->nIndentation * 2, pSection->csName,
+			nTimesExecuted, dCPUPercentage, nSectionTime, nAvgTime,
+			xnProfilingGetPercentile(aIntervalHistogram, nTimesExecuted, nMaxTime, 50),
+			xnProfilingGetPercentile(aIntervalHistogram, nTimesExecuted, nMaxTime, 99),
+			nMaxTime);
+
+		if (pSection->nIndentation == 0)
+			nTotalTime += nSectionTime;
+	}
+
+	// print total
+	double dCPUPercentage = ((double)nTotalTime) / nInterval * 100.0;
+	sprintf(csReport + nReportChars, "%-*s %5s %6.2f %9" PRIu64 " %7s\n",
+		nNameWidth, "*** Total ***", "-", dCPUPercentage, nTotalTime, "-");
+
+	xnLogVerbose(XN_MASK_PROFILING, "%s", csReport);
+}
+
+XN_THREAD_PROC xnProfilingThread(XN_THREAD_PARAM /*pThreadParam*/)
+{
+	std::vector<XnProfiledSectionTotals> lastTotals;
+
+	uint64_t nLastTime;
+	xnOSGetHighResTimeStamp(&nLastTime);
+
+	while (!g_ProfilingData.bKillThread)
+	{
+		xnOSSleep(g_ProfilingData.nProfilingInterval);
+
+		uint64_t nNow;
+		xnOSGetHighResTimeStamp(&nNow);
+
+		xnProfilingPrintReport(lastTotals, nNow - nLastTime);
+
+		if (g_ProfilingData.strDumpFile[0] != '\0')
+		{
+			xnProfilingDumpToFile(g_ProfilingData.strDumpFile);
+		}
 
 		nLastTime = nNow;
 	}
@@ -137,19 +313,18 @@ XN_C_API XnStatus xnProfilingInit(uint32_t nProfilingInterval)
 	}
 	else if (!g_ProfilingData.bInitialized)
 	{
-		g_ProfilingData.nMaxSectionName = 0;
-		g_ProfilingData.nSectionCount = 0;
 		g_ProfilingData.nProfilingInterval = nProfilingInterval;
 		g_ProfilingData.bKillThread = false;
 
-		XN_VALIDATE_CALLOC(g_ProfilingData.aSections, XnProfiledSection, MAX_PROFILED_SECTIONS);
-		g_ProfilingData.nSectionCount = 0;
+		if (g_ProfilingData.hCriticalSection == NULL)
+		{
+			nRetVal = xnOSCreateCriticalSection(&g_ProfilingData.hCriticalSection);
+			XN_IS_STATUS_OK(nRetVal);
+		}
 
 		nRetVal = xnOSCreateThread(xnProfilingThread, (XN_THREAD_PARAM)NULL, &g_ProfilingData.hThread);
 		XN_IS_STATUS_OK(nRetVal);
-
-		nRetVal = xnOSCreateCriticalSection(&g_ProfilingData.hCriticalSection);
-		XN_IS_STATUS_OK(nRetVal);
+		xnOSApplyThreadPolicy(g_ProfilingData.hThread, XN_THREAD_CLASS_SERVICE, "Profiling");
 
 		g_ProfilingData.bInitialized = true;
 	}
@@ -164,6 +339,11 @@ XN_C_API XnStatus xnProfilingInitFromINI(const char* cpINIFileName, const char*
 	int32_t nProfilingInterval = 0;
 	xnOSReadIntFromINI(cpINIFileName, cpSectionName, "ProfilingInterval", &nProfilingInterval);
 
+	if (xnOSReadStringFromINI(cpINIFileName, cpSectionName, "ProfilingFile", g_ProfilingData.strDumpFile, sizeof(g_ProfilingData.strDumpFile)) != XN_STATUS_OK)
+	{
+		g_ProfilingData.strDumpFile[0] = '\0';
+	}
+
 	nRetVal = xnProfilingInit(nProfilingInterval);
 	XN_IS_STATUS_OK(nRetVal);
 
@@ -180,16 +360,28 @@ XN_C_API XnStatus xnProfilingShutdown()
 		g_ProfilingData.hThread = NULL;
 	}
 
-	if (g_ProfilingData.hCriticalSection != NULL)
+	if (g_ProfilingData.bInitialized && g_ProfilingData.strDumpFile[0] != '\0')
 	{
-		xnOSCloseCriticalSection(&g_ProfilingData.hCriticalSection);
-		g_ProfilingData.hCriticalSection = NULL;
+		xnProfilingDumpToFile(g_ProfilingData.strDumpFile);
 	}
 
-	XN_FREE_AND_NULL(g_ProfilingData.aSections);
-
 	g_ProfilingData.bInitialized = false;
 
+	if (g_ProfilingData.hCriticalSection != NULL)
+	{
+		xnl::AutoCSLocker locker(g_ProfilingData.hCriticalSection);
+		for (std::vector<XnProfilingThreadData*>::iterator it = g_ProfilingData.threads.begin(); it != g_ProfilingData.threads.end(); ++it)
+		{
+			for (uint32_t i = 0; i < MAX_PROFILED_SECTIONS; ++i)
+			{
+				XN_DELETE((*it)->apSections[i].load(std::memory_order_relaxed));
+			}
+			XN_DELETE(*it);
+		}
+		g_ProfilingData.threads.clear();
+		++g_ProfilingData.nGeneration;
+	}
+
 	return XN_STATUS_OK;
 }
 
@@ -198,71 +390,280 @@ XN_C_API bool xnProfilingIsActive()
 	return (g_ProfilingData.bInitialized && g_ProfilingData.nProfilingInterval > 0);
 }
 
-XN_C_API XnStatus xnProfilingSectionStart(const char* csSectionName, bool bMT, XnProfilingHandle* pHandle)
+static XnProfilingThreadData* xnProfilingGetThreadData()
+{
+	if (gt_pThreadData != NULL && gt_nThreadGeneration == g_ProfilingData.nGeneration)
+	{
+		return gt_pThreadData;
+	}
+
+	// first section executed by this thread (since profiling was initialized)
+	XnProfilingThreadData* pThreadData = XN_NEW(XnProfilingThreadData);
+	if (pThreadData == NULL)
+	{
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < MAX_PROFILED_SECTIONS; ++i)
+	{
+		pThreadData->apSections[i].store(NULL, std::memory_order_relaxed);
+	}
+	pThreadData->nStackDepth = 0;
+
+	xnl::AutoCSLocker locker(g_ProfilingData.hCriticalSection);
+	g_ProfilingData.threads.push_back(pThreadData);
+	gt_pThreadData = pThreadData;
+	gt_nThreadGeneration = g_ProfilingData.nGeneration;
+
+	return pThreadData;
+}
+
+XN_C_API XnStatus xnProfilingSectionStart(const char* csSectionName, bool /*bMT*/, XnProfilingHandle* pHandle)
 {
 	if (!g_ProfilingData.bInitialized)
 		return XN_STATUS_OK;
 
+	XnProfilingThreadData* pThreadData = xnProfilingGetThreadData();
+	XN_VALIDATE_ALLOC_PTR(pThreadData);
+
 	if (*pHandle == INVALID_PROFILING_HANDLE)
 	{
-		xnOSEnterCriticalSection(&g_ProfilingData.hCriticalSection);
+		xnl::AutoCSLocker locker(g_ProfilingData.hCriticalSection);
 		if (*pHandle == INVALID_PROFILING_HANDLE)
 		{
+			if (g_ProfilingData.nSectionCount == MAX_PROFILED_SECTIONS)
+			{
+				return XN_STATUS_INTERNAL_BUFFER_TOO_SMALL;
+			}
+
 			uint32_t nIndex = g_ProfilingData.nSectionCount;
+			XnProfiledSection* pSection = &g_aSections[nIndex];
+			pSection->nIndentation = pThreadData->nStackDepth;
+			xnOSStrCopy(pSection->csName, csSectionName, sizeof(pSection->csName));
+
+			size_t nNameLength = pSection->nIndentation * 2 + strlen(pSection->csName);
+			if (nNameLength > g_ProfilingData.nMaxSectionName)
+				g_ProfilingData.nMaxSectionName = nNameLength;
+
 			g_ProfilingData.nSectionCount++;
-			XnProfiledSection* pSection = &g_ProfilingData.aSections[nIndex];
-			pSection->nIndentation = gt_nStackDepth;
+			*pHandle = nIndex;
+		}
+	}
 
-			uint32_t nChar = 0;
-			for (nChar = 0; nChar < gt_nStackDepth*2; ++nChar)
-				pSection->csName[nChar] = ' ';
+	if (pThreadData->nStackDepth < MAX_CALL_STACK_SIZE)
+	{
+		XnProfilingStackEntry& entry = pThreadData->aStack[pThreadData->nStackDepth];
+		entry.nHandle = *pHandle;
+		xnOSGetHighResTimeStamp(&entry.nStartTime);
+	}
 
-			strncpy(pSection->csName + nChar, csSectionName, MAX_SECTION_NAME - nChar - 1);
-			pSection->csName[MAX_SECTION_NAME - 1] = '\0';
+	pThreadData->nStackDepth++;
 
-			if (strlen(pSection->csName) > g_ProfilingData.nMaxSectionName)
-				g_ProfilingData.nMaxSectionName = strlen(pSection->csName);
+	return XN_STATUS_OK;
+}
 
-			if (bMT)
-			{
-				pSection->bMultiThreaded = true;
-				xnOSCreateCriticalSection(&pSection->hLock);
-			}
+XN_C_API XnStatus xnProfilingSectionEnd(XnProfilingHandle* pHandle)
+{
+	uint64_t nNow;
+	xnOSGetHighResTimeStamp(&nNow);
 
-			*pHandle = nIndex;
-		}
-		xnOSLeaveCriticalSection(&g_ProfilingData.hCriticalSection);
+	if (!g_ProfilingData.bInitialized || gt_pThreadData == NULL || gt_nThreadGeneration != g_ProfilingData.nGeneration)
+		return XN_STATUS_OK;
+
+	XnProfilingThreadData* pThreadData = gt_pThreadData;
+	if (pThreadData->nStackDepth == 0)
+	{
+		// section started before profiling was initialized
+		return XN_STATUS_OK;
+	}
+
+	if (pThreadData->nStackDepth > MAX_CALL_STACK_SIZE)
+	{
+		// too deep to be measured
+		pThreadData->nStackDepth--;
+		return XN_STATUS_OK;
 	}
 
-	gt_nStackDepth++;
+	const XnProfilingStackEntry& entry = pThreadData->aStack[pThreadData->nStackDepth - 1];
+	if (entry.nHandle != *pHandle)
+	{
+		// this section started before profiling was initialized, inside one that started after it
+		return XN_STATUS_OK;
+	}
 
-	XnProfiledSection* pSection = &g_ProfilingData.aSections[*pHandle];
-	xnOSGetHighResTimeStamp(&pSection->nCurrStartTime);
+	pThreadData->nStackDepth--;
+
+	XnProfiledSectionThreadStats* pStats = pThreadData->apSections[*pHandle].load(std::memory_order_relaxed);
+	if (pStats == NULL)
+	{
+		pStats = XN_NEW(XnProfiledSectionThreadStats);
+		XN_VALIDATE_ALLOC_PTR(pStats);
+
+		pStats->nTimesExecuted.store(0, std::memory_order_relaxed);
+		pStats->nTotalTime.store(0, std::memory_order_relaxed);
+		pStats->nMinTime.store(UINT64_MAX, std::memory_order_relaxed);
+		pStats->nMaxTime.store(0, std::memory_order_relaxed);
+		pStats->nIntervalMaxTime.store(0, std::memory_order_relaxed);
+		for (uint32_t i = 0; i < XN_PROFILING_HISTOGRAM_SIZE; ++i)
+		{
+			pStats->aHistogram[i].store(0, std::memory_order_relaxed);
+		}
+
+		pThreadData->apSections[*pHandle].store(pStats, std::memory_order_release);
+	}
+
+	// This thread is the only one updating these, so there's no need for atomic read-modify-write
+	uint64_t nTime = nNow - entry.nStartTime;
+	pStats->nTimesExecuted.store(pStats->nTimesExecuted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	pStats->nTotalTime.store(pStats->nTotalTime.load(std::memory_order_relaxed) + nTime, std::memory_order_relaxed);
+	if (nTime < pStats->nMinTime.load(std::memory_order_relaxed))
+	{
+		pStats->nMinTime.store(nTime, std::memory_order_relaxed);
+	}
+	if (nTime > pStats->nMaxTime.load(std::memory_order_relaxed))
+	{
+		pStats->nMaxTime.store(nTime, std::memory_order_relaxed);
+	}
+	if (nTime > pStats->nIntervalMaxTime.load(std::memory_order_relaxed))
+	{
+		pStats->nIntervalMaxTime.store(nTime, std::memory_order_relaxed);
+	}
+	std::atomic<uint64_t>& nBucket = pStats->aHistogram[xnProfilingGetBucket(nTime)];
+	nBucket.store(nBucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
 	return XN_STATUS_OK;
 }
 
-XN_C_API XnStatus xnProfilingSectionEnd(XnProfilingHandle* pHandle)
+static void xnProfilingFillStatistics(XnProfilingHandle nHandle, const XnProfiledSectionTotals& totals, XnProfilingSectionStatistics* pStatistics)
+{
+	xnOSStrCopy(pStatistics->strName, g_aSections[nHandle].csName, sizeof(pStatistics->strName));
+	pStatistics->nIndentation = g_aSections[nHandle].nIndentation;
+	pStatistics->nThreads = totals.nThreads;
+	pStatistics->nTimesExecuted = totals.nTimesExecuted;
+	pStatistics->nTotalTime = totals.nTotalTime;
+	pStatistics->nMinTime = totals.nMinTime;
+	pStatistics->nMaxTime = totals.nMaxTime;
+	pStatistics->nMedianTime = xnProfilingGetPercentile(totals.aHistogram, totals.nTimesExecuted, totals.nMaxTime, 50);
+	pStatistics->nP90Time = xnProfilingGetPercentile(totals.aHistogram, totals.nTimesExecuted, totals.nMaxTime, 90);
+	pStatistics->nP99Time = xnProfilingGetPercentile(totals.aHistogram, totals.nTimesExecuted, totals.nMaxTime, 99);
+}
+
+XN_C_API XnStatus xnProfilingGetStatistics(XnProfilingSectionStatistics* aStatistics, uint32_t* pnCount)
 {
+	XN_VALIDATE_INPUT_PTR(aStatistics);
+	XN_VALIDATE_INPUT_PTR(pnCount);
+
 	if (!g_ProfilingData.bInitialized)
+	{
+		*pnCount = 0;
 		return XN_STATUS_OK;
+	}
 
-	uint64_t nNow;
-	xnOSGetHighResTimeStamp(&nNow);
+	XnProfiledSectionTotals totals;
 
-	XnProfiledSection* pSection = &g_ProfilingData.aSections[*pHandle];
-	if (pSection->bMultiThreaded)
+	xnl::AutoCSLocker locker(g_ProfilingData.hCriticalSection);
+	uint32_t nCount = XN_MIN(*pnCount, g_ProfilingData.nSectionCount);
+	for (uint32_t i = 0; i < nCount; ++i)
 	{
-		xnOSEnterCriticalSection(&pSection->hLock);
+		xnProfilingGetTotals(i, totals, false);
+		xnProfilingFillStatistics(i, totals, &aStatistics[i]);
 	}
-	pSection->nTimesExecuted++;
-	pSection->nTotalTime += nNow - pSection->nCurrStartTime;
-	if (pSection->bMultiThreaded)
+
+	*pnCount = nCount;
+
+	return (nCount < g_ProfilingData.nSectionCount) ? XN_STATUS_OUTPUT_BUFFER_OVERFLOW : XN_STATUS_OK;
+}
+
+static XnStatus xnProfilingWriteFormatted(XN_FILE_HANDLE hFile, const char* csFormat, ...)
+{
+	char csBuffer[1024];
+	uint32_t nChars = 0;
+
+	va_list args;
+	va_start(args, csFormat);
+	XnStatus nRetVal = xnOSStrFormatV(csBuffer, sizeof(csBuffer), &nChars, csFormat, args);
+	va_end(args);
+	XN_IS_STATUS_OK(nRetVal);
+
+	return xnOSWriteFile(hFile, csBuffer, nChars);
+}
+
+static void xnProfilingEscapeName(const char* strName, char* strEscaped, uint32_t nSize)
+{
+	uint32_t nChars = 0;
+	for (const char* p = strName; *p != '\0' && nChars + 3 < nSize; ++p)
 	{
-		xnOSLeaveCriticalSection(&pSection->hLock);
+		if (*p == '"' || *p == '\\')
+		{
+			strEscaped[nChars++] = '\\';
+		}
+		strEscaped[nChars++] = ((unsigned char)*p < ' ') ? ' ' : *p;
 	}
+	strEscaped[nChars] = '\0';
+}
 
-	gt_nStackDepth--;
+XN_C_API XnStatus xnProfilingDumpToFile(const char* strFileName)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
 
-	return XN_STATUS_OK;
+	XN_VALIDATE_INPUT_PTR(strFileName);
+
+	if (!g_ProfilingData.bInitialized)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	XN_FILE_HANDLE hFile;
+	nRetVal = xnOSOpenFile(strFileName, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &hFile);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnProfiledSectionTotals totals;
+	XnProfilingSectionStatistics statistics;
+	char strName[XN_PROFILING_MAX_SECTION_NAME * 2];
+
+	uint64_t nTimestamp = 0;
+	xnOSGetHighResTimeStamp(&nTimestamp);
+	nRetVal = xnProfilingWriteFormatted(hFile, "{\n\"timestamp_us\": %" PRIu64 ",\n\"sections\": [\n", nTimestamp);
+
+	{
+		xnl::AutoCSLocker locker(g_ProfilingData.hCriticalSection);
+		for (uint32_t i = 0; i < g_ProfilingData.nSectionCount && nRetVal == XN_STATUS_OK; ++i)
+		{
+			xnProfilingGetTotals(i, totals, false);
+			xnProfilingFillStatistics(i, totals, &statistics);
+			xnProfilingEscapeName(statistics.strName, strName, sizeof(strName));
+
+			nRetVal = xnProfilingWriteFormatted(hFile,
+				"%s{\"name\": \"%s\", \"depth\": %u, \"threads\": %u, \"count\": %" PRIu64 ", \"total_us\": %" PRIu64 ", "
+				"\"min_us\": %" PRIu64 ", \"max_us\": %" PRIu64 ", \"p50_us\": %" PRIu64 ", \"p90_us\": %" PRIu64 ", \"p99_us\": %" PRIu64 ", "
+				"\"histogram\": [",
+				(i == 0) ? "" : ",\n", strName, statistics.nIndentation, statistics.nThreads, statistics.nTimesExecuted, statistics.nTotalTime,
+				statistics.nMinTime, statistics.nMaxTime, statistics.nMedianTime, statistics.nP90Time, statistics.nP99Time);
+
+			// non-empty buckets, as [lower bound, count]
+			bool bFirst = true;
+			for (uint32_t j = 0; j < XN_PROFILING_HISTOGRAM_SIZE && nRetVal == XN_STATUS_OK; ++j)
+			{
+				if (totals.aHistogram[j] != 0)
+				{
+					nRetVal = xnProfilingWriteFormatted(hFile, "%s[%" PRIu64 ", %" PRIu64 "]", bFirst ? "" : ", ", xnProfilingGetBucketLowerBound(j), totals.aHistogram[j]);
+					bFirst = false;
+				}
+			}
+
+			if (nRetVal == XN_STATUS_OK)
+			{
+				nRetVal = xnProfilingWriteFormatted(hFile, "]}");
+			}
+		}
+	}
+
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = xnProfilingWriteFormatted(hFile, "\n]\n}\n");
+	}
+
+	xnOSCloseFile(&hFile);
+
+	return (nRetVal);
 }
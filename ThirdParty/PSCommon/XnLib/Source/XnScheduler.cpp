@@ -222,6 +222,7 @@ XN_C_API XnStatus xnSchedulerStart(XnScheduler** ppScheduler)
 	// start thread
 	nRetVal = xnOSCreateThread(xnSchedulerThreadFunc, (XN_THREAD_PARAM)pScheduler, &pScheduler->hThread);
 	XN_CHECK_RC_AND_FREE(nRetVal, pScheduler);
+	xnOSApplyThreadPolicy(pScheduler->hThread, XN_THREAD_CLASS_SERVICE, "Scheduler");
 
 	*ppScheduler = pScheduler;
 
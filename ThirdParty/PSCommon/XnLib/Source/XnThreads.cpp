@@ -20,6 +20,45 @@
 *****************************************************************************/
 #include <XnLib.h>
 #include <XnLog.h>
+#include <XnOSCpp.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_THREAD_MAX_CLASSES			32
+#define XN_THREAD_MAX_CLASS_NAME		32
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct XnThreadClass
+{
+	char strName[XN_THREAD_MAX_CLASS_NAME];
+	XnThreadPolicy policy;
+} XnThreadClass;
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const char* g_astrKnownThreadClasses[] =
+{
+	XN_THREAD_CLASS_USB_READ,
+	XN_THREAD_CLASS_USB_EVENTS,
+	XN_THREAD_CLASS_DECODE,
+	XN_THREAD_CLASS_NEW_FRAME,
+	XN_THREAD_CLASS_RECORDER,
+	XN_THREAD_CLASS_PLAYER,
+	XN_THREAD_CLASS_SERVICE,
+};
+
+static XnThreadClass g_aThreadClasses[XN_THREAD_MAX_CLASSES];
+static uint32_t g_nThreadClasses = 0;
+static xnl::CriticalSection g_threadClassesLock;
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
 
 XN_C_API XnStatus xnOSWaitAndTerminateThread(XN_THREAD_HANDLE* pThreadHandle, uint32_t nMilliseconds)
 {
@@ -43,3 +82,214 @@ XN_C_API XnStatus xnOSWaitAndTerminateThread(XN_THREAD_HANDLE* pThreadHandle, ui
 
 	return (XN_STATUS_OK);
 }
+
+XN_C_API XnStatus xnOSSetThreadClassPolicy(const char* strClass, const XnThreadPolicy* pPolicy)
+{
+	XN_VALIDATE_INPUT_PTR(strClass);
+	XN_VALIDATE_INPUT_PTR(pPolicy);
+
+	xnl::AutoCSLocker locker(g_threadClassesLock);
+
+	uint32_t nClass = 0;
+	while (nClass < g_nThreadClasses && strcmp(g_aThreadClasses[nClass].strName, strClass) != 0)
+	{
+		++nClass;
+	}
+
+	if (nClass == g_nThreadClasses)
+	{
+		if (g_nThreadClasses == XN_THREAD_MAX_CLASSES)
+		{
+			return XN_STATUS_INTERNAL_BUFFER_TOO_SMALL;
+		}
+
+		XnStatus nRetVal = xnOSStrCopy(g_aThreadClasses[nClass].strName, strClass, sizeof(g_aThreadClasses[nClass].strName));
+		XN_IS_STATUS_OK(nRetVal);
+		++g_nThreadClasses;
+	}
+
+	g_aThreadClasses[nClass].policy = *pPolicy;
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSGetThreadClassPolicy(const char* strClass, XnThreadPolicy* pPolicy)
+{
+	XN_VALIDATE_INPUT_PTR(strClass);
+	XN_VALIDATE_OUTPUT_PTR(pPolicy);
+
+	xnl::AutoCSLocker locker(g_threadClassesLock);
+
+	for (uint32_t i = 0; i < g_nThreadClasses; ++i)
+	{
+		if (strcmp(g_aThreadClasses[i].strName, strClass) == 0)
+		{
+			*pPolicy = g_aThreadClasses[i].policy;
+			return (XN_STATUS_OK);
+		}
+	}
+
+	return (XN_STATUS_NO_MATCH);
+}
+
+static XnStatus xnOSParseCPUList(const char* strCPUs, uint64_t* anAffinity)
+{
+	xnOSMemSet(anAffinity, 0, sizeof(uint64_t) * XN_THREAD_AFFINITY_WORDS);
+
+	const char* pCur = strCPUs;
+	while (*pCur != '\0')
+	{
+		char* pEnd = NULL;
+		long nFirst = strtol(pCur, &pEnd, 10);
+		if (pEnd == pCur)
+		{
+			return (XN_STATUS_BAD_PARAM);
+		}
+
+		long nLast = nFirst;
+		pCur = pEnd;
+		if (*pCur == '-')
+		{
+			++pCur;
+			nLast = strtol(pCur, &pEnd, 10);
+			if (pEnd == pCur)
+			{
+				return (XN_STATUS_BAD_PARAM);
+			}
+			pCur = pEnd;
+		}
+
+		if (nFirst < 0 || nLast < nFirst || nLast >= XN_THREAD_AFFINITY_WORDS * 64)
+		{
+			return (XN_STATUS_BAD_PARAM);
+		}
+
+		for (long nCPU = nFirst; nCPU <= nLast; ++nCPU)
+		{
+			anAffinity[nCPU / 64] |= (1ULL << (nCPU % 64));
+		}
+
+		while (*pCur == ',' || *pCur == ' ')
+		{
+			++pCur;
+		}
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSLoadThreadPoliciesFromINI(const char* csINIFile, const char* csSection)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_INPUT_PTR(csINIFile);
+	XN_VALIDATE_INPUT_PTR(csSection);
+
+	for (uint32_t i = 0; i < sizeof(g_astrKnownThreadClasses) / sizeof(g_astrKnownThreadClasses[0]); ++i)
+	{
+		const char* strClass = g_astrKnownThreadClasses[i];
+		char strClassSection[XN_INI_MAX_LEN];
+		uint32_t nChars;
+		nRetVal = xnOSStrFormat(strClassSection, sizeof(strClassSection), &nChars, "%s.%s", csSection, strClass);
+		XN_IS_STATUS_OK(nRetVal);
+
+		XnThreadPolicy policy;
+		xnOSMemSet(&policy, 0, sizeof(policy));
+		policy.nSchedPolicy = XN_THREAD_SCHED_DEFAULT;
+		bool bFound = false;
+
+		char strValue[XN_INI_MAX_LEN];
+		if (xnOSReadStringFromINI(csINIFile, strClassSection, "CPUs", strValue, sizeof(strValue)) == XN_STATUS_OK)
+		{
+			if (xnOSParseCPUList(strValue, policy.anAffinity) != XN_STATUS_OK)
+			{
+				xnLogWarning(XN_MASK_OS, "Invalid CPU list '%s' for %s threads - ignoring", strValue, strClass);
+				xnOSMemSet(policy.anAffinity, 0, sizeof(policy.anAffinity));
+			}
+			bFound = true;
+		}
+
+		if (xnOSReadStringFromINI(csINIFile, strClassSection, "Policy", strValue, sizeof(strValue)) == XN_STATUS_OK)
+		{
+			if (xnOSStrCaseCmp(strValue, "Normal") == 0)
+			{
+				policy.nSchedPolicy = XN_THREAD_SCHED_NORMAL;
+			}
+			else if (xnOSStrCaseCmp(strValue, "RR") == 0)
+			{
+				policy.nSchedPolicy = XN_THREAD_SCHED_RR;
+			}
+			else if (xnOSStrCaseCmp(strValue, "FIFO") == 0)
+			{
+				policy.nSchedPolicy = XN_THREAD_SCHED_FIFO;
+			}
+			else
+			{
+				xnLogWarning(XN_MASK_OS, "Unknown scheduling policy '%s' for %s threads - ignoring", strValue, strClass);
+			}
+			bFound = true;
+		}
+
+		int32_t nPriority = 0;
+		if (xnOSReadIntFromINI(csINIFile, strClassSection, "Priority", &nPriority) == XN_STATUS_OK)
+		{
+			policy.nSchedPriority = nPriority;
+			bFound = true;
+		}
+
+		if (bFound)
+		{
+			nRetVal = xnOSSetThreadClassPolicy(strClass, &policy);
+			XN_IS_STATUS_OK(nRetVal);
+
+			xnLogVerbose(XN_MASK_OS, "Placement of %s threads was read from '%s'", strClass, csINIFile);
+		}
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSApplyThreadPolicy(XN_THREAD_HANDLE ThreadHandle, const char* strClass, const char* strName)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_INPUT_PTR(strClass);
+
+	// names are a debugging aid - don't fail for them
+	xnOSSetThreadName(ThreadHandle, (strName != NULL) ? strName : strClass);
+
+	XnThreadPolicy policy;
+	if (xnOSGetThreadClassPolicy(strClass, &policy) != XN_STATUS_OK)
+	{
+		// nothing configured for this class
+		return (XN_STATUS_OK);
+	}
+
+	bool bHasAffinity = false;
+	for (uint32_t i = 0; i < XN_THREAD_AFFINITY_WORDS; ++i)
+	{
+		bHasAffinity |= (policy.anAffinity[i] != 0);
+	}
+
+	if (bHasAffinity)
+	{
+		nRetVal = xnOSSetThreadAffinity(ThreadHandle, policy.anAffinity);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_OS, "Failed to set the CPU affinity of a %s thread: %s", strClass, xnGetStatusString(nRetVal));
+			return (nRetVal);
+		}
+	}
+
+	if (policy.nSchedPolicy != XN_THREAD_SCHED_DEFAULT)
+	{
+		nRetVal = xnOSSetThreadScheduling(ThreadHandle, policy.nSchedPolicy, policy.nSchedPriority);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_OS, "Failed to set the scheduling policy of a %s thread: %s", strClass, xnGetStatusString(nRetVal));
+			return (nRetVal);
+		}
+	}
+
+	return (XN_STATUS_OK);
+}
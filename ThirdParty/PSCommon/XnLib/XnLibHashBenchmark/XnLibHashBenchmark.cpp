@@ -0,0 +1,334 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// XnLibHashBenchmark.cpp : Compares xnl::Hash (bins of lists) with xnl::OpenHash (open addressing), on the
+// kind of keys OpenNI looks up: property IDs, pointers and module names.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <vector>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+#include <XnHash.h>
+#include <XnOpenHash.h>
+#include <XnStringsHash.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_LOOKUPS 2000000
+#define VERIFY_OPERATIONS 200000
+#define MAX_NAME_LENGTH 32
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static const uint32_t g_sizes[] = { 8, 32, 128, 1024 };
+
+/* A simple xorshift generator, so runs are repeatable. */
+static uint32_t g_nRandom = 2463534242u;
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+inline uint32_t Random()
+{
+	g_nRandom ^= g_nRandom << 13;
+	g_nRandom ^= g_nRandom >> 17;
+	g_nRandom ^= g_nRandom << 5;
+	return g_nRandom;
+}
+
+/* Property IDs look like 0x1080xxxx (driver properties) or small integers (OpenNI properties). */
+void MakeIntKeys(uint32_t nCount, std::vector<uint32_t>& keys, std::vector<uint32_t>& missingKeys)
+{
+	keys.clear();
+	missingKeys.clear();
+	for (uint32_t i = 0; i < nCount; ++i)
+	{
+		keys.push_back((i % 2 == 0) ? (0x10801000 + i) : i);
+		missingKeys.push_back((i % 2 == 0) ? (0x10802000 + i) : (0x1000 + i));
+	}
+}
+
+/* Heap objects, as used for stream and recorder keys. */
+void MakePointerKeys(uint32_t nCount, std::vector<void*>& keys, std::vector<void*>& missingKeys)
+{
+	keys.clear();
+	missingKeys.clear();
+	for (uint32_t i = 0; i < nCount; ++i)
+	{
+		keys.push_back(xnOSMalloc(64));
+		missingKeys.push_back(xnOSMalloc(64));
+	}
+}
+
+void FreePointerKeys(std::vector<void*>& keys)
+{
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		xnOSFree(keys[i]);
+	}
+	keys.clear();
+}
+
+/* Module names, like "Device", "Depth1" or "Image1". Missing keys are distinct copies of other names, so
+   lookups compare strings rather than pointers. */
+void MakeNameKeys(uint32_t nCount, std::vector<char*>& names, std::vector<const char*>& keys, std::vector<const char*>& missingKeys)
+{
+	static const char* aPrefixes[] = { "Device", "Depth", "Image", "IR", "Audio" };
+
+	uint32_t nWritten = 0;
+	names.resize(nCount * 2);
+	keys.clear();
+	missingKeys.clear();
+	for (uint32_t i = 0; i < nCount * 2; ++i)
+	{
+		names[i] = (char*)xnOSMalloc(MAX_NAME_LENGTH);
+		xnOSStrFormat(names[i], MAX_NAME_LENGTH, &nWritten, "%s%u", aPrefixes[i % 5], i);
+		if (i < nCount)
+		{
+			keys.push_back(names[i]);
+		}
+		else
+		{
+			missingKeys.push_back(names[i]);
+		}
+	}
+}
+
+void FreeNameKeys(std::vector<char*>& names)
+{
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		xnOSFree(names[i]);
+	}
+	names.clear();
+}
+
+/* Times nLookups lookups of keys (hits or misses), counting the keys found. */
+template <class THash, class TKey>
+void TimeLookups(xnl::Benchmark& benchmark, const char* strCase, const char* strHash, const THash& hash, const std::vector<TKey>& keys, uint32_t nLookups, uint32_t& nFound)
+{
+	uint32_t nCount = (uint32_t)keys.size();
+
+	benchmark.ResetTimes();
+	benchmark.StartRun();
+	for (uint32_t i = 0; i < nLookups; ++i)
+	{
+		if (hash.Find(keys[(i * 7) % nCount]) != hash.End())
+		{
+			++nFound;
+		}
+	}
+	benchmark.EndRun();
+
+	benchmark.ReportOperationTime(strCase, nLookups, strHash);
+}
+
+/* Times filling a table with keys and clearing it, about nLookups times in all. */
+template <class THash, class TKey>
+void TimeFill(xnl::Benchmark& benchmark, const char* strCase, const char* strHash, const std::vector<TKey>& keys, uint32_t nLookups)
+{
+	uint32_t nCount = (uint32_t)keys.size();
+	uint32_t nRounds = nLookups / nCount + 1;
+
+	THash hash;
+	benchmark.ResetTimes();
+	benchmark.StartRun();
+	for (uint32_t nRound = 0; nRound < nRounds; ++nRound)
+	{
+		for (uint32_t i = 0; i < nCount; ++i)
+		{
+			hash.Set(keys[i], i);
+		}
+		for (uint32_t i = 0; i < nCount; ++i)
+		{
+			hash.Remove(keys[i]);
+		}
+	}
+	benchmark.EndRun();
+
+	benchmark.ReportOperationTime(strCase, (uint64_t)nRounds * nCount, strHash);
+}
+
+template <class TChained, class TOpen, class TKey>
+void BenchmarkKeys(xnl::Benchmark& benchmark, const char* strKeys, const std::vector<TKey>& keys, const std::vector<TKey>& missingKeys, uint32_t nLookups)
+{
+	TChained chained;
+	TOpen open;
+	for (uint32_t i = 0; i < keys.size(); ++i)
+	{
+		chained.Set(keys[i], i);
+		open.Set(keys[i], i);
+	}
+
+	char strCase[64];
+	uint32_t nChars;
+	uint32_t nChainedFound = 0;
+	uint32_t nOpenFound = 0;
+
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %u keys hit", strKeys, (uint32_t)keys.size());
+	TimeLookups(benchmark, strCase, "Hash", chained, keys, nLookups, nChainedFound);
+	TimeLookups(benchmark, strCase, "OpenHash", open, keys, nLookups, nOpenFound);
+
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %u keys miss", strKeys, (uint32_t)keys.size());
+	TimeLookups(benchmark, strCase, "Hash", chained, missingKeys, nLookups, nChainedFound);
+	TimeLookups(benchmark, strCase, "OpenHash", open, missingKeys, nLookups, nOpenFound);
+
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "%s %u keys set+remove", strKeys, (uint32_t)keys.size());
+	TimeFill<TChained>(benchmark, strCase, "Hash", keys, nLookups);
+	TimeFill<TOpen>(benchmark, strCase, "OpenHash", keys, nLookups);
+
+	if (nChainedFound != nLookups || nOpenFound != nLookups)
+	{
+		benchmark.Fail("%s: found %u / %u keys instead of %u!", strKeys, nChainedFound, nOpenFound, nLookups);
+	}
+}
+
+/* Applies the same random operations to both tables, and checks they always hold the same entries. */
+void VerifyOpenHash(xnl::Benchmark& benchmark)
+{
+	typedef xnl::Hash<uint32_t, uint32_t> Chained;
+	typedef xnl::OpenHash<uint32_t, uint32_t> Open;
+
+	Chained chained;
+	Open open;
+
+	for (uint32_t i = 0; i < VERIFY_OPERATIONS; ++i)
+	{
+		// a small key range, so keys are removed and added back often
+		uint32_t nKey = Random() % 300;
+		uint32_t nOperation = Random() % 8;
+		if (nOperation < 4)
+		{
+			chained.Set(nKey, i);
+			open.Set(nKey, i);
+		}
+		else if (nOperation < 7)
+		{
+			if (chained.Remove(nKey) != open.Remove(nKey))
+			{
+				benchmark.Fail("Removing key %u gave different results!", nKey);
+				return;
+			}
+		}
+		else
+		{
+			open[nKey] += 1;
+			chained[nKey] += 1;
+		}
+
+		uint32_t nChainedValue = 0;
+		uint32_t nOpenValue = 0;
+		nKey = Random() % 300;
+		if (chained.Get(nKey, nChainedValue) != open.Get(nKey, nOpenValue) || nChainedValue != nOpenValue)
+		{
+			benchmark.Fail("Key %u has different values!", nKey);
+			return;
+		}
+
+		if (i % 1000 == 0 || i == VERIFY_OPERATIONS - 1)
+		{
+			uint32_t nEntries = 0;
+			for (Open::ConstIterator it = open.Begin(); it != open.End(); ++it, ++nEntries)
+			{
+				if (chained.Get(it->Key(), nChainedValue) != XN_STATUS_OK || nChainedValue != it->Value())
+				{
+					benchmark.Fail("Key %u is different when iterating!", it->Key());
+					return;
+				}
+			}
+			if (nEntries != chained.Size() || open.Size() != chained.Size())
+			{
+				benchmark.Fail("Tables have %u / %u entries!", chained.Size(), nEntries);
+				return;
+			}
+		}
+
+		if (i % 50000 == 49999)
+		{
+			// copies, and removal while iterating (which keeps the other iterators valid)
+			Open copy(open);
+			for (Open::Iterator it = copy.Begin(); it != copy.End(); ++it)
+			{
+				if (it->Key() % 2 == 0)
+				{
+					copy.Remove(it);
+				}
+			}
+			for (Open::ConstIterator it = open.Begin(); it != open.End(); ++it)
+			{
+				if ((copy.Find(it->Key()) != copy.End()) != (it->Key() % 2 != 0))
+				{
+					benchmark.Fail("Removal while iterating went wrong on key %u!", it->Key());
+					return;
+				}
+			}
+
+			chained.Clear();
+			open.Clear();
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t nLookups = DEFAULT_LOOKUPS;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("lookups", "Number of lookups in each run.", &nLookups);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	VerifyOpenHash(benchmark);
+
+	for (uint32_t s = 0; s < sizeof(g_sizes) / sizeof(g_sizes[0]); ++s)
+	{
+		std::vector<uint32_t> intKeys;
+		std::vector<uint32_t> missingIntKeys;
+		MakeIntKeys(g_sizes[s], intKeys, missingIntKeys);
+		BenchmarkKeys<xnl::Hash<uint32_t, uint32_t>, xnl::OpenHash<uint32_t, uint32_t> >(benchmark, "Int", intKeys, missingIntKeys, nLookups);
+
+		std::vector<void*> pointerKeys;
+		std::vector<void*> missingPointerKeys;
+		MakePointerKeys(g_sizes[s], pointerKeys, missingPointerKeys);
+		BenchmarkKeys<xnl::Hash<void*, uint32_t>, xnl::OpenHash<void*, uint32_t> >(benchmark, "Pointer", pointerKeys, missingPointerKeys, nLookups);
+		FreePointerKeys(pointerKeys);
+		FreePointerKeys(missingPointerKeys);
+
+		std::vector<char*> names;
+		std::vector<const char*> nameKeys;
+		std::vector<const char*> missingNameKeys;
+		MakeNameKeys(g_sizes[s], names, nameKeys, missingNameKeys);
+		BenchmarkKeys<xnl::XnStringsHashT<uint32_t>, xnl::XnStringsOpenHashT<uint32_t> >(benchmark, "String", nameKeys, missingNameKeys, nLookups);
+		FreeNameKeys(names);
+	}
+
+	return benchmark.GetResult();
+}
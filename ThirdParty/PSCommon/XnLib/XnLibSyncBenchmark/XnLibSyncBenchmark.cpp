@@ -0,0 +1,333 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+// XnLibSyncBenchmark.cpp : Measures the cost of XnLib's critical sections and events, with and without contention.
+//
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <condition_variable>
+#include <mutex>
+
+#include <XnOS.h>
+#include <XnBenchmark.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DEFAULT_ITERATIONS 1000000
+#define DEFAULT_ROUND_TRIPS 100000
+#define MAX_THREADS 8
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/* The lock being measured. Either a critical section or a (recursive pthread) mutex, which is what
+   critical sections used to be on Linux. */
+typedef struct
+{
+	bool bMutex;
+	XN_CRITICAL_SECTION_HANDLE hCS;
+	XN_MUTEX_HANDLE hMutex;
+	volatile uint64_t nCounter;
+} BenchmarkLock;
+
+typedef struct
+{
+	BenchmarkLock* pLock;
+	uint32_t nIterations;
+} LockThreadParams;
+
+/* A mutex and condition variable auto-reset event, the way unnamed events used to be implemented. */
+class CondVarEvent
+{
+public:
+	CondVarEvent() : m_bSignaled(false) {}
+
+	void Set()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bSignaled = true;
+		m_cond.notify_all();
+	}
+
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (!m_bSignaled)
+		{
+			m_cond.wait(lock);
+		}
+		m_bSignaled = false;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	bool m_bSignaled;
+};
+
+typedef struct
+{
+	bool bCondVar;
+	XN_EVENT_HANDLE hPing;
+	XN_EVENT_HANDLE hPong;
+	CondVarEvent* pPing;
+	CondVarEvent* pPong;
+	uint32_t nRoundTrips;
+} PingPongParams;
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+inline void Lock(BenchmarkLock* pLock)
+{
+	if (pLock->bMutex)
+	{
+		xnOSLockMutex(pLock->hMutex, XN_WAIT_INFINITE);
+	}
+	else
+	{
+		xnOSEnterCriticalSection(&pLock->hCS);
+	}
+}
+
+inline void Unlock(BenchmarkLock* pLock)
+{
+	if (pLock->bMutex)
+	{
+		xnOSUnLockMutex(pLock->hMutex);
+	}
+	else
+	{
+		xnOSLeaveCriticalSection(&pLock->hCS);
+	}
+}
+
+XN_THREAD_PROC LockThread(XN_THREAD_PARAM pParam)
+{
+	LockThreadParams* pParams = (LockThreadParams*)pParam;
+	for (uint32_t i = 0; i < pParams->nIterations; ++i)
+	{
+		Lock(pParams->pLock);
+		pParams->pLock->nCounter++;
+		Unlock(pParams->pLock);
+	}
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+/* Runs nThreads threads taking the lock nIterations times each, and checks the lock protected the counter. */
+void BenchmarkLockContention(xnl::Benchmark& benchmark, bool bMutex, uint32_t nThreads, uint32_t nIterations)
+{
+	BenchmarkLock lock;
+	lock.bMutex = bMutex;
+	lock.hCS = NULL;
+	lock.hMutex = NULL;
+	lock.nCounter = 0;
+
+	if ((bMutex ? xnOSCreateMutex(&lock.hMutex) : xnOSCreateCriticalSection(&lock.hCS)) != XN_STATUS_OK)
+	{
+		benchmark.Fail("Failed to create the lock!");
+		return;
+	}
+
+	LockThreadParams params = { &lock, nIterations };
+	XN_THREAD_HANDLE aThreads[MAX_THREADS];
+
+	benchmark.ResetTimes();
+	benchmark.StartRun();
+
+	// Even the uncontended case runs on a thread of its own - some C libraries skip atomic operations
+	// in mutexes while a process has a single thread, which OpenNI never does.
+	for (uint32_t i = 0; i < nThreads; ++i)
+	{
+		xnOSCreateThread(LockThread, &params, &aThreads[i]);
+	}
+	for (uint32_t i = 0; i < nThreads; ++i)
+	{
+		xnOSWaitAndTerminateThread(&aThreads[i], XN_WAIT_INFINITE);
+	}
+
+	benchmark.EndRun();
+
+	char strCase[64];
+	uint32_t nChars;
+	uint64_t nTotal = (uint64_t)nThreads * nIterations;
+	xnOSStrFormat(strCase, sizeof(strCase), &nChars, "Lock, %u thread(s)", nThreads);
+	benchmark.ReportOperationTime(strCase, nTotal, bMutex ? "Mutex" : "CritSec");
+
+	if (bMutex)
+	{
+		xnOSCloseMutex(&lock.hMutex);
+	}
+	else
+	{
+		xnOSCloseCriticalSection(&lock.hCS);
+	}
+
+	if (lock.nCounter != nTotal)
+	{
+		benchmark.Fail("Counter is %llu instead of %llu - the lock is broken!", (unsigned long long)lock.nCounter, (unsigned long long)nTotal);
+	}
+}
+
+XN_THREAD_PROC PongThread(XN_THREAD_PARAM pParam)
+{
+	PingPongParams* pParams = (PingPongParams*)pParam;
+	for (uint32_t i = 0; i < pParams->nRoundTrips; ++i)
+	{
+		if (pParams->bCondVar)
+		{
+			pParams->pPing->Wait();
+			pParams->pPong->Set();
+		}
+		else
+		{
+			xnOSWaitEvent(pParams->hPing, XN_WAIT_INFINITE);
+			xnOSSetEvent(pParams->hPong);
+		}
+	}
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+/* Two threads waking each other up in turns, like a frame producer and its consumer. */
+void BenchmarkPingPong(xnl::Benchmark& benchmark, bool bCondVar, uint32_t nRoundTrips)
+{
+	CondVarEvent ping;
+	CondVarEvent pong;
+	PingPongParams params = { bCondVar, NULL, NULL, &ping, &pong, nRoundTrips };
+
+	if (!bCondVar && (xnOSCreateEvent(&params.hPing, false) != XN_STATUS_OK || xnOSCreateEvent(&params.hPong, false) != XN_STATUS_OK))
+	{
+		benchmark.Fail("Failed to create events!");
+		return;
+	}
+
+	XN_THREAD_HANDLE hThread;
+	benchmark.ResetTimes();
+	benchmark.StartRun();
+
+	xnOSCreateThread(PongThread, &params, &hThread);
+	bool bResult = true;
+	for (uint32_t i = 0; i < nRoundTrips; ++i)
+	{
+		if (bCondVar)
+		{
+			ping.Set();
+			pong.Wait();
+		}
+		else
+		{
+			xnOSSetEvent(params.hPing);
+			if (xnOSWaitEvent(params.hPong, 5000) != XN_STATUS_OK)
+			{
+				benchmark.Fail("Timed out waiting for the other thread - a wake up was lost!");
+				bResult = false;
+				break;
+			}
+		}
+	}
+	xnOSWaitAndTerminateThread(&hThread, bResult ? XN_WAIT_INFINITE : 100);
+
+	benchmark.EndRun();
+	benchmark.ReportOperationTime("Event round trip", nRoundTrips, bCondVar ? "CondVar" : "XnOS");
+
+	if (!bCondVar)
+	{
+		xnOSCloseEvent(&params.hPing);
+		xnOSCloseEvent(&params.hPong);
+	}
+}
+
+/* Checks timeouts and the manual / auto reset behaviour of events. */
+void VerifyEvents(xnl::Benchmark& benchmark)
+{
+	XN_EVENT_HANDLE hAuto = NULL;
+	XN_EVENT_HANDLE hManual = NULL;
+	if (xnOSCreateEvent(&hAuto, false) != XN_STATUS_OK || xnOSCreateEvent(&hManual, true) != XN_STATUS_OK)
+	{
+		benchmark.Fail("Failed to create events!");
+		return;
+	}
+
+	uint64_t nStart = 0;
+	uint64_t nEnd = 0;
+	xnOSGetHighResTimeStamp(&nStart);
+	if (xnOSWaitEvent(hAuto, 50) != XN_STATUS_OS_EVENT_TIMEOUT)
+	{
+		benchmark.Fail("Waiting on an event that isn't set didn't time out!");
+	}
+	xnOSGetHighResTimeStamp(&nEnd);
+	if (nEnd - nStart < 45000)
+	{
+		benchmark.Fail("Event timed out after %llu us instead of 50 ms!", (unsigned long long)(nEnd - nStart));
+	}
+
+	xnOSSetEvent(hAuto);
+	if (xnOSWaitEvent(hAuto, 0) != XN_STATUS_OK || xnOSWaitEvent(hAuto, 0) != XN_STATUS_OS_EVENT_TIMEOUT)
+	{
+		benchmark.Fail("Auto-reset event wasn't reset by a wait!");
+	}
+
+	xnOSSetEvent(hManual);
+	if (xnOSWaitEvent(hManual, 0) != XN_STATUS_OK || xnOSWaitEvent(hManual, 0) != XN_STATUS_OK)
+	{
+		benchmark.Fail("Manual-reset event was reset by a wait!");
+	}
+	xnOSResetEvent(hManual);
+	if (xnOSWaitEvent(hManual, 0) != XN_STATUS_OS_EVENT_TIMEOUT)
+	{
+		benchmark.Fail("Manual-reset event wasn't reset!");
+	}
+
+	xnOSCloseEvent(&hAuto);
+	xnOSCloseEvent(&hManual);
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t nIterations = DEFAULT_ITERATIONS;
+	uint32_t nRoundTrips = DEFAULT_ROUND_TRIPS;
+
+	xnl::Benchmark benchmark;
+	benchmark.AddOption("iterations", "Number of times each thread takes the lock.", &nIterations);
+	benchmark.AddOption("roundtrips", "Number of event round trips between two threads.", &nRoundTrips);
+	if (!benchmark.ParseCommandLine(argc, argv))
+	{
+		return benchmark.GetExitCode();
+	}
+
+	VerifyEvents(benchmark);
+
+	for (uint32_t nThreads = 1; nThreads <= MAX_THREADS; nThreads *= 2)
+	{
+		BenchmarkLockContention(benchmark, true, nThreads, nIterations);
+		BenchmarkLockContention(benchmark, false, nThreads, nIterations);
+	}
+
+	BenchmarkPingPong(benchmark, true, nRoundTrips);
+	BenchmarkPingPong(benchmark, false, nRoundTrips);
+
+	return benchmark.GetResult();
+}